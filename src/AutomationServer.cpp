@@ -0,0 +1,389 @@
+//
+// Created by neapu on 2025/12/29.
+//
+
+#include "AutomationServer.h"
+#include "SessionManager.h"
+#include "codec/MediaClock.h"
+
+#include <logger.h>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QJsonDocument>
+#include <QPointer>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <optional>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <timeapi.h>
+#endif
+
+// 单行请求的长度上限，超过时断开连接
+constexpr qint64 MAX_LINE_BYTES = 1 << 20;
+constexpr qsizetype MAX_BATCH_EVENTS = 4096;
+constexpr size_t MAX_QUEUED_EVENTS = 65536;
+// 批次内相对时间的上限
+constexpr double MAX_EVENT_OFFSET_MS = 10 * 60 * 1000.0;
+constexpr int64_t LATE_THRESHOLD_US = 1000;
+
+// 堆顶为最早到期的事件
+constexpr auto LATER_THAN = [](const auto& a, const auto& b) {
+    return a.dueUs != b.dueUs ? a.dueUs > b.dueUs : a.order > b.order;
+};
+
+static std::optional<network::ControlMessage::Action> parseAction(const QString& action)
+{
+    if (action == "down") return network::ControlMessage::Action::Down;
+    if (action == "up") return network::ControlMessage::Action::Up;
+    if (action == "move") return network::ControlMessage::Action::Move;
+    return std::nullopt;
+}
+
+// 解析单个事件，画面尺寸留到发出时填写
+static std::optional<network::ControlMessage> parseEvent(const QJsonObject& event, QString& error)
+{
+    using network::ControlMessage;
+    const QString type = event.value("type").toString();
+    const auto action = parseAction(event.value("action").toString("down"));
+    if (!action) {
+        error = "invalid action";
+        return std::nullopt;
+    }
+    ControlMessage::Position position;
+    position.x = event.value("x").toInt();
+    position.y = event.value("y").toInt();
+
+    if (type == "touch") {
+        const QJsonValue pointer = event.value("pointer");
+        const uint64_t pointerId = pointer.isDouble()
+            ? static_cast<uint64_t>(pointer.toInteger())
+            : ControlMessage::POINTER_ID_GENERIC_FINGER;
+        const float pressure = *action == ControlMessage::Action::Up
+            ? 0.0f
+            : static_cast<float>(event.value("pressure").toDouble(1.0));
+        return ControlMessage::touch(*action, pointerId, position, pressure);
+    }
+    if (type == "key") {
+        if (*action == ControlMessage::Action::Move || !event.value("keycode").isDouble()) {
+            error = "key event needs keycode and down/up action";
+            return std::nullopt;
+        }
+        return ControlMessage::keycode(*action, event.value("keycode").toInt(), event.value("repeat").toInt(),
+                                       event.value("meta").toInt());
+    }
+    if (type == "scroll") {
+        const auto h = static_cast<float>(std::clamp(event.value("h").toDouble(), -16.0, 16.0));
+        const auto v = static_cast<float>(std::clamp(event.value("v").toDouble(), -16.0, 16.0));
+        return ControlMessage::scroll(position, h, v);
+    }
+    if (type == "back") {
+        return ControlMessage::backOrScreenOn(*action);
+    }
+    if (type == "clipboard") {
+        const QByteArray text = event.value("text").toString().toUtf8();
+        if (static_cast<size_t>(text.size()) > ControlMessage::CLIPBOARD_TEXT_MAX_LENGTH) {
+            error = "clipboard text too long";
+            return std::nullopt;
+        }
+        return ControlMessage::setClipboard(0, text, event.value("paste").toBool());
+    }
+    error = QString("unknown event type '%1'").arg(type);
+    return std::nullopt;
+}
+
+AutomationServer::AutomationServer()
+    : QObject(nullptr)
+{
+    m_thread.setObjectName("AutomationServer");
+    moveToThread(&m_thread);
+    m_thread.start();
+    m_running = true;
+    m_scheduler = std::thread(&AutomationServer::schedulerLoop, this);
+}
+AutomationServer::~AutomationServer()
+{
+    FUNC_TRACE;
+    stop();
+    m_running.store(false);
+    m_cv.notify_all();
+    if (m_scheduler.joinable()) {
+        m_scheduler.join();
+    }
+    m_thread.quit();
+    m_thread.wait();
+}
+bool AutomationServer::start(const QString& name)
+{
+    bool ok = false;
+    QMetaObject::invokeMethod(this, [this, name, &ok]() {
+        if (m_server) {
+            return;
+        }
+        m_server = new QLocalServer(this);
+        m_server->setSocketOptions(QLocalServer::UserAccessOption);
+        // 上次异常退出时残留的 socket 文件会导致 listen 失败
+        QLocalServer::removeServer(name);
+        if (!m_server->listen(name)) {
+            LOGE("Failed to listen on automation socket {}: {}", name.toStdString(),
+                 m_server->errorString().toStdString());
+            delete m_server;
+            m_server = nullptr;
+            return;
+        }
+        connect(m_server, &QLocalServer::newConnection, this, &AutomationServer::onNewConnection);
+        LOGI("Automation server listening on {}", m_server->fullServerName().toStdString());
+        ok = true;
+    }, Qt::BlockingQueuedConnection);
+    return ok;
+}
+void AutomationServer::stop()
+{
+    if (!m_thread.isRunning()) {
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this]() {
+        // 已连接的 socket 是服务端的子对象，一并释放
+        delete m_server;
+        m_server = nullptr;
+    }, Qt::BlockingQueuedConnection);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.clear();
+}
+AutomationServer::Stats AutomationServer::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+void AutomationServer::onNewConnection()
+{
+    while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+    }
+}
+void AutomationServer::onReadyRead(QLocalSocket* socket)
+{
+    while (socket->canReadLine()) {
+        const QByteArray line = socket->readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        QJsonParseError error{};
+        const auto document = QJsonDocument::fromJson(line, &error);
+        if (!document.isObject()) {
+            reply(socket, {{"ok", false}, {"error", QString("invalid request: %1").arg(error.errorString())}});
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_stats.requests;
+        }
+        const QJsonObject response = handle(document.object(), socket);
+        if (!response.isEmpty()) {
+            reply(socket, response);
+        }
+    }
+    if (socket->bytesAvailable() > MAX_LINE_BYTES) {
+        LOGW("Automation request exceeds {} bytes, closing connection", MAX_LINE_BYTES);
+        socket->abort();
+    }
+}
+QJsonObject AutomationServer::handle(const QJsonObject& request, QLocalSocket* socket)
+{
+    const QJsonValue id = request.value("id");
+    const QString cmd = request.value("cmd").toString();
+    const QString serial = request.value("serial").toString();
+    QJsonObject response{{"id", id}, {"ok", true}};
+
+    if (cmd == "devices") {
+        response["devices"] = QJsonArray::fromStringList(SessionManager::instance()->openedSerials());
+        return response;
+    }
+    if (cmd == "open") {
+        // 会话只能在主线程创建，结果回到 I/O 线程再应答
+        QPointer<QLocalSocket> guard(socket);
+        QMetaObject::invokeMethod(SessionManager::instance(), [this, guard, serial, response]() mutable {
+            const bool opened = SessionManager::instance()->isDeviceOpened(serial)
+                || SessionManager::instance()->openDevice(serial);
+            response["ok"] = opened;
+            if (!opened) {
+                response["error"] = "failed to open session";
+            }
+            QMetaObject::invokeMethod(this, [guard, response]() {
+                if (guard) {
+                    reply(guard, response);
+                }
+            }, Qt::QueuedConnection);
+        }, Qt::QueuedConnection);
+        return {};
+    }
+    if (cmd == "frame") {
+        const bool found = SessionManager::instance()->withSession(serial, [&](Session& session) {
+            const auto info = session.latestFrameInfo();
+            response["width"] = info.size.width();
+            response["height"] = info.size.height();
+            response["pts"] = static_cast<qint64>(info.pts);
+            response["frames"] = static_cast<qint64>(info.frames);
+            response["ageMs"] = info.frames > 0
+                ? static_cast<double>(codec::MediaClock::nowUs() - info.decodedUs) / 1000.0
+                : -1.0;
+        });
+        if (!found) {
+            response["ok"] = false;
+            response["error"] = "session not opened";
+        }
+        return response;
+    }
+    if (cmd == "events") {
+        QJsonObject result = scheduleEvents(serial, request.value("events").toArray());
+        result["id"] = id;
+        return result;
+    }
+    if (cmd == "stats") {
+        const Stats stats = this->stats();
+        response["requests"] = static_cast<qint64>(stats.requests);
+        response["events"] = static_cast<qint64>(stats.events);
+        response["failed"] = static_cast<qint64>(stats.failed);
+        response["late"] = static_cast<qint64>(stats.late);
+        response["avgLatenessUs"] = stats.events ? stats.totalLatenessUs / static_cast<int64_t>(stats.events) : 0;
+        response["maxLatenessUs"] = stats.maxLatenessUs;
+        // 指定了会话时附带该会话帧分析器的统计
+        if (!serial.isEmpty()) {
+            SessionManager::instance()->withSession(serial, [&](Session& session) {
+                QJsonArray analyzers;
+                for (const auto& analyzer : session.frameAnalyzerStats()) {
+                    QJsonObject item;
+                    item["name"] = QString::fromStdString(analyzer.name);
+                    item["analyzed"] = static_cast<qint64>(analyzer.analyzed);
+                    item["skipped"] = static_cast<qint64>(analyzer.skipped);
+                    item["failed"] = static_cast<qint64>(analyzer.failed);
+                    item["avgLatencyUs"] = analyzer.analyzed
+                        ? analyzer.totalLatencyUs / static_cast<int64_t>(analyzer.analyzed) : 0;
+                    item["maxLatencyUs"] = analyzer.maxLatencyUs;
+                    item["avgAnalyzeUs"] = analyzer.analyzed
+                        ? analyzer.totalAnalyzeUs / static_cast<int64_t>(analyzer.analyzed) : 0;
+                    item["maxAnalyzeUs"] = analyzer.maxAnalyzeUs;
+                    analyzers.append(item);
+                }
+                response["analyzers"] = analyzers;
+            });
+        }
+        return response;
+    }
+    response["ok"] = false;
+    response["error"] = QString("unknown command '%1'").arg(cmd);
+    return response;
+}
+QJsonObject AutomationServer::scheduleEvents(const QString& serial, const QJsonArray& events)
+{
+    if (!SessionManager::instance()->isDeviceOpened(serial)) {
+        return {{"ok", false}, {"error", "session not opened"}};
+    }
+    if (events.isEmpty() || events.size() > MAX_BATCH_EVENTS) {
+        return {{"ok", false}, {"error", QString("batch must contain 1 to %1 events").arg(MAX_BATCH_EVENTS)}};
+    }
+    // 先整批解析，任何一个事件无效都不发送
+    const int64_t baseUs = codec::MediaClock::nowUs();
+    std::vector<ScheduledEvent> batch;
+    batch.reserve(static_cast<size_t>(events.size()));
+    for (qsizetype i = 0; i < events.size(); ++i) {
+        const QJsonObject event = events.at(i).toObject();
+        const double atMs = event.value("at").toDouble(0.0);
+        QString error;
+        auto message = parseEvent(event, error);
+        if (!message || !std::isfinite(atMs) || atMs < 0.0 || atMs > MAX_EVENT_OFFSET_MS) {
+            return {{"ok", false}, {"error", QString("event %1: %2").arg(i).arg(message ? "invalid time" : error)}};
+        }
+        ScheduledEvent scheduled;
+        scheduled.dueUs = baseUs + std::llround(atMs * 1000.0);
+        scheduled.serial = serial;
+        scheduled.needsScreenSize = message->type == network::ControlMessage::Type::InjectTouchEvent
+            || message->type == network::ControlMessage::Type::InjectScrollEvent;
+        scheduled.message = std::move(*message);
+        batch.push_back(std::move(scheduled));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_queue.size() + batch.size() > MAX_QUEUED_EVENTS) {
+            return {{"ok", false}, {"error", "too many pending events"}};
+        }
+        for (auto& scheduled : batch) {
+            scheduled.order = m_order++;
+            m_queue.push_back(std::move(scheduled));
+            std::push_heap(m_queue.begin(), m_queue.end(), LATER_THAN);
+        }
+    }
+    m_cv.notify_one();
+    return {{"ok", true}, {"scheduled", static_cast<qint64>(batch.size())}};
+}
+void AutomationServer::reply(QLocalSocket* socket, const QJsonObject& response)
+{
+    socket->write(QJsonDocument(response).toJson(QJsonDocument::Compact));
+    socket->write("\n");
+}
+void AutomationServer::schedulerLoop()
+{
+#ifdef _WIN32
+    // 默认的系统定时器精度约 15ms，等待到期事件时需要 1ms
+    timeBeginPeriod(1);
+#endif
+    std::vector<ScheduledEvent> due;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_running.load()) {
+        if (m_queue.empty()) {
+            m_cv.wait(lock, [&] { return !m_running.load() || !m_queue.empty(); });
+            continue;
+        }
+        const int64_t nextUs = m_queue.front().dueUs;
+        if (nextUs > codec::MediaClock::nowUs()) {
+            // MediaClock 基于 steady_clock，可以直接换算成等待的截止时刻
+            m_cv.wait_until(lock, std::chrono::steady_clock::time_point(std::chrono::microseconds(nextUs)));
+            continue;
+        }
+        const int64_t nowUs = codec::MediaClock::nowUs();
+        while (!m_queue.empty() && m_queue.front().dueUs <= nowUs) {
+            std::pop_heap(m_queue.begin(), m_queue.end(), LATER_THAN);
+            due.push_back(std::move(m_queue.back()));
+            m_queue.pop_back();
+        }
+        lock.unlock();
+
+        uint64_t failed = 0;
+        int64_t totalLatenessUs = 0;
+        int64_t maxLatenessUs = 0;
+        uint64_t late = 0;
+        for (auto& event : due) {
+            bool sent = false;
+            SessionManager::instance()->withSession(event.serial, [&](Session& session) {
+                if (event.needsScreenSize) {
+                    const QSize size = session.frameSize();
+                    event.message.position.screenWidth = static_cast<uint16_t>(size.width());
+                    event.message.position.screenHeight = static_cast<uint16_t>(size.height());
+                }
+                event.message.timestampUs = codec::MediaClock::nowUs();
+                sent = session.sendControlMessage(event.message);
+            });
+            const int64_t latenessUs = codec::MediaClock::nowUs() - event.dueUs;
+            failed += sent ? 0 : 1;
+            late += latenessUs > LATE_THRESHOLD_US ? 1 : 0;
+            totalLatenessUs += latenessUs;
+            maxLatenessUs = std::max(maxLatenessUs, latenessUs);
+        }
+
+        lock.lock();
+        m_stats.events += due.size();
+        m_stats.failed += failed;
+        m_stats.late += late;
+        m_stats.totalLatenessUs += totalLatenessUs;
+        m_stats.maxLatenessUs = std::max(m_stats.maxLatenessUs, maxLatenessUs);
+        due.clear();
+    }
+    lock.unlock();
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+}
@@ -0,0 +1,93 @@
+//
+// Created by neapu on 2025/12/29.
+//
+
+#pragma once
+#include <QObject>
+#include <QThread>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QString>
+#include "network/ControlMessage.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <atomic>
+
+class QLocalServer;
+class QLocalSocket;
+
+// 本机自动化接口：本地 socket（Unix 域 socket / Windows 命名管道）上的逐行 JSON 请求，每行一个对象，
+// 应答同样是一行 JSON 并带回请求的 id。socket 运行在独立的 I/O 线程上，控制事件按批次内的相对时间
+// 由调度线程直接送入会话的控制通道，都不经过界面线程。
+//
+//   {"id":1,"cmd":"devices"}
+//   {"id":2,"cmd":"open","serial":"..."}
+//   {"id":3,"cmd":"frame","serial":"..."}
+//   {"id":4,"cmd":"events","serial":"...","events":[
+//       {"at":0,"type":"touch","action":"down","x":540,"y":1200,"pointer":0},
+//       {"at":80,"type":"touch","action":"up","x":540,"y":1200,"pointer":0},
+//       {"at":200,"type":"key","action":"down","keycode":4}, ...]}
+//   {"id":5,"cmd":"stats"}
+//   {"id":6,"cmd":"stats","serial":"..."}
+//
+// at 为相对收到批次时刻的毫秒数，可以带小数。触控坐标为画面像素，发送时按设备当前的画面尺寸填写。
+// 事件类型：touch（down/up/move）、key（down/up）、scroll（h/v）、back（down/up）、clipboard（text/paste）
+// stats 带 serial 时附带该会话各帧分析器的统计（analyzers）
+class AutomationServer : public QObject {
+    Q_OBJECT
+public:
+    AutomationServer();
+    ~AutomationServer() override;
+
+    // 只允许当前用户连接，同名的残留 socket 会被移除
+    bool start(const QString& name);
+    void stop();
+
+    struct Stats {
+        uint64_t requests{0};
+        uint64_t events{0};
+        // 会话不存在或控制通道队列已满
+        uint64_t failed{0};
+        // 发出时刻晚于计划超过 1ms
+        uint64_t late{0};
+        int64_t totalLatenessUs{0};
+        int64_t maxLatenessUs{0};
+    };
+    Stats stats() const;
+
+private:
+    struct ScheduledEvent {
+        int64_t dueUs{0};
+        // 同一时刻的事件按加入的顺序发出
+        uint64_t order{0};
+        QString serial;
+        network::ControlMessage message;
+        // 触控和滚动事件在发出时填写画面尺寸
+        bool needsScreenSize{false};
+    };
+
+    void onNewConnection();
+    void onReadyRead(QLocalSocket* socket);
+    // 返回空对象表示应答稍后异步发出
+    QJsonObject handle(const QJsonObject& request, QLocalSocket* socket);
+    QJsonObject scheduleEvents(const QString& serial, const QJsonArray& events);
+    static void reply(QLocalSocket* socket, const QJsonObject& response);
+    void schedulerLoop();
+
+private:
+    QThread m_thread;
+    // 只在 I/O 线程访问
+    QLocalServer* m_server{nullptr};
+
+    std::thread m_scheduler;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    // 按 dueUs 排列的最小堆
+    std::vector<ScheduledEvent> m_queue;
+    uint64_t m_order{0};
+    std::atomic<bool> m_running{false};
+    Stats m_stats;
+};
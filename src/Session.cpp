@@ -5,10 +5,22 @@
 #include "Session.h"
 
 #include "device/AdbHelper.h"
+#include "codec/DecoderProbe.h"
+#include "codec/NullAudioSink.h"
+#include "audio/QtAudioSink.h"
 
 #include <logger.h>
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCryptographicHash>
 #include <QCoreApplication>
+#include <QGuiApplication>
+#include <QClipboard>
+#include <QStandardPaths>
+#include <QRegularExpression>
+#include <optional>
+#include <algorithm>
 
 constexpr auto SCRCPY_SERVER_PATH = "/data/local/tmp/scrcpy-server.jar";
 constexpr auto SCRCPY_SERVER_VERSION = "3.3.3";
@@ -17,6 +29,69 @@ constexpr auto VIDEO_CODEC_H264_ID = 0x68323634;
 constexpr auto VIDEO_CODEC_HEVC_ID = 0x68323635;
 constexpr auto VIDEO_CODEC_AV1_ID  = 0x00617631;
 
+constexpr auto AUDIO_CODEC_DISABLED = 0;
+constexpr auto AUDIO_CODEC_ERROR = 1;
+constexpr auto AUDIO_CODEC_OPUS_ID = 0x6f707573;
+constexpr auto AUDIO_CODEC_AAC_ID  = 0x00616163;
+constexpr auto AUDIO_CODEC_FLAC_ID = 0x666c6163;
+constexpr auto AUDIO_CODEC_RAW_ID  = 0x00726177;
+
+// android.view.KeyEvent.KEYCODE_HOME
+constexpr int32_t AKEYCODE_HOME = 3;
+constexpr int32_t AKEYCODE_0 = 7;
+constexpr int32_t AKEYCODE_A = 29;
+constexpr int32_t AKEYCODE_SPACE = 62;
+constexpr int32_t AKEYCODE_ENTER = 66;
+constexpr int32_t AKEYCODE_DEL = 67;
+
+// 按像素缩放码率时的下限，画面很小时也保证基本清晰度
+constexpr int MIN_VIDEO_BIT_RATE = 1000000;
+
+// 超过该时间没有解码出新帧视为画面静止
+constexpr int64_t STATIC_SCREEN_US = 200000;
+
+// 每隔多少帧输出一次同步统计
+constexpr uint64_t SYNC_STATS_INTERVAL_FRAMES = 600;
+
+// 探针按键注入时使用的 Android 键值，只覆盖字母、数字和少数常用键
+static int32_t toAndroidKeycode(int key)
+{
+    if (key >= Qt::Key_A && key <= Qt::Key_Z) return AKEYCODE_A + (key - Qt::Key_A);
+    if (key >= Qt::Key_0 && key <= Qt::Key_9) return AKEYCODE_0 + (key - Qt::Key_0);
+    switch (key) {
+    case Qt::Key_Space: return AKEYCODE_SPACE;
+    case Qt::Key_Return: return AKEYCODE_ENTER;
+    case Qt::Key_Backspace: return AKEYCODE_DEL;
+    default: return 0;
+    }
+}
+
+// 解析 "wm size" 的输出，存在 Override size 时以它为准（它在 Physical size 之后输出）
+static QSize parseWmSize(const QString& output)
+{
+    static const QRegularExpression regex(R"((?:Physical|Override) size:\s*(\d+)x(\d+))");
+    QSize size;
+    auto it = regex.globalMatch(output);
+    while (it.hasNext()) {
+        const auto match = it.next();
+        size = QSize(match.captured(1).toInt(), match.captured(2).toInt());
+    }
+    return size;
+}
+
+// 与服务端的 max_size 处理一致：长边缩到 maxSize 以内，宽高对齐到 8
+static QSize fitToMaxSize(const QSize& size, int maxSize)
+{
+    if (size.isEmpty()) {
+        return size;
+    }
+    QSize fitted = size;
+    if (maxSize > 0 && std::max(size.width(), size.height()) > maxSize) {
+        fitted = size.scaled(maxSize, maxSize, Qt::KeepAspectRatio);
+    }
+    return {fitted.width() & ~7, fitted.height() & ~7};
+}
+
 static QString getScrcpyServerLocalPath()
 {
 #ifdef DEBUG_MODE
@@ -26,52 +101,197 @@ static QString getScrcpyServerLocalPath()
 #endif
 }
 
-Session::Session(const QString& serial, QObject* parent)
+struct LocalServerFileInfo {
+    qint64 size{0};
+    QByteArray md5;
+    QDateTime lastModified;
+};
+
+// 本地服务端文件的大小和哈希，文件未修改时复用上次的计算结果
+static std::optional<LocalServerFileInfo> getLocalServerFileInfo(const QString& path)
+{
+    static QMutex mutex;
+    static std::optional<LocalServerFileInfo> cached;
+
+    const QFileInfo fileInfo(path);
+    if (!fileInfo.exists()) {
+        return std::nullopt;
+    }
+
+    QMutexLocker locker(&mutex);
+    if (cached && cached->size == fileInfo.size() && cached->lastModified == fileInfo.lastModified()) {
+        return cached;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return std::nullopt;
+    }
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    if (!hash.addData(&file)) {
+        return std::nullopt;
+    }
+    cached = LocalServerFileInfo{fileInfo.size(), hash.result().toHex(), fileInfo.lastModified()};
+    return cached;
+}
+
+// 解析设备端 "stat -c %s; md5sum" 的输出并与本地文件比较
+static bool remoteServerMatches(const QString& output, const LocalServerFileInfo& local)
+{
+    const QStringList lines = output.split('\n', Qt::SkipEmptyParts);
+    if (lines.size() < 2) {
+        return false;
+    }
+    bool ok = false;
+    const qint64 remoteSize = lines[0].trimmed().toLongLong(&ok);
+    if (!ok || remoteSize != local.size) {
+        return false;
+    }
+    const QString remoteMd5 = lines[1].trimmed().section(' ', 0, 0);
+    return remoteMd5.toLatin1() == local.md5;
+}
+
+Session::Session(const QString& serial, const SessionOptions& options, QObject* parent)
     : QObject(parent)
     , m_serial(serial)
+    , m_options(options)
+    , m_clock(options.syncMode)
+    , m_keymapStore(QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation) + "/keymaps")
 {
     m_network = new network::Network(this);
+    connect(m_network, &network::Network::receivedDeviceName, this, [this](const QByteArray& name) {
+        if (m_relay) {
+            m_relay->setDeviceName(name);
+        }
+    });
     connect(m_network, &network::Network::receivedVideoMetaData, this, &Session::onReceivedVideoMetaData);
     connect(m_network, &network::Network::receivedVideoData, this, &Session::onReceivedVideoData);
     connect(m_network, &network::Network::receivedAudioMetaData, this, &Session::onReceivedAudioMetaData);
     connect(m_network, &network::Network::receivedAudioData, this, &Session::onReceivedAudioData);
+    // 控制通道的信号在其 I/O 线程发出，剪贴板需要回到主线程处理
+    connect(m_network->controlChannel(), &network::ControlChannel::clipboardReceived, this,
+            &Session::onDeviceClipboardReceived, Qt::QueuedConnection);
+    connect(QGuiApplication::clipboard(), &QClipboard::dataChanged, this, &Session::onLocalClipboardChanged);
 }
 bool Session::open()
 {
     FUNC_TRACE;
+    m_openTimer.start();
+    m_firstFrameReceived = false;
+    m_network->setAudioEnabled(m_options.audio);
+    m_network->setControlEnabled(m_options.control);
     if (!m_network->start()) {
         LOGE("Failed to start network for device {}", m_serial.toStdString());
         return false;
     }
 
     m_deviceWindow = new view::DeviceWindow();
+    // 视频与音频按同一个时钟呈现，同步模式由时钟决定
+    view::PresentationScheduler::Config presentationConfig;
+    presentationConfig.clock = &m_clock;
+    m_deviceWindow->setPresentationConfig(presentationConfig);
+    m_deviceWindow->setCursorOverlay(m_options.cursorOverlay);
+    m_deviceWindow->setScaler(m_options.scaler);
+    m_deviceWindow->setRegionOfInterest(m_options.viewRegion);
     connect(m_deviceWindow, &view::DeviceWindow::windowClosed, this, &Session::onWindowClosed, Qt::QueuedConnection);
+    connect(m_deviceWindow, &view::DeviceWindow::framePresented, this, &Session::onFramePresented);
+    connect(m_deviceWindow, &view::DeviceWindow::backRequested, this, &Session::onBackRequested);
+    connect(m_deviceWindow, &view::DeviceWindow::homeRequested, this, &Session::onHomeRequested);
+    // 主机剪贴板只同步给活动窗口对应的设备，切换到其他设备窗口时再同步给该设备
+    connect(m_deviceWindow, &view::DeviceWindow::activated, this, &Session::onLocalClipboardChanged);
+    if (m_options.control) {
+        if (m_options.inputMode == SessionOptions::InputMode::Uhid) {
+            startUhidInput();
+        } else {
+            startKeymap();
+        }
+        if (m_options.latencyProbe) {
+            startLatencyProbe();
+        }
+    }
+    if (!m_options.recordPath.isEmpty()) {
+        startRecording();
+    }
+    if (m_options.relayPort >= 0) {
+        m_relay = std::make_unique<network::StreamRelay>();
+        if (!m_relay->start(static_cast<quint16>(m_options.relayPort))) {
+            m_relay.reset();
+        }
+    }
+    {
+        QMutexLocker locker(&m_frameHooksMutex);
+        m_frameHooksOpen = true;
+    }
+    if (m_options.sharedMemoryExport) {
+#ifdef __linux__
+        m_frameExporter = std::make_unique<codec::SharedFrameExporter>(
+            m_frameBus, codec::SharedFrameExporter::nameForSerial(m_serial.toStdString()));
+#else
+        LOGW("Shared memory frame export is only supported on Linux");
+#endif
+    }
     m_deviceWindow->show();
 
     const QString localServerPath = getScrcpyServerLocalPath();
-    if (!QFile::exists(localServerPath)) {
+    const auto localServer = getLocalServerFileInfo(localServerPath);
+    if (!localServer) {
         LOGE("Scrcpy server file not found: {}", localServerPath.toStdString());
     }
 
-    device::AdbHelper::runCommandAsync(m_serial, {
-        "push",
-        localServerPath,
-        QString::fromLatin1(SCRCPY_SERVER_PATH)
-    }).onFailed(this, [this](const device::AdbException& ex) -> QString {
-        LOGE("Failed to push scrcpy server to device {}: {}", m_serial.toStdString(), ex.message().toStdString());
-        throw ex;
-    }).then(this, [this](const QString& output) {
-        Q_UNUSED(output);
+    // 推送服务端与设置reverse互不依赖，并行执行，两者都完成后再启动服务端
+    auto pushFuture = device::AdbHelper::runCommandAsync(m_serial, {
+        "shell",
+        QString("stat -c %s %1 2>/dev/null; md5sum %1 2>/dev/null").arg(SCRCPY_SERVER_PATH)
+    }).onFailed(this, [](const device::AdbException&) {
+        // 文件不存在时命令返回非0，按需要推送处理
+        return QString();
+    }).then(this, [this, localServerPath, localServer](const QString& output) {
+        if (localServer && remoteServerMatches(output, *localServer)) {
+            LOGI("Scrcpy server on device {} is up to date, skipping push", m_serial.toStdString());
+            return QtFuture::makeReadyValueFuture(QString());
+        }
         return device::AdbHelper::runCommandAsync(m_serial, {
-            "reverse",
-            "localabstract:scrcpy",
-            QString("tcp:%1").arg(m_network->port())
+            "push",
+            localServerPath,
+            QString::fromLatin1(SCRCPY_SERVER_PATH)
         });
     }).unwrap().onFailed(this, [this](const device::AdbException& ex) -> QString {
+        LOGE("Failed to push scrcpy server to device {}: {}", m_serial.toStdString(), ex.message().toStdString());
+        throw ex;
+    });
+
+    auto reverseFuture = device::AdbHelper::runCommandAsync(m_serial, {
+        "reverse",
+        "localabstract:scrcpy",
+        QString("tcp:%1").arg(m_network->port())
+    }).onFailed(this, [this](const device::AdbException& ex) -> QString {
         LOGE("Failed to set adb reverse for device {}: {}", m_serial.toStdString(), ex.message().toStdString());
         throw ex;
-    }).then(this, [this](const QString& output2) {
-        Q_UNUSED(output2);
+    });
+
+    // 设备屏幕尺寸用于按实际传输的像素数缩放码率，查询失败时不缩放
+    auto screenSizeFuture = device::AdbHelper::runCommandAsync(m_serial, {
+        "shell",
+        "wm size"
+    }).then(this, [this](const QString& output) {
+        m_deviceScreenSize = parseWmSize(output);
+        return output;
+    }).onFailed(this, [this](const device::AdbException& ex) {
+        LOGW("Failed to query screen size of device {}: {}", m_serial.toStdString(), ex.message().toStdString());
+        return QString();
+    });
+
+    QList<QFuture<QString>> setupFutures{pushFuture, reverseFuture, screenSizeFuture};
+    QtFuture::whenAll(setupFutures.begin(), setupFutures.end()).then(this, [this](const QList<QFuture<QString>>& results) {
+        for (const auto& future : results) {
+            try {
+                Q_UNUSED(future.result());
+            } catch (const device::AdbException&) {
+                // 错误已在各自的步骤中记录
+                return;
+            }
+        }
+        LOGI("Device {} setup finished in {} ms", m_serial.toStdString(), m_openTimer.elapsed());
         startScrcpyServer();
     });
 
@@ -88,12 +308,110 @@ void Session::startScrcpyServer()
     args << "com.genymobile.scrcpy.Server";
     args << SCRCPY_SERVER_VERSION;
     args << "tunnel_forward=false";
-    args << "control=false";
+    args << QString("control=%1").arg(m_options.control ? "true" : "false");
     args << "video=true";
-    args << "audio=false";
+    args << QString("audio=%1").arg(m_options.audio ? "true" : "false");
     args << "cleanup=true";
-    args << "video_bit_rate=8000000";
-    args << "video_codec=h264";
+
+    // 根据本机解码能力选择编码格式和分辨率上限，探测未完成时使用 H.264 软硬解默认流程
+    int maxSize = m_options.maxSize;
+    if (m_options.autoSelectCodec) {
+        if (const auto selection = codec::DecoderProbe::instance()->select(m_options.maxFps)) {
+            m_videoCodec = selection->codecType;
+            m_swDecode = selection->swDecode;
+            if (maxSize == 0 || (selection->maxSize > 0 && selection->maxSize < maxSize)) {
+                maxSize = selection->maxSize;
+            }
+            LOGI("Selected codec {} ({} decode), max_size={} for device {}", codec::DecoderProbe::codecName(m_videoCodec),
+                 m_swDecode ? "sw" : "hw", maxSize, m_serial.toStdString());
+        } else {
+            LOGI("Decoder probe not ready, using default codec for device {}", m_serial.toStdString());
+        }
+    }
+    const QSize windowSize = windowPixelSize();
+    // 适应窗口时画面按自身宽高比放进窗口，以放入后的长边作为 max_size
+    const auto fitMaxSizeToWindow = [&](const QSize& source, bool followsWindowOrientation) {
+        if (!m_options.fitToWindow || windowSize.isEmpty()) {
+            return;
+        }
+        QSize fitted = windowSize;
+        if (!source.isEmpty()) {
+            QSize oriented = source;
+            // 设备画面会随旋转改变方向，假定与窗口方向一致
+            if (followsWindowOrientation
+                && (oriented.width() > oriented.height()) != (windowSize.width() > windowSize.height())) {
+                oriented.transpose();
+            }
+            fitted = fitToMaxSize(oriented.scaled(windowSize, Qt::KeepAspectRatio), 0);
+        }
+        const int windowMaxSize = std::max(fitted.width(), fitted.height());
+        if (windowMaxSize > 0 && (maxSize == 0 || windowMaxSize < maxSize)) {
+            maxSize = windowMaxSize;
+        }
+    };
+
+    // 实际编码的画面尺寸，用于缩放码率
+    QSize sourceSize = m_deviceScreenSize;
+    if (m_options.newDisplay) {
+        QSize displaySize = m_options.newDisplaySize;
+        if (displaySize.isEmpty() && m_options.fitToWindow) {
+            // 虚拟显示器与窗口同宽高比，画面不需要留黑边
+            displaySize = windowSize;
+        }
+        fitMaxSizeToWindow(displaySize, false);
+        displaySize = fitToMaxSize(displaySize, maxSize);
+        QString value;
+        if (!displaySize.isEmpty()) {
+            value = QString("%1x%2").arg(displaySize.width()).arg(displaySize.height());
+            sourceSize = displaySize;
+        }
+        if (m_options.newDisplayDpi > 0) {
+            value += QString("/%1").arg(m_options.newDisplayDpi);
+        }
+        args << QString("new_display=%1").arg(value);
+        if (!m_options.startApp.isEmpty()) {
+            // 控制连接建立后随第一批消息发出，服务端会等虚拟显示器创建完成再启动
+            sendControlMessage(network::ControlMessage::startApp(m_options.startApp.toUtf8()));
+        }
+    }
+
+    if (!m_options.crop.isEmpty()) {
+        if (m_options.newDisplay) {
+            // 虚拟显示器本身就是按需创建的尺寸，服务端不支持二者同时使用
+            LOGW("Crop is ignored on a new display for device {}", m_serial.toStdString());
+        } else {
+            const QRect& crop = m_options.crop;
+            args << QString("crop=%1:%2:%3:%4").arg(crop.width()).arg(crop.height()).arg(crop.x()).arg(crop.y());
+            // max_size 作用于裁剪后的画面
+            sourceSize = crop.size();
+        }
+    }
+    if (!m_options.newDisplay) {
+        // 裁剪区域以设备自然方向给出，不随旋转
+        fitMaxSizeToWindow(sourceSize, m_options.crop.isEmpty());
+    }
+
+    int bitRate = m_options.videoBitRate;
+    if (m_options.scaleBitRate && !sourceSize.isEmpty() && !m_deviceScreenSize.isEmpty()) {
+        const QSize encodedSize = fitToMaxSize(sourceSize, maxSize);
+        const double ratio = static_cast<double>(encodedSize.width()) * encodedSize.height()
+            / (static_cast<double>(m_deviceScreenSize.width()) * m_deviceScreenSize.height());
+        if (ratio < 1.0) {
+            bitRate = std::max(MIN_VIDEO_BIT_RATE, static_cast<int>(bitRate * ratio));
+        }
+        LOGI("Encoding {}x{} of {}x{} for device {}, bit rate {}", encodedSize.width(), encodedSize.height(),
+             m_deviceScreenSize.width(), m_deviceScreenSize.height(), m_serial.toStdString(), bitRate);
+    }
+
+    args << QString("video_bit_rate=%1").arg(bitRate);
+    args << QString("video_codec=%1").arg(codec::DecoderProbe::codecName(m_videoCodec));
+    args << QString("max_fps=%1").arg(m_options.maxFps);
+    if (maxSize > 0) {
+        args << QString("max_size=%1").arg(maxSize);
+    }
+    if (m_options.audio) {
+        args << "audio_codec=opus";
+    }
     m_adbProcess = device::AdbHelper::runBackgroundCommand(m_serial, args);
     if (!m_adbProcess) {
         LOGE("Failed to start scrcpy server for device {}", m_serial.toStdString());
@@ -114,18 +432,155 @@ void Session::startScrcpyServer()
         }
     }, Qt::QueuedConnection);
     m_adbProcess->start();
-    LOGI("Started scrcpy server for device {}", m_serial.toStdString());
+    LOGI("Started scrcpy server for device {} at {} ms", m_serial.toStdString(), m_openTimer.elapsed());
+}
+QSize Session::windowPixelSize() const
+{
+    if (!m_deviceWindow || !m_deviceWindow->centralWidget()) {
+        return {};
+    }
+    const QWidget* widget = m_deviceWindow->centralWidget();
+    const qreal ratio = widget->devicePixelRatioF();
+    return {static_cast<int>(widget->width() * ratio), static_cast<int>(widget->height() * ratio)};
+}
+bool Session::sendControlMessage(const network::ControlMessage& message) const
+{
+    if (!m_options.control) {
+        return false;
+    }
+    return m_network->sendControlMessage(message);
+}
+void Session::requestFreshFrame()
+{
+    if (m_firstFrameReceived && codec::MediaClock::nowUs() - m_lastFrameDecodedUs.load() > STATIC_SCREEN_US
+        && !sendControlMessage(network::ControlMessage::resetVideo())) {
+        LOGW("Screen of device {} is static, waiting for the next frame", m_serial.toStdString());
+    }
+}
+bool Session::grabFrame(const codec::FrameGrabber::Request& request)
+{
+    {
+        QMutexLocker locker(&m_frameHooksMutex);
+        if (!m_frameHooksOpen) {
+            return false;
+        }
+        if (!m_frameGrabber) {
+            // 大多数会话从不抓帧，用到时才启动工作线程
+            m_frameGrabber = std::make_unique<codec::FrameGrabber>();
+            m_activeFrameGrabber.store(m_frameGrabber.get());
+        }
+        m_frameGrabber->request(request);
+    }
+    requestFreshFrame();
+    return true;
+}
+int Session::addFrameAnalyzer(std::shared_ptr<codec::FrameAnalyzer> analyzer)
+{
+    int id = -1;
+    {
+        QMutexLocker locker(&m_frameHooksMutex);
+        if (!m_frameHooksOpen) {
+            return -1;
+        }
+        if (!m_frameAnalysisHost) {
+            // 没有分析器时不启动工作线程，解码线程也不引用帧
+            m_frameAnalysisHost = std::make_unique<codec::FrameAnalysisHost>(m_options.analysisWorkers);
+            m_activeFrameAnalysisHost.store(m_frameAnalysisHost.get());
+        }
+        id = m_frameAnalysisHost->add(std::move(analyzer));
+    }
+    // 宿主在没有分析器时不保留帧，新分析器等待下一帧
+    requestFreshFrame();
+    return id;
+}
+void Session::removeFrameAnalyzer(int id)
+{
+    QMutexLocker locker(&m_frameHooksMutex);
+    if (m_frameAnalysisHost) {
+        m_frameAnalysisHost->remove(id);
+    }
+}
+std::vector<codec::FrameAnalysisHost::Stats> Session::frameAnalyzerStats() const
+{
+    QMutexLocker locker(&m_frameHooksMutex);
+    return m_frameAnalysisHost ? m_frameAnalysisHost->stats() : std::vector<codec::FrameAnalysisHost::Stats>{};
 }
-void Session::onVideoFrameDecoded(codec::FramePtr&& frame) const
+codec::FrameBus::SubscriptionPtr Session::subscribeFrames(const std::string& name, codec::FrameBus::Policy policy,
+                                                         size_t capacity, std::function<void()> notify)
 {
+    return m_frameBus.subscribe(name, policy, capacity, std::move(notify));
+}
+void Session::unsubscribeFrames(const codec::FrameBus::SubscriptionPtr& subscription)
+{
+    m_frameBus.unsubscribe(subscription);
+}
+QSize Session::frameSize() const
+{
+    const uint32_t packed = m_frameSize.load();
+    return {static_cast<int>(packed >> 16), static_cast<int>(packed & 0xffff)};
+}
+Session::FrameInfo Session::latestFrameInfo() const
+{
+    FrameInfo info;
+    info.size = frameSize();
+    info.pts = m_lastFramePts.load();
+    info.frames = m_decodedFrames.load();
+    info.decodedUs = m_lastFrameDecodedUs.load();
+    return info;
+}
+void Session::onVideoFrameDecoded(codec::FramePtr&& frame)
+{
+    // 旋转或分辨率变化后以解码出的帧为准
+    m_frameSize = static_cast<uint32_t>(frame->width()) << 16 | static_cast<uint32_t>(frame->height() & 0xffff);
+    m_lastFramePts = frame->pts();
+    m_lastFrameDecodedUs = codec::MediaClock::nowUs();
+    ++m_decodedFrames;
+    if (!m_firstFrameReceived.exchange(true)) {
+        m_timeToFirstFrameMs = m_openTimer.elapsed();
+        LOGI("Time to first frame for device {}: {} ms", m_serial.toStdString(), m_timeToFirstFrameMs.load());
+    }
+    // 以下钩子不经过帧总线：探针需要在解码线程上按到达时刻比较画面，抓帧器和分析宿主空闲时直接返回、
+    // 不引用帧，而总线订阅会为每一帧保留引用
+    if (m_latencyProbe) {
+        m_latencyProbe->onFrame(*frame);
+    }
+    if (auto* grabber = m_activeFrameGrabber.load()) {
+        grabber->onFrame(*frame);
+    }
+    if (auto* host = m_activeFrameAnalysisHost.load()) {
+        host->onFrame(*frame);
+    }
+    // 各订阅者只取得引用，窗口仍然接管这一帧
+    m_frameBus.publish(*frame);
     if (!m_deviceWindow) return;
+    // 呈现时刻由渲染端的调度器决定
     QMetaObject::invokeMethod(m_deviceWindow, [dw = m_deviceWindow, f = std::move(frame)]() mutable {
         dw->renderFrame(std::move(f));
     }, Qt::QueuedConnection);
 }
+void Session::onFramePresented(qint64 pts)
+{
+    if (m_latencyProbe) {
+        m_latencyProbe->onPresented(pts);
+    }
+    if (pts >= 0 && m_audioDecoder) {
+        if (const int64_t audioPts = m_audioDecoder->playingPts(); audioPts >= 0) {
+            m_clock.reportSkew(pts, audioPts);
+        }
+    }
+
+    if (++m_presentedFrames % SYNC_STATS_INTERVAL_FRAMES == 0 && m_deviceWindow) {
+        const auto stats = m_deviceWindow->presentationStats();
+        LOGI("Sync stats for device {}: A/V skew {} us, drift {:.1f} ppm, presentation delay {} us, jitter {} us, "
+             "shown {}, skipped {}, repeated {}, latency mean {:.0f} us, stddev {:.0f} us",
+             m_serial.toStdString(), m_clock.skewUs(), m_clock.driftPpm(), stats.delayUs, stats.jitterUs,
+             stats.shown, stats.skipped, stats.repeated, stats.latencyMeanUs, stats.latencyStdDevUs);
+    }
+}
 void Session::onWindowClosed()
 {
     FUNC_TRACE;
+    emit sessionClosing(m_serial);
     if (m_adbProcess) {
         m_adbProcess->terminate();
         m_adbProcess->waitForFinished(3000);
@@ -137,13 +592,270 @@ void Session::onWindowClosed()
         QMutexLocker locker(&m_videoDecoderMutex);
         m_videoDecoder.reset();
     }
+    stopAudio();
+    stopRecording();
+    std::unique_ptr<codec::FrameGrabber> frameGrabber;
+    std::unique_ptr<codec::FrameAnalysisHost> frameAnalysisHost;
+    {
+        QMutexLocker locker(&m_frameHooksMutex);
+        m_frameHooksOpen = false;
+        m_activeFrameGrabber.store(nullptr);
+        frameGrabber = std::move(m_frameGrabber);
+        m_activeFrameAnalysisHost.store(nullptr);
+        frameAnalysisHost = std::move(m_frameAnalysisHost);
+    }
+    if (frameGrabber) {
+        const auto stats = frameGrabber->stats();
+        if (stats.requested > 0) {
+            LOGI("Frame grab stats for device {}: {} requests, {} saved, {} failed, {} skipped, process avg {} us, max {} us",
+                 m_serial.toStdString(), stats.requested, stats.saved, stats.failed, stats.skipped,
+                 stats.saved + stats.failed ? stats.totalProcessUs / static_cast<int64_t>(stats.saved + stats.failed) : 0,
+                 stats.maxProcessUs);
+        }
+        // 析构时等待进行中的抓取写完，未完成的请求以失败回调
+        frameGrabber.reset();
+    }
+    if (frameAnalysisHost) {
+        for (const auto& stats : frameAnalysisHost->stats()) {
+            LOGI("Frame analyzer {} on device {}: {} analyzed, {} skipped, {} failed, latency avg {} us, max {} us, "
+                 "analyze avg {} us, max {} us",
+                 stats.name, m_serial.toStdString(), stats.analyzed, stats.skipped, stats.failed,
+                 stats.analyzed ? stats.totalLatencyUs / static_cast<int64_t>(stats.analyzed) : 0, stats.maxLatencyUs,
+                 stats.analyzed ? stats.totalAnalyzeUs / static_cast<int64_t>(stats.analyzed) : 0, stats.maxAnalyzeUs);
+        }
+        // 等待进行中的分析返回
+        frameAnalysisHost.reset();
+    }
+#ifdef __linux__
+    if (m_frameExporter) {
+        const auto stats = m_frameExporter->stats();
+        LOGI("Shared memory export stats for device {}: {} exported, {} skipped, {} failed, {} reallocations, "
+             "write avg {} us, max {} us",
+             m_serial.toStdString(), stats.exported, stats.skipped, stats.failed, stats.reallocations,
+             stats.exported + stats.failed ? stats.totalWriteUs / static_cast<int64_t>(stats.exported + stats.failed) : 0,
+             stats.maxWriteUs);
+        // 析构时标记共享内存作废并删除
+        m_frameExporter.reset();
+    }
+#endif
+    for (const auto& stats : m_frameBus.stats()) {
+        LOGI("Frame subscriber {} on device {} ({}): {} published, {} taken, {} dropped",
+             stats.name, m_serial.toStdString(),
+             stats.policy == codec::FrameBus::Policy::LatestOnly ? "latest only" : "queued",
+             stats.published, stats.taken, stats.dropped);
+    }
+    m_frameBus.unsubscribeAll();
+    if (m_latencyProbe) {
+        // 解码器已销毁，探针不会再被解码线程访问
+        m_latencyProbeTimer.stop();
+        const auto stats = m_latencyProbe->stats();
+        LOGI("Latency probe for device {}: {} samples, {} timeouts, click-to-photon median {} us, p95 {} us, min {} us, max {} us",
+             m_serial.toStdString(), stats.samples, stats.timeouts, stats.medianPresentUs, stats.p95PresentUs,
+             stats.minPresentUs, stats.maxPresentUs);
+        m_latencyProbe.reset();
+    }
+    if (m_keymapEngine) {
+        m_deviceWindow->setInputSink(nullptr);
+        const auto stats = m_keymapEngine->stats();
+        LOGI("Keymap stats for device {}: {} events, {} messages, {} dropped, latency avg {} us, max {} us",
+             m_serial.toStdString(), stats.events, stats.messages, stats.dropped,
+             stats.events ? stats.totalLatencyUs / static_cast<int64_t>(stats.events) : 0, stats.maxLatencyUs);
+        m_keymapEngine.reset();
+    }
+    if (m_uhidInput) {
+        m_deviceWindow->setInputSink(nullptr);
+        const auto stats = m_uhidInput->stats();
+        LOGI("UHID input stats for device {}: {} events, {} reports, {} dropped, latency avg {} us, max {} us",
+             m_serial.toStdString(), stats.events, stats.reports, stats.dropped,
+             stats.events ? stats.totalLatencyUs / static_cast<int64_t>(stats.events) : 0, stats.maxLatencyUs);
+        // 析构时发送销毁消息，必须在关闭网络之前
+        m_uhidInput.reset();
+    }
+    if (m_options.control) {
+        const auto stats = m_network->controlChannel()->stats();
+        LOGI("Control stats for device {}: {} sent, {} merged, {} dropped, queue delay avg {} us, max {} us, "
+             "ack rtt avg {} us, max {} us ({} acks)",
+             m_serial.toStdString(), stats.sent, stats.merged, stats.dropped,
+             stats.sent ? stats.totalQueueDelayUs / static_cast<int64_t>(stats.sent) : 0, stats.maxQueueDelayUs,
+             stats.acks ? stats.totalAckRttUs / static_cast<int64_t>(stats.acks) : 0, stats.maxAckRttUs, stats.acks);
+    }
+    m_syncedClipboard.clear();
+    m_clock.reset();
+    m_frameSize = 0;
+    m_lastFramePts = -1;
+    m_decodedFrames = 0;
 
+    if (m_relay) {
+        const auto stats = m_relay->stats();
+        LOGI("Stream relay stats for device {}: {} viewers, {} dropped, {} packets, {} bytes sent",
+             m_serial.toStdString(), stats.viewers, stats.dropped, stats.packets, stats.bytesSent);
+        m_relay.reset();
+    }
     m_network->stop();
     m_deviceWindow->deleteLater();
     m_deviceWindow = nullptr;
 
     emit sessionClosed(m_serial);
 }
+void Session::startKeymap()
+{
+    m_keymapEngine = std::make_unique<input::KeymapEngine>(
+        [this](const network::ControlMessage& message) { return m_network->sendControlMessage(message); },
+        [this]() { return frameSize(); },
+        [this](bool enabled) {
+            if (enabled) {
+                // 开启映射时玩家通常已经进入游戏，此时再按前台应用切换配置
+                QMetaObject::invokeMethod(this, &Session::refreshKeymapProfile, Qt::QueuedConnection);
+            }
+        });
+    m_keymapEngine->setProfile(m_keymapStore.load({}));
+    m_deviceWindow->setInputSink(m_keymapEngine.get());
+}
+void Session::startUhidInput()
+{
+    // 消息在控制连接建立前进入队列，连接后随第一批写出
+    m_uhidInput = std::make_unique<input::UhidInput>(
+        [this](const network::ControlMessage& message) { return m_network->sendControlMessage(message); });
+    m_deviceWindow->setInputSink(m_uhidInput.get());
+}
+void Session::startRecording()
+{
+    codec::Recorder::CreateParam param;
+    param.path = m_options.recordPath.toStdString();
+    param.format = m_options.recordPath.endsWith(".mkv", Qt::CaseInsensitive) ? codec::Recorder::Format::mkv
+                                                                              : codec::Recorder::Format::mp4;
+    param.audio = m_options.audio;
+    try {
+        auto recorder = std::make_unique<codec::Recorder>(param);
+        QMutexLocker locker(&m_videoDecoderMutex);
+        m_recorder = std::move(recorder);
+    } catch (const std::exception& ex) {
+        // 录制失败不影响投屏
+        LOGE("Failed to start recording for device {}: {}", m_serial.toStdString(), ex.what());
+    }
+}
+void Session::stopRecording()
+{
+    std::unique_ptr<codec::Recorder> recorder;
+    {
+        QMutexLocker locker(&m_videoDecoderMutex);
+        recorder = std::move(m_recorder);
+    }
+    if (!recorder) {
+        return;
+    }
+    recorder->stop();
+    const auto stats = recorder->stats();
+    LOGI("Recording stats for device {}: {} video packets, {} audio packets, {} dropped, {} bytes",
+         m_serial.toStdString(), stats.videoPackets, stats.audioPackets, stats.dropped, stats.bytes);
+}
+void Session::startLatencyProbe()
+{
+    m_latencyProbe = std::make_unique<codec::LatencyProbe>(m_options.latencyProbeConfig, [this]() {
+        return triggerLatencyProbe();
+    });
+    m_latencyProbeTimer.setInterval(m_options.latencyProbeIntervalMs);
+    connect(&m_latencyProbeTimer, &QTimer::timeout, this, [this]() {
+        if (!m_latencyProbe) {
+            return;
+        }
+        m_latencyProbe->poll();
+        // 上一次测量结束后再开始下一次，画面静止时也由超时推进
+        m_latencyProbe->start();
+    }, Qt::UniqueConnection);
+    m_latencyProbeTimer.start();
+    LOGI("Latency probe enabled for device {}", m_serial.toStdString());
+}
+bool Session::triggerLatencyProbe()
+{
+    const int64_t nowUs = codec::MediaClock::nowUs();
+    if (m_options.probeAction == SessionOptions::ProbeAction::Key) {
+        if (m_uhidInput) {
+            // 走完整的 UHID 输入路径，与注入模式的结果可以直接比较
+            input::InputEvent event;
+            event.type = input::InputEvent::Type::KeyPress;
+            event.timestampUs = nowUs;
+            event.key = m_options.probeKey;
+            m_uhidInput->post(event);
+            event.type = input::InputEvent::Type::KeyRelease;
+            m_uhidInput->post(event);
+            return true;
+        }
+        const int32_t keycode = toAndroidKeycode(m_options.probeKey);
+        if (keycode == 0) {
+            LOGW("Latency probe key {} has no Android keycode", m_options.probeKey);
+            return false;
+        }
+        return sendControlMessage(network::ControlMessage::keycode(network::ControlMessage::Action::Down, keycode))
+            && sendControlMessage(network::ControlMessage::keycode(network::ControlMessage::Action::Up, keycode));
+    }
+
+    // UHID 鼠标是相对坐标，无法点击指定位置，点击始终以触控注入
+    const QSize size = frameSize();
+    if (size.isEmpty()) {
+        return false;
+    }
+    const auto& config = m_options.latencyProbeConfig;
+    network::ControlMessage::Position position;
+    position.x = static_cast<int32_t>((config.roiX + config.roiWidth / 2) * static_cast<float>(size.width()));
+    position.y = static_cast<int32_t>((config.roiY + config.roiHeight / 2) * static_cast<float>(size.height()));
+    position.screenWidth = static_cast<uint16_t>(size.width());
+    position.screenHeight = static_cast<uint16_t>(size.height());
+    return sendControlMessage(network::ControlMessage::touch(network::ControlMessage::Action::Down,
+                                                             network::ControlMessage::POINTER_ID_GENERIC_FINGER, position))
+        && sendControlMessage(network::ControlMessage::touch(network::ControlMessage::Action::Up,
+                                                             network::ControlMessage::POINTER_ID_GENERIC_FINGER, position));
+}
+void Session::refreshKeymapProfile()
+{
+    device::AdbHelper::runCommandAsync(m_serial, {
+        "shell",
+        "dumpsys window | grep -E 'mCurrentFocus|mFocusedApp'"
+    }).then(this, [this](const QString& output) {
+        // 形如 mCurrentFocus=Window{1a2b3c u0 com.example.game/com.example.game.MainActivity}
+        static const QRegularExpression regex(R"(\s([A-Za-z0-9_.]+)/)");
+        const auto match = regex.match(output);
+        if (!match.hasMatch() || !m_keymapEngine) {
+            return;
+        }
+        const QString packageName = match.captured(1);
+        LOGI("Foreground app on device {}: {}", m_serial.toStdString(), packageName.toStdString());
+        m_keymapEngine->setProfile(m_keymapStore.load(packageName));
+    }).onFailed(this, [this](const device::AdbException& ex) {
+        LOGW("Failed to query foreground app on device {}: {}", m_serial.toStdString(), ex.message().toStdString());
+    });
+}
+void Session::onBackRequested() const
+{
+    sendControlMessage(network::ControlMessage::backOrScreenOn(network::ControlMessage::Action::Down));
+    sendControlMessage(network::ControlMessage::backOrScreenOn(network::ControlMessage::Action::Up));
+}
+void Session::onHomeRequested() const
+{
+    sendControlMessage(network::ControlMessage::keycode(network::ControlMessage::Action::Down, AKEYCODE_HOME));
+    sendControlMessage(network::ControlMessage::keycode(network::ControlMessage::Action::Up, AKEYCODE_HOME));
+}
+void Session::onDeviceClipboardReceived(const QString& text)
+{
+    if (!m_options.clipboardSync || !m_deviceWindow) {
+        return;
+    }
+    m_syncedClipboard = text;
+    QGuiApplication::clipboard()->setText(m_syncedClipboard);
+}
+void Session::onLocalClipboardChanged()
+{
+    if (!m_options.control || !m_options.clipboardSync || !m_deviceWindow || !m_deviceWindow->isActiveWindow()) {
+        return;
+    }
+    const QString text = QGuiApplication::clipboard()->text();
+    if (text.isEmpty() || text == m_syncedClipboard) {
+        return;
+    }
+    m_syncedClipboard = text;
+    // 带序号请求确认，确认的往返时间计入控制通道的延迟统计
+    sendControlMessage(network::ControlMessage::setClipboard(++m_clipboardSequence, text.toUtf8(), false));
+}
 void Session::onReceivedDeviceName(const QString& deviceName)
 {
     qInfo() << "Connected to device:" << deviceName;
@@ -154,6 +866,10 @@ void Session::onReceivedDeviceName(const QString& deviceName)
 void Session::onReceivedVideoMetaData(int codec, int width, int height)
 {
     LOGI("Received video metadata: codec={}, width={}, height={}", codec, width, height);
+    m_frameSize = static_cast<uint32_t>(width) << 16 | static_cast<uint32_t>(height & 0xffff);
+    if (m_relay) {
+        m_relay->setVideoMetaData(codec, width, height);
+    }
     if (m_videoDecoder) {
         return;
     }
@@ -172,21 +888,34 @@ void Session::onReceivedVideoMetaData(int codec, int width, int height)
         return;
     }
     param.frameCallback = std::bind(&Session::onVideoFrameDecoded, this, std::placeholders::_1);
-    param.swDecode = false;
+    param.swDecode = m_swDecode;
 
     {
         QMutexLocker locker(&m_videoDecoderMutex);
         m_videoDecoder = std::make_unique<codec::VideoDecoder>(param);
+        if (m_recorder) {
+            m_recorder->setVideoStream(param.codecType, width, height);
+        }
     }
 }
 void Session::onReceivedVideoData(bool configFlag, bool keyFrameFlag, int64_t pts, const QByteArray& data)
 {
+    if (!configFlag) {
+        m_clock.update(pts);
+    }
+    if (m_relay) {
+        m_relay->pushVideo(configFlag, keyFrameFlag, pts, data);
+    }
     auto packet = codec::Packet::fromData(configFlag, keyFrameFlag, pts, reinterpret_cast<const uint8_t*>(data.constData()), data.size());
     if (!packet) {
         LOGE("Failed to create video packet");
         return;
     }
     QMutexLocker locker(&m_videoDecoderMutex);
+    if (m_recorder) {
+        // 与解码器共享同一份数据
+        m_recorder->pushVideo(packet->ref());
+    }
     if (m_videoDecoder) {
         m_videoDecoder->decode(std::move(packet));
     }
@@ -194,16 +923,98 @@ void Session::onReceivedVideoData(bool configFlag, bool keyFrameFlag, int64_t pt
 void Session::onReceivedAudioMetaData(int codecId)
 {
     LOGI("Received audio metadata: codecId={}", codecId);
+    if (codecId == AUDIO_CODEC_DISABLED) {
+        LOGW("Audio is not available on device {}", m_serial.toStdString());
+        if (m_recorder) {
+            m_recorder->disableAudio();
+        }
+        return;
+    }
+    if (codecId == AUDIO_CODEC_ERROR) {
+        LOGE("Audio capture failed on device {}", m_serial.toStdString());
+        if (m_recorder) {
+            m_recorder->disableAudio();
+        }
+        return;
+    }
+    if (m_audioDecoder) {
+        return;
+    }
+
+    codec::AudioDecoder::CreateParam param;
+    if (codecId == AUDIO_CODEC_OPUS_ID) {
+        param.codecType = codec::AudioDecoder::CodecType::opus;
+    } else if (codecId == AUDIO_CODEC_AAC_ID) {
+        param.codecType = codec::AudioDecoder::CodecType::aac;
+    } else if (codecId == AUDIO_CODEC_FLAC_ID) {
+        param.codecType = codec::AudioDecoder::CodecType::flac;
+    } else if (codecId == AUDIO_CODEC_RAW_ID) {
+        param.codecType = codec::AudioDecoder::CodecType::raw;
+    } else {
+        LOGE("Unsupported audio codec ID: {}", codecId);
+        if (m_recorder) {
+            m_recorder->disableAudio();
+        }
+        return;
+    }
+    if (m_recorder) {
+        m_recorder->setAudioStream(param.codecType);
+    }
+    param.bufferMs = m_options.audioBufferMs;
+    param.clock = &m_clock;
+
+    try {
+        m_audioDecoder = std::make_unique<codec::AudioDecoder>(param);
+    } catch (const std::exception& ex) {
+        LOGE("Failed to create audio decoder for device {}: {}", m_serial.toStdString(), ex.what());
+        return;
+    }
+    startAudioOutput();
 }
 void Session::onReceivedAudioData(bool configFlag, bool keyFrameFlag, int64_t pts, const QByteArray& data)
 {
-    // TODO: Handle audio data
-    LOGD("Received audio data: pts={}, size={}", pts, data.size());
-    if (configFlag) {
-        LOGI("Is config frame");
+    if (!m_audioDecoder && !m_recorder) {
+        return;
+    }
+    auto packet = codec::Packet::fromData(configFlag, keyFrameFlag, pts, reinterpret_cast<const uint8_t*>(data.constData()), data.size());
+    if (!packet) {
+        LOGE("Failed to create audio packet");
+        return;
+    }
+    if (m_recorder) {
+        m_recorder->pushAudio(packet->ref());
+    }
+    if (m_audioDecoder) {
+        m_audioDecoder->decode(std::move(packet));
+    }
+}
+void Session::startAudioOutput()
+{
+    if (!m_options.nullAudioSink) {
+        auto sink = std::make_unique<audio::QtAudioSink>();
+        if (sink->start(m_audioDecoder->buffer())) {
+            m_audioDecoder->setOutputLatencyUs(sink->latencyUs());
+            m_audioSink = std::move(sink);
+            return;
+        }
+        LOGW("Falling back to null audio sink for device {}", m_serial.toStdString());
+    }
+    // 没有可用的输出设备时仍需消费缓冲，否则解码端会持续溢出
+    m_audioSink = std::make_unique<codec::NullAudioSink>();
+    m_audioSink->start(m_audioDecoder->buffer());
+}
+void Session::stopAudio()
+{
+    // 输出端持有解码器的缓冲区，必须先于解码器停止
+    if (m_audioSink) {
+        m_audioSink->stop();
+        m_audioSink.reset();
     }
-    if (keyFrameFlag) {
-        LOGI("Is key frame");
+    if (m_audioDecoder) {
+        const auto* buffer = m_audioDecoder->buffer();
+        LOGI("Audio stats for device {}: underflow {} frames, overflow {} frames", m_serial.toStdString(),
+             buffer->underflowFrames(), buffer->overflowFrames());
+        m_audioDecoder.reset();
     }
 }
 
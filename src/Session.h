@@ -2,29 +2,165 @@
 #include <QObject>
 #include <QProcess>
 #include "network/Network.h"
+#include "network/StreamRelay.h"
 #include "view/DeviceWindow.h"
 #include "codec/VideoDecoder.h"
+#include "codec/AudioDecoder.h"
+#include "codec/AudioSink.h"
+#include "codec/MediaClock.h"
+#include "codec/LatencyProbe.h"
+#include "codec/Recorder.h"
+#include "codec/FrameGrabber.h"
+#include "codec/FrameBus.h"
+#include "codec/SharedFrameExporter.h"
+#include "codec/FrameAnalysisHost.h"
+#include "input/KeymapEngine.h"
+#include "input/UhidInput.h"
 
 #include <QMutex>
+#include <QElapsedTimer>
+#include <QSize>
+#include <QRect>
+#include <QTimer>
+#include <atomic>
+
+struct SessionOptions {
+    int maxFps{60};
+    int videoBitRate{8000000};
+    // 0 表示不限制，自动选择编码格式时由解码能力探测结果决定
+    int maxSize{0};
+    // 按窗口中视频区域的像素尺寸限制分辨率，显示不出来的像素不编码、不传输、不解码
+    bool fitToWindow{false};
+    // videoBitRate 对应设备原始分辨率，实际传输的像素更少时码率等比降低
+    bool scaleBitRate{true};
+    // 在虚拟显示器上运行应用而不是镜像主屏。尺寸为空时按窗口尺寸（fitToWindow）或主屏尺寸创建，
+    // dpi 为 0 时使用主屏密度
+    bool newDisplay{false};
+    QSize newDisplaySize;
+    int newDisplayDpi{0};
+    // 使用虚拟显示器时启动的应用包名，需要控制通道
+    QString startApp;
+    // 设备端裁剪（设备像素，镜像主屏时有效），只编码该区域，码率和解码开销随面积降低。
+    // 触控坐标由服务端换算，客户端不需要处理
+    QRect crop;
+    // 客户端只显示画面的一部分（归一化坐标），直接改变采样区域，不复制纹理；空矩形显示完整画面
+    QRectF viewRegion;
+    // 非空时把收到的压缩数据直接封装到文件，不解码、不编码。.mkv 使用 Matroska，其余使用分片 MP4
+    QString recordPath;
+    // 把解码出的帧导出到共享内存（仅 Linux），名字由序列号生成，见 SharedFrameLayout.h
+    bool sharedMemoryExport{false};
+    // 大于等于 0 时在本机该端口按 scrcpy 视频连接的格式转发视频流，0 为自动选择端口
+    int relayPort{-1};
+    // 运行帧分析器的线程数
+    int analysisWorkers{2};
+    // 关闭时固定使用 H.264
+    bool autoSelectCodec{true};
+    bool audio{true};
+    // 抖动缓冲目标深度，加上输出端缓冲后稳态延迟约30ms
+    int audioBufferMs{20};
+    // 不发声，只按实时速率消费音频，用于无音频设备的环境
+    bool nullAudioSink{false};
+    bool control{true};
+    // Inject 通过注入触控事件实现键位映射；Uhid 在设备上创建虚拟 HID 键盘鼠标，不做键位映射
+    enum class InputMode {
+        Inject,
+        Uhid,
+    };
+    InputMode inputMode{InputMode::Inject};
+    // 鼠标锁定（视角拖动）时在本地绘制的准星，跟随本机输入，不等待设备画面
+    view::CursorOverlay::Style cursorOverlay{view::CursorOverlay::Style::Crosshair};
+    // 低分辨率画面放大到窗口时的滤波算法
+    view::Scaler scaler{view::Scaler::Bicubic};
+    // 双向同步剪贴板，依赖控制通道
+    bool clipboardSync{true};
+    codec::MediaClock::SyncMode syncMode{codec::MediaClock::SyncMode::LatencyFirst};
+
+    // 点击到显示延迟的测量模式：周期性发送控制事件并检测画面区域的变化，需要控制通道
+    bool latencyProbe{false};
+    enum class ProbeAction {
+        // 在区域中心注入一次点击
+        Tap,
+        // 按下并松开 probeKey，UHID 模式下经虚拟键盘发送
+        Key,
+    };
+    ProbeAction probeAction{ProbeAction::Tap};
+    int probeKey{Qt::Key_A};
+    int latencyProbeIntervalMs{1000};
+    codec::LatencyProbe::Config latencyProbeConfig;
+};
 
 class Session : public QObject {
     Q_OBJECT
 public:
-    explicit Session(const QString& serial, QObject* parent = nullptr);
+    explicit Session(const QString& serial, const SessionOptions& options = {}, QObject* parent = nullptr);
     ~Session() override = default;
 
     bool open();
 
+    // 从 open() 到解码出第一帧的耗时，尚未出帧时返回 -1
+    qint64 timeToFirstFrameMs() const { return m_timeToFirstFrameMs.load(); }
+    // 平滑后的音视频偏差（微秒），正数表示视频领先音频
+    int64_t avSkewUs() const { return m_clock.skewUs(); }
+
+    // 线程安全，发送控制消息到设备
+    bool sendControlMessage(const network::ControlMessage& message) const;
+    // 设备当前的视频尺寸，触摸坐标以此为准，未收到视频时为空
+    QSize frameSize() const;
+    struct FrameInfo {
+        QSize size;
+        // 设备端PTS（微秒），尚未出帧时为 -1
+        int64_t pts{-1};
+        uint64_t frames{0};
+        // 解码完成的时刻（MediaClock::nowUs）
+        int64_t decodedUs{0};
+    };
+    // 线程安全，最近解码出的一帧的信息，各字段分别读取，不保证来自同一帧
+    FrameInfo latestFrameInfo() const;
+    // 线程安全，异步保存当前画面，结果通过 request.callback 在工作线程返回。会话未打开时返回 false
+    bool grabFrame(const codec::FrameGrabber::Request& request);
+    // 线程安全，注册帧分析器，在会话关闭时自动注销。返回用于注销的 id，会话未打开时返回 -1
+    int addFrameAnalyzer(std::shared_ptr<codec::FrameAnalyzer> analyzer);
+    void removeFrameAnalyzer(int id);
+    // 线程安全，各帧分析器到目前为止的统计，没有注册过分析器或会话已关闭时为空
+    std::vector<codec::FrameAnalysisHost::Stats> frameAnalyzerStats() const;
+    // 线程安全，订阅解码出的帧，每个订阅者得到同一帧的引用并按 policy 缓存，解码线程从不等待。
+    // 会话关闭时所有订阅被关闭；订阅可以跨越多次打开，重新打开后需要重新订阅
+    codec::FrameBus::SubscriptionPtr subscribeFrames(const std::string& name, codec::FrameBus::Policy policy,
+                                                     size_t capacity = 1, std::function<void()> notify = {});
+    void unsubscribeFrames(const codec::FrameBus::SubscriptionPtr& subscription);
+
 signals:
+    // 在主线程上、释放任何资源之前同步发出，之后其他线程不能再访问会话
+    void sessionClosing(const QString& serial);
     void sessionClosed(const QString& serial);
 
 private:
     void startScrcpyServer();
+    // 窗口中视频区域的像素尺寸
+    QSize windowPixelSize() const;
+    void startAudioOutput();
+    void stopAudio();
+    void startKeymap();
+    void startUhidInput();
+    void startLatencyProbe();
+    void startRecording();
+    void stopRecording();
+    // 在解码线程上由探针调用
+    bool triggerLatencyProbe();
+    // 抓帧和分析由下一帧完成，画面静止时服务端不发新帧，让编码器重新输出一帧
+    void requestFreshFrame();
+    // 查询前台应用并加载对应的键位配置
+    void refreshKeymapProfile();
 
-    void onVideoFrameDecoded(codec::FramePtr&& frame) const;
+    void onVideoFrameDecoded(codec::FramePtr&& frame);
 
 private slots:
     void onWindowClosed();
+    void onFramePresented(qint64 pts);
+    void onBackRequested() const;
+    void onHomeRequested() const;
+    void onDeviceClipboardReceived(const QString& text);
+    void onLocalClipboardChanged();
 
     void onReceivedDeviceName(const QString& deviceName);
     void onReceivedVideoMetaData(int codec, int width, int height);
@@ -37,9 +173,55 @@ private slots:
 
 private:
     QString m_serial;
+    SessionOptions m_options;
+    // 解码器持有时钟的指针，必须先于解码器构造
+    codec::MediaClock m_clock;
+    codec::VideoDecoder::CodecType m_videoCodec{codec::VideoDecoder::CodecType::h264};
+    bool m_swDecode{false};
+    // 设备主屏尺寸（wm size），查询失败时为空
+    QSize m_deviceScreenSize;
     network::Network* m_network{nullptr};
     view::DeviceWindow* m_deviceWindow{nullptr};
     QProcess* m_adbProcess{nullptr};
     std::unique_ptr<codec::VideoDecoder> m_videoDecoder;
+    // 同时保护录制器，视频包在网络线程送入
     QMutex m_videoDecoderMutex;
+    std::unique_ptr<codec::Recorder> m_recorder;
+    // 视频数据的回调都在主线程，无需加锁
+    std::unique_ptr<network::StreamRelay> m_relay;
+    // 自身线程安全，生命周期同会话对象，订阅者在它之后声明
+    codec::FrameBus m_frameBus;
+    // 抓帧器和分析宿主在第一次使用时于 m_frameHooksMutex 下创建，解码线程经对应的原子指针无锁访问，
+    // 解码器销毁后才销毁。会话关闭后不再创建
+    mutable QMutex m_frameHooksMutex;
+    bool m_frameHooksOpen{false};
+    std::unique_ptr<codec::FrameGrabber> m_frameGrabber;
+    std::atomic<codec::FrameGrabber*> m_activeFrameGrabber{nullptr};
+    std::unique_ptr<codec::FrameAnalysisHost> m_frameAnalysisHost;
+    std::atomic<codec::FrameAnalysisHost*> m_activeFrameAnalysisHost{nullptr};
+#ifdef __linux__
+    // 在解码器之前创建、之后销毁，解码线程访问时无需加锁
+    std::unique_ptr<codec::SharedFrameExporter> m_frameExporter;
+#endif
+    // 音频的创建、送包和销毁都在主线程，无需加锁
+    std::unique_ptr<codec::AudioDecoder> m_audioDecoder;
+    std::unique_ptr<codec::AudioSink> m_audioSink;
+    input::KeymapStore m_keymapStore;
+    std::unique_ptr<input::KeymapEngine> m_keymapEngine;
+    std::unique_ptr<input::UhidInput> m_uhidInput;
+    std::unique_ptr<codec::LatencyProbe> m_latencyProbe;
+    QTimer m_latencyProbeTimer;
+    // 最近一次两端同步过的剪贴板内容，用于过滤回环
+    QString m_syncedClipboard;
+    uint64_t m_clipboardSequence{0};
+
+    QElapsedTimer m_openTimer;
+    std::atomic<bool> m_firstFrameReceived{false};
+    std::atomic<qint64> m_timeToFirstFrameMs{-1};
+    uint64_t m_presentedFrames{0};
+    // 宽高打包存储，解码线程更新，输入线程读取
+    std::atomic<uint32_t> m_frameSize{0};
+    std::atomic<int64_t> m_lastFramePts{-1};
+    std::atomic<int64_t> m_lastFrameDecodedUs{0};
+    std::atomic<uint64_t> m_decodedFrames{0};
 };
\ No newline at end of file
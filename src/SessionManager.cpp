@@ -3,15 +3,15 @@
 //
 
 #include "SessionManager.h"
-#include "device/AdbHelper.h"
 #include "logger.h"
 #include <QCoreApplication>
-#include <QRegularExpression>
 
 
 SessionManager::SessionManager()
     : QObject(nullptr)
 {
+    m_deviceTracker = new device::DeviceTracker(this);
+    connect(m_deviceTracker, &device::DeviceTracker::devicesChanged, this, &SessionManager::deviceListUpdated);
 }
 
 SessionManager* SessionManager::instance()
@@ -23,94 +23,56 @@ SessionManager* SessionManager::instance()
 void SessionManager::updateDeviceList()
 {
     FUNC_TRACE;
-    using namespace device;
-    AdbHelper::runCommandAsync({"devices", "-l"}).then([this](const QString& output) {
-        QList<DeviceInfoPtr> deviceList;
-        QStringList lines = output.split('\n', Qt::SkipEmptyParts);
-
-        for (const QString& line : lines) {
-            if (line.startsWith("List of devices attached")) continue;
-
-            QString trimmedLine = line.trimmed();
-            if (trimmedLine.isEmpty()) continue;
-
-            QStringList parts = trimmedLine.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-            if (parts.size() < 2) continue;
-
-            auto info = std::make_shared<DeviceInfo>();
-            info->serial = parts[0];
-            info->status = parts[1];
-
-            for (int j = 2; j < parts.size(); ++j) {
-                if (parts[j].startsWith("model:")) {
-                    info->name = parts[j].mid(6);
-                    info->name = info->name.replace('_', ' ');
-                }
-            }
-
-            if (info->name.isEmpty()) {
-                info->name = info->serial;
-            }
-
-            deviceList.append(info);
-        }
-
-        if (deviceList.isEmpty()) {
-            emit deviceListUpdated(deviceList);
-            return;
-        }
-
-        // Fetch Android version for each device
-        QList<QFuture<QString>> futures;
-        for (const auto& device : deviceList) {
-            if (device->status == "device") {
-                futures.append(AdbHelper::runCommandAsync(device->serial, {"shell", "getprop", "ro.build.version.release"}));
-            } else {
-                // For offline/unauthorized devices, return empty result
-                futures.append(QtFuture::makeReadyValueFuture(QString()));
-            }
-        }
-
-        QtFuture::whenAll(futures.begin(), futures.end()).then([this, deviceList](const QList<QFuture<QString>>& results) {
-            for (int i = 0; i < results.size() && i < deviceList.size(); ++i) {
-                const auto& future = results[i];
-                try {
-                    const QString& version = future.result();
-                    if (!version.isEmpty()) {
-                        deviceList[i]->androidVersion = QString("Android ") + version;
-                    }
-                } catch (const device::AdbException&) {
-                    LOGE("Failed to get Android version for device {}", qPrintable(deviceList[i]->serial));
-                }
-            }
-            emit deviceListUpdated(deviceList);
-        });
-    }).onFailed([this](const device::AdbException&) {
-        emit deviceListUpdated({});
-    });
+    // 设备变化由 track-devices 长连接推送，这里只需确保跟踪已启动并重发当前快照
+    if (!m_deviceTracker->isTracking()) {
+        m_deviceTracker->start();
+        return;
+    }
+    emit deviceListUpdated(m_deviceTracker->devices());
 }
 bool SessionManager::openDevice(const QString& serial)
 {
     FUNC_TRACE;
-    if (m_openedSession.contains(serial)) {
+    if (isDeviceOpened(serial)) {
         return false;
     }
 
-    const auto session = new Session(serial, this);
+    const auto session = new Session(serial, {}, this);
     if (!session->open()) {
         session->deleteLater();
         return false;
     }
-    connect(session, &Session::sessionClosed, this, [this, serial]() {
-        m_openedSession[serial]->deleteLater();
+    // 先移出会话表再释放资源：移除时等待进行中的 withSession 返回，之后其他线程无法再取得会话
+    connect(session, &Session::sessionClosing, this, [this, serial]() {
+        QMutexLocker locker(&m_sessionMutex);
         m_openedSession.remove(serial);
+    }, Qt::DirectConnection);
+    connect(session, &Session::sessionClosed, this, [session, serial]() {
+        session->deleteLater();
         LOGI("Session for device {} closed", serial.toStdString());
     });
+    QMutexLocker locker(&m_sessionMutex);
     m_openedSession.insert(serial, session);
 
     return true;
 }
 bool SessionManager::isDeviceOpened(const QString& serial) const
 {
+    QMutexLocker locker(&m_sessionMutex);
     return m_openedSession.contains(serial);
 }
+bool SessionManager::withSession(const QString& serial, const std::function<void(Session&)>& fn) const
+{
+    QMutexLocker locker(&m_sessionMutex);
+    const auto it = m_openedSession.constFind(serial);
+    if (it == m_openedSession.constEnd()) {
+        return false;
+    }
+    fn(**it);
+    return true;
+}
+QStringList SessionManager::openedSerials() const
+{
+    QMutexLocker locker(&m_sessionMutex);
+    return m_openedSession.keys();
+}
@@ -5,8 +5,12 @@
 #pragma once
 #include <QObject>
 #include "device/DeviceInfo.h"
+#include "device/DeviceTracker.h"
 #include <QString>
 #include <QMap>
+#include <QMutex>
+#include <QStringList>
+#include <functional>
 #include "Session.h"
 
 class SessionManager : public QObject {
@@ -22,10 +26,18 @@ public:
     bool openDevice(const QString& serial);
     bool isDeviceOpened(const QString& serial) const;
 
+    // 以下两个方法线程安全。fn 在持有会话表锁时调用，会话在此期间不会被销毁；
+    // fn 中不能打开或关闭会话。会话不存在时返回 false
+    bool withSession(const QString& serial, const std::function<void(Session&)>& fn) const;
+    QStringList openedSerials() const;
+
 signals:
     void deviceListUpdated(const QList<device::DeviceInfoPtr>& deviceList);
 
 private:
+    device::DeviceTracker* m_deviceTracker{nullptr};
+    // 会话表只在主线程修改，其他线程读取时加锁。会话在关闭开始时即被移除
+    mutable QMutex m_sessionMutex;
     QMap<QString, Session*> m_openedSession;
 };
 
@@ -0,0 +1,102 @@
+//
+// Created by neapu on 2025/12/14.
+//
+
+#include "QtAudioSink.h"
+#include <logger.h>
+#include <QAudioSink>
+#include <QAudioFormat>
+#include <QMediaDevices>
+
+namespace audio {
+// 设备端缓冲区时长，与抖动缓冲一起构成总延迟
+constexpr int SINK_BUFFER_MS = 10;
+
+BufferDevice::BufferDevice(codec::AudioBuffer* buffer, QObject* parent)
+    : QIODevice(parent)
+    , m_buffer(buffer)
+{
+}
+qint64 BufferDevice::bytesAvailable() const
+{
+    // 数据不足时补静音，对播放端而言始终有数据可读
+    return static_cast<qint64>(m_buffer->sampleRate()) * m_buffer->channels() * sizeof(int16_t) + QIODevice::bytesAvailable();
+}
+qint64 BufferDevice::readData(char* data, qint64 maxSize)
+{
+    const qint64 frameBytes = m_buffer->channels() * static_cast<qint64>(sizeof(int16_t));
+    const int frames = static_cast<int>(maxSize / frameBytes);
+    if (frames <= 0) {
+        return 0;
+    }
+    m_buffer->read(reinterpret_cast<int16_t*>(data), frames);
+    return frames * frameBytes;
+}
+qint64 BufferDevice::writeData(const char* data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+QtAudioSink::QtAudioSink(QObject* parent)
+    : QObject(parent)
+{
+}
+QtAudioSink::~QtAudioSink()
+{
+    stop();
+}
+bool QtAudioSink::start(codec::AudioBuffer* buffer)
+{
+    FUNC_TRACE;
+    if (!buffer || m_sink) {
+        return false;
+    }
+
+    QAudioFormat format;
+    format.setSampleRate(buffer->sampleRate());
+    format.setChannelCount(buffer->channels());
+    format.setSampleFormat(QAudioFormat::Int16);
+
+    const auto device = QMediaDevices::defaultAudioOutput();
+    if (device.isNull() || !device.isFormatSupported(format)) {
+        LOGE("Default audio output does not support {} Hz {} channels s16", buffer->sampleRate(), buffer->channels());
+        return false;
+    }
+
+    m_sink = new QAudioSink(device, format, this);
+    m_sink->setBufferSize(format.bytesForDuration(SINK_BUFFER_MS * 1000));
+    m_device = new BufferDevice(buffer, this);
+    m_device->open(QIODevice::ReadOnly);
+    m_sink->start(m_device);
+    if (m_sink->error() != QtAudio::NoError) {
+        LOGE("Failed to start audio output: {}", static_cast<int>(m_sink->error()));
+        stop();
+        return false;
+    }
+    LOGI("Audio output started on {}, buffer {} bytes", device.description().toStdString(), m_sink->bufferSize());
+    return true;
+}
+void QtAudioSink::stop()
+{
+    if (m_sink) {
+        m_sink->stop();
+        delete m_sink;
+        m_sink = nullptr;
+    }
+    if (m_device) {
+        m_device->close();
+        delete m_device;
+        m_device = nullptr;
+    }
+}
+int64_t QtAudioSink::latencyUs() const
+{
+    if (!m_sink) {
+        return 0;
+    }
+    // 拉取模式下设备缓冲区稳态时总是满的，按其总时长估算
+    return m_sink->format().durationForBytes(static_cast<qint32>(m_sink->bufferSize()));
+}
+} // namespace audio
@@ -0,0 +1,45 @@
+//
+// Created by neapu on 2025/12/14.
+//
+
+#pragma once
+#include "../codec/AudioSink.h"
+#include <QObject>
+#include <QIODevice>
+
+class QAudioSink;
+
+namespace audio {
+// 以拉取模式从 AudioBuffer 读取数据的设备，数据不足时由 AudioBuffer 补静音，保证播放不中断
+class BufferDevice final : public QIODevice {
+    Q_OBJECT
+public:
+    explicit BufferDevice(codec::AudioBuffer* buffer, QObject* parent = nullptr);
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    codec::AudioBuffer* m_buffer{nullptr};
+};
+
+// 基于 QtMultimedia 的输出端，必须在有事件循环的线程中创建和使用
+class QtAudioSink final : public QObject, public codec::AudioSink {
+    Q_OBJECT
+public:
+    explicit QtAudioSink(QObject* parent = nullptr);
+    ~QtAudioSink() override;
+
+    bool start(codec::AudioBuffer* buffer) override;
+    void stop() override;
+    int64_t latencyUs() const override;
+
+private:
+    QAudioSink* m_sink{nullptr};
+    BufferDevice* m_device{nullptr};
+};
+} // namespace audio
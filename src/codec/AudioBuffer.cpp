@@ -0,0 +1,80 @@
+//
+// Created by neapu on 2025/12/14.
+//
+
+#include "AudioBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace codec {
+AudioBuffer::AudioBuffer(int sampleRate, int channels, int capacityMs)
+    : m_sampleRate(sampleRate)
+    , m_channels(channels)
+    , m_capacityFrames(std::max(1, sampleRate * capacityMs / 1000))
+{
+    m_samples.resize(static_cast<size_t>(m_capacityFrames) * m_channels);
+}
+int AudioBuffer::write(const int16_t* samples, int frames)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int dropped = 0;
+    if (frames > m_capacityFrames) {
+        dropped += frames - m_capacityFrames;
+        samples += static_cast<size_t>(dropped) * m_channels;
+        frames = m_capacityFrames;
+    }
+    const int overflow = m_size + frames - m_capacityFrames;
+    if (overflow > 0) {
+        m_readPos = (m_readPos + overflow) % m_capacityFrames;
+        m_size -= overflow;
+        dropped += overflow;
+    }
+    m_overflowFrames += dropped;
+
+    int writePos = (m_readPos + m_size) % m_capacityFrames;
+    int remaining = frames;
+    while (remaining > 0) {
+        const int chunk = std::min(remaining, m_capacityFrames - writePos);
+        std::memcpy(&m_samples[static_cast<size_t>(writePos) * m_channels], samples, static_cast<size_t>(chunk) * m_channels * sizeof(int16_t));
+        samples += static_cast<size_t>(chunk) * m_channels;
+        writePos = (writePos + chunk) % m_capacityFrames;
+        remaining -= chunk;
+    }
+    m_size += frames;
+    return dropped;
+}
+int AudioBuffer::read(int16_t* out, int frames)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const int available = std::min(frames, m_size);
+    int remaining = available;
+    while (remaining > 0) {
+        const int chunk = std::min(remaining, m_capacityFrames - m_readPos);
+        std::memcpy(out, &m_samples[static_cast<size_t>(m_readPos) * m_channels], static_cast<size_t>(chunk) * m_channels * sizeof(int16_t));
+        out += static_cast<size_t>(chunk) * m_channels;
+        m_readPos = (m_readPos + chunk) % m_capacityFrames;
+        remaining -= chunk;
+    }
+    m_size -= available;
+    if (available < frames) {
+        std::memset(out, 0, static_cast<size_t>(frames - available) * m_channels * sizeof(int16_t));
+        m_underflowFrames += frames - available;
+    }
+    return available;
+}
+int AudioBuffer::bufferedFrames() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size;
+}
+int64_t AudioBuffer::underflowFrames() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_underflowFrames;
+}
+int64_t AudioBuffer::overflowFrames() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_overflowFrames;
+}
+} // namespace codec
@@ -0,0 +1,41 @@
+//
+// Created by neapu on 2025/12/14.
+//
+
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace codec {
+// 解码输出与播放设备之间的抖动缓冲，交织的S16样本环形缓冲区。
+// 解码线程写入，播放端拉取，数据不足时补静音。
+class AudioBuffer {
+public:
+    AudioBuffer(int sampleRate, int channels, int capacityMs);
+    ~AudioBuffer() = default;
+
+    int sampleRate() const { return m_sampleRate; }
+    int channels() const { return m_channels; }
+
+    // 超出容量时丢弃最旧的数据，返回丢弃的帧数
+    int write(const int16_t* samples, int frames);
+    // 始终填满out，返回其中真实音频的帧数，其余为静音
+    int read(int16_t* out, int frames);
+
+    int bufferedFrames() const;
+    int64_t underflowFrames() const;
+    int64_t overflowFrames() const;
+
+private:
+    const int m_sampleRate;
+    const int m_channels;
+    const int m_capacityFrames;
+    std::vector<int16_t> m_samples;
+    int m_readPos{0};
+    int m_size{0};
+    int64_t m_underflowFrames{0};
+    int64_t m_overflowFrames{0};
+    mutable std::mutex m_mutex;
+};
+} // namespace codec
@@ -0,0 +1,284 @@
+//
+// Created by neapu on 2025/12/14.
+//
+
+#include "AudioDecoder.h"
+#include "logger.h"
+#include "Helper.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libswresample/swresample.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/mem.h>
+}
+
+namespace codec {
+// 缓冲区容量为目标深度的倍数，只有严重积压时才会丢弃最旧的数据
+constexpr int BUFFER_CAPACITY_FACTOR = 5;
+constexpr int MIN_BUFFER_CAPACITY_MS = 100;
+// 缓冲深度的平滑系数
+constexpr double BUFFERED_SMOOTHING = 1.0 / 32;
+// 最大速率调整 1%，在1秒内完成补偿
+constexpr int MAX_COMPENSATION_PERCENT = 1;
+// 音视频偏差的修正：每秒按偏差的 20% 调整目标深度。重采样每秒最多补偿 10ms，增益再大会过冲
+constexpr double SKEW_CORRECTION_PER_SECOND = 0.2;
+// 偏差小于此值时不修正，远低于可察觉的唇音不同步
+constexpr int64_t SKEW_DEADBAND_US = 5000;
+
+static AVCodecID toAVCodecId(AudioDecoder::CodecType codecType)
+{
+    switch (codecType) {
+    case AudioDecoder::CodecType::aac: return AV_CODEC_ID_AAC;
+    case AudioDecoder::CodecType::flac: return AV_CODEC_ID_FLAC;
+    case AudioDecoder::CodecType::raw: return AV_CODEC_ID_PCM_S16LE;
+    default: return AV_CODEC_ID_OPUS;
+    }
+}
+
+AudioDecoder::AudioDecoder(const CreateParam& param)
+    : m_codecType(param.codecType)
+    , m_sampleRate(param.sampleRate)
+    , m_channels(param.channels)
+    , m_targetFrames(param.sampleRate * param.bufferMs / 1000)
+    , m_clock(param.clock)
+{
+    FUNC_TRACE;
+    const int capacityMs = std::max(param.bufferMs * BUFFER_CAPACITY_FACTOR, MIN_BUFFER_CAPACITY_MS);
+    m_buffer = std::make_unique<AudioBuffer>(m_sampleRate, m_channels, capacityMs);
+    // 跟随时钟时保留余量，避免目标深度贴近容量导致丢弃
+    m_maxTargetFrames = m_sampleRate * capacityMs / 1000 * 3 / 4;
+    m_avgBufferedFrames = m_targetFrames;
+
+    // 除raw外，编码参数由首个config包提供，收到后再打开解码器
+    if (m_codecType == CodecType::raw && !openCodec(nullptr, 0)) {
+        throw std::runtime_error("Failed to open audio codec");
+    }
+
+    m_running = true;
+    m_worker = std::thread(&AudioDecoder::workerLoop, this);
+}
+AudioDecoder::~AudioDecoder()
+{
+    FUNC_TRACE;
+    if (m_running.load()) {
+        m_running.store(false);
+        m_cv.notify_all();
+    }
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+    if (m_codecCtx) {
+        avcodec_free_context(&m_codecCtx);
+    }
+    if (m_swrCtx) {
+        swr_free(&m_swrCtx);
+    }
+}
+void AudioDecoder::decode(PacketPtr&& packet)
+{
+    if (!packet) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.emplace_back(std::move(packet));
+    }
+    m_cv.notify_one();
+}
+bool AudioDecoder::openCodec(const uint8_t* extradata, int extradataSize)
+{
+    const AVCodec* codec = avcodec_find_decoder(toAVCodecId(m_codecType));
+    if (!codec) {
+        LOGE("Failed to find audio decoder for codec type {}", static_cast<int>(m_codecType));
+        return false;
+    }
+    m_codecCtx = avcodec_alloc_context3(codec);
+    if (!m_codecCtx) {
+        LOGE("Failed to allocate audio codec context");
+        return false;
+    }
+    m_codecCtx->sample_rate = m_sampleRate;
+    // 数据包的PTS以微秒为单位，解码输出沿用同一时基
+    m_codecCtx->pkt_timebase = {1, 1000000};
+    av_channel_layout_default(&m_codecCtx->ch_layout, m_channels);
+    if (extradata && extradataSize > 0) {
+        m_codecCtx->extradata = static_cast<uint8_t*>(av_mallocz(extradataSize + AV_INPUT_BUFFER_PADDING_SIZE));
+        if (!m_codecCtx->extradata) {
+            avcodec_free_context(&m_codecCtx);
+            return false;
+        }
+        std::memcpy(m_codecCtx->extradata, extradata, extradataSize);
+        m_codecCtx->extradata_size = extradataSize;
+    }
+
+    const int ret = avcodec_open2(m_codecCtx, codec, nullptr);
+    if (ret < 0) {
+        LOGE("Failed to open audio codec: {}", Helper::getFFmpegErrorString(ret));
+        avcodec_free_context(&m_codecCtx);
+        return false;
+    }
+    LOGI("Opened audio decoder {}", codec->name);
+    return true;
+}
+void AudioDecoder::processFrame(const AVFrame* frame)
+{
+    if (!m_swrCtx) {
+        AVChannelLayout outLayout;
+        av_channel_layout_default(&outLayout, m_channels);
+        int ret = swr_alloc_set_opts2(&m_swrCtx, &outLayout, AV_SAMPLE_FMT_S16, m_sampleRate, &frame->ch_layout,
+                                      static_cast<AVSampleFormat>(frame->format), frame->sample_rate, 0, nullptr);
+        av_channel_layout_uninit(&outLayout);
+        if (ret < 0 || swr_init(m_swrCtx) < 0) {
+            LOGE("Failed to initialize audio resampler");
+            swr_free(&m_swrCtx);
+            return;
+        }
+    }
+
+    const int outCapacity = swr_get_out_samples(m_swrCtx, frame->nb_samples);
+    if (outCapacity <= 0) {
+        return;
+    }
+    // 只在容量不足时扩容，稳定后不再分配
+    if (m_convertBuffer.size() < static_cast<size_t>(outCapacity) * m_channels) {
+        m_convertBuffer.resize(static_cast<size_t>(outCapacity) * m_channels);
+    }
+    auto* out = reinterpret_cast<uint8_t*>(m_convertBuffer.data());
+    const int converted = swr_convert(m_swrCtx, &out, outCapacity, const_cast<const uint8_t**>(frame->extended_data), frame->nb_samples);
+    if (converted < 0) {
+        LOGE("Failed to resample audio: {}", Helper::getFFmpegErrorString(converted));
+        return;
+    }
+    const int64_t pts = frame->best_effort_timestamp != AV_NOPTS_VALUE ? frame->best_effort_timestamp : frame->pts;
+    if (pts != AV_NOPTS_VALUE && frame->sample_rate > 0) {
+        m_writtenEndPts = pts + static_cast<int64_t>(frame->nb_samples) * 1000000 / frame->sample_rate;
+    }
+    const int dropped = m_buffer->write(m_convertBuffer.data(), converted);
+    if (dropped > 0) {
+        LOGW("Audio buffer overflow, dropped {} frames", dropped);
+    }
+    correctSkew(converted);
+    compensateDrift();
+}
+void AudioDecoder::correctSkew(int frames)
+{
+    if (!m_clock) {
+        return;
+    }
+    // 正的偏差表示视频领先音频，音频应更早播放，减小缓冲深度
+    const int64_t skewUs = m_clock->skewUs();
+    if (std::abs(skewUs) < SKEW_DEADBAND_US) {
+        return;
+    }
+    const double seconds = static_cast<double>(frames) / m_sampleRate;
+    const int64_t maxCorrectionUs = static_cast<int64_t>(std::max(m_targetFrames, m_maxTargetFrames)) * 1000000 / m_sampleRate;
+    m_skewCorrectionUs = std::clamp<int64_t>(
+        m_skewCorrectionUs - static_cast<int64_t>(static_cast<double>(skewUs) * SKEW_CORRECTION_PER_SECOND * seconds),
+        -maxCorrectionUs, maxCorrectionUs);
+}
+void AudioDecoder::compensateDrift()
+{
+    const int buffered = m_buffer->bufferedFrames();
+    m_avgBufferedFrames += (buffered - m_avgBufferedFrames) * BUFFERED_SMOOTHING;
+
+    // 缓冲偏多时压缩、偏少时拉伸，速率变化限制在1%以内不可察觉
+    const int distance = m_sampleRate;
+    const int maxDiff = distance * MAX_COMPENSATION_PERCENT / 100;
+    const int target = targetFrames();
+    int diff = target - static_cast<int>(m_avgBufferedFrames);
+    // 偏差在目标的十分之一以内时不做调整，避免频繁切换
+    if (std::abs(diff) < target / 10) {
+        diff = 0;
+    }
+    diff = std::clamp(diff, -maxDiff, maxDiff);
+    if (diff == m_compensation) {
+        return;
+    }
+    const int ret = swr_set_compensation(m_swrCtx, diff, distance);
+    if (ret < 0) {
+        LOGW("Failed to set audio compensation: {}", Helper::getFFmpegErrorString(ret));
+        return;
+    }
+    m_compensation = diff;
+}
+int AudioDecoder::targetFrames() const
+{
+    const int64_t endPts = m_writtenEndPts.load();
+    if (!m_clock || endPts < 0 || !m_clock->valid()) {
+        return m_targetFrames;
+    }
+    // 缓冲末尾的样本应在时钟给出的呈现时刻播放，由此反推需要的缓冲深度；
+    // 再按测得的音视频偏差修正，补上时钟不包含的视频解码和渲染耗时
+    const int64_t desiredUs = m_clock->presentationTimeUs(endPts) - MediaClock::nowUs() - m_outputLatencyUs.load()
+        + m_skewCorrectionUs;
+    const int64_t desiredFrames = desiredUs * m_sampleRate / 1000000;
+    return static_cast<int>(std::clamp<int64_t>(desiredFrames, m_targetFrames, std::max(m_targetFrames, m_maxTargetFrames)));
+}
+int64_t AudioDecoder::playingPts() const
+{
+    const int64_t endPts = m_writtenEndPts.load();
+    if (endPts < 0) {
+        return -1;
+    }
+    const int64_t bufferedUs = static_cast<int64_t>(m_buffer->bufferedFrames()) * 1000000 / m_sampleRate;
+    return endPts - bufferedUs - m_outputLatencyUs.load();
+}
+void AudioDecoder::workerLoop()
+{
+    AVFrame* frame = av_frame_alloc();
+    if (!frame) {
+        LOGE("Failed to allocate audio frame");
+        return;
+    }
+    for (;;) {
+        PacketPtr pkt;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return !m_queue.empty() || !m_running.load(); });
+            if (!m_running.load() && m_queue.empty()) {
+                break;
+            }
+            pkt = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        if (!pkt) {
+            continue;
+        }
+
+        if (pkt->isConfig()) {
+            // config包作为extradata打开解码器，之后的config包忽略
+            if (!m_codecCtx) {
+                const auto* avPacket = pkt->avPacket();
+                openCodec(avPacket->data, avPacket->size);
+            }
+            continue;
+        }
+        if (!m_codecCtx && !openCodec(nullptr, 0)) {
+            continue;
+        }
+
+        int ret = avcodec_send_packet(m_codecCtx, pkt->avPacket());
+        if (ret < 0) {
+            LOGE("Error sending packet to audio decoder: {}", Helper::getFFmpegErrorString(ret));
+            continue;
+        }
+        for (;;) {
+            ret = avcodec_receive_frame(m_codecCtx, frame);
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                break;
+            }
+            if (ret < 0) {
+                LOGE("Error receiving frame from audio decoder: {}", Helper::getFFmpegErrorString(ret));
+                break;
+            }
+            processFrame(frame);
+            av_frame_unref(frame);
+        }
+    }
+    av_frame_free(&frame);
+}
+} // namespace codec
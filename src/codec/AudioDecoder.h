@@ -0,0 +1,89 @@
+//
+// Created by neapu on 2025/12/14.
+//
+
+#pragma once
+#include "Packet.h"
+#include "AudioBuffer.h"
+#include "MediaClock.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+struct AVCodecContext;
+struct SwrContext;
+struct AVFrame;
+
+namespace codec {
+// 音频解码：在独立线程中解码、重采样为交织S16，写入抖动缓冲供输出端拉取。
+// 缓冲深度偏离目标时通过微调重采样速率修正时钟漂移，而不是丢弃数据。
+class AudioDecoder {
+public:
+    enum class CodecType {
+        opus,
+        aac,
+        flac,
+        raw, // 48kHz 双声道 s16le
+    };
+    struct CreateParam {
+        CodecType codecType{CodecType::opus};
+        int sampleRate{48000};
+        int channels{2};
+        // 抖动缓冲目标深度
+        int bufferMs{20};
+        // 设置后缓冲深度跟随时钟调整，使音频按时钟的呈现时刻播放，并按时钟上报的音视频偏差向实际呈现的视频靠拢。
+        // bufferMs作为下限
+        const MediaClock* clock{nullptr};
+    };
+    explicit AudioDecoder(const CreateParam& param);
+    ~AudioDecoder();
+
+    void decode(PacketPtr&& packet);
+
+    AudioBuffer* buffer() const { return m_buffer.get(); }
+
+    // 输出端自身缓存的时长，计入播放位置
+    void setOutputLatencyUs(int64_t latencyUs) { m_outputLatencyUs = latencyUs; }
+    // 当前正在播放的样本的PTS，尚未解码出数据时返回-1
+    int64_t playingPts() const;
+
+private:
+    bool openCodec(const uint8_t* extradata, int extradataSize);
+    void processFrame(const AVFrame* frame);
+    // 积分音视频偏差，frames 为本次写入的样本数
+    void correctSkew(int frames);
+    void compensateDrift();
+    int targetFrames() const;
+
+    void workerLoop();
+
+private:
+    CodecType m_codecType{CodecType::opus};
+    int m_sampleRate{48000};
+    int m_channels{2};
+    int m_targetFrames{0};
+    int m_maxTargetFrames{0};
+    const MediaClock* m_clock{nullptr};
+    std::atomic<int64_t> m_writtenEndPts{-1};
+    std::atomic<int64_t> m_outputLatencyUs{0};
+
+    AVCodecContext* m_codecCtx{nullptr};
+    SwrContext* m_swrCtx{nullptr};
+    std::unique_ptr<AudioBuffer> m_buffer;
+    std::vector<int16_t> m_convertBuffer;
+    double m_avgBufferedFrames{0.0};
+    int m_compensation{0};
+    // 叠加在时钟呈现时刻上的修正，只在解码线程访问
+    int64_t m_skewCorrectionUs{0};
+
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<PacketPtr> m_queue;
+    std::atomic<bool> m_running{false};
+};
+} // namespace codec
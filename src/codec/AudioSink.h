@@ -0,0 +1,19 @@
+//
+// Created by neapu on 2025/12/14.
+//
+
+#pragma once
+#include "AudioBuffer.h"
+
+namespace codec {
+// 音频输出端接口，输出端按自己的时钟从 AudioBuffer 中拉取数据
+class AudioSink {
+public:
+    virtual ~AudioSink() = default;
+
+    virtual bool start(AudioBuffer* buffer) = 0;
+    virtual void stop() = 0;
+    // 输出端自身缓存的时长（微秒），用于估算总延迟
+    virtual int64_t latencyUs() const { return 0; }
+};
+} // namespace codec
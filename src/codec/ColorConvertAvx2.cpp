@@ -0,0 +1,72 @@
+//
+// Created by neapu on 2025/12/26.
+//
+
+#include "ColorConvertKernels.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+
+// 本文件以 AVX2 编译，只在运行时检测到支持后调用
+namespace codec::kernels {
+static __m256i load8(const uint8_t* p)
+{
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+}
+// 8 个 32 位结果饱和打包为 8 个 16 位
+static __m128i pack8(__m256i value)
+{
+    return _mm_packs_epi32(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+}
+
+void convertRowAvx2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width,
+                    const YuvCoefficients& c, bool bgra)
+{
+    const __m256i yOffset = _mm256_set1_epi32(c.yOffset);
+    const __m256i cy = _mm256_set1_epi32(c.cy);
+    const __m256i crv = _mm256_set1_epi32(c.crv);
+    const __m256i cgu = _mm256_set1_epi32(c.cgu);
+    const __m256i cgv = _mm256_set1_epi32(c.cgv);
+    const __m256i cbu = _mm256_set1_epi32(c.cbu);
+    const __m256i uvOffset = _mm256_set1_epi32(128);
+    const __m256i round = _mm256_set1_epi32(COEFFICIENT_ROUND);
+    const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xff));
+
+    auto compute8 = [&](int x, __m256i& r, __m256i& g, __m256i& b) {
+        const __m256i yy = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(load8(y + x), yOffset), cy), round);
+        const __m256i uu = _mm256_sub_epi32(load8(u + x), uvOffset);
+        const __m256i vv = _mm256_sub_epi32(load8(v + x), uvOffset);
+        r = _mm256_srai_epi32(_mm256_add_epi32(yy, _mm256_mullo_epi32(vv, crv)), COEFFICIENT_SHIFT);
+        g = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(yy, _mm256_mullo_epi32(uu, cgu)),
+                                               _mm256_mullo_epi32(vv, cgv)), COEFFICIENT_SHIFT);
+        b = _mm256_srai_epi32(_mm256_add_epi32(yy, _mm256_mullo_epi32(uu, cbu)), COEFFICIENT_SHIFT);
+    };
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m256i r0, g0, b0, r1, g1, b1;
+        compute8(x, r0, g0, b0);
+        compute8(x + 8, r1, g1, b1);
+        // 跨 128 位通道的打包顺序不直观，先拆成两半再用 SSE 打包
+        const __m128i r = _mm_packus_epi16(pack8(r0), pack8(r1));
+        const __m128i g = _mm_packus_epi16(pack8(g0), pack8(g1));
+        const __m128i b = _mm_packus_epi16(pack8(b0), pack8(b1));
+
+        const __m128i first = bgra ? b : r;
+        const __m128i third = bgra ? r : b;
+        const __m128i rgLo = _mm_unpacklo_epi8(first, g);
+        const __m128i rgHi = _mm_unpackhi_epi8(first, g);
+        const __m128i baLo = _mm_unpacklo_epi8(third, alpha);
+        const __m128i baHi = _mm_unpackhi_epi8(third, alpha);
+        uint8_t* out = dst + x * 4;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(rgLo, baLo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi16(rgLo, baLo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32), _mm_unpacklo_epi16(rgHi, baHi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 48), _mm_unpackhi_epi16(rgHi, baHi));
+    }
+    if (x < width) {
+        convertRowScalar(y + x, u + x, v + x, dst + x * 4, width - x, c, bgra);
+    }
+}
+} // namespace codec::kernels
+#endif
@@ -0,0 +1,38 @@
+//
+// Created by neapu on 2025/12/26.
+//
+
+#pragma once
+#include <cstdint>
+
+// ColorConverter 内部使用的行转换内核，各指令集的实现分别编译，结果与标量版本逐位一致
+namespace codec::kernels {
+// ColorMatrix 的定点形式，Q14
+struct YuvCoefficients {
+    int32_t yOffset;
+    int32_t cy;
+    int32_t crv;
+    int32_t cgu;
+    int32_t cgv;
+    int32_t cbu;
+};
+constexpr int COEFFICIENT_SHIFT = 14;
+constexpr int32_t COEFFICIENT_ROUND = 1 << (COEFFICIENT_SHIFT - 1);
+
+// y/u/v 每个输出像素各一个 8 位样本，输出 width 个 RGBA 像素，bgra 为 true 时交换 R 和 B
+using RowKernel = void (*)(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width,
+                           const YuvCoefficients& c, bool bgra);
+
+void convertRowScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width,
+                      const YuvCoefficients& c, bool bgra);
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+void convertRowSse41(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width,
+                     const YuvCoefficients& c, bool bgra);
+void convertRowAvx2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width,
+                    const YuvCoefficients& c, bool bgra);
+#endif
+#if defined(__aarch64__) || defined(_M_ARM64)
+void convertRowNeon(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width,
+                    const YuvCoefficients& c, bool bgra);
+#endif
+} // namespace codec::kernels
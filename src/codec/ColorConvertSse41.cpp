@@ -0,0 +1,68 @@
+//
+// Created by neapu on 2025/12/26.
+//
+
+#include "ColorConvertKernels.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <smmintrin.h>
+#include <cstring>
+
+// 本文件以 SSE4.1 编译，只在运行时检测到支持后调用
+namespace codec::kernels {
+static __m128i load4(const uint8_t* p)
+{
+    int32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(value));
+}
+
+void convertRowSse41(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width,
+                     const YuvCoefficients& c, bool bgra)
+{
+    const __m128i yOffset = _mm_set1_epi32(c.yOffset);
+    const __m128i cy = _mm_set1_epi32(c.cy);
+    const __m128i crv = _mm_set1_epi32(c.crv);
+    const __m128i cgu = _mm_set1_epi32(c.cgu);
+    const __m128i cgv = _mm_set1_epi32(c.cgv);
+    const __m128i cbu = _mm_set1_epi32(c.cbu);
+    const __m128i uvOffset = _mm_set1_epi32(128);
+    const __m128i round = _mm_set1_epi32(COEFFICIENT_ROUND);
+    const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xff));
+
+    // 4 个像素为一组做 32 位定点运算，饱和打包到 8 位即完成截断
+    auto compute4 = [&](int x, __m128i& r, __m128i& g, __m128i& b) {
+        const __m128i yy = _mm_add_epi32(_mm_mullo_epi32(_mm_sub_epi32(load4(y + x), yOffset), cy), round);
+        const __m128i uu = _mm_sub_epi32(load4(u + x), uvOffset);
+        const __m128i vv = _mm_sub_epi32(load4(v + x), uvOffset);
+        r = _mm_srai_epi32(_mm_add_epi32(yy, _mm_mullo_epi32(vv, crv)), COEFFICIENT_SHIFT);
+        g = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(yy, _mm_mullo_epi32(uu, cgu)), _mm_mullo_epi32(vv, cgv)),
+                           COEFFICIENT_SHIFT);
+        b = _mm_srai_epi32(_mm_add_epi32(yy, _mm_mullo_epi32(uu, cbu)), COEFFICIENT_SHIFT);
+    };
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128i r0, g0, b0, r1, g1, b1;
+        compute4(x, r0, g0, b0);
+        compute4(x + 4, r1, g1, b1);
+        __m128i r = _mm_packs_epi32(r0, r1);
+        __m128i g = _mm_packs_epi32(g0, g1);
+        __m128i b = _mm_packs_epi32(b0, b1);
+        r = _mm_packus_epi16(r, r);
+        g = _mm_packus_epi16(g, g);
+        b = _mm_packus_epi16(b, b);
+
+        const __m128i first = bgra ? b : r;
+        const __m128i third = bgra ? r : b;
+        const __m128i rg = _mm_unpacklo_epi8(first, g);
+        const __m128i ba = _mm_unpacklo_epi8(third, alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4 + 16), _mm_unpackhi_epi16(rg, ba));
+    }
+    if (x < width) {
+        convertRowScalar(y + x, u + x, v + x, dst + x * 4, width - x, c, bgra);
+    }
+}
+} // namespace codec::kernels
+#endif
@@ -0,0 +1,317 @@
+//
+// Created by neapu on 2025/12/26.
+//
+
+#include "ColorConverter.h"
+#include "ColorMatrix.h"
+#include "logger.h"
+#include <algorithm>
+#include <cmath>
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#endif
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace codec {
+namespace kernels {
+void convertRowScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width,
+                      const YuvCoefficients& c, bool bgra)
+{
+    const int ri = bgra ? 2 : 0;
+    const int bi = bgra ? 0 : 2;
+    for (int x = 0; x < width; ++x) {
+        const int32_t yy = (y[x] - c.yOffset) * c.cy + COEFFICIENT_ROUND;
+        const int32_t uu = u[x] - 128;
+        const int32_t vv = v[x] - 128;
+        const int32_t r = (yy + c.crv * vv) >> COEFFICIENT_SHIFT;
+        const int32_t g = (yy + c.cgu * uu + c.cgv * vv) >> COEFFICIENT_SHIFT;
+        const int32_t b = (yy + c.cbu * uu) >> COEFFICIENT_SHIFT;
+        uint8_t* out = dst + x * 4;
+        out[ri] = static_cast<uint8_t>(std::clamp(r, 0, 255));
+        out[1] = static_cast<uint8_t>(std::clamp(g, 0, 255));
+        out[bi] = static_cast<uint8_t>(std::clamp(b, 0, 255));
+        out[3] = 0xff;
+    }
+}
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+// NEON 是 AArch64 的基础指令集，不需要单独编译
+void convertRowNeon(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width,
+                    const YuvCoefficients& c, bool bgra)
+{
+    const int32x4_t yOffset = vdupq_n_s32(c.yOffset);
+    const int32x4_t cy = vdupq_n_s32(c.cy);
+    const int32x4_t crv = vdupq_n_s32(c.crv);
+    const int32x4_t cgu = vdupq_n_s32(c.cgu);
+    const int32x4_t cgv = vdupq_n_s32(c.cgv);
+    const int32x4_t cbu = vdupq_n_s32(c.cbu);
+    const int32x4_t uvOffset = vdupq_n_s32(128);
+    const int32x4_t round = vdupq_n_s32(COEFFICIENT_ROUND);
+
+    auto widen = [](uint16x4_t value) { return vreinterpretq_s32_u32(vmovl_u16(value)); };
+    auto compute4 = [&](uint16x4_t y16, uint16x4_t u16, uint16x4_t v16, int32x4_t& r, int32x4_t& g, int32x4_t& b) {
+        const int32x4_t yy = vaddq_s32(vmulq_s32(vsubq_s32(widen(y16), yOffset), cy), round);
+        const int32x4_t uu = vsubq_s32(widen(u16), uvOffset);
+        const int32x4_t vv = vsubq_s32(widen(v16), uvOffset);
+        r = vshrq_n_s32(vaddq_s32(yy, vmulq_s32(vv, crv)), COEFFICIENT_SHIFT);
+        g = vshrq_n_s32(vaddq_s32(vaddq_s32(yy, vmulq_s32(uu, cgu)), vmulq_s32(vv, cgv)), COEFFICIENT_SHIFT);
+        b = vshrq_n_s32(vaddq_s32(yy, vmulq_s32(uu, cbu)), COEFFICIENT_SHIFT);
+    };
+    auto narrow = [](int32x4_t lo, int32x4_t hi) { return vqmovun_s16(vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi))); };
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const uint16x8_t y16 = vmovl_u8(vld1_u8(y + x));
+        const uint16x8_t u16 = vmovl_u8(vld1_u8(u + x));
+        const uint16x8_t v16 = vmovl_u8(vld1_u8(v + x));
+        int32x4_t r0, g0, b0, r1, g1, b1;
+        compute4(vget_low_u16(y16), vget_low_u16(u16), vget_low_u16(v16), r0, g0, b0);
+        compute4(vget_high_u16(y16), vget_high_u16(u16), vget_high_u16(v16), r1, g1, b1);
+        const uint8x8_t r = narrow(r0, r1);
+        const uint8x8_t b = narrow(b0, b1);
+        uint8x8x4_t pixels;
+        pixels.val[0] = bgra ? b : r;
+        pixels.val[1] = narrow(g0, g1);
+        pixels.val[2] = bgra ? r : b;
+        pixels.val[3] = vdup_n_u8(0xff);
+        vst4_u8(dst + x * 4, pixels);
+    }
+    if (x < width) {
+        convertRowScalar(y + x, u + x, v + x, dst + x * 4, width - x, c, bgra);
+    }
+}
+#endif
+} // namespace kernels
+
+// 平面的取样方式：step 为相邻样本的字节距离，wide 表示 16 位小端样本
+struct PlaneSampler {
+    const uint8_t* base;
+    int lineSize;
+    int step;
+    int offset;
+    bool wide;
+};
+
+// 按盒式滤波生成一行 8 位样本：输出第 ox 个样本取 x0 = (ox * num) >> denShift 起 block x block 个源样本的平均
+template <bool Wide>
+static void sampleRow(const PlaneSampler& plane, int row0, int block, int num, int denShift, int shift, uint8_t* out,
+                      int outWidth)
+{
+    auto sampleAt = [&](const uint8_t* line, int x) {
+        const uint8_t* p = line + static_cast<ptrdiff_t>(x) * plane.step;
+        return Wide ? (p[0] | p[1] << 8) : p[0];
+    };
+    const uint8_t* first = plane.base + static_cast<ptrdiff_t>(row0) * plane.lineSize + plane.offset;
+    if (block == 1) {
+        // 不缩小时只做取样（色度为最近邻上采样），这是最常用的路径
+        for (int ox = 0; ox < outWidth; ++ox) {
+            out[ox] = static_cast<uint8_t>(sampleAt(first, (ox * num) >> denShift) >> shift);
+        }
+        return;
+    }
+    const int count = block * block;
+    for (int ox = 0; ox < outWidth; ++ox) {
+        const int x0 = (ox * num) >> denShift;
+        int sum = 0;
+        const uint8_t* line = first;
+        for (int dy = 0; dy < block; ++dy, line += plane.lineSize) {
+            for (int dx = 0; dx < block; ++dx) {
+                sum += sampleAt(line, x0 + dx);
+            }
+        }
+        out[ox] = static_cast<uint8_t>(((sum + count / 2) / count) >> shift);
+    }
+}
+static void sampleRow(const PlaneSampler& plane, int row0, int block, int num, int denShift, int shift, uint8_t* out,
+                      int outWidth)
+{
+    if (plane.wide) {
+        sampleRow<true>(plane, row0, block, num, denShift, shift, out, outWidth);
+    } else {
+        sampleRow<false>(plane, row0, block, num, denShift, shift, out, outWidth);
+    }
+}
+static kernels::YuvCoefficients toFixedPoint(const ColorMatrix& matrix)
+{
+    constexpr float one = 1 << kernels::COEFFICIENT_SHIFT;
+    auto fixed = [&](float value) { return static_cast<int32_t>(std::lround(value * one)); };
+    return {
+        static_cast<int32_t>(std::lround(matrix.yOffset * 255.0f)),
+        fixed(matrix.m[0]),
+        fixed(matrix.m[2]),
+        fixed(matrix.m[4]),
+        fixed(matrix.m[5]),
+        fixed(matrix.m[7]),
+    };
+}
+static kernels::RowKernel kernelFor(ColorConverter::Isa isa)
+{
+    switch (isa) {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    case ColorConverter::Isa::SSE41: return kernels::convertRowSse41;
+    case ColorConverter::Isa::AVX2: return kernels::convertRowAvx2;
+#endif
+#if defined(__aarch64__) || defined(_M_ARM64)
+    case ColorConverter::Isa::NEON: return kernels::convertRowNeon;
+#endif
+    default: return kernels::convertRowScalar;
+    }
+}
+
+ColorConverter::ColorConverter(Isa isa)
+    : m_isa(isaSupported(isa) ? isa : Isa::Scalar)
+    , m_kernel(kernelFor(m_isa))
+{
+}
+bool ColorConverter::supportsFormat(int rawPixelFormat)
+{
+    switch (static_cast<AVPixelFormat>(rawPixelFormat)) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+    case AV_PIX_FMT_NV12:
+    case AV_PIX_FMT_P010LE:
+        return true;
+    default:
+        return false;
+    }
+}
+bool ColorConverter::convert(const AVFrame* frame, uint8_t* dst, int dstStride, Output output, int scale)
+{
+    if (!frame || !dst || !supportsFormat(frame->format)) {
+        return false;
+    }
+    if (scale != 1 && scale != 2 && scale != 4 && scale != 8) {
+        LOGE("Unsupported color conversion scale {}", scale);
+        return false;
+    }
+    const int outWidth = outputWidth(frame->width, scale);
+    const int outHeight = outputHeight(frame->height, scale);
+    if (outWidth <= 0 || outHeight <= 0) {
+        return false;
+    }
+
+    const auto format = static_cast<AVPixelFormat>(frame->format);
+    // YUVJ420P 固定为全范围
+    const auto range = format == AV_PIX_FMT_YUVJ420P || frame->color_range == AVCOL_RANGE_JPEG
+        ? Frame::ColorRange::Full : Frame::ColorRange::Limited;
+    const auto space = frame->colorspace == AVCOL_SPC_BT709 ? Frame::ColorSpace::BT709 : Frame::ColorSpace::BT601;
+    const auto coefficients = toFixedPoint(ColorMatrix::forFrame(space, range));
+
+    PlaneSampler planeY{frame->data[0], frame->linesize[0], 1, 0, false};
+    PlaneSampler planeU{frame->data[1], frame->linesize[1], 1, 0, false};
+    PlaneSampler planeV{frame->data[2], frame->linesize[2], 1, 0, false};
+    int shift = 0;
+    if (format == AV_PIX_FMT_NV12) {
+        planeU = {frame->data[1], frame->linesize[1], 2, 0, false};
+        planeV = {frame->data[1], frame->linesize[1], 2, 1, false};
+    } else if (format == AV_PIX_FMT_P010LE) {
+        // 10 位有效数据在高位，取高 8 位
+        planeY = {frame->data[0], frame->linesize[0], 2, 0, true};
+        planeU = {frame->data[1], frame->linesize[1], 4, 0, true};
+        planeV = {frame->data[1], frame->linesize[1], 4, 2, true};
+        shift = 8;
+    }
+    // 8 位平面且不缩小时直接使用源数据，不经过行缓冲
+    const bool directY = scale == 1 && !planeY.wide;
+
+    if (!directY) {
+        m_lineY.resize(static_cast<size_t>(outWidth));
+    }
+    m_lineU.resize(static_cast<size_t>(outWidth));
+    m_lineV.resize(static_cast<size_t>(outWidth));
+    const bool bgra = output == Output::BGRA;
+    // 4:2:0 色度在两个方向上都是亮度的一半
+    const int chromaBlock = std::max(1, scale / 2);
+    const int chromaNum = scale == 1 ? 1 : chromaBlock;
+    const int chromaDenShift = scale == 1 ? 1 : 0;
+
+    int lastChromaRow = -1;
+    for (int oy = 0; oy < outHeight; ++oy) {
+        const uint8_t* rowY;
+        if (directY) {
+            rowY = planeY.base + static_cast<ptrdiff_t>(oy) * planeY.lineSize;
+        } else {
+            sampleRow(planeY, oy * scale, scale, scale, 0, shift, m_lineY.data(), outWidth);
+            rowY = m_lineY.data();
+        }
+        const int chromaRow = scale == 1 ? oy / 2 : oy * chromaBlock;
+        // 不缩小时相邻两行共用同一行色度
+        if (chromaRow != lastChromaRow) {
+            sampleRow(planeU, chromaRow, chromaBlock, chromaNum, chromaDenShift, shift, m_lineU.data(), outWidth);
+            sampleRow(planeV, chromaRow, chromaBlock, chromaNum, chromaDenShift, shift, m_lineV.data(), outWidth);
+            lastChromaRow = chromaRow;
+        }
+        m_kernel(rowY, m_lineU.data(), m_lineV.data(), dst + static_cast<ptrdiff_t>(oy) * dstStride, outWidth,
+                 coefficients, bgra);
+    }
+    return true;
+}
+ColorConverter::Isa ColorConverter::bestIsa()
+{
+    static const Isa best = [] {
+        for (const Isa isa : {Isa::AVX2, Isa::SSE41, Isa::NEON}) {
+            if (isaSupported(isa)) {
+                LOGI("Using {} color conversion kernels", isaName(isa));
+                return isa;
+            }
+        }
+        return Isa::Scalar;
+    }();
+    return best;
+}
+bool ColorConverter::isaSupported(Isa isa)
+{
+    switch (isa) {
+    case Isa::Scalar:
+        return true;
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#if defined(_MSC_VER)
+    case Isa::SSE41: {
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 19)) != 0;
+    }
+    case Isa::AVX2: {
+        int info[4];
+        __cpuid(info, 1);
+        // 还需要操作系统保存 YMM 寄存器
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    }
+#else
+    case Isa::SSE41:
+        return __builtin_cpu_supports("sse4.1");
+    case Isa::AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+#endif
+#if defined(__aarch64__) || defined(_M_ARM64)
+    case Isa::NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+const char* ColorConverter::isaName(Isa isa)
+{
+    switch (isa) {
+    case Isa::SSE41: return "SSE4.1";
+    case Isa::AVX2: return "AVX2";
+    case Isa::NEON: return "NEON";
+    default: return "scalar";
+    }
+}
+} // namespace codec
@@ -0,0 +1,56 @@
+//
+// Created by neapu on 2025/12/26.
+//
+
+#pragma once
+#include "Frame.h"
+#include "ColorConvertKernels.h"
+#include <vector>
+#include <cstdint>
+
+struct AVFrame;
+
+namespace codec {
+// CPU 端 YUV 转 RGBA/BGRA，系数与着色器一致（ColorMatrix）。
+// 支持 YUV420P、NV12、P010 软件帧，可在同一遍中按 2 的幂整数倍缩小（盒式滤波）。
+// 行转换内核按运行时检测到的指令集选择，各版本输出逐位一致。实例持有行缓冲，不能跨线程共用。
+class ColorConverter {
+public:
+    enum class Output {
+        RGBA,
+        BGRA,
+    };
+    enum class Isa {
+        Scalar,
+        SSE41,
+        AVX2,
+        NEON,
+    };
+
+    explicit ColorConverter(Isa isa = bestIsa());
+
+    // dst 至少有 outputHeight 行、每行 outputWidth * 4 字节。scale 为 1、2、4 或 8
+    bool convert(const AVFrame* frame, uint8_t* dst, int dstStride, Output output = Output::RGBA, int scale = 1);
+    bool convert(const Frame& frame, uint8_t* dst, int dstStride, Output output = Output::RGBA, int scale = 1)
+    {
+        return convert(frame.avFrame(), dst, dstStride, output, scale);
+    }
+
+    static int outputWidth(int width, int scale) { return scale > 0 ? width / scale : 0; }
+    static int outputHeight(int height, int scale) { return scale > 0 ? height / scale : 0; }
+    static bool supportsFormat(int rawPixelFormat);
+
+    Isa isa() const { return m_isa; }
+    // 当前 CPU 支持的最快实现
+    static Isa bestIsa();
+    static bool isaSupported(Isa isa);
+    static const char* isaName(Isa isa);
+
+private:
+    Isa m_isa{Isa::Scalar};
+    kernels::RowKernel m_kernel{nullptr};
+    std::vector<uint8_t> m_lineY;
+    std::vector<uint8_t> m_lineU;
+    std::vector<uint8_t> m_lineV;
+};
+} // namespace codec
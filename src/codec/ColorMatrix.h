@@ -0,0 +1,39 @@
+//
+// Created by neapu on 2025/12/26.
+//
+
+#pragma once
+#include "Frame.h"
+
+namespace codec {
+// YUV 转 RGB 的系数，着色器（Uniforms）和 CPU 转换（ColorConverter）共用同一份，保证两边颜色一致。
+// RGB = m * (Y - yOffset, U - 0.5, V - 0.5)，m 为行主序 3x3，分量按 [0, 1] 归一化
+struct ColorMatrix {
+    float m[9];
+    float yOffset;
+
+    static constexpr ColorMatrix forFrame(Frame::ColorSpace colorSpace, Frame::ColorRange colorRange)
+    {
+        const bool limited = colorRange == Frame::ColorRange::Limited;
+        const float yOffset = limited ? 16.0f / 255.0f : 0.0f;
+        if (colorSpace == Frame::ColorSpace::BT709) {
+            if (limited) {
+                return {{1.164f,  0.0f,    1.793f,
+                         1.164f, -0.213f, -0.533f,
+                         1.164f,  2.112f,  0.0f}, yOffset};
+            }
+            return {{1.0f,  0.0f,    1.574f,
+                     1.0f, -0.187f, -0.468f,
+                     1.0f,  1.855f,  0.0f}, yOffset};
+        }
+        if (limited) {
+            return {{1.164f,  0.0f,    1.596f,
+                     1.164f, -0.391f, -0.813f,
+                     1.164f,  2.018f,  0.0f}, yOffset};
+        }
+        return {{1.0f,  0.0f,    1.402f,
+                 1.0f, -0.344f, -0.714f,
+                 1.0f,  1.772f,  0.0f}, yOffset};
+    }
+};
+} // namespace codec
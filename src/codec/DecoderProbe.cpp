@@ -0,0 +1,437 @@
+//
+// Created by neapu on 2025/12/13.
+//
+
+#include "DecoderProbe.h"
+#include "Helper.h"
+#include <logger.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/opt.h>
+}
+#ifdef __linux__
+#include <libavutil/hwcontext_vaapi.h>
+#include <va/va.h>
+#endif
+
+namespace codec {
+// 缓存格式版本，修改基准测试方法时递增使旧缓存失效
+constexpr int CACHE_FORMAT_VERSION = 2;
+
+constexpr int CLIP_WIDTH = 1280;
+constexpr int CLIP_HEIGHT = 720;
+constexpr int CLIP_FRAMES = 60;
+constexpr int BENCH_ITERATIONS = 3;
+
+// 解码能力只用到七成，给渲染和其它会话留出余量
+constexpr double DECODE_HEADROOM = 0.7;
+// 按常见手机屏幕比例估算长边
+constexpr double SCREEN_ASPECT = 20.0 / 9.0;
+constexpr int MIN_MAX_SIZE = 480;
+constexpr int UNLIMITED_MAX_SIZE = 3200;
+// 没有计时结果的软解路径按保守的上限处理，不能假定 CPU 足够
+constexpr int UNMEASURED_SW_MAX_SIZE = 1280;
+
+static AVCodecID toAVCodecId(VideoDecoder::CodecType codecType)
+{
+    switch (codecType) {
+    case VideoDecoder::CodecType::hevc: return AV_CODEC_ID_HEVC;
+    case VideoDecoder::CodecType::av1: return AV_CODEC_ID_AV1;
+    default: return AV_CODEC_ID_H264;
+    }
+}
+
+// 硬解驱动的标识，换显卡或更新驱动后缓存的硬解结果失效。没有硬解设备时为空
+static std::string hwDecoderIdentity()
+{
+    std::string identity;
+#ifdef __linux__
+    AVBufferRef* hwDeviceCtx = VideoDecoder::sharedHwDeviceContext();
+    if (!hwDeviceCtx) {
+        return identity;
+    }
+    const auto* deviceCtx = reinterpret_cast<AVHWDeviceContext*>(hwDeviceCtx->data);
+    if (deviceCtx->type == AV_HWDEVICE_TYPE_VAAPI) {
+        const auto* vaDeviceCtx = static_cast<AVVAAPIDeviceContext*>(deviceCtx->hwctx);
+        // 厂商字符串包含驱动名称和版本，例如 "Mesa Gallium driver 24.0.5 for AMD Radeon ..."
+        if (const char* vendor = vaQueryVendorString(vaDeviceCtx->display)) {
+            identity = vendor;
+        }
+        if (const char* driverName = std::getenv("LIBVA_DRIVER_NAME")) {
+            identity += " driver=";
+            identity += driverName;
+        }
+    }
+    av_buffer_unref(&hwDeviceCtx);
+    // 缓存首行以换行结束
+    std::replace(identity.begin(), identity.end(), '\n', ' ');
+#endif
+    return identity;
+}
+
+using Clip = std::vector<std::vector<uint8_t>>;
+
+// 用本机可用的编码器生成一段测试片段（码流内含参数集），没有编码器时返回空
+static Clip encodeClip(AVCodecID codecId)
+{
+    Clip clip;
+    const AVCodec* encoder = avcodec_find_encoder(codecId);
+    if (!encoder) {
+        return clip;
+    }
+
+    AVCodecContext* ctx = avcodec_alloc_context3(encoder);
+    if (!ctx) {
+        return clip;
+    }
+    ctx->width = CLIP_WIDTH;
+    ctx->height = CLIP_HEIGHT;
+    ctx->time_base = {1, 60};
+    ctx->framerate = {60, 1};
+    ctx->pix_fmt = AV_PIX_FMT_YUV420P;
+    ctx->gop_size = CLIP_FRAMES;
+    ctx->max_b_frames = 0;
+    ctx->bit_rate = 8000000;
+    // 各编码器的速度选项名不同，设置失败忽略即可
+    av_opt_set(ctx->priv_data, "preset", "ultrafast", 0);
+    av_opt_set(ctx->priv_data, "tune", "zerolatency", 0);
+    av_opt_set(ctx->priv_data, "cpu-used", "8", 0);
+
+    int ret = avcodec_open2(ctx, encoder, nullptr);
+    if (ret < 0) {
+        LOGW("Failed to open encoder {} for probe clip: {}", encoder->name, Helper::getFFmpegErrorString(ret));
+        avcodec_free_context(&ctx);
+        return clip;
+    }
+
+    AVFrame* frame = av_frame_alloc();
+    AVPacket* packet = av_packet_alloc();
+    if (frame) {
+        frame->format = ctx->pix_fmt;
+        frame->width = ctx->width;
+        frame->height = ctx->height;
+    }
+    if (!frame || !packet || av_frame_get_buffer(frame, 0) < 0) {
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+        avcodec_free_context(&ctx);
+        return clip;
+    }
+
+    auto drain = [&]() {
+        while (avcodec_receive_packet(ctx, packet) >= 0) {
+            clip.emplace_back(packet->data, packet->data + packet->size);
+            av_packet_unref(packet);
+        }
+    };
+
+    for (int i = 0; i < CLIP_FRAMES; i++) {
+        if (av_frame_make_writable(frame) < 0) break;
+        // 移动的渐变图案，避免编码器把帧全部跳过
+        for (int y = 0; y < frame->height; y++) {
+            uint8_t* row = frame->data[0] + y * frame->linesize[0];
+            for (int x = 0; x < frame->width; x++) {
+                row[x] = static_cast<uint8_t>(x + y + i * 3);
+            }
+        }
+        for (int y = 0; y < frame->height / 2; y++) {
+            uint8_t* uRow = frame->data[1] + y * frame->linesize[1];
+            uint8_t* vRow = frame->data[2] + y * frame->linesize[2];
+            for (int x = 0; x < frame->width / 2; x++) {
+                uRow[x] = static_cast<uint8_t>(128 + y + i * 2);
+                vRow[x] = static_cast<uint8_t>(64 + x + i * 5);
+            }
+        }
+        frame->pts = i;
+        if (avcodec_send_frame(ctx, frame) < 0) break;
+        drain();
+    }
+    avcodec_send_frame(ctx, nullptr);
+    drain();
+
+    av_packet_free(&packet);
+    av_frame_free(&frame);
+    avcodec_free_context(&ctx);
+    return clip;
+}
+
+// 打开解码器，hwDecode为true时只接受VAAPI输出
+static AVCodecContext* openDecoder(AVCodecID codecId, bool hwDecode)
+{
+    const AVCodec* codec = avcodec_find_decoder(codecId);
+    if (!codec) {
+        return nullptr;
+    }
+    AVCodecContext* ctx = avcodec_alloc_context3(codec);
+    if (!ctx) {
+        return nullptr;
+    }
+    if (hwDecode) {
+#ifdef __linux__
+        const int hwPixelFormat = VideoDecoder::hwPixelFormat(codecId);
+        AVBufferRef* hwDeviceCtx = VideoDecoder::sharedHwDeviceContext();
+        if (hwPixelFormat == AV_PIX_FMT_NONE || !hwDeviceCtx) {
+            av_buffer_unref(&hwDeviceCtx);
+            avcodec_free_context(&ctx);
+            return nullptr;
+        }
+        ctx->hw_device_ctx = hwDeviceCtx;
+        ctx->opaque = reinterpret_cast<void*>(static_cast<intptr_t>(hwPixelFormat));
+        ctx->get_format = [](AVCodecContext* c, const AVPixelFormat* pixFmts) -> AVPixelFormat {
+            const auto wanted = static_cast<AVPixelFormat>(reinterpret_cast<intptr_t>(c->opaque));
+            for (const AVPixelFormat* p = pixFmts; *p != AV_PIX_FMT_NONE; p++) {
+                if (*p == wanted) return *p;
+            }
+            return AV_PIX_FMT_NONE;
+        };
+#else
+        avcodec_free_context(&ctx);
+        return nullptr;
+#endif
+    }
+    if (avcodec_open2(ctx, codec, nullptr) < 0) {
+        avcodec_free_context(&ctx);
+        return nullptr;
+    }
+    return ctx;
+}
+
+static DecoderProbe::Result benchmark(VideoDecoder::CodecType codecType, bool hwDecode, const Clip& clip, const std::atomic<bool>& abort)
+{
+    DecoderProbe::Result result;
+    result.codecType = codecType;
+    result.hwDecode = hwDecode;
+    result.width = CLIP_WIDTH;
+    result.height = CLIP_HEIGHT;
+
+    AVCodecContext* ctx = openDecoder(toAVCodecId(codecType), hwDecode);
+    if (!ctx) {
+        return result;
+    }
+    if (clip.empty()) {
+        // 没有测试片段，只能确认解码器可以打开
+        result.supported = true;
+        avcodec_free_context(&ctx);
+        return result;
+    }
+
+    AVPacket* packet = av_packet_alloc();
+    AVFrame* frame = av_frame_alloc();
+    int decodedFrames = 0;
+    bool failed = false;
+    const auto begin = std::chrono::steady_clock::now();
+    for (int iter = 0; iter < BENCH_ITERATIONS && !failed && !abort.load(); iter++) {
+        for (const auto& data : clip) {
+            if (av_new_packet(packet, static_cast<int>(data.size())) < 0) {
+                failed = true;
+                break;
+            }
+            std::copy(data.begin(), data.end(), packet->data);
+            int ret = avcodec_send_packet(ctx, packet);
+            av_packet_unref(packet);
+            if (ret < 0) {
+                failed = true;
+                break;
+            }
+            while (avcodec_receive_frame(ctx, frame) >= 0) {
+                // 硬解路径若静默回退到软解则视为不支持
+                if (hwDecode && frame->hw_frames_ctx == nullptr) {
+                    failed = true;
+                }
+                decodedFrames++;
+                av_frame_unref(frame);
+            }
+        }
+        avcodec_send_packet(ctx, nullptr);
+        while (avcodec_receive_frame(ctx, frame) >= 0) {
+            decodedFrames++;
+            av_frame_unref(frame);
+        }
+        avcodec_flush_buffers(ctx);
+    }
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    if (!failed && decodedFrames > 0 && elapsed > 0.0) {
+        result.supported = true;
+        result.measured = true;
+        result.fps = decodedFrames / elapsed;
+    }
+
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    avcodec_free_context(&ctx);
+    return result;
+}
+
+DecoderProbe* DecoderProbe::instance()
+{
+    static DecoderProbe instance;
+    return &instance;
+}
+DecoderProbe::~DecoderProbe()
+{
+    m_abort.store(true);
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+void DecoderProbe::start(const std::string& cachePath)
+{
+    FUNC_TRACE;
+    if (m_worker.joinable() || m_ready.load()) {
+        return;
+    }
+    m_cachePath = cachePath;
+    if (loadCache()) {
+        LOGI("Loaded decoder probe cache from {}", m_cachePath);
+        m_ready.store(true);
+        return;
+    }
+    m_worker = std::thread(&DecoderProbe::runBenchmark, this);
+}
+std::vector<DecoderProbe::Result> DecoderProbe::results() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_results;
+}
+std::optional<DecoderProbe::Result> DecoderProbe::result(VideoDecoder::CodecType codecType, bool hwDecode) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& r : m_results) {
+        if (r.codecType == codecType && r.hwDecode == hwDecode) {
+            return r;
+        }
+    }
+    return std::nullopt;
+}
+std::optional<DecoderProbe::Selection> DecoderProbe::select(int fps) const
+{
+    if (!m_ready.load() || fps <= 0) {
+        return std::nullopt;
+    }
+
+    // 计算给定解码路径在目标帧率下能承受的长边上限。未计时的硬解视为不限制，未计时的软解按保守上限
+    auto maxSizeFor = [fps](const Result& r) -> int {
+        if (!r.measured) return r.hwDecode ? 0 : UNMEASURED_SW_MAX_SIZE;
+        const double maxPixels = r.pixelRate() * DECODE_HEADROOM / fps;
+        int maxSize = static_cast<int>(std::sqrt(maxPixels * SCREEN_ASPECT)) & ~7;
+        if (maxSize >= UNLIMITED_MAX_SIZE) return 0;
+        return std::max(maxSize, MIN_MAX_SIZE);
+    };
+
+    // AV1 编码器在手机上并不普及，自动选择只在 H.264 与 HEVC 之间进行。
+    // 有计时结果的路径优先，全部没有计时时才使用只确认能打开的路径
+    for (bool measured : {true, false}) {
+        for (bool hwDecode : {true, false}) {
+            std::optional<Selection> best;
+            int bestMaxSize = -1;
+            for (auto codecType : {VideoDecoder::CodecType::h264, VideoDecoder::CodecType::hevc}) {
+                const auto r = result(codecType, hwDecode);
+                if (!r || !r->supported || r->measured != measured) continue;
+                const int maxSize = maxSizeFor(*r);
+                if (maxSize == 0) {
+                    return Selection{codecType, !hwDecode, 0};
+                }
+                if (maxSize > bestMaxSize) {
+                    bestMaxSize = maxSize;
+                    best = Selection{codecType, !hwDecode, maxSize};
+                }
+            }
+            // 硬解可用时优先使用硬解，避免软解占满CPU
+            if (best) return best;
+        }
+    }
+    return std::nullopt;
+}
+const char* DecoderProbe::codecName(VideoDecoder::CodecType codecType)
+{
+    switch (codecType) {
+    case VideoDecoder::CodecType::hevc: return "h265";
+    case VideoDecoder::CodecType::av1: return "av1";
+    default: return "h264";
+    }
+}
+bool DecoderProbe::loadCache()
+{
+    std::ifstream in(m_cachePath);
+    if (!in) {
+        return false;
+    }
+    int formatVersion = 0;
+    unsigned int ffmpegVersion = 0;
+    std::string hwIdentity;
+    in >> formatVersion >> ffmpegVersion;
+    std::getline(in >> std::ws, hwIdentity);
+    if (!in || formatVersion != CACHE_FORMAT_VERSION || ffmpegVersion != avcodec_version()
+        || hwIdentity != "hw:" + hwDecoderIdentity()) {
+        LOGI("Decoder probe cache is outdated, probing again");
+        return false;
+    }
+
+    std::vector<Result> results;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        std::istringstream ss(line);
+        int codecType = 0;
+        Result r;
+        ss >> codecType >> r.hwDecode >> r.supported >> r.measured >> r.fps >> r.width >> r.height;
+        if (!ss) {
+            LOGW("Malformed decoder probe cache line: {}", line);
+            return false;
+        }
+        r.codecType = static_cast<VideoDecoder::CodecType>(codecType);
+        results.push_back(r);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_results = std::move(results);
+    return true;
+}
+void DecoderProbe::saveCache() const
+{
+    std::ofstream out(m_cachePath, std::ios::trunc);
+    if (!out) {
+        LOGW("Failed to write decoder probe cache: {}", m_cachePath);
+        return;
+    }
+    out << CACHE_FORMAT_VERSION << ' ' << avcodec_version() << " hw:" << hwDecoderIdentity() << '\n';
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& r : m_results) {
+        out << static_cast<int>(r.codecType) << ' ' << r.hwDecode << ' ' << r.supported << ' ' << r.measured << ' ' << r.fps << ' '
+            << r.width << ' ' << r.height << '\n';
+    }
+}
+void DecoderProbe::runBenchmark()
+{
+    FUNC_TRACE;
+    std::vector<Result> results;
+    for (auto codecType : {VideoDecoder::CodecType::h264, VideoDecoder::CodecType::hevc, VideoDecoder::CodecType::av1}) {
+        if (m_abort.load()) return;
+        const Clip clip = encodeClip(toAVCodecId(codecType));
+        if (clip.empty()) {
+            LOGW("No encoder available for {}, decoder will be probed without timing", codecName(codecType));
+        }
+        for (bool hwDecode : {true, false}) {
+            const auto r = benchmark(codecType, hwDecode, clip, m_abort);
+            LOGI("Decoder probe: codec={}, hw={}, supported={}, fps={:.1f}", codecName(codecType), hwDecode, r.supported, r.fps);
+            results.push_back(r);
+        }
+    }
+    if (m_abort.load()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_results = std::move(results);
+    }
+    saveCache();
+    m_ready.store(true);
+}
+} // namespace codec
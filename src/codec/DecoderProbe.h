@@ -0,0 +1,67 @@
+//
+// Created by neapu on 2025/12/13.
+//
+
+#pragma once
+#include "VideoDecoder.h"
+#include <string>
+#include <vector>
+#include <optional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+namespace codec {
+// 本机解码能力探测：对每种编码格式的软/硬解路径各跑一次短片段解码基准，
+// 结果缓存到磁盘，之后的启动直接读取缓存。
+class DecoderProbe {
+public:
+    struct Result {
+        VideoDecoder::CodecType codecType{VideoDecoder::CodecType::h264};
+        bool hwDecode{false};
+        bool supported{false}; // 解码器能否打开并输出帧
+        bool measured{false};  // 是否有可用编码器生成测试片段并完成计时
+        double fps{0.0};       // 测试分辨率下的解码帧率
+        int width{0};
+        int height{0};
+
+        double pixelRate() const { return fps * width * height; }
+    };
+
+    struct Selection {
+        VideoDecoder::CodecType codecType{VideoDecoder::CodecType::h264};
+        bool swDecode{false};
+        int maxSize{0}; // 0 表示不需要限制分辨率
+    };
+
+    static DecoderProbe* instance();
+
+    // 读取缓存，缓存不存在或与当前FFmpeg版本、硬解驱动不匹配时在后台线程运行基准测试
+    void start(const std::string& cachePath);
+    bool ready() const { return m_ready.load(); }
+
+    std::vector<Result> results() const;
+    std::optional<Result> result(VideoDecoder::CodecType codecType, bool hwDecode) const;
+
+    // 根据目标帧率选择本机能够承受的编码格式与分辨率上限
+    std::optional<Selection> select(int fps) const;
+
+    static const char* codecName(VideoDecoder::CodecType codecType);
+
+private:
+    DecoderProbe() = default;
+    ~DecoderProbe();
+
+    bool loadCache();
+    void saveCache() const;
+    void runBenchmark();
+
+private:
+    std::string m_cachePath;
+    std::vector<Result> m_results;
+    mutable std::mutex m_mutex;
+    std::thread m_worker;
+    std::atomic<bool> m_ready{false};
+    std::atomic<bool> m_abort{false};
+};
+} // namespace codec
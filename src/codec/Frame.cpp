@@ -45,6 +45,17 @@ Frame& Frame::operator=(Frame&& other) noexcept
     }
     return *this;
 }
+std::unique_ptr<Frame> Frame::ref() const
+{
+    if (!m_avFrame) {
+        return nullptr;
+    }
+    auto frame = std::make_unique<Frame>();
+    if (av_frame_ref(frame->m_avFrame, m_avFrame) < 0) {
+        return nullptr;
+    }
+    return frame;
+}
 uint8_t* Frame::data(int index) const
 {
     return (!m_avFrame || index < 0 || index >= AV_NUM_DATA_POINTERS) ? nullptr : m_avFrame->data[index];
@@ -61,6 +72,13 @@ int Frame::height() const
 {
     return m_avFrame ? m_avFrame->height : 0;
 }
+int64_t Frame::pts() const
+{
+    if (!m_avFrame) return -1;
+    if (m_avFrame->pts != AV_NOPTS_VALUE) return m_avFrame->pts;
+    if (m_avFrame->best_effort_timestamp != AV_NOPTS_VALUE) return m_avFrame->best_effort_timestamp;
+    return -1;
+}
 Frame::PixelFormat Frame::pixelFormat() const
 {
     if (!m_avFrame) return PixelFormat::None;
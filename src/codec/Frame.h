@@ -17,6 +17,9 @@ public:
     Frame(Frame&& other) noexcept;
     Frame& operator=(Frame&& other) noexcept;
 
+    // 新的引用，与原帧共享数据缓冲（硬件帧共享同一个表面），不复制数据
+    std::unique_ptr<Frame> ref() const;
+
     AVFrame* avFrame() const { return m_avFrame; }
 
     uint8_t* data(int index) const;
@@ -24,6 +27,8 @@ public:
 
     int width() const;
     int height() const;
+    // 设备端PTS（微秒），没有时返回-1
+    int64_t pts() const;
 
     enum class PixelFormat {
         None,
@@ -0,0 +1,284 @@
+//
+// Created by neapu on 2025/12/28.
+//
+
+#include "FrameAnalysisHost.h"
+#include "ColorConverter.h"
+#include "MediaClock.h"
+#include "Helper.h"
+#include "logger.h"
+#include <algorithm>
+#include <exception>
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/hwcontext.h>
+}
+
+namespace codec {
+// 每个工作线程独占的下载和转换缓冲
+struct FrameAnalysisHost::WorkerContext {
+    ColorConverter converter;
+    // 同一帧依次交给多个分析器时只下载一次
+    FramePtr downloaded;
+    uint64_t downloadedSequence{0};
+    // 裁剪后的引用，analyze 返回后释放
+    FramePtr cropped;
+    std::vector<uint8_t> buffer;
+};
+
+FrameAnalysisHost::FrameAnalysisHost(int workers)
+{
+    m_running = true;
+    for (int i = 0; i < std::max(1, workers); ++i) {
+        m_workers.emplace_back(&FrameAnalysisHost::workerLoop, this);
+    }
+}
+FrameAnalysisHost::~FrameAnalysisHost()
+{
+    FUNC_TRACE;
+    m_running.store(false);
+    m_cv.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+int FrameAnalysisHost::add(std::shared_ptr<FrameAnalyzer> analyzer)
+{
+    if (!analyzer) {
+        return -1;
+    }
+    auto entry = std::make_unique<Entry>();
+    entry->config = analyzer->config();
+    entry->stats.name = analyzer->name();
+    entry->analyzer = std::move(analyzer);
+    int id;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        id = m_nextId++;
+        entry->id = id;
+        // 注册后立即处理当前帧，画面静止时也能拿到一帧
+        entry->lastSequence = m_latestSequence > 0 ? m_latestSequence - 1 : 0;
+        LOGI("Frame analyzer {} registered with id {}", entry->stats.name, id);
+        m_entries.push_back(std::move(entry));
+        m_entryCount.store(m_entries.size());
+    }
+    m_cv.notify_all();
+    return id;
+}
+void FrameAnalysisHost::remove(int id)
+{
+    std::unique_ptr<Entry> removed;
+    FramePtr latest;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto find = [&] {
+            return std::find_if(m_entries.begin(), m_entries.end(), [&](const auto& e) { return e->id == id; });
+        };
+        m_cv.wait(lock, [&] {
+            const auto it = find();
+            return it == m_entries.end() || !(*it)->running;
+        });
+        const auto it = find();
+        if (it == m_entries.end()) {
+            return;
+        }
+        removed = std::move(*it);
+        m_entries.erase(it);
+        m_entryCount.store(m_entries.size());
+        if (m_entries.empty()) {
+            // 不再需要最新帧，尽早归还硬件表面
+            latest = std::move(m_latest);
+        }
+    }
+    // 分析器可能由调用方之外的代码持有，在锁外释放
+    removed.reset();
+}
+void FrameAnalysisHost::onFrame(const Frame& frame)
+{
+    if (m_entryCount.load() == 0) {
+        return;
+    }
+    FramePtr latest = frame.ref();
+    if (!latest) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // 旧帧的引用在锁外释放
+        std::swap(m_latest, latest);
+        if (latest) {
+            for (const auto& entry : m_entries) {
+                if (entry->lastSequence < m_latestSequence) {
+                    ++entry->stats.skipped;
+                }
+            }
+        }
+        ++m_latestSequence;
+        m_latestArrivalUs = MediaClock::nowUs();
+    }
+    m_cv.notify_all();
+}
+std::vector<FrameAnalysisHost::Stats> FrameAnalysisHost::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Stats> result;
+    result.reserve(m_entries.size());
+    for (const auto& entry : m_entries) {
+        result.push_back(entry->stats);
+    }
+    return result;
+}
+FrameAnalysisHost::Entry* FrameAnalysisHost::nextReadyLocked()
+{
+    if (!m_latest || m_entries.empty()) {
+        return nullptr;
+    }
+    // 轮流选择，避免排在前面的分析器占满线程池
+    for (size_t n = 0; n < m_entries.size(); ++n) {
+        const size_t index = (m_nextIndex + n) % m_entries.size();
+        Entry* entry = m_entries[index].get();
+        if (!entry->running && entry->lastSequence < m_latestSequence) {
+            m_nextIndex = index + 1;
+            return entry;
+        }
+    }
+    return nullptr;
+}
+bool FrameAnalysisHost::prepare(WorkerContext& ctx, const Frame& frame, uint64_t sequence,
+                                const FrameAnalyzer::Config& config, FrameAnalyzer::Image& image) const
+{
+    const Frame* source = &frame;
+    if (frame.avFrame()->hw_frames_ctx) {
+        if (!ctx.downloaded || ctx.downloadedSequence != sequence) {
+            ctx.downloaded.reset();
+            auto downloaded = std::make_unique<Frame>();
+            const int ret = av_hwframe_transfer_data(downloaded->avFrame(), frame.avFrame(), 0);
+            if (ret < 0) {
+                LOGE("Failed to download frame for analysis: {}", Helper::getFFmpegErrorString(ret));
+                return false;
+            }
+            av_frame_copy_props(downloaded->avFrame(), frame.avFrame());
+            ctx.downloaded = std::move(downloaded);
+            ctx.downloadedSequence = sequence;
+        }
+        source = ctx.downloaded.get();
+    }
+
+    // 区域对齐到 2 个像素，色度平面可以按相同的区域裁剪
+    const int frameWidth = source->width();
+    const int frameHeight = source->height();
+    const int x = std::clamp(static_cast<int>(config.roiX * static_cast<float>(frameWidth)), 0, frameWidth) & ~1;
+    const int y = std::clamp(static_cast<int>(config.roiY * static_cast<float>(frameHeight)), 0, frameHeight) & ~1;
+    const int width = std::min(static_cast<int>(config.roiWidth * static_cast<float>(frameWidth)), frameWidth - x) & ~1;
+    const int height = std::min(static_cast<int>(config.roiHeight * static_cast<float>(frameHeight)), frameHeight - y) & ~1;
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    image.roiX = x;
+    image.roiY = y;
+    image.roiWidth = width;
+    image.roiHeight = height;
+    image.frameWidth = frameWidth;
+    image.frameHeight = frameHeight;
+
+    // 裁剪只移动平面指针，不复制像素
+    ctx.cropped = source->ref();
+    if (!ctx.cropped) {
+        return false;
+    }
+    AVFrame* cropped = ctx.cropped->avFrame();
+    cropped->crop_left = static_cast<size_t>(x);
+    cropped->crop_top = static_cast<size_t>(y);
+    cropped->crop_right = static_cast<size_t>(frameWidth - x - width);
+    cropped->crop_bottom = static_cast<size_t>(frameHeight - y - height);
+    if (av_frame_apply_cropping(cropped, AV_FRAME_CROP_UNALIGNED) < 0) {
+        return false;
+    }
+
+    if (config.input == FrameAnalyzer::Config::Input::Yuv) {
+        image.frame = ctx.cropped.get();
+        image.width = width;
+        image.height = height;
+        return true;
+    }
+    if (!ColorConverter::supportsFormat(cropped->format)) {
+        LOGE("Pixel format {} cannot be converted for analysis", cropped->format);
+        return false;
+    }
+    const int outputWidth = ColorConverter::outputWidth(width, config.scale);
+    const int outputHeight = ColorConverter::outputHeight(height, config.scale);
+    if (outputWidth <= 0 || outputHeight <= 0) {
+        return false;
+    }
+    const int stride = outputWidth * 4;
+    ctx.buffer.resize(static_cast<size_t>(stride) * outputHeight);
+    const auto output = config.input == FrameAnalyzer::Config::Input::BGRA
+        ? ColorConverter::Output::BGRA
+        : ColorConverter::Output::RGBA;
+    // 缩小和颜色转换在同一遍中完成
+    if (!ctx.converter.convert(cropped, ctx.buffer.data(), stride, output, config.scale)) {
+        return false;
+    }
+    image.pixels = ctx.buffer.data();
+    image.width = outputWidth;
+    image.height = outputHeight;
+    image.stride = stride;
+    return true;
+}
+void FrameAnalysisHost::workerLoop()
+{
+    WorkerContext ctx;
+    for (;;) {
+        Entry* entry = nullptr;
+        FramePtr frame;
+        FrameAnalyzer::Image image;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return !m_running.load() || (entry = nextReadyLocked()) != nullptr; });
+            if (!m_running.load()) {
+                break;
+            }
+            frame = m_latest->ref();
+            entry->running = true;
+            entry->lastSequence = m_latestSequence;
+            image.sequence = m_latestSequence;
+            image.arrivalUs = m_latestArrivalUs;
+        }
+
+        bool ok = false;
+        int64_t analyzeUs = 0;
+        if (frame && prepare(ctx, *frame, image.sequence, entry->config, image)) {
+            image.pts = frame->pts();
+            const int64_t startUs = MediaClock::nowUs();
+            try {
+                entry->analyzer->analyze(image);
+                ok = true;
+            } catch (const std::exception& ex) {
+                LOGE("Frame analyzer {} failed: {}", entry->stats.name, ex.what());
+            }
+            analyzeUs = MediaClock::nowUs() - startUs;
+        }
+        ctx.cropped.reset();
+        frame.reset();
+        const int64_t latencyUs = MediaClock::nowUs() - image.arrivalUs;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            entry->running = false;
+            auto& stats = entry->stats;
+            if (!ok) {
+                ++stats.failed;
+            } else {
+                ++stats.analyzed;
+                stats.totalLatencyUs += latencyUs;
+                stats.maxLatencyUs = std::max(stats.maxLatencyUs, latencyUs);
+                stats.totalAnalyzeUs += analyzeUs;
+                stats.maxAnalyzeUs = std::max(stats.maxAnalyzeUs, analyzeUs);
+            }
+        }
+        // 唤醒等待注销的线程，以及可能因本条目忙碌而空等的工作线程
+        m_cv.notify_all();
+    }
+}
+} // namespace codec
@@ -0,0 +1,79 @@
+//
+// Created by neapu on 2025/12/28.
+//
+
+#pragma once
+#include "FrameAnalyzer.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace codec {
+// 在线程池中运行注册的 FrameAnalyzer。解码线程只替换最新帧的引用，从不等待分析器；
+// 每个分析器只处理它空闲时的最新一帧，中间的帧记为跳过。没有注册分析器时不持有任何帧。
+class FrameAnalysisHost {
+public:
+    struct Stats {
+        std::string name;
+        uint64_t analyzed{0};
+        // 分析器忙碌期间被更新的帧替换掉的帧
+        uint64_t skipped{0};
+        uint64_t failed{0};
+        // 从帧到达到分析完成
+        int64_t totalLatencyUs{0};
+        int64_t maxLatencyUs{0};
+        // 只计 analyze 本身
+        int64_t totalAnalyzeUs{0};
+        int64_t maxAnalyzeUs{0};
+    };
+
+    explicit FrameAnalysisHost(int workers = 2);
+    ~FrameAnalysisHost();
+
+    // 线程安全，返回用于注销的 id
+    int add(std::shared_ptr<FrameAnalyzer> analyzer);
+    // 线程安全，分析器正在运行时等待其返回，不能在 analyze 中注销自身
+    void remove(int id);
+    // 在解码线程调用，没有分析器时直接返回，否则只增加引用计数，不阻塞
+    void onFrame(const Frame& frame);
+
+    std::vector<Stats> stats() const;
+
+private:
+    struct Entry {
+        int id{0};
+        std::shared_ptr<FrameAnalyzer> analyzer;
+        FrameAnalyzer::Config config;
+        uint64_t lastSequence{0};
+        bool running{false};
+        Stats stats;
+    };
+    struct WorkerContext;
+
+    // 调用方持有 m_mutex，返回下一个可以运行的分析器
+    Entry* nextReadyLocked();
+    // 下载、裁剪和转换，失败返回 false
+    bool prepare(WorkerContext& ctx, const Frame& frame, uint64_t sequence, const FrameAnalyzer::Config& config,
+                 FrameAnalyzer::Image& image) const;
+    void workerLoop();
+
+private:
+    std::vector<std::thread> m_workers;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    // 运行中的条目在工作线程解锁后仍被访问，注销前会等待其结束，指针保持有效
+    std::vector<std::unique_ptr<Entry>> m_entries;
+    int m_nextId{1};
+    size_t m_nextIndex{0};
+    FramePtr m_latest;
+    uint64_t m_latestSequence{0};
+    int64_t m_latestArrivalUs{0};
+    std::atomic<bool> m_running{false};
+    // m_entries 的大小，解码线程不加锁读取
+    std::atomic<size_t> m_entryCount{0};
+};
+} // namespace codec
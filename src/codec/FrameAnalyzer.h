@@ -0,0 +1,63 @@
+//
+// Created by neapu on 2025/12/28.
+//
+
+#pragma once
+#include "Frame.h"
+#include <cstdint>
+
+namespace codec {
+// 帧分析插件接口（模板匹配、OCR 触发、脚本逻辑等），由 FrameAnalysisHost 在线程池中调用。
+// 同一个分析器不会被并发调用；处理不过来时只拿到最新的帧，不影响解码和显示。
+class FrameAnalyzer {
+public:
+    struct Config {
+        enum class Input {
+            // 解码出的 YUV 帧，硬件帧已下载到内存
+            Yuv,
+            // 紧密排列的 RGBA8888 / BGRA8888
+            RGBA,
+            BGRA,
+        };
+        Input input{Input::RGBA};
+        // 转换时按整数倍缩小：1、2、4 或 8，只对 RGBA/BGRA 有效
+        int scale{1};
+        // 感兴趣区域，相对画面的归一化坐标，默认整帧
+        float roiX{0.0f};
+        float roiY{0.0f};
+        float roiWidth{1.0f};
+        float roiHeight{1.0f};
+    };
+
+    struct Image {
+        uint64_t sequence{0};
+        // 设备端PTS（微秒），没有时为 -1
+        int64_t pts{-1};
+        // 帧从解码器交给分析模块的时刻（MediaClock::nowUs）
+        int64_t arrivalUs{0};
+        // Yuv 输入时为裁剪到感兴趣区域的帧；其余输入为 nullptr
+        const Frame* frame{nullptr};
+        // RGBA/BGRA 输入时的像素，只在 analyze 调用期间有效
+        const uint8_t* pixels{nullptr};
+        int width{0};
+        int height{0};
+        int stride{0};
+        // 感兴趣区域在整帧中的像素位置，用于把结果换算回设备坐标
+        int roiX{0};
+        int roiY{0};
+        int roiWidth{0};
+        int roiHeight{0};
+        int frameWidth{0};
+        int frameHeight{0};
+    };
+
+    virtual ~FrameAnalyzer() = default;
+
+    // 用于日志和统计
+    virtual const char* name() const = 0;
+    // 注册时读取一次
+    virtual Config config() const { return {}; }
+    // 在线程池的线程上调用
+    virtual void analyze(const Image& image) = 0;
+};
+} // namespace codec
@@ -0,0 +1,259 @@
+//
+// Created by neapu on 2025/12/31.
+//
+
+#include "FrameBus.h"
+#include "Helper.h"
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/hwcontext.h>
+}
+
+namespace codec {
+FrameBus::Subscription::Subscription(std::string name, Policy policy, size_t capacity, std::function<void()> notify)
+    : m_policy(policy)
+    , m_capacity(policy == Policy::LatestOnly ? 1 : std::max<size_t>(1, capacity))
+    , m_notify(std::move(notify))
+{
+    m_stats.name = std::move(name);
+    m_stats.policy = policy;
+}
+FramePtr FrameBus::Subscription::take()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_frames.empty()) {
+        return nullptr;
+    }
+    FramePtr frame = std::move(m_frames.front());
+    m_frames.pop_front();
+    ++m_stats.taken;
+    return frame;
+}
+FramePtr FrameBus::Subscription::wait(int64_t timeoutUs)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait_for(lock, std::chrono::microseconds(timeoutUs), [&] { return !m_frames.empty() || m_closed; });
+    if (m_frames.empty()) {
+        return nullptr;
+    }
+    FramePtr frame = std::move(m_frames.front());
+    m_frames.pop_front();
+    ++m_stats.taken;
+    return frame;
+}
+void FrameBus::Subscription::close()
+{
+    std::deque<FramePtr> frames;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        frames.swap(m_frames);
+    }
+    m_cv.notify_all();
+}
+bool FrameBus::Subscription::closed() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_closed;
+}
+FrameBus::Stats FrameBus::Subscription::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+FramePtr FrameBus::Subscription::push(FramePtr&& frame)
+{
+    FramePtr evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_closed) {
+            return std::move(frame);
+        }
+        ++m_stats.published;
+        if (m_frames.size() >= m_capacity) {
+            evicted = std::move(m_frames.front());
+            m_frames.pop_front();
+            ++m_stats.dropped;
+        }
+        m_frames.push_back(std::move(frame));
+    }
+    m_cv.notify_one();
+    if (m_notify) {
+        m_notify();
+    }
+    return evicted;
+}
+void FrameBus::Subscription::dropUndelivered()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_closed) {
+        ++m_stats.published;
+        ++m_stats.dropped;
+    }
+}
+
+FrameBus::~FrameBus()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_downloadMutex);
+        m_downloadStopping = true;
+    }
+    m_downloadCv.notify_all();
+    if (m_downloadThread.joinable()) {
+        m_downloadThread.join();
+    }
+}
+FrameBus::SubscriptionPtr FrameBus::subscribe(const std::string& name, Policy policy, size_t capacity,
+                                              std::function<void()> notify)
+{
+    auto subscription = std::make_shared<Subscription>(name, policy, capacity, std::move(notify));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_subscriptions.push_back(subscription);
+    LOGI("Frame bus subscriber {} added ({})", name, policy == Policy::LatestOnly ? "latest only" : "queued");
+    return subscription;
+}
+void FrameBus::unsubscribe(const SubscriptionPtr& subscription)
+{
+    if (!subscription) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::erase(m_subscriptions, subscription);
+    }
+    subscription->close();
+}
+void FrameBus::unsubscribeAll()
+{
+    std::vector<SubscriptionPtr> subscriptions;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        subscriptions.swap(m_subscriptions);
+    }
+    FramePtr pending;
+    {
+        std::lock_guard<std::mutex> lock(m_downloadMutex);
+        pending = std::move(m_pendingDownload);
+    }
+    for (const auto& subscription : subscriptions) {
+        subscription->close();
+    }
+}
+void FrameBus::publish(const Frame& frame)
+{
+    // 订阅列表很短，复制一份后在锁外分发，订阅和退订不会阻塞解码线程
+    std::vector<SubscriptionPtr> subscriptions;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_subscriptions.empty()) {
+            return;
+        }
+        subscriptions = m_subscriptions;
+    }
+    const bool hwFrame = frame.avFrame()->hw_frames_ctx != nullptr;
+    bool needsDownload = false;
+    for (const auto& subscription : subscriptions) {
+        if (hwFrame && subscription->m_policy == Policy::Queued) {
+            needsDownload = true;
+            continue;
+        }
+        FramePtr ref = frame.ref();
+        if (!ref) {
+            LOGE("Failed to reference frame for subscriber {}", subscription->stats().name);
+            continue;
+        }
+        // 被挤出的帧在这里释放，不持有订阅者的锁
+        FramePtr evicted = subscription->push(std::move(ref));
+    }
+    if (!needsDownload) {
+        return;
+    }
+    FramePtr ref = frame.ref();
+    if (!ref) {
+        LOGE("Failed to reference frame for download");
+        return;
+    }
+    FramePtr replaced;
+    {
+        std::lock_guard<std::mutex> lock(m_downloadMutex);
+        if (!m_downloadThread.joinable()) {
+            m_downloadThread = std::thread(&FrameBus::downloadLoop, this);
+        }
+        replaced = std::move(m_pendingDownload);
+        m_pendingDownload = std::move(ref);
+    }
+    m_downloadCv.notify_one();
+    if (replaced) {
+        for (const auto& subscription : subscriptions) {
+            if (subscription->m_policy == Policy::Queued) {
+                subscription->dropUndelivered();
+            }
+        }
+    }
+}
+std::vector<FrameBus::SubscriptionPtr> FrameBus::queuedSubscriptions() const
+{
+    std::vector<SubscriptionPtr> queued;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& subscription : m_subscriptions) {
+        if (subscription->m_policy == Policy::Queued) {
+            queued.push_back(subscription);
+        }
+    }
+    return queued;
+}
+void FrameBus::downloadLoop()
+{
+    for (;;) {
+        FramePtr hwFrame;
+        {
+            std::unique_lock<std::mutex> lock(m_downloadMutex);
+            m_downloadCv.wait(lock, [&] { return m_downloadStopping || m_pendingDownload; });
+            if (m_downloadStopping) {
+                break;
+            }
+            hwFrame = std::move(m_pendingDownload);
+        }
+        // 等待期间订阅者可能已经退订
+        const auto subscriptions = queuedSubscriptions();
+        if (subscriptions.empty()) {
+            continue;
+        }
+        // 每帧只下载一次，所有 Queued 订阅者共享
+        auto downloaded = std::make_unique<Frame>();
+        const int ret = av_hwframe_transfer_data(downloaded->avFrame(), hwFrame->avFrame(), 0);
+        if (ret < 0) {
+            LOGE("Failed to download frame for queued subscribers: {}", Helper::getFFmpegErrorString(ret));
+            continue;
+        }
+        av_frame_copy_props(downloaded->avFrame(), hwFrame->avFrame());
+        // 尽早归还解码器的表面
+        hwFrame.reset();
+        for (const auto& subscription : subscriptions) {
+            FramePtr ref = downloaded->ref();
+            if (!ref) {
+                LOGE("Failed to reference frame for subscriber {}", subscription->stats().name);
+                continue;
+            }
+            FramePtr evicted = subscription->push(std::move(ref));
+        }
+    }
+}
+std::vector<FrameBus::Stats> FrameBus::stats() const
+{
+    std::vector<SubscriptionPtr> subscriptions;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        subscriptions = m_subscriptions;
+    }
+    std::vector<Stats> result;
+    result.reserve(subscriptions.size());
+    for (const auto& subscription : subscriptions) {
+        result.push_back(subscription->stats());
+    }
+    return result;
+}
+} // namespace codec
@@ -0,0 +1,100 @@
+//
+// Created by neapu on 2025/12/31.
+//
+
+#pragma once
+#include "Frame.h"
+#include <string>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace codec {
+// 会话内的帧分发：解码线程发布一次，每个订阅者得到同一帧的独立引用（av_frame_ref，不复制像素），
+// 按自己的策略缓存并计数丢弃。发布从不等待订阅者。
+// 硬件解码的表面池大小固定，Queued 订阅者得到的是下载到内存的副本，缓存再多也不占用解码器的表面。
+// 下载在总线自己的线程上进行，解码线程只把硬件帧的引用放进单帧邮箱，下载跟不上时旧帧被替换。
+class FrameBus {
+public:
+    enum class Policy {
+        // 只保留最新的一帧，未取走的旧帧被替换
+        LatestOnly,
+        // 按顺序缓存，满时丢弃最旧的一帧。硬件帧先在总线线程下载到内存，所有 Queued 订阅者共享同一份副本
+        Queued,
+    };
+    struct Stats {
+        std::string name;
+        Policy policy{Policy::LatestOnly};
+        uint64_t published{0};
+        uint64_t taken{0};
+        uint64_t dropped{0};
+    };
+
+    class Subscription {
+    public:
+        Subscription(std::string name, Policy policy, size_t capacity, std::function<void()> notify);
+
+        // 线程安全，没有帧时返回 nullptr
+        FramePtr take();
+        // 线程安全，等待到有帧、超时或关闭，后两种情况返回 nullptr
+        FramePtr wait(int64_t timeoutUs);
+        // 唤醒所有等待者，之后发布的帧不再入队
+        void close();
+        bool closed() const;
+        Stats stats() const;
+
+    private:
+        friend class FrameBus;
+        // 返回被替换或挤出的帧，由调用方在锁外释放
+        FramePtr push(FramePtr&& frame);
+        // 帧在下载前被邮箱中更新的帧替换，计为发布并丢弃
+        void dropUndelivered();
+
+    private:
+        const Policy m_policy;
+        const size_t m_capacity;
+        const std::function<void()> m_notify;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::deque<FramePtr> m_frames;
+        bool m_closed{false};
+        Stats m_stats;
+    };
+    using SubscriptionPtr = std::shared_ptr<Subscription>;
+
+    FrameBus() = default;
+    ~FrameBus();
+
+    // 线程安全。capacity 只对 Queued 有效；notify 在帧入队后调用，不能阻塞，
+    // 硬件帧的 Queued 订阅在总线的下载线程上调用，其余在发布线程上
+    SubscriptionPtr subscribe(const std::string& name, Policy policy, size_t capacity = 1,
+                              std::function<void()> notify = {});
+    // 线程安全，同时关闭订阅
+    void unsubscribe(const SubscriptionPtr& subscription);
+    // 线程安全，关闭并移除所有订阅，等待中的订阅者被唤醒，邮箱中未下载的帧被释放
+    void unsubscribeAll();
+    // 在解码线程调用，只增加引用计数，不下载
+    void publish(const Frame& frame);
+
+    std::vector<Stats> stats() const;
+
+private:
+    std::vector<SubscriptionPtr> queuedSubscriptions() const;
+    void downloadLoop();
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<SubscriptionPtr> m_subscriptions;
+
+    // 下载线程在第一次需要下载时启动
+    std::thread m_downloadThread;
+    std::mutex m_downloadMutex;
+    std::condition_variable m_downloadCv;
+    FramePtr m_pendingDownload;
+    bool m_downloadStopping{false};
+};
+} // namespace codec
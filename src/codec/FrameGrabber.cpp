@@ -0,0 +1,290 @@
+//
+// Created by neapu on 2025/12/25.
+//
+
+#include "FrameGrabber.h"
+#include "MediaClock.h"
+#include "ColorConverter.h"
+#include "logger.h"
+#include "Helper.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
+}
+
+namespace codec {
+// 等待处理的帧数上限，硬件帧占用解码器的表面，不能积压太多
+constexpr size_t MAX_PENDING_JOBS = 4;
+
+// 连拍时在扩展名前追加序号
+static std::string burstPath(const std::string& path, int index, int count)
+{
+    if (count <= 1) {
+        return path;
+    }
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "_%04d", index);
+    const size_t slash = path.find_last_of("/\\");
+    const size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return path + suffix;
+    }
+    return path.substr(0, dot) + suffix + path.substr(dot);
+}
+static bool writeFile(const std::string& path, const uint8_t* data, size_t size)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        LOGE("Failed to open {} for writing", path);
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+    return static_cast<bool>(file);
+}
+
+// 每个工作线程独占的转换和编码上下文，尺寸不变时复用
+struct FrameGrabber::WorkerContext {
+    ColorConverter converter;
+    SwsContext* swsCtx{nullptr};
+    AVCodecContext* pngCtx{nullptr};
+    AVFrame* swFrame{nullptr};
+    AVFrame* rgbaFrame{nullptr};
+    AVPacket* packet{nullptr};
+    std::vector<uint8_t> buffer;
+
+    ~WorkerContext()
+    {
+        sws_freeContext(swsCtx);
+        avcodec_free_context(&pngCtx);
+        av_frame_free(&swFrame);
+        av_frame_free(&rgbaFrame);
+        av_packet_free(&packet);
+    }
+};
+
+FrameGrabber::FrameGrabber(int workers)
+{
+    m_running = true;
+    for (int i = 0; i < std::max(1, workers); ++i) {
+        m_workers.emplace_back(&FrameGrabber::workerLoop, this);
+    }
+}
+FrameGrabber::~FrameGrabber()
+{
+    FUNC_TRACE;
+    m_running.store(false);
+    m_cv.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    // 工作线程退出前已处理完队列，剩下的是还没等到帧的请求
+    for (const auto& burst : m_bursts) {
+        for (int index = burst.next; index < burst.request.count; ++index) {
+            ++m_stats.failed;
+            if (burst.request.callback) {
+                burst.request.callback(burstPath(burst.request.path, index, burst.request.count), false);
+            }
+        }
+    }
+}
+void FrameGrabber::request(const Request& request)
+{
+    if (request.path.empty() || request.count <= 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.requested;
+    m_bursts.push_back({request, 0});
+}
+void FrameGrabber::onFrame(const Frame& frame)
+{
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_bursts.begin(); it != m_bursts.end();) {
+            if (!enqueue(frame, it->request, it->next)) {
+                ++m_stats.skipped;
+                ++it;
+                continue;
+            }
+            queued = true;
+            if (++it->next >= it->request.count) {
+                it = m_bursts.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (queued) {
+        m_cv.notify_all();
+    }
+}
+FrameGrabber::Stats FrameGrabber::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+bool FrameGrabber::enqueue(const Frame& frame, const Request& request, int index)
+{
+    if (m_jobs.size() >= MAX_PENDING_JOBS) {
+        return false;
+    }
+    auto ref = frame.ref();
+    if (!ref) {
+        return false;
+    }
+    m_jobs.push_back({std::move(ref), request, index});
+    return true;
+}
+bool FrameGrabber::process(WorkerContext& ctx, Job& job) const
+{
+    const AVFrame* src = job.frame->avFrame();
+    if (src->hw_frames_ctx) {
+        // 在工作线程下载，解码和渲染线程不等待
+        if (!ctx.swFrame && !(ctx.swFrame = av_frame_alloc())) {
+            return false;
+        }
+        av_frame_unref(ctx.swFrame);
+        const int ret = av_hwframe_transfer_data(ctx.swFrame, src, 0);
+        if (ret < 0) {
+            LOGE("Failed to download frame for grabbing: {}", Helper::getFFmpegErrorString(ret));
+            return false;
+        }
+        av_frame_copy_props(ctx.swFrame, src);
+        // 尽早归还硬件表面
+        job.frame.reset();
+        src = ctx.swFrame;
+    }
+    const int width = src->width;
+    const int height = src->height;
+    const auto srcFormat = static_cast<AVPixelFormat>(src->format);
+    const std::string path = burstPath(job.request.path, job.index, job.request.count);
+
+    if (job.request.format == Format::yuv) {
+        const int size = av_image_get_buffer_size(srcFormat, width, height, 1);
+        if (size <= 0) {
+            return false;
+        }
+        ctx.buffer.resize(static_cast<size_t>(size));
+        if (av_image_copy_to_buffer(ctx.buffer.data(), size, src->data, src->linesize, srcFormat, width, height, 1) < 0) {
+            return false;
+        }
+        return writeFile(path, ctx.buffer.data(), ctx.buffer.size());
+    }
+
+    const int stride = width * 4;
+    ctx.buffer.resize(static_cast<size_t>(stride) * height);
+    if (ColorConverter::supportsFormat(srcFormat)) {
+        // 与着色器使用同一份系数
+        if (!ctx.converter.convert(src, ctx.buffer.data(), stride)) {
+            LOGE("Failed to convert {}x{} frame of format {} to RGBA", width, height, static_cast<int>(srcFormat));
+            return false;
+        }
+    } else {
+        // 其他格式交给 swscale，矩阵同样按帧标记选择 BT.601/BT.709
+        ctx.swsCtx = sws_getCachedContext(ctx.swsCtx, width, height, srcFormat, width, height, AV_PIX_FMT_RGBA,
+                                          SWS_BILINEAR | SWS_ACCURATE_RND, nullptr, nullptr, nullptr);
+        if (!ctx.swsCtx) {
+            LOGE("Failed to create color converter for grabbing");
+            return false;
+        }
+        const int colorSpace = src->colorspace == AVCOL_SPC_BT709 ? SWS_CS_ITU709 : SWS_CS_ITU601;
+        const int srcRange = src->color_range == AVCOL_RANGE_JPEG ? 1 : 0;
+        sws_setColorspaceDetails(ctx.swsCtx, sws_getCoefficients(colorSpace), srcRange,
+                                 sws_getCoefficients(SWS_CS_DEFAULT), 1, 0, 1 << 16, 1 << 16);
+        uint8_t* dst[4] = {ctx.buffer.data(), nullptr, nullptr, nullptr};
+        const int dstStride[4] = {stride, 0, 0, 0};
+        sws_scale(ctx.swsCtx, src->data, src->linesize, 0, height, dst, dstStride);
+    }
+    if (job.request.format == Format::rgba) {
+        return writeFile(path, ctx.buffer.data(), ctx.buffer.size());
+    }
+
+    if (!ctx.pngCtx || ctx.pngCtx->width != width || ctx.pngCtx->height != height) {
+        avcodec_free_context(&ctx.pngCtx);
+        const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_PNG);
+        if (!codec || !(ctx.pngCtx = avcodec_alloc_context3(codec))) {
+            LOGE("PNG encoder is not available");
+            return false;
+        }
+        ctx.pngCtx->width = width;
+        ctx.pngCtx->height = height;
+        ctx.pngCtx->pix_fmt = AV_PIX_FMT_RGBA;
+        ctx.pngCtx->time_base = {1, 1};
+        const int ret = avcodec_open2(ctx.pngCtx, codec, nullptr);
+        if (ret < 0) {
+            LOGE("Failed to open PNG encoder: {}", Helper::getFFmpegErrorString(ret));
+            avcodec_free_context(&ctx.pngCtx);
+            return false;
+        }
+    }
+    if (!ctx.rgbaFrame && !(ctx.rgbaFrame = av_frame_alloc())) {
+        return false;
+    }
+    if (!ctx.packet && !(ctx.packet = av_packet_alloc())) {
+        return false;
+    }
+    // 直接引用转换缓冲，不复制
+    ctx.rgbaFrame->format = AV_PIX_FMT_RGBA;
+    ctx.rgbaFrame->width = width;
+    ctx.rgbaFrame->height = height;
+    ctx.rgbaFrame->data[0] = ctx.buffer.data();
+    ctx.rgbaFrame->linesize[0] = stride;
+    int ret = avcodec_send_frame(ctx.pngCtx, ctx.rgbaFrame);
+    if (ret >= 0) {
+        ret = avcodec_receive_packet(ctx.pngCtx, ctx.packet);
+    }
+    if (ret < 0) {
+        LOGE("Failed to encode PNG: {}", Helper::getFFmpegErrorString(ret));
+        return false;
+    }
+    const bool ok = writeFile(path, ctx.packet->data, static_cast<size_t>(ctx.packet->size));
+    av_packet_unref(ctx.packet);
+    return ok;
+}
+void FrameGrabber::workerLoop()
+{
+    WorkerContext ctx;
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return !m_jobs.empty() || !m_running.load(); });
+            if (!m_running.load() && m_jobs.empty()) {
+                break;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        const int64_t startUs = MediaClock::nowUs();
+        const bool ok = process(ctx, job);
+        const int64_t elapsedUs = MediaClock::nowUs() - startUs;
+        const std::string path = burstPath(job.request.path, job.index, job.request.count);
+        if (!ok) {
+            LOGE("Failed to grab frame to {}", path);
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (ok) {
+                ++m_stats.saved;
+            } else {
+                ++m_stats.failed;
+            }
+            m_stats.totalProcessUs += elapsedUs;
+            m_stats.maxProcessUs = std::max(m_stats.maxProcessUs, elapsedUs);
+        }
+        if (job.request.callback) {
+            job.request.callback(path, ok);
+        }
+    }
+}
+} // namespace codec
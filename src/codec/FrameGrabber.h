@@ -0,0 +1,82 @@
+//
+// Created by neapu on 2025/12/25.
+//
+
+#pragma once
+#include "Frame.h"
+#include <string>
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+
+namespace codec {
+// 截图与抓帧：解码线程只取帧的引用，下载、转换和压缩都在工作线程完成，不影响解码和显示。
+// 请求由之后解码出的帧完成，没有等待中的请求时不持有任何帧，硬件帧的表面不被长期占用。
+class FrameGrabber {
+public:
+    enum class Format {
+        png,
+        // 紧密排列的 RGBA8888
+        rgba,
+        // 原始 YUV 平面，硬件帧下载后的格式（NV12/P010），软件帧保持解码输出格式
+        yuv,
+    };
+    struct Request {
+        Format format{Format::png};
+        std::string path;
+        // 连拍帧数，大于 1 时文件名追加序号，从下一帧开始按流的帧率连续抓取
+        int count{1};
+        // 每个文件写完或失败后在工作线程调用，析构时尚未抓取的帧在析构的线程上以失败回调
+        std::function<void(const std::string& path, bool ok)> callback;
+    };
+    struct Stats {
+        uint64_t requested{0};
+        uint64_t saved{0};
+        uint64_t failed{0};
+        // 工作线程跟不上时跳过的帧
+        uint64_t skipped{0};
+        int64_t totalProcessUs{0};
+        int64_t maxProcessUs{0};
+    };
+
+    explicit FrameGrabber(int workers = 2);
+    ~FrameGrabber();
+
+    // 线程安全
+    void request(const Request& request);
+    // 在解码线程调用，没有等待中的请求时直接返回，否则只增加引用计数，不阻塞
+    void onFrame(const Frame& frame);
+
+    Stats stats() const;
+
+private:
+    struct Job {
+        FramePtr frame;
+        Request request;
+        int index{0};
+    };
+    struct Burst {
+        Request request;
+        int next{0};
+    };
+    struct WorkerContext;
+
+    // 调用方持有 m_mutex
+    bool enqueue(const Frame& frame, const Request& request, int index);
+    bool process(WorkerContext& ctx, Job& job) const;
+    void workerLoop();
+
+private:
+    std::vector<std::thread> m_workers;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Burst> m_bursts;
+    std::deque<Job> m_jobs;
+    std::atomic<bool> m_running{false};
+    Stats m_stats;
+};
+} // namespace codec
@@ -0,0 +1,236 @@
+//
+// Created by neapu on 2025/12/16.
+//
+
+#include "LatencyProbe.h"
+#include "MediaClock.h"
+#include "Helper.h"
+#include <logger.h>
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/hwcontext.h>
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PROBE_USE_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define PROBE_USE_NEON
+#endif
+
+namespace codec {
+LatencyProbe::LatencyProbe(const Config& config, Trigger trigger)
+    : m_config(config)
+    , m_trigger(std::move(trigger))
+{
+    m_reference.reserve(SAMPLE_SIZE * SAMPLE_SIZE);
+    m_current.reserve(SAMPLE_SIZE * SAMPLE_SIZE);
+    m_samples.reserve(MAX_SAMPLES);
+}
+LatencyProbe::~LatencyProbe()
+{
+    if (m_swFrame) {
+        av_frame_free(&m_swFrame);
+    }
+}
+void LatencyProbe::start()
+{
+    FramePtr reference;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_state != State::Idle || !m_lastFrame) {
+            return;
+        }
+        reference = std::move(m_lastFrame);
+        m_state = State::Capturing;
+    }
+    // 参考取自事件发出前已解码的最后一帧，不依赖之后是否还有新帧
+    const bool captured = sampleRoi(*reference, m_reference);
+    reference.reset();
+    const int64_t sentUs = MediaClock::nowUs();
+    const bool sent = captured && m_trigger && m_trigger();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!sent) {
+        m_state = State::Idle;
+        return;
+    }
+    m_sentUs = sentUs;
+    m_state = State::Waiting;
+}
+bool LatencyProbe::busy() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_state != State::Idle;
+}
+void LatencyProbe::onFrame(const Frame& frame)
+{
+    FramePtr previous;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // 只增加引用，旧的引用在锁外释放。测量期间也更新，测量结束后画面静止时下一次仍有参考
+        previous = std::exchange(m_lastFrame, frame.ref());
+        if (m_state != State::Waiting) {
+            return;
+        }
+    }
+
+    if (!sampleRoi(frame, m_current) || m_current.size() != m_reference.size()) {
+        return;
+    }
+    const uint64_t sad = sumOfAbsDiff(m_reference.data(), m_current.data(), m_current.size());
+    const double meanDiff = static_cast<double>(sad) / static_cast<double>(m_current.size());
+    if (meanDiff < m_config.threshold) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_state != State::Waiting) {
+        return;
+    }
+    m_decodedUs = MediaClock::nowUs();
+    m_changedPts = frame.pts();
+    if (m_changedPts < 0) {
+        // 没有PTS时无法与呈现对应，以解码时刻作为结果
+        finishLocked(m_decodedUs - m_sentUs);
+        return;
+    }
+    m_state = State::Presenting;
+}
+void LatencyProbe::onPresented(int64_t pts)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_state != State::Presenting || pts < m_changedPts) {
+        return;
+    }
+    // 调度器可能跳过这一帧，取不早于它的第一帧呈现
+    finishLocked(MediaClock::nowUs() - m_sentUs);
+}
+void LatencyProbe::poll()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_state != State::Waiting && m_state != State::Presenting) {
+        return;
+    }
+    if (MediaClock::nowUs() - m_sentUs < m_config.timeoutUs) {
+        return;
+    }
+    ++m_stats.timeouts;
+    LOGW("Latency probe timed out, no change detected in region of interest");
+    m_state = State::Idle;
+}
+LatencyProbe::Stats LatencyProbe::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+void LatencyProbe::finishLocked(int64_t presentUs)
+{
+    m_stats.lastDecodeUs = m_decodedUs - m_sentUs;
+    m_stats.lastPresentUs = presentUs;
+    ++m_stats.samples;
+    // 保留最近的样本计算分位数
+    if (m_samples.size() == MAX_SAMPLES) {
+        m_samples.erase(m_samples.begin());
+    }
+    m_samples.push_back(presentUs);
+    auto sorted = m_samples;
+    std::sort(sorted.begin(), sorted.end());
+    m_stats.medianPresentUs = sorted[sorted.size() / 2];
+    m_stats.p95PresentUs = sorted[std::min(sorted.size() - 1, sorted.size() * 95 / 100)];
+    m_stats.minPresentUs = sorted.front();
+    m_stats.maxPresentUs = sorted.back();
+    LOGI("Latency probe: decode {} us, present {} us, median {} us over {} samples",
+         m_stats.lastDecodeUs, presentUs, m_stats.medianPresentUs, m_stats.samples);
+    m_state = State::Idle;
+}
+bool LatencyProbe::sampleRoi(const Frame& frame, std::vector<uint8_t>& out)
+{
+    const AVFrame* src = frame.avFrame();
+    if (!src) {
+        return false;
+    }
+    if (src->hw_frames_ctx) {
+        // 硬件帧需要先下载，只在测量期间发生
+        if (!m_swFrame) {
+            m_swFrame = av_frame_alloc();
+            if (!m_swFrame) {
+                return false;
+            }
+        }
+        av_frame_unref(m_swFrame);
+        const int ret = av_hwframe_transfer_data(m_swFrame, src, 0);
+        if (ret < 0) {
+            LOGE("Failed to download frame for latency probe: {}", Helper::getFFmpegErrorString(ret));
+            return false;
+        }
+        src = m_swFrame;
+    }
+
+    int bytesPerSample = 1;
+    int byteOffset = 0;
+    switch (static_cast<AVPixelFormat>(src->format)) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+    case AV_PIX_FMT_NV12:
+        break;
+    case AV_PIX_FMT_P010LE:
+        // 10位数据在16位的高位，取高字节即可
+        bytesPerSample = 2;
+        byteOffset = 1;
+        break;
+    default:
+        LOGW("Latency probe does not support pixel format {}", src->format);
+        return false;
+    }
+
+    const int roiLeft = std::clamp(static_cast<int>(m_config.roiX * src->width), 0, src->width - 1);
+    const int roiTop = std::clamp(static_cast<int>(m_config.roiY * src->height), 0, src->height - 1);
+    const int roiWidth = std::clamp(static_cast<int>(m_config.roiWidth * src->width), 1, src->width - roiLeft);
+    const int roiHeight = std::clamp(static_cast<int>(m_config.roiHeight * src->height), 1, src->height - roiTop);
+    const int outWidth = std::min(roiWidth, SAMPLE_SIZE);
+    const int outHeight = std::min(roiHeight, SAMPLE_SIZE);
+
+    // 最近邻缩小，只读取需要的像素
+    out.resize(static_cast<size_t>(outWidth) * outHeight);
+    for (int y = 0; y < outHeight; ++y) {
+        const int srcY = roiTop + y * roiHeight / outHeight;
+        const uint8_t* row = src->data[0] + static_cast<ptrdiff_t>(srcY) * src->linesize[0] + byteOffset;
+        uint8_t* dst = out.data() + static_cast<size_t>(y) * outWidth;
+        for (int x = 0; x < outWidth; ++x) {
+            dst[x] = row[static_cast<ptrdiff_t>(roiLeft + x * roiWidth / outWidth) * bytesPerSample];
+        }
+    }
+    return true;
+}
+uint64_t LatencyProbe::sumOfAbsDiff(const uint8_t* a, const uint8_t* b, size_t size)
+{
+    uint64_t sum = 0;
+    size_t i = 0;
+#if defined(PROBE_USE_SSE2)
+    // psadbw 每16字节得到两个64位部分和
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    alignas(16) uint64_t partial[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(partial), acc);
+    sum = partial[0] + partial[1];
+#elif defined(PROBE_USE_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (; i + 16 <= size; i += 16) {
+        const uint8x16_t diff = vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+        acc = vpadalq_u16(acc, vpaddlq_u8(diff));
+    }
+    sum = vaddvq_u32(acc);
+#endif
+    for (; i < size; ++i) {
+        sum += static_cast<uint64_t>(std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i])));
+    }
+    return sum;
+}
+} // namespace codec
@@ -0,0 +1,99 @@
+//
+// Created by neapu on 2025/12/16.
+//
+
+#pragma once
+#include "Frame.h"
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace codec {
+// 点击到显示延迟的探针：始终保留最近解码的一帧的引用，开始测量时从这一帧截取感兴趣区域的缩小亮度图
+// 作为参考并触发控制事件，之后在解码线程逐帧比较同一区域，第一帧出现明显变化时记下解码时刻，
+// 这一帧被呈现时得到完整的往返时间。设备画面静止、服务端不再发送新帧时也能开始测量。
+class LatencyProbe {
+public:
+    struct Config {
+        // 感兴趣区域，相对画面的归一化坐标
+        float roiX{0.45f};
+        float roiY{0.45f};
+        float roiWidth{0.1f};
+        float roiHeight{0.1f};
+        // 缩小图中每个像素的平均亮度差超过该值视为变化
+        double threshold{4.0};
+        // 超时未检测到变化记为丢失
+        int64_t timeoutUs{1000000};
+    };
+    // 在调用 start 的线程调用，发送控制事件，返回是否发送成功
+    using Trigger = std::function<bool()>;
+
+    explicit LatencyProbe(const Config& config, Trigger trigger);
+    ~LatencyProbe();
+
+    // 开始一次测量，在调用线程截取参考并发送控制事件。上一次尚未结束或还没有解码出任何帧时忽略
+    void start();
+    // 解码线程每出一帧调用
+    void onFrame(const Frame& frame);
+    // 帧被呈现时调用（任意线程）
+    void onPresented(int64_t pts);
+    // 定期调用以处理超时：设备画面静止时服务端不会发送新帧
+    void poll();
+    bool busy() const;
+
+    struct Stats {
+        uint64_t samples{0};
+        uint64_t timeouts{0};
+        // 最近一次的结果
+        int64_t lastDecodeUs{0};
+        int64_t lastPresentUs{0};
+        int64_t medianPresentUs{0};
+        int64_t p95PresentUs{0};
+        int64_t minPresentUs{0};
+        int64_t maxPresentUs{0};
+    };
+    Stats stats() const;
+
+    // 两块等长缓冲区的绝对差之和
+    static uint64_t sumOfAbsDiff(const uint8_t* a, const uint8_t* b, size_t size);
+
+private:
+    enum class State {
+        Idle,
+        // start 正在截取参考并发送事件
+        Capturing,
+        // 事件已发出，等待画面变化
+        Waiting,
+        // 已检测到变化，等待该帧呈现
+        Presenting,
+    };
+
+    // 按配置的区域缩小采样亮度平面，写入 out，失败返回 false
+    bool sampleRoi(const Frame& frame, std::vector<uint8_t>& out);
+    void finishLocked(int64_t presentUs);
+
+private:
+    static constexpr int SAMPLE_SIZE = 64;
+    static constexpr size_t MAX_SAMPLES = 1024;
+
+    const Config m_config;
+    Trigger m_trigger;
+
+    mutable std::mutex m_mutex;
+    State m_state{State::Idle};
+    int64_t m_sentUs{0};
+    int64_t m_decodedUs{0};
+    int64_t m_changedPts{-1};
+    Stats m_stats;
+    std::vector<int64_t> m_samples;
+
+    // 最近解码的一帧，start 取走后为空。硬件帧会多占用一个解码表面
+    FramePtr m_lastFrame;
+
+    // 以下在 Capturing 状态只由 start 访问，其他状态只由解码线程访问
+    std::vector<uint8_t> m_reference;
+    std::vector<uint8_t> m_current;
+    AVFrame* m_swFrame{nullptr};
+};
+} // namespace codec
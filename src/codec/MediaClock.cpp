@@ -0,0 +1,143 @@
+//
+// Created by neapu on 2025/12/15.
+//
+
+#include "MediaClock.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+namespace codec {
+// 偏移高于下界时缓慢上调，用于跟随设备时钟变慢的情况
+constexpr int64_t OFFSET_RISE_DIVISOR = 512;
+constexpr double JITTER_SMOOTHING = 1.0 / 16;
+constexpr double SKEW_SMOOTHING = 1.0 / 16;
+// 每秒取一次偏移下界，至少积累5秒后才计算漂移，跨度太短时抖动会淹没漂移
+constexpr int64_t DRIFT_WINDOW_US = 1000000;
+constexpr int64_t DRIFT_MIN_SPAN_US = 5000000;
+// 偏移突变超过1秒视为设备时钟跳变或流重启，重新建立映射
+constexpr int64_t RESYNC_THRESHOLD_US = 1000000;
+// Smooth模式下的呈现延迟：抖动的两倍加固定余量，并限制上限
+constexpr int64_t SMOOTH_JITTER_FACTOR = 2;
+constexpr int64_t SMOOTH_MARGIN_US = 4000;
+
+MediaClock::MediaClock(SyncMode mode)
+    : m_mode(mode)
+{
+}
+int64_t MediaClock::nowUs()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+void MediaClock::update(int64_t pts, int64_t localUs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const int64_t offset = localUs - pts;
+    if (!m_valid || std::abs(offset - m_offsetUs) > RESYNC_THRESHOLD_US) {
+        m_valid = true;
+        m_offsetUs = offset;
+        m_lastPts = pts;
+        m_jitterUs = 0.0;
+        m_windowCount = 0;
+        m_windowStartPts = pts;
+        m_windowMinOffsetUs = offset;
+        m_driftValid = false;
+        return;
+    }
+
+    if (offset < m_offsetUs) {
+        m_offsetUs = offset;
+    } else {
+        m_offsetUs += (offset - m_offsetUs) / OFFSET_RISE_DIVISOR;
+    }
+    m_jitterUs += (static_cast<double>(offset - m_offsetUs) - m_jitterUs) * JITTER_SMOOTHING;
+    m_lastPts = std::max(m_lastPts, pts);
+
+    m_windowMinOffsetUs = std::min(m_windowMinOffsetUs, offset);
+    if (pts - m_windowStartPts >= DRIFT_WINDOW_US) {
+        if (m_windowCount == DRIFT_WINDOWS) {
+            std::move(m_windows.begin() + 1, m_windows.end(), m_windows.begin());
+            --m_windowCount;
+        }
+        m_windows[m_windowCount++] = {m_windowStartPts, m_windowMinOffsetUs};
+        const auto& first = m_windows[0];
+        const auto& last = m_windows[m_windowCount - 1];
+        if (last.pts - first.pts >= DRIFT_MIN_SPAN_US) {
+            m_driftPpm = static_cast<double>(last.offsetUs - first.offsetUs) * 1e6 / static_cast<double>(last.pts - first.pts);
+            m_driftValid = true;
+        }
+        m_windowStartPts = pts;
+        m_windowMinOffsetUs = offset;
+    }
+}
+void MediaClock::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_valid = false;
+    m_jitterUs = 0.0;
+    m_windowCount = 0;
+    m_driftPpm = 0.0;
+    m_driftValid = false;
+    m_skewUs = 0.0;
+    m_skewValid = false;
+}
+bool MediaClock::valid() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_valid;
+}
+int64_t MediaClock::toLocalUs(int64_t pts) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return pts + projectedOffsetLocked(pts);
+}
+int64_t MediaClock::presentationTimeUs(int64_t pts) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return pts + projectedOffsetLocked(pts) + presentationDelayLocked();
+}
+int64_t MediaClock::presentationDelayUs() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return presentationDelayLocked();
+}
+int64_t MediaClock::jitterUs() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<int64_t>(m_jitterUs);
+}
+double MediaClock::driftPpm() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_driftPpm;
+}
+void MediaClock::reportSkew(int64_t videoPts, int64_t audioPts)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto skew = static_cast<double>(videoPts - audioPts);
+    m_skewUs = m_skewValid ? m_skewUs + (skew - m_skewUs) * SKEW_SMOOTHING : skew;
+    m_skewValid = true;
+}
+int64_t MediaClock::skewUs() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<int64_t>(m_skewUs);
+}
+int64_t MediaClock::projectedOffsetLocked(int64_t pts) const
+{
+    if (!m_driftValid) {
+        return m_offsetUs;
+    }
+    // 按漂移外推到尚未到达的PTS
+    return m_offsetUs + static_cast<int64_t>(m_driftPpm * static_cast<double>(pts - m_lastPts) / 1e6);
+}
+int64_t MediaClock::presentationDelayLocked() const
+{
+    if (m_mode == SyncMode::LatencyFirst) {
+        return 0;
+    }
+    const int64_t delay = SMOOTH_JITTER_FACTOR * static_cast<int64_t>(m_jitterUs) + SMOOTH_MARGIN_US;
+    return std::min(delay, MAX_PRESENTATION_DELAY_US);
+}
+} // namespace codec
@@ -0,0 +1,79 @@
+//
+// Created by neapu on 2025/12/15.
+//
+
+#pragma once
+#include <cstdint>
+#include <array>
+#include <mutex>
+
+namespace codec {
+// 会话主时钟：把设备端PTS（微秒）映射到本地单调时钟，估计两者的偏移和漂移。
+// 网络抖动只会让数据晚到，因此以最早到达的样本作为偏移的下界，超出部分视为抖动。
+class MediaClock {
+public:
+    enum class SyncMode {
+        // 视频解码后立即呈现，音频按 reportSkew 测得的偏差向实际呈现的视频靠拢
+        LatencyFirst,
+        // 视频按时钟节奏呈现，呈现延迟随抖动估计自适应
+        Smooth,
+    };
+
+    // Smooth 模式呈现延迟的上限
+    static constexpr int64_t MAX_PRESENTATION_DELAY_US = 100000;
+
+    explicit MediaClock(SyncMode mode = SyncMode::LatencyFirst);
+    ~MediaClock() = default;
+
+    static int64_t nowUs();
+
+    SyncMode mode() const { return m_mode; }
+
+    // 收到带PTS的数据包时调用
+    void update(int64_t pts, int64_t localUs = nowUs());
+    void reset();
+    bool valid() const;
+
+    // PTS对应的本地到达时刻（不含呈现延迟）
+    int64_t toLocalUs(int64_t pts) const;
+    // PTS期望的本地呈现时刻
+    int64_t presentationTimeUs(int64_t pts) const;
+    int64_t presentationDelayUs() const;
+
+    int64_t jitterUs() const;
+    double driftPpm() const;
+
+    // 呈现视频帧时记录当前播放的音频PTS，正数表示视频领先音频。AudioDecoder 据此修正缓冲深度
+    void reportSkew(int64_t videoPts, int64_t audioPts);
+    int64_t skewUs() const;
+
+private:
+    int64_t projectedOffsetLocked(int64_t pts) const;
+    int64_t presentationDelayLocked() const;
+
+private:
+    const SyncMode m_mode;
+    mutable std::mutex m_mutex;
+
+    bool m_valid{false};
+    int64_t m_offsetUs{0};
+    int64_t m_lastPts{0};
+    double m_jitterUs{0.0};
+
+    // 每个窗口内偏移的最小值构成下包络，漂移取包络首尾的斜率
+    struct WindowMin {
+        int64_t pts;
+        int64_t offsetUs;
+    };
+    static constexpr size_t DRIFT_WINDOWS = 10;
+    std::array<WindowMin, DRIFT_WINDOWS> m_windows{};
+    size_t m_windowCount{0};
+    int64_t m_windowStartPts{0};
+    int64_t m_windowMinOffsetUs{0};
+    double m_driftPpm{0.0};
+    bool m_driftValid{false};
+
+    double m_skewUs{0.0};
+    bool m_skewValid{false};
+};
+} // namespace codec
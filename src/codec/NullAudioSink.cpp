@@ -0,0 +1,51 @@
+//
+// Created by neapu on 2025/12/14.
+//
+
+#include "NullAudioSink.h"
+#include <chrono>
+#include <vector>
+
+namespace codec {
+constexpr auto PULL_INTERVAL = std::chrono::milliseconds(10);
+
+NullAudioSink::~NullAudioSink()
+{
+    stop();
+}
+bool NullAudioSink::start(AudioBuffer* buffer)
+{
+    if (!buffer || m_running.exchange(true)) {
+        return false;
+    }
+    m_worker = std::thread(&NullAudioSink::workerLoop, this, buffer);
+    return true;
+}
+void NullAudioSink::stop()
+{
+    m_running.store(false);
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+void NullAudioSink::workerLoop(AudioBuffer* buffer)
+{
+    using namespace std::chrono;
+    std::vector<int16_t> scratch;
+    const auto begin = steady_clock::now();
+    int64_t consumedFrames = 0;
+    auto next = begin;
+    while (m_running.load()) {
+        next += PULL_INTERVAL;
+        std::this_thread::sleep_until(next);
+        // 按经过的真实时间计算应消费的帧数，避免睡眠误差累积
+        const auto elapsedUs = duration_cast<microseconds>(steady_clock::now() - begin).count();
+        const int64_t targetFrames = elapsedUs * buffer->sampleRate() / 1000000;
+        const int frames = static_cast<int>(targetFrames - consumedFrames);
+        if (frames <= 0) continue;
+        scratch.resize(static_cast<size_t>(frames) * buffer->channels());
+        buffer->read(scratch.data(), frames);
+        consumedFrames += frames;
+    }
+}
+} // namespace codec
@@ -0,0 +1,27 @@
+//
+// Created by neapu on 2025/12/14.
+//
+
+#pragma once
+#include "AudioSink.h"
+#include <atomic>
+#include <thread>
+
+namespace codec {
+// 不发声的输出端，按实时速率消费数据，用于无音频设备的环境
+class NullAudioSink final : public AudioSink {
+public:
+    NullAudioSink() = default;
+    ~NullAudioSink() override;
+
+    bool start(AudioBuffer* buffer) override;
+    void stop() override;
+
+private:
+    void workerLoop(AudioBuffer* buffer);
+
+private:
+    std::thread m_worker;
+    std::atomic<bool> m_running{false};
+};
+} // namespace codec
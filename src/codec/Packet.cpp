@@ -28,6 +28,7 @@ Packet::~Packet()
 Packet::Packet(Packet&& other) noexcept
 {
     m_avPacket = other.m_avPacket;
+    m_config = other.m_config;
     other.m_avPacket = nullptr;
 }
 Packet& Packet::operator=(Packet&& other) noexcept
@@ -37,6 +38,7 @@ Packet& Packet::operator=(Packet&& other) noexcept
             av_packet_free(&m_avPacket);
         }
         m_avPacket = other.m_avPacket;
+        m_config = other.m_config;
         other.m_avPacket = nullptr;
     }
     return *this;
@@ -54,6 +56,7 @@ std::unique_ptr<Packet> Packet::fromData(bool configFlag, bool keyFrameFlag, int
         return nullptr;
     }
     std::memcpy(avPacket->data, data, size);
+    packet->m_config = configFlag;
     if (configFlag) {
         avPacket->pts = AV_NOPTS_VALUE;
     } else {
@@ -68,4 +71,14 @@ std::unique_ptr<Packet> Packet::fromData(bool configFlag, bool keyFrameFlag, int
 
     return packet;
 }
+std::unique_ptr<Packet> Packet::ref() const
+{
+    auto packet = std::make_unique<Packet>();
+    if (av_packet_ref(packet->m_avPacket, m_avPacket) < 0) {
+        LOGE("Failed to reference packet");
+        return nullptr;
+    }
+    packet->m_config = m_config;
+    return packet;
+}
 } // namespace codec
\ No newline at end of file
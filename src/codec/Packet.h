@@ -19,10 +19,16 @@ public:
 
     static std::unique_ptr<Packet> fromData(bool configFlag, bool keyFrameFlag, int64_t pts, const uint8_t* data, size_t size);
 
+    // 新的引用，与原包共享数据缓冲，不复制数据
+    std::unique_ptr<Packet> ref() const;
+
     AVPacket* avPacket() const { return m_avPacket; }
+    // 编码参数包（SPS/PPS、OpusHead等），不含媒体数据
+    bool isConfig() const { return m_config; }
 
 private:
     AVPacket* m_avPacket{nullptr};
+    bool m_config{false};
 };
 using PacketPtr = std::unique_ptr<Packet>;
 } // namespace codec
@@ -0,0 +1,400 @@
+//
+// Created by neapu on 2025/12/24.
+//
+
+#include "Recorder.h"
+#include "logger.h"
+#include "Helper.h"
+#include <cstring>
+#include <stdexcept>
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/mem.h>
+}
+
+namespace codec {
+// 数据包的时间戳以微秒为单位
+constexpr AVRational PACKET_TIME_BASE = {1, 1000000};
+// 写文件头前最多缓存的媒体包数（相对队列上限的倍数），超过后不再等待音频流
+constexpr size_t PENDING_LIMIT_FACTOR = 4;
+// 与服务端的音频采集参数一致
+constexpr int AUDIO_SAMPLE_RATE = 48000;
+constexpr int AUDIO_CHANNELS = 2;
+
+static AVCodecID toAVCodecId(VideoDecoder::CodecType codecType)
+{
+    switch (codecType) {
+    case VideoDecoder::CodecType::hevc: return AV_CODEC_ID_HEVC;
+    case VideoDecoder::CodecType::av1: return AV_CODEC_ID_AV1;
+    default: return AV_CODEC_ID_H264;
+    }
+}
+static AVCodecID toAVCodecId(AudioDecoder::CodecType codecType)
+{
+    switch (codecType) {
+    case AudioDecoder::CodecType::aac: return AV_CODEC_ID_AAC;
+    case AudioDecoder::CodecType::flac: return AV_CODEC_ID_FLAC;
+    case AudioDecoder::CodecType::raw: return AV_CODEC_ID_PCM_S16LE;
+    default: return AV_CODEC_ID_OPUS;
+    }
+}
+static bool setExtradata(AVCodecParameters* par, const std::vector<uint8_t>& extradata)
+{
+    if (extradata.empty()) {
+        return true;
+    }
+    par->extradata = static_cast<uint8_t*>(av_mallocz(extradata.size() + AV_INPUT_BUFFER_PADDING_SIZE));
+    if (!par->extradata) {
+        return false;
+    }
+    std::memcpy(par->extradata, extradata.data(), extradata.size());
+    par->extradata_size = static_cast<int>(extradata.size());
+    return true;
+}
+
+Recorder::Recorder(const CreateParam& param)
+    : m_format(param.format)
+    , m_maxQueuedPackets(param.maxQueuedPackets)
+{
+    FUNC_TRACE;
+    const char* formatName = m_format == Format::mp4 ? "mp4" : "matroska";
+    int ret = avformat_alloc_output_context2(&m_formatCtx, nullptr, formatName, param.path.c_str());
+    if (ret < 0 || !m_formatCtx) {
+        LOGE("Failed to allocate output context for {}: {}", param.path, Helper::getFFmpegErrorString(ret));
+        throw std::runtime_error("Failed to allocate output context");
+    }
+    ret = avio_open(&m_formatCtx->pb, param.path.c_str(), AVIO_FLAG_WRITE);
+    if (ret < 0) {
+        LOGE("Failed to open {} for recording: {}", param.path, Helper::getFFmpegErrorString(ret));
+        avformat_free_context(m_formatCtx);
+        m_formatCtx = nullptr;
+        throw std::runtime_error("Failed to open recording file");
+    }
+    if (!param.audio) {
+        m_audioState = AudioState::Disabled;
+    }
+    LOGI("Recording to {}", param.path);
+
+    m_running = true;
+    m_worker = std::thread(&Recorder::workerLoop, this);
+}
+Recorder::~Recorder()
+{
+    FUNC_TRACE;
+    stop();
+    if (m_formatCtx) {
+        avio_closep(&m_formatCtx->pb);
+        avformat_free_context(m_formatCtx);
+        m_formatCtx = nullptr;
+    }
+}
+void Recorder::setVideoStream(VideoDecoder::CodecType codecType, int width, int height)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_videoKnown) {
+            return;
+        }
+        m_videoKnown = true;
+        m_videoCodec = codecType;
+        m_width = width;
+        m_height = height;
+    }
+    m_cv.notify_one();
+}
+void Recorder::setAudioStream(AudioDecoder::CodecType codecType)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_audioState != AudioState::Pending) {
+            return;
+        }
+        if (m_format == Format::mp4 && codecType == AudioDecoder::CodecType::raw) {
+            // MP4 不支持 s16le 原始音频
+            LOGW("Raw audio cannot be stored in MP4, recording video only");
+            m_audioState = AudioState::Disabled;
+        } else {
+            m_audioState = AudioState::Enabled;
+            m_audioCodec = codecType;
+        }
+    }
+    m_cv.notify_one();
+}
+void Recorder::disableAudio()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_audioState != AudioState::Pending) {
+            return;
+        }
+        m_audioState = AudioState::Disabled;
+    }
+    m_cv.notify_one();
+}
+void Recorder::pushVideo(PacketPtr&& packet)
+{
+    push(std::move(packet), false);
+}
+void Recorder::pushAudio(PacketPtr&& packet)
+{
+    push(std::move(packet), true);
+}
+void Recorder::stop()
+{
+    if (m_running.load()) {
+        m_running.store(false);
+        m_cv.notify_all();
+    }
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+Recorder::Stats Recorder::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+void Recorder::push(PacketPtr&& packet, bool audio)
+{
+    if (!packet) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running.load() || (audio && m_audioState == AudioState::Disabled)) {
+            return;
+        }
+        const bool config = packet->isConfig();
+        const bool keyFrame = (packet->avPacket()->flags & AV_PKT_FLAG_KEY) != 0;
+        if (!audio && m_waitKeyFrame && !config) {
+            if (!keyFrame) {
+                ++m_stats.dropped;
+                return;
+            }
+            m_waitKeyFrame = false;
+        }
+        // 编码参数包必须保留，否则之后的数据无法解码
+        if (!config && m_queue.size() >= static_cast<size_t>(m_maxQueuedPackets)) {
+            ++m_stats.dropped;
+            if (!audio) {
+                m_waitKeyFrame = true;
+            }
+            return;
+        }
+        m_queue.push_back({std::move(packet), audio});
+    }
+    m_cv.notify_one();
+}
+bool Recorder::readyForHeader() const
+{
+    // 调用方持有 m_mutex
+    if (!m_videoKnown || m_videoExtradata.empty()) {
+        return false;
+    }
+    if (m_audioState == AudioState::Pending) {
+        return false;
+    }
+    // 原始 PCM 没有参数包，其余格式需要等参数包作为 extradata
+    return m_audioState == AudioState::Disabled || m_audioCodec == AudioDecoder::CodecType::raw || m_audioConfigReceived;
+}
+bool Recorder::writeHeader()
+{
+    VideoDecoder::CodecType videoCodec;
+    int width;
+    int height;
+    bool audio;
+    AudioDecoder::CodecType audioCodec;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        videoCodec = m_videoCodec;
+        width = m_width;
+        height = m_height;
+        audio = m_audioState == AudioState::Enabled;
+        audioCodec = m_audioCodec;
+    }
+
+    m_videoStream = avformat_new_stream(m_formatCtx, nullptr);
+    if (!m_videoStream) {
+        LOGE("Failed to create video stream for recording");
+        return false;
+    }
+    AVCodecParameters* par = m_videoStream->codecpar;
+    par->codec_type = AVMEDIA_TYPE_VIDEO;
+    par->codec_id = toAVCodecId(videoCodec);
+    par->width = width;
+    par->height = height;
+    if (!setExtradata(par, m_videoExtradata)) {
+        return false;
+    }
+
+    if (audio) {
+        m_audioStream = avformat_new_stream(m_formatCtx, nullptr);
+        if (!m_audioStream) {
+            LOGE("Failed to create audio stream for recording");
+            return false;
+        }
+        par = m_audioStream->codecpar;
+        par->codec_type = AVMEDIA_TYPE_AUDIO;
+        par->codec_id = toAVCodecId(audioCodec);
+        par->sample_rate = AUDIO_SAMPLE_RATE;
+        av_channel_layout_default(&par->ch_layout, AUDIO_CHANNELS);
+        if (audioCodec == AudioDecoder::CodecType::raw) {
+            par->format = AV_SAMPLE_FMT_S16;
+            par->bits_per_coded_sample = 16;
+        }
+        if (!setExtradata(par, m_audioExtradata)) {
+            return false;
+        }
+    }
+
+    AVDictionary* options = nullptr;
+    if (m_format == Format::mp4) {
+        // 每个关键帧开始一个分片，moov 放在文件头且不含样本，写到一半中断也能播放
+        av_dict_set(&options, "movflags", "frag_keyframe+empty_moov+default_base_moof", 0);
+    }
+    const int ret = avformat_write_header(m_formatCtx, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        LOGE("Failed to write recording header: {}", Helper::getFFmpegErrorString(ret));
+        return false;
+    }
+    LOGI("Recording started: {}x{}, audio {}", width, height, audio ? "on" : "off");
+    return true;
+}
+void Recorder::writePacket(Entry& entry)
+{
+    AVPacket* pkt = entry.packet->avPacket();
+    AVStream* stream = entry.audio ? m_audioStream : m_videoStream;
+    if (!stream || pkt->pts == AV_NOPTS_VALUE) {
+        return;
+    }
+    const bool keyFrame = (pkt->flags & AV_PKT_FLAG_KEY) != 0;
+    if (!entry.audio) {
+        if (m_ptsOrigin < 0) {
+            // 文件必须从关键帧开始
+            if (!keyFrame) {
+                return;
+            }
+            m_ptsOrigin = pkt->pts;
+        }
+        if (keyFrame && !m_pendingVideoConfig.empty()) {
+            // 参数包与关键帧合并为一个包，新参数随关键帧在带内传递
+            auto merged = std::make_unique<Packet>();
+            const size_t size = m_pendingVideoConfig.size() + static_cast<size_t>(pkt->size);
+            if (av_new_packet(merged->avPacket(), static_cast<int>(size)) < 0) {
+                LOGE("Failed to merge video config into key frame");
+                return;
+            }
+            std::memcpy(merged->avPacket()->data, m_pendingVideoConfig.data(), m_pendingVideoConfig.size());
+            std::memcpy(merged->avPacket()->data + m_pendingVideoConfig.size(), pkt->data, pkt->size);
+            av_packet_copy_props(merged->avPacket(), pkt);
+            m_pendingVideoConfig.clear();
+            entry.packet = std::move(merged);
+            pkt = entry.packet->avPacket();
+        }
+    } else if (m_ptsOrigin < 0 || pkt->pts < m_ptsOrigin) {
+        // 第一个视频关键帧之前的音频没有画面对应，丢弃
+        return;
+    }
+
+    pkt->pts -= m_ptsOrigin;
+    pkt->dts = pkt->pts;
+    pkt->stream_index = stream->index;
+    av_packet_rescale_ts(pkt, PACKET_TIME_BASE, stream->time_base);
+    const int size = pkt->size;
+    // 写入后 pkt 的引用被封装器接管
+    const int ret = av_interleaved_write_frame(m_formatCtx, pkt);
+    if (ret < 0) {
+        LOGE("Failed to write {} packet: {}", entry.audio ? "audio" : "video", Helper::getFFmpegErrorString(ret));
+        return;
+    }
+    if (!entry.audio && keyFrame) {
+        // 分片随关键帧完成，及时落盘
+        avio_flush(m_formatCtx->pb);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (entry.audio) {
+        ++m_stats.audioPackets;
+    } else {
+        ++m_stats.videoPackets;
+    }
+    m_stats.bytes += static_cast<uint64_t>(size);
+}
+void Recorder::workerLoop()
+{
+    for (;;) {
+        Entry entry;
+        bool ready = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return !m_queue.empty() || !m_running.load(); });
+            if (!m_running.load() && m_queue.empty()) {
+                break;
+            }
+            entry = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        if (m_failed) {
+            continue;
+        }
+
+        const auto* avPacket = entry.packet->avPacket();
+        if (entry.packet->isConfig()) {
+            std::vector<uint8_t> data(avPacket->data, avPacket->data + avPacket->size);
+            if (entry.audio) {
+                // 音频参数只在开始时发送一次
+                if (!m_audioConfigReceived) {
+                    m_audioExtradata = std::move(data);
+                    m_audioConfigReceived = true;
+                }
+            } else if (!m_headerWritten) {
+                m_videoExtradata = std::move(data);
+            } else {
+                m_pendingVideoConfig = std::move(data);
+            }
+        } else if (!m_headerWritten) {
+            m_pending.push_back(std::move(entry));
+        } else {
+            writePacket(entry);
+        }
+
+        if (m_headerWritten) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_pending.size() > static_cast<size_t>(m_maxQueuedPackets) * PENDING_LIMIT_FACTOR
+                && m_audioState != AudioState::Disabled && !m_audioConfigReceived) {
+                LOGW("Audio stream is not ready, recording video only");
+                m_audioState = AudioState::Disabled;
+            }
+            ready = readyForHeader();
+        }
+        if (!ready) {
+            continue;
+        }
+        if (!writeHeader()) {
+            m_failed = true;
+            m_pending.clear();
+            continue;
+        }
+        m_headerWritten = true;
+        for (auto& pending : m_pending) {
+            writePacket(pending);
+        }
+        m_pending.clear();
+    }
+
+    if (m_headerWritten) {
+        const int ret = av_write_trailer(m_formatCtx);
+        if (ret < 0) {
+            LOGE("Failed to write recording trailer: {}", Helper::getFFmpegErrorString(ret));
+        }
+    } else if (!m_failed) {
+        LOGW("Recording stopped before any video was written");
+    }
+}
+} // namespace codec
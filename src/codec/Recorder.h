@@ -0,0 +1,117 @@
+//
+// Created by neapu on 2025/12/24.
+//
+
+#pragma once
+#include "Packet.h"
+#include "VideoDecoder.h"
+#include "AudioDecoder.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+
+struct AVFormatContext;
+struct AVStream;
+
+namespace codec {
+// 录制：把收到的压缩数据包直接封装到 MP4/Matroska，不解码、不编码。
+// 数据包以引用的方式进入有界队列，在独立线程中写出；MP4 使用分片格式，进程异常退出时文件仍可播放。
+class Recorder {
+public:
+    enum class Format {
+        mp4,
+        mkv,
+    };
+    struct CreateParam {
+        std::string path;
+        Format format{Format::mp4};
+        // 为 false 时只录制视频，不等待音频流
+        bool audio{true};
+        // 队列中最多缓存的数据包数，写出跟不上时丢弃到下一个关键帧
+        int maxQueuedPackets{256};
+    };
+    struct Stats {
+        uint64_t videoPackets{0};
+        uint64_t audioPackets{0};
+        uint64_t dropped{0};
+        uint64_t bytes{0};
+    };
+
+    // 打开输出文件失败时抛出异常
+    explicit Recorder(const CreateParam& param);
+    ~Recorder();
+
+    // 收到流的元数据时调用，视频流和音频流都确定后才写文件头
+    void setVideoStream(VideoDecoder::CodecType codecType, int width, int height);
+    void setAudioStream(AudioDecoder::CodecType codecType);
+    // 设备没有音频时调用，只录制视频
+    void disableAudio();
+
+    // 线程安全，packet 为引用，不复制数据
+    void pushVideo(PacketPtr&& packet);
+    void pushAudio(PacketPtr&& packet);
+
+    // 写完队列中的数据和文件尾，之后的数据包被丢弃，析构时自动调用
+    void stop();
+
+    Stats stats() const;
+
+private:
+    enum class AudioState {
+        Pending,
+        Enabled,
+        Disabled,
+    };
+    struct Entry {
+        PacketPtr packet;
+        bool audio{false};
+    };
+
+    void push(PacketPtr&& packet, bool audio);
+    bool readyForHeader() const;
+    bool writeHeader();
+    void writePacket(Entry& entry);
+    void workerLoop();
+
+private:
+    Format m_format{Format::mp4};
+    int m_maxQueuedPackets{256};
+    AVFormatContext* m_formatCtx{nullptr};
+    AVStream* m_videoStream{nullptr};
+    AVStream* m_audioStream{nullptr};
+
+    // 以下由 m_mutex 保护
+    bool m_videoKnown{false};
+    VideoDecoder::CodecType m_videoCodec{VideoDecoder::CodecType::h264};
+    int m_width{0};
+    int m_height{0};
+    AudioState m_audioState{AudioState::Pending};
+    AudioDecoder::CodecType m_audioCodec{AudioDecoder::CodecType::opus};
+    // 队列满后丢弃视频包，直到下一个关键帧
+    bool m_waitKeyFrame{false};
+    Stats m_stats;
+
+    // 以下只在写出线程访问
+    std::vector<uint8_t> m_videoExtradata;
+    std::vector<uint8_t> m_audioExtradata;
+    bool m_audioConfigReceived{false};
+    // 写文件头前到达的媒体包
+    std::deque<Entry> m_pending;
+    bool m_headerWritten{false};
+    bool m_failed{false};
+    // 时间戳以第一个视频关键帧为零点
+    int64_t m_ptsOrigin{-1};
+    // 文件头之后的参数变化（如旋转后的 SPS/PPS），合并到下一个关键帧前
+    std::vector<uint8_t> m_pendingVideoConfig;
+
+    std::thread m_worker;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Entry> m_queue;
+    std::atomic<bool> m_running{false};
+};
+} // namespace codec
@@ -0,0 +1,303 @@
+//
+// Created by neapu on 2025/12/27.
+//
+
+#ifdef __linux__
+#include "SharedFrameExporter.h"
+#include "MediaClock.h"
+#include "Helper.h"
+#include "logger.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/imgutils.h>
+}
+
+namespace codec {
+constexpr uint64_t PAGE_SIZE_BYTES = 4096;
+constexpr int MIN_SLOT_COUNT = 2;
+// 没有新帧时工作线程的等待间隔，退订后立即唤醒
+constexpr int64_t WAIT_TIMEOUT_US = 1000000;
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+// 写入端只做唤醒，不做等待；没有等待者时开销只是一次系统调用
+static void wakeReaders(uint32_t* word)
+{
+    std::atomic_ref(*word).fetch_add(1, std::memory_order_release);
+    syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+SharedFrameExporter::SharedFrameExporter(FrameBus& bus, const std::string& name, int slotCount)
+    : m_name(name)
+    , m_slotCount(std::max(MIN_SLOT_COUNT, slotCount))
+    , m_bus(bus)
+{
+    m_slotFrame = av_frame_alloc();
+    if (!m_slotFrame) {
+        throw std::runtime_error("Failed to allocate frame for shared memory export");
+    }
+    m_subscription = m_bus.subscribe("SharedFrameExporter", FrameBus::Policy::LatestOnly);
+    m_worker = std::thread(&SharedFrameExporter::workerLoop, this);
+}
+SharedFrameExporter::~SharedFrameExporter()
+{
+    FUNC_TRACE;
+    m_bus.unsubscribe(m_subscription);
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+    av_frame_free(&m_slotFrame);
+}
+SharedFrameExporter::Stats SharedFrameExporter::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.skipped = m_subscription->stats().dropped;
+    return stats;
+}
+std::string SharedFrameExporter::nameForSerial(const std::string& serial)
+{
+    // 网络设备的序列号形如 192.168.1.2:5555，只保留安全字符
+    std::string name = "/gamescrcpy-";
+    for (const char c : serial) {
+        const bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '.' || c == '-';
+        name += safe ? c : '_';
+    }
+    return name;
+}
+bool SharedFrameExporter::computeLayout(int rawPixelFormat, int width, int height, PlaneLayout& layout)
+{
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    const auto w = static_cast<uint32_t>(width);
+    const auto h = static_cast<uint32_t>(height);
+    const uint32_t chromaWidth = (w + 1) / 2;
+    const uint32_t chromaHeight = (h + 1) / 2;
+    switch (static_cast<AVPixelFormat>(rawPixelFormat)) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+        layout.format = shm::PixelFormat::YUV420P;
+        layout.planeCount = 3;
+        layout.rowBytes[0] = w;
+        layout.rowBytes[1] = layout.rowBytes[2] = chromaWidth;
+        layout.rows[0] = h;
+        layout.rows[1] = layout.rows[2] = chromaHeight;
+        break;
+    case AV_PIX_FMT_NV12:
+        layout.format = shm::PixelFormat::NV12;
+        layout.planeCount = 2;
+        layout.rowBytes[0] = w;
+        layout.rowBytes[1] = chromaWidth * 2;
+        layout.rows[0] = h;
+        layout.rows[1] = chromaHeight;
+        break;
+    case AV_PIX_FMT_P010LE:
+        layout.format = shm::PixelFormat::P010;
+        layout.planeCount = 2;
+        layout.rowBytes[0] = w * 2;
+        layout.rowBytes[1] = chromaWidth * 4;
+        layout.rows[0] = h;
+        layout.rows[1] = chromaHeight;
+        break;
+    default:
+        return false;
+    }
+    uint64_t offset = shm::SLOT_DATA_OFFSET;
+    for (uint32_t i = 0; i < layout.planeCount; ++i) {
+        offset = alignUp(offset, shm::PLANE_ALIGNMENT);
+        layout.offsets[i] = static_cast<uint32_t>(offset);
+        layout.strides[i] = static_cast<uint32_t>(alignUp(layout.rowBytes[i], shm::PLANE_ALIGNMENT));
+        offset += static_cast<uint64_t>(layout.strides[i]) * layout.rows[i];
+    }
+    layout.slotBytes = offset;
+    return true;
+}
+bool SharedFrameExporter::ensureSegment(uint64_t slotBytes, uint64_t reserveBytes)
+{
+    if (m_mapping && slotBytes <= m_slotSize) {
+        return true;
+    }
+    if (m_mapping) {
+        releaseSegment();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.reallocations;
+    }
+
+    const uint64_t slotSize = alignUp(std::max(slotBytes, reserveBytes), PAGE_SIZE_BYTES);
+    const uint64_t size = shm::HEADER_SIZE + slotSize * static_cast<uint64_t>(m_slotCount);
+    // 上次异常退出时可能留下同名的段
+    shm_unlink(m_name.c_str());
+    m_fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+    if (m_fd < 0) {
+        LOGE("Failed to create shared memory {}: {}", m_name, std::strerror(errno));
+        return false;
+    }
+    void* mapping = MAP_FAILED;
+    if (ftruncate(m_fd, static_cast<off_t>(size)) == 0) {
+        mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    }
+    if (mapping == MAP_FAILED) {
+        LOGE("Failed to map {} bytes of shared memory {}: {}", size, m_name, std::strerror(errno));
+        close(m_fd);
+        m_fd = -1;
+        shm_unlink(m_name.c_str());
+        return false;
+    }
+    m_mapping = static_cast<uint8_t*>(mapping);
+    m_mappingSize = size;
+    m_slotSize = slotSize;
+
+    // ftruncate 后内容全为 0，魔数最后写入，读者看到魔数时其余字段已就绪
+    auto* header = reinterpret_cast<shm::Header*>(m_mapping);
+    header->version = shm::VERSION;
+    header->headerSize = shm::HEADER_SIZE;
+    header->slotCount = static_cast<uint32_t>(m_slotCount);
+    header->slotSize = slotSize;
+    header->segmentSize = size;
+    header->producerPid = static_cast<uint32_t>(getpid());
+    std::atomic_ref(header->magic).store(shm::MAGIC, std::memory_order_release);
+    LOGI("Exporting frames to shared memory {}: {} slots of {} bytes", m_name, m_slotCount, slotSize);
+    return true;
+}
+void SharedFrameExporter::releaseSegment()
+{
+    if (!m_mapping) {
+        return;
+    }
+    auto* header = reinterpret_cast<shm::Header*>(m_mapping);
+    std::atomic_ref(header->stale).store(1, std::memory_order_release);
+    wakeReaders(&header->notify);
+    // 已映射的读者不受影响，可以读完手头的帧
+    munmap(m_mapping, m_mappingSize);
+    close(m_fd);
+    shm_unlink(m_name.c_str());
+    m_mapping = nullptr;
+    m_mappingSize = 0;
+    m_slotSize = 0;
+    m_fd = -1;
+}
+bool SharedFrameExporter::write(const AVFrame* frame)
+{
+    const bool hwFrame = frame->hw_frames_ctx != nullptr;
+    const int swFormat = hwFrame
+        ? reinterpret_cast<const AVHWFramesContext*>(frame->hw_frames_ctx->data)->sw_format
+        : frame->format;
+    PlaneLayout layout;
+    if (!computeLayout(swFormat, frame->width, frame->height, layout)) {
+        if (!m_formatWarned) {
+            LOGW("Pixel format {} cannot be exported to shared memory", swFormat);
+            m_formatWarned = true;
+        }
+        return false;
+    }
+    // 按旋转后的尺寸预留，横竖屏切换时不用重新创建
+    PlaneLayout rotated;
+    computeLayout(swFormat, frame->height, frame->width, rotated);
+    if (!ensureSegment(layout.slotBytes, rotated.slotBytes)) {
+        return false;
+    }
+
+    auto* header = reinterpret_cast<shm::Header*>(m_mapping);
+    const uint64_t sequence = m_sequence + 1;
+    uint8_t* slot = m_mapping + shm::HEADER_SIZE + (sequence - 1) % static_cast<uint64_t>(m_slotCount) * m_slotSize;
+    auto* slotHeader = reinterpret_cast<shm::SlotHeader*>(slot);
+    // 先把序号清零再写数据，正在读这个槽位的读者会在校验时发现
+    std::atomic_ref(slotHeader->sequence).store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (hwFrame) {
+        // 下载的目标直接指向槽位，不经过中间缓冲
+        m_slotFrame->format = swFormat;
+        m_slotFrame->width = frame->width;
+        m_slotFrame->height = frame->height;
+        for (uint32_t i = 0; i < layout.planeCount; ++i) {
+            m_slotFrame->data[i] = slot + layout.offsets[i];
+            m_slotFrame->linesize[i] = static_cast<int>(layout.strides[i]);
+        }
+        m_slotFrame->buf[0] = av_buffer_create(slot, static_cast<size_t>(m_slotSize),
+                                               [](void*, uint8_t*) {}, nullptr, 0);
+        if (!m_slotFrame->buf[0]) {
+            av_frame_unref(m_slotFrame);
+            return false;
+        }
+        const int ret = av_hwframe_transfer_data(m_slotFrame, frame, 0);
+        av_frame_unref(m_slotFrame);
+        if (ret < 0) {
+            LOGE("Failed to download frame to shared memory: {}", Helper::getFFmpegErrorString(ret));
+            return false;
+        }
+    } else {
+        for (uint32_t i = 0; i < layout.planeCount; ++i) {
+            av_image_copy_plane(slot + layout.offsets[i], static_cast<int>(layout.strides[i]),
+                                frame->data[i], frame->linesize[i],
+                                static_cast<int>(layout.rowBytes[i]), static_cast<int>(layout.rows[i]));
+        }
+    }
+
+    slotHeader->pts = frame->pts != AV_NOPTS_VALUE ? frame->pts
+        : frame->best_effort_timestamp != AV_NOPTS_VALUE ? frame->best_effort_timestamp : -1;
+    slotHeader->format = static_cast<uint32_t>(layout.format);
+    slotHeader->width = static_cast<uint32_t>(frame->width);
+    slotHeader->height = static_cast<uint32_t>(frame->height);
+    slotHeader->colorSpace = frame->colorspace == AVCOL_SPC_BT709 ? 1 : 0;
+    slotHeader->colorRange = frame->color_range == AVCOL_RANGE_JPEG || swFormat == AV_PIX_FMT_YUVJ420P ? 1 : 0;
+    slotHeader->planeCount = layout.planeCount;
+    for (uint32_t i = 0; i < shm::MAX_PLANES; ++i) {
+        slotHeader->offsets[i] = layout.offsets[i];
+        slotHeader->strides[i] = layout.strides[i];
+    }
+    slotHeader->dataSize = static_cast<uint32_t>(layout.slotBytes - shm::SLOT_DATA_OFFSET);
+    slotHeader->exportTimeUs = MediaClock::nowUs();
+
+    std::atomic_ref(slotHeader->sequence).store(sequence, std::memory_order_release);
+    std::atomic_ref(header->latestSequence).store(sequence, std::memory_order_release);
+    wakeReaders(&header->notify);
+    m_sequence = sequence;
+    return true;
+}
+void SharedFrameExporter::workerLoop()
+{
+    for (;;) {
+        FramePtr frame = m_subscription->wait(WAIT_TIMEOUT_US);
+        if (!frame) {
+            if (m_subscription->closed()) {
+                break;
+            }
+            continue;
+        }
+
+        const int64_t startUs = MediaClock::nowUs();
+        const bool ok = write(frame->avFrame());
+        // 尽早归还硬件表面
+        frame.reset();
+        const int64_t elapsedUs = MediaClock::nowUs() - startUs;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (ok) {
+                ++m_stats.exported;
+            } else {
+                ++m_stats.failed;
+            }
+            m_stats.totalWriteUs += elapsedUs;
+            m_stats.maxWriteUs = std::max(m_stats.maxWriteUs, elapsedUs);
+        }
+    }
+    releaseSegment();
+}
+} // namespace codec
+#endif
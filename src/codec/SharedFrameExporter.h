@@ -0,0 +1,83 @@
+//
+// Created by neapu on 2025/12/27.
+//
+
+#pragma once
+#ifdef __linux__
+#include "Frame.h"
+#include "FrameBus.h"
+#include "SharedFrameLayout.h"
+#include <string>
+#include <thread>
+#include <mutex>
+
+struct AVFrame;
+
+namespace codec {
+// 把解码出的帧导出到 POSIX 共享内存中的槽位环（布局见 SharedFrameLayout.h），供本机其他进程只读映射。
+// 以 LatestOnly 订阅会话的帧总线，工作线程跟不上时只保留最新的一帧；
+// 工作线程把软件帧直接复制进槽位，硬件帧直接下载到槽位中，只传输一次。写入端从不等待读者。
+class SharedFrameExporter {
+public:
+    struct Stats {
+        uint64_t exported{0};
+        // 工作线程还没处理就被新帧替换，即订阅的丢弃计数
+        uint64_t skipped{0};
+        uint64_t failed{0};
+        // 画面变大后重新创建共享内存的次数
+        uint64_t reallocations{0};
+        int64_t totalWriteUs{0};
+        int64_t maxWriteUs{0};
+    };
+
+    // name 为共享内存名，以 / 开头且不含其他 /。共享内存在第一帧到达时按其尺寸创建
+    SharedFrameExporter(FrameBus& bus, const std::string& name, int slotCount = 3);
+    ~SharedFrameExporter();
+
+    const std::string& name() const { return m_name; }
+    Stats stats() const;
+
+    // 由设备序列号生成共享内存名
+    static std::string nameForSerial(const std::string& serial);
+
+private:
+    struct PlaneLayout {
+        shm::PixelFormat format{shm::PixelFormat::None};
+        uint32_t planeCount{0};
+        uint32_t offsets[shm::MAX_PLANES]{};
+        uint32_t strides[shm::MAX_PLANES]{};
+        // 每个平面一行的有效字节数和行数
+        uint32_t rowBytes[shm::MAX_PLANES]{};
+        uint32_t rows[shm::MAX_PLANES]{};
+        // 相对槽位起点，包含 SlotHeader
+        uint64_t slotBytes{0};
+    };
+    static bool computeLayout(int rawPixelFormat, int width, int height, PlaneLayout& layout);
+
+    // 以下只在工作线程调用
+    bool ensureSegment(uint64_t slotBytes, uint64_t reserveBytes);
+    void releaseSegment();
+    bool write(const AVFrame* frame);
+    void workerLoop();
+
+private:
+    std::string m_name;
+    int m_slotCount{3};
+
+    // 只由工作线程访问
+    int m_fd{-1};
+    uint8_t* m_mapping{nullptr};
+    uint64_t m_mappingSize{0};
+    uint64_t m_slotSize{0};
+    uint64_t m_sequence{0};
+    AVFrame* m_slotFrame{nullptr};
+    bool m_formatWarned{false};
+
+    FrameBus& m_bus;
+    FrameBus::SubscriptionPtr m_subscription;
+    std::thread m_worker;
+    mutable std::mutex m_mutex;
+    Stats m_stats;
+};
+} // namespace codec
+#endif
@@ -0,0 +1,81 @@
+//
+// Created by neapu on 2025/12/27.
+//
+
+#pragma once
+#include <cstdint>
+
+// 共享内存帧导出的内存布局，只依赖标准头文件，外部程序（自动化脚本、OBS 插件）可以直接包含。
+//
+// 段的开头是一页 Header，之后是 slotCount 个槽位，每个槽位 slotSize 字节：SlotHeader 加上从
+// SLOT_DATA_OFFSET 开始的平面数据。写入端按帧序号轮流覆盖槽位，不等待读者。
+//
+// 读取步骤（所有字段按小端、自然对齐访问）：
+//   1. seq = load_acquire(header.latestSequence)，为 0 表示还没有帧；槽位为 (seq - 1) % slotCount
+//   2. load_acquire(slot.sequence) 不等于 seq 说明已被覆盖，回到第 1 步
+//   3. 读取 SlotHeader 和平面数据
+//   4. acquire 栅栏后再读一次 slot.sequence，与第 2 步不同则丢弃本次读到的内容
+// 等待新帧时对 header.notify 做 FUTEX_WAIT（非 private，跨进程），写入端每写完一帧都会唤醒。
+// header.stale 非 0 时本段已作废（需要更大的槽位或会话结束），读者应解除映射后按名字重新打开，
+// 打开失败（ENOENT）时稍后重试。
+namespace codec::shm {
+constexpr uint32_t MAGIC = 0x52465347; // "GSFR"
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t MAX_PLANES = 3;
+constexpr uint32_t HEADER_SIZE = 4096;
+constexpr uint32_t SLOT_DATA_OFFSET = 128;
+// 平面起点和行跨度的对齐
+constexpr uint32_t PLANE_ALIGNMENT = 64;
+
+enum class PixelFormat : uint32_t {
+    None = 0,
+    // 三个平面：Y、U、V
+    YUV420P = 1,
+    // 两个平面：Y、交错的 UV
+    NV12 = 2,
+    // 同 NV12，每个样本 16 位，有效数据在高 10 位
+    P010 = 3,
+};
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t slotCount;
+    // 每个槽位占用的字节数，包含 SlotHeader，按页对齐
+    uint64_t slotSize;
+    uint64_t segmentSize;
+    // 最近写完的帧序号，从 1 开始
+    uint64_t latestSequence;
+    // 每写完一帧加 1，用作 futex
+    uint32_t notify;
+    uint32_t stale;
+    uint32_t producerPid;
+    uint32_t reserved;
+};
+
+struct SlotHeader {
+    // 帧序号，写入过程中为 0
+    uint64_t sequence;
+    // 设备端 PTS（微秒），未知时为 -1
+    int64_t pts;
+    // 写入完成时的 CLOCK_MONOTONIC 时间（微秒）
+    int64_t exportTimeUs;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    // 0 为 BT.601，1 为 BT.709
+    uint32_t colorSpace;
+    // 0 为有限范围，1 为完整范围
+    uint32_t colorRange;
+    uint32_t planeCount;
+    // 相对槽位起点的偏移
+    uint32_t offsets[MAX_PLANES];
+    uint32_t strides[MAX_PLANES];
+    uint32_t dataSize;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(Header) <= HEADER_SIZE);
+static_assert(sizeof(SlotHeader) <= SLOT_DATA_OFFSET);
+} // namespace codec::shm
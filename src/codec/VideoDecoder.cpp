@@ -13,8 +13,15 @@ extern "C" {
 #ifdef __linux__
 #include <libavutil/hwcontext_vaapi.h>
 #endif
+#include <map>
 
 namespace codec {
+// 硬件设备上下文和硬件像素格式在进程内缓存，避免每个会话重复探测和初始化设备
+static std::mutex s_hwCacheMutex;
+static AVBufferRef* s_hwDeviceCtx{nullptr};
+static bool s_hwDeviceCtxFailed{false};
+static std::map<int, int> s_hwPixelFormats;
+
 VideoDecoder::VideoDecoder(const CreateParam& param)
     : m_frameCallback(param.frameCallback)
     , m_swDecode(param.swDecode)
@@ -86,6 +93,9 @@ VideoDecoder::~VideoDecoder()
         sws_freeContext(m_swsCtx);
         m_swsCtx = nullptr;
     }
+    if (m_hwDeviceCtx) {
+        av_buffer_unref(&m_hwDeviceCtx);
+    }
 }
 void VideoDecoder::decode(PacketPtr&& packet)
 {
@@ -99,42 +109,71 @@ void VideoDecoder::decode(PacketPtr&& packet)
     m_cv.notify_one();
 }
 
-void VideoDecoder::initHwContext()
+AVBufferRef* VideoDecoder::sharedHwDeviceContext()
 {
-    FUNC_TRACE;
 #ifdef __linux__
-    auto deviceType = AV_HWDEVICE_TYPE_VAAPI;
+    constexpr auto deviceType = AV_HWDEVICE_TYPE_VAAPI;
+    std::lock_guard<std::mutex> lock(s_hwCacheMutex);
+    if (!s_hwDeviceCtx && !s_hwDeviceCtxFailed) {
+        int ret = av_hwdevice_ctx_create(&s_hwDeviceCtx, deviceType, nullptr, nullptr, 0);
+        if (ret < 0) {
+            LOGE("Failed to create HW device context: {}", Helper::getFFmpegErrorString(ret));
+            s_hwDeviceCtx = nullptr;
+            s_hwDeviceCtxFailed = true;
+            return nullptr;
+        }
+        LOGI("Created HW device context for video decoding, device type: {}", static_cast<int>(deviceType));
+    }
+    return s_hwDeviceCtx ? av_buffer_ref(s_hwDeviceCtx) : nullptr;
 #else
-    auto deviceType = AV_HWDEVICE_TYPE_NONE;
-    return;
+    return nullptr;
 #endif
+}
+
+int VideoDecoder::hwPixelFormat(int codecId)
+{
+#ifdef __linux__
+    constexpr auto deviceType = AV_HWDEVICE_TYPE_VAAPI;
+    std::lock_guard<std::mutex> lock(s_hwCacheMutex);
+    if (const auto it = s_hwPixelFormats.find(codecId); it != s_hwPixelFormats.end()) {
+        return it->second;
+    }
 
-    for (int i = 0; ; i++) {
-        const AVCodecHWConfig* config = avcodec_get_hw_config(m_codecCtx->codec, i);
+    int pixelFormat = AV_PIX_FMT_NONE;
+    const AVCodec* codec = avcodec_find_decoder(static_cast<AVCodecID>(codecId));
+    for (int i = 0; codec; i++) {
+        const AVCodecHWConfig* config = avcodec_get_hw_config(codec, i);
         if (!config) {
             LOGW("Decoder does not support the requested HW device type");
-            return;
+            break;
         }
         if (config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX && config->device_type == deviceType) {
-            m_hwPixelFormat = config->pix_fmt;
-            LOGI("Using HW pixel format {} for video decoding", static_cast<int>(m_hwPixelFormat));
+            pixelFormat = config->pix_fmt;
             break;
         }
     }
+    s_hwPixelFormats.emplace(codecId, pixelFormat);
+    return pixelFormat;
+#else
+    return AV_PIX_FMT_NONE;
+#endif
+}
+
+void VideoDecoder::initHwContext()
+{
+    FUNC_TRACE;
+    m_hwPixelFormat = hwPixelFormat(m_codecCtx->codec->id);
     if (m_hwPixelFormat == AV_PIX_FMT_NONE) {
         LOGW("No suitable HW pixel format found for codec {}", static_cast<int>(m_codecCtx->codec->id));
         return;
     }
+    LOGI("Using HW pixel format {} for video decoding", static_cast<int>(m_hwPixelFormat));
 
-    int ret = av_hwdevice_ctx_create(&m_hwDeviceCtx, deviceType, nullptr, nullptr, 0);
-    if (ret < 0) {
-        LOGE("Failed to create HW device context: {}", Helper::getFFmpegErrorString(ret));
-        m_hwDeviceCtx = nullptr;
+    m_hwDeviceCtx = sharedHwDeviceContext();
+    if (!m_hwDeviceCtx) {
         return;
     }
 
-    LOGI("Created HW device context for video decoding, device type: {}", static_cast<int>(deviceType));
-
     m_codecCtx->hw_device_ctx = av_buffer_ref(m_hwDeviceCtx);
     m_codecCtx->opaque = this;
     m_codecCtx->get_format = [](AVCodecContext* ctx, const AVPixelFormat* pix_fmts) -> AVPixelFormat {
@@ -36,6 +36,11 @@ public:
 
     void decode(PacketPtr&& packet);
 
+    // 进程内共享的硬件设备上下文，返回新的引用，调用方负责释放
+    static AVBufferRef* sharedHwDeviceContext();
+    // 查询解码器支持的硬件像素格式，结果按codecId缓存，不支持时返回AV_PIX_FMT_NONE
+    static int hwPixelFormat(int codecId);
+
 private:
     void initHwContext();
 
@@ -0,0 +1,548 @@
+//
+// Created by neapu on 2025/12/13.
+//
+
+#include "AdbClient.h"
+#include "AdbCommandRunner.h"
+#include <logger.h>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QProcess>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QPointer>
+#include <QtEndian>
+#include <functional>
+#include <utility>
+
+namespace device {
+constexpr quint16 DEFAULT_SERVER_PORT = 5037;
+constexpr qint64 SYNC_DATA_MAX = 64 * 1024;
+// push 时发送缓冲低于该值才继续读文件，避免整个文件进入套接字缓冲
+constexpr qint64 SYNC_SEND_BUFFER = 4 * SYNC_DATA_MAX;
+constexpr int SYNC_FILE_MODE = 0100644;
+// readExact 的特殊长度，读取直到对端关闭连接
+constexpr qint64 READ_TO_END = -1;
+
+// shell v2 协议的包类型
+constexpr char SHELL_ID_STDOUT = 1;
+constexpr char SHELL_ID_STDERR = 2;
+constexpr char SHELL_ID_EXIT = 3;
+
+// 预先发起连接的空闲套接字，下一个请求无需再等待建立连接。只在执行线程访问，父对象为执行器
+static QPointer<QTcpSocket> s_spareSocket;
+
+// 连接已失效时返回 nullptr。adb server 不会主动发送数据，收到数据或连接断开都说明套接字不可用
+static QTcpSocket* takeSpareSocket()
+{
+    QTcpSocket* socket = s_spareSocket;
+    s_spareSocket = nullptr;
+    if (!socket) {
+        return nullptr;
+    }
+    socket->disconnect(AdbCommandRunner::instance());
+    const auto state = socket->state();
+    const bool alive = state == QAbstractSocket::ConnectedState || state == QAbstractSocket::ConnectingState
+        || state == QAbstractSocket::HostLookupState;
+    if (!alive || socket->bytesAvailable() > 0) {
+        socket->deleteLater();
+        return nullptr;
+    }
+    return socket;
+}
+
+static void prepareSpareSocket()
+{
+    if (s_spareSocket) {
+        return;
+    }
+    auto* runner = AdbCommandRunner::instance();
+    auto* socket = new QTcpSocket(runner);
+    // 空闲期间出错、断开或收到数据都立即丢弃，下次请求重新连接
+    const auto invalidate = [socket]() {
+        if (s_spareSocket == socket) {
+            s_spareSocket = nullptr;
+        }
+        socket->disconnect(AdbCommandRunner::instance());
+        socket->deleteLater();
+    };
+    QObject::connect(socket, &QTcpSocket::errorOccurred, runner, invalidate);
+    QObject::connect(socket, &QTcpSocket::disconnected, runner, invalidate);
+    QObject::connect(socket, &QTcpSocket::readyRead, runner, invalidate);
+    socket->connectToHost(QHostAddress::LocalHost, AdbClient::serverPort());
+    s_spareSocket = socket;
+}
+
+static QByteArray encodeLe32(quint32 value)
+{
+    QByteArray data(4, Qt::Uninitialized);
+    qToLittleEndian<quint32>(value, data.data());
+    return data;
+}
+
+// 与 adb server 的一次会话。adb server 在服务执行完毕后关闭连接，因此连接不可复用，
+// 复用的是预先发起连接的空闲套接字。协议的每一步以回调串联，数据到达时由 readyRead 推进，不阻塞执行线程。
+class AdbConnectionJob : public AdbJob {
+public:
+    void start(Done done) override
+    {
+        m_done = std::move(done);
+        connectToServer();
+    }
+
+    void abort() override
+    {
+        m_finished = true;
+        if (m_socket) {
+            m_socket->disconnect(this);
+            m_socket->abort();
+        }
+        if (m_startServerProcess) {
+            m_startServerProcess->disconnect(this);
+            m_startServerProcess->kill();
+        }
+    }
+
+protected:
+    // 连接建立后调用，重新连接后会再次调用
+    virtual void onConnected() = 0;
+
+    // 切换到指定设备的传输通道，之后的请求都发往该设备
+    void openTransport(const QString& serial, std::function<void()> next)
+    {
+        request(serial.isEmpty() ? QByteArray("host:transport-any") : "host:transport:" + serial.toUtf8(), std::move(next));
+    }
+
+    // onFail 为空时服务端返回的 FAIL 直接作为错误结束
+    void request(const QByteArray& service, std::function<void()> onOkay, std::function<void(const QString&)> onFail = {})
+    {
+        write(QByteArray::number(service.size(), 16).rightJustified(4, '0') + service);
+        readStatus(std::move(onOkay), std::move(onFail));
+    }
+
+    void readStatus(std::function<void()> onOkay, std::function<void(const QString&)> onFail = {})
+    {
+        readExact(4, [this, onOkay = std::move(onOkay), onFail = std::move(onFail)](const QByteArray& status) {
+            if (status == "OKAY") {
+                onOkay();
+                return;
+            }
+            if (status != "FAIL") {
+                fail(QString("Unexpected adb status: %1").arg(QString::fromLatin1(status.toHex())));
+                return;
+            }
+            readLengthPrefixed([this, onFail](const QByteArray& message) {
+                if (onFail) {
+                    onFail(QString::fromUtf8(message));
+                } else {
+                    fail(QString::fromUtf8(message));
+                }
+            });
+        });
+    }
+
+    void readLengthPrefixed(std::function<void(const QByteArray&)> handler)
+    {
+        readExact(4, [this, handler = std::move(handler)](const QByteArray& header) {
+            bool ok = false;
+            const int length = header.toInt(&ok, 16);
+            if (!ok) {
+                fail(QString("Invalid adb response length"));
+                return;
+            }
+            readExact(length, handler);
+        });
+    }
+
+    // size 为 READ_TO_END 时读取直到对端关闭连接。同一时刻只有一个读取在等待
+    void readExact(qint64 size, std::function<void(const QByteArray&)> handler)
+    {
+        m_expected = size;
+        m_handler = std::move(handler);
+        if (!m_dispatching) {
+            dispatch();
+        }
+    }
+
+    void write(const QByteArray& data)
+    {
+        if (m_socket->write(data) != data.size()) {
+            fail(QString("Failed to write to adb server: %1").arg(m_socket->errorString()));
+        }
+    }
+
+    void finish(const QString& output)
+    {
+        if (m_finished) return;
+        m_finished = true;
+        m_handler = nullptr;
+        m_socket->disconnect(this);
+        m_socket->disconnectFromHost();
+        m_done(std::nullopt, output);
+    }
+
+    void fail(const QString& message)
+    {
+        if (m_finished) return;
+        m_finished = true;
+        m_handler = nullptr;
+        if (m_socket) {
+            m_socket->disconnect(this);
+            m_socket->abort();
+        }
+        m_done(AdbException(message), {});
+    }
+
+    // 关闭当前连接并建立新连接，之后再次调用 onConnected
+    void reconnect(bool useSpare = true)
+    {
+        m_socket->disconnect(this);
+        m_socket->abort();
+        m_socket->deleteLater();
+        m_socket = nullptr;
+        connectToServer(useSpare);
+    }
+
+    QTcpSocket* socket() const { return m_socket; }
+    bool finished() const { return m_finished; }
+
+private:
+    void connectToServer(bool useSpare = true)
+    {
+        m_buffer.clear();
+        m_expected = 0;
+        m_handler = nullptr;
+        m_received = false;
+        m_socket = useSpare ? takeSpareSocket() : nullptr;
+        m_usingSpare = m_socket != nullptr;
+        if (m_usingSpare) {
+            m_socket->setParent(this);
+        } else {
+            m_socket = new QTcpSocket(this);
+        }
+        connect(m_socket, &QTcpSocket::connected, this, [this]() { onConnected(); });
+        connect(m_socket, &QTcpSocket::readyRead, this, [this]() {
+            m_buffer += m_socket->readAll();
+            m_received = true;
+            dispatch();
+        });
+        connect(m_socket, &QTcpSocket::disconnected, this, [this]() {
+            m_buffer += m_socket->readAll();
+            if (m_handler && m_expected == READ_TO_END) {
+                const auto handler = std::move(m_handler);
+                m_handler = nullptr;
+                handler(std::exchange(m_buffer, {}));
+                return;
+            }
+            if (retryStaleSpare()) {
+                return;
+            }
+            dispatch();
+            fail(QString("Connection to adb server closed"));
+        });
+        connect(m_socket, &QTcpSocket::errorOccurred, this, [this](QAbstractSocket::SocketError error) {
+            if (error == QAbstractSocket::RemoteHostClosedError) {
+                // 由 disconnected 处理
+                return;
+            }
+            if (retryStaleSpare()) {
+                return;
+            }
+            if (error == QAbstractSocket::ConnectionRefusedError && !m_serverStarted) {
+                startServer();
+                return;
+            }
+            fail(QString("Failed to connect to adb server: %1").arg(m_socket->errorString()));
+        });
+        // 下一个请求的空闲连接与本次请求同时建立
+        prepareSpareSocket();
+        if (!m_usingSpare) {
+            m_socket->connectToHost(QHostAddress::LocalHost, AdbClient::serverPort());
+        } else if (m_socket->state() == QAbstractSocket::ConnectedState) {
+            onConnected();
+        }
+    }
+
+    // 空闲连接可能在检查之后才失效（例如 adb server 重启），没有收到任何数据就出错时换新连接重试一次
+    bool retryStaleSpare()
+    {
+        if (!m_usingSpare || m_received || m_finished) {
+            return false;
+        }
+        LOGW("Spare adb server connection is stale, reconnecting");
+        reconnect(false);
+        return true;
+    }
+
+    // adb server 未运行时通过 adb start-server 拉起，之后重新连接一次
+    void startServer()
+    {
+        m_serverStarted = true;
+        LOGI("adb server is not running, starting it");
+        m_startServerProcess = new QProcess(this);
+        connect(m_startServerProcess, &QProcess::finished, this, [this](int exitCode, QProcess::ExitStatus exitStatus) {
+            if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+                fail(QString("Failed to start adb server: %1")
+                         .arg(QString::fromUtf8(m_startServerProcess->readAllStandardError()).trimmed()));
+                return;
+            }
+            reconnect(false);
+        });
+        connect(m_startServerProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+            if (error == QProcess::FailedToStart) {
+                fail(QString("Failed to start adb: %1").arg(m_startServerProcess->errorString()));
+            }
+        });
+        m_startServerProcess->start(AdbHelper::adbPath(), {"start-server"});
+    }
+
+    // 缓冲中的数据满足当前读取时交给处理函数，处理函数可以发起下一次读取
+    void dispatch()
+    {
+        m_dispatching = true;
+        while (m_handler && !m_finished && m_expected != READ_TO_END && m_buffer.size() >= m_expected) {
+            const QByteArray data = m_buffer.left(m_expected);
+            m_buffer.remove(0, m_expected);
+            const auto handler = std::move(m_handler);
+            m_handler = nullptr;
+            handler(data);
+        }
+        m_dispatching = false;
+    }
+
+private:
+    Done m_done;
+    QTcpSocket* m_socket{nullptr};
+    QProcess* m_startServerProcess{nullptr};
+    QByteArray m_buffer;
+    qint64 m_expected{0};
+    std::function<void(const QByteArray&)> m_handler;
+    bool m_dispatching{false};
+    // 当前连接来自空闲套接字
+    bool m_usingSpare{false};
+    // 当前连接已收到数据
+    bool m_received{false};
+    bool m_serverStarted{false};
+    bool m_finished{false};
+};
+
+class HostCommandJob : public AdbConnectionJob {
+public:
+    explicit HostCommandJob(const QString& service)
+        : m_service(service.toUtf8())
+    {
+    }
+
+protected:
+    void onConnected() override
+    {
+        request(m_service, [this]() {
+            readLengthPrefixed([this](const QByteArray& data) { finish(QString::fromUtf8(data).trimmed()); });
+        });
+    }
+
+private:
+    QByteArray m_service;
+};
+
+class ShellJob : public AdbConnectionJob {
+public:
+    ShellJob(const QString& serial, const QString& command)
+        : m_serial(serial)
+        , m_command(command.toUtf8())
+    {
+    }
+
+protected:
+    void onConnected() override
+    {
+        openTransport(m_serial, [this]() {
+            if (m_legacy) {
+                request("shell:" + m_command, [this]() {
+                    readExact(READ_TO_END, [this](const QByteArray& data) { finish(QString::fromUtf8(data).trimmed()); });
+                });
+                return;
+            }
+            request("shell,v2,raw:" + m_command, [this]() { readPacket(); }, [this](const QString&) {
+                // 旧设备不支持 shell v2，无法取得退出码
+                m_legacy = true;
+                reconnect();
+            });
+        });
+    }
+
+private:
+    void readPacket()
+    {
+        readExact(5, [this](const QByteArray& header) {
+            const char id = header[0];
+            const quint32 length = qFromLittleEndian<quint32>(header.constData() + 1);
+            readExact(length, [this, id](const QByteArray& payload) {
+                switch (id) {
+                case SHELL_ID_STDOUT: m_out += payload; break;
+                case SHELL_ID_STDERR: m_err += payload; break;
+                case SHELL_ID_EXIT: {
+                    const int exitCode = payload.isEmpty() ? 0 : static_cast<quint8>(payload[0]);
+                    if (exitCode != 0) {
+                        fail(QString::fromUtf8(m_err.isEmpty() ? m_out : m_err).trimmed());
+                    } else {
+                        finish(QString::fromUtf8(m_out).trimmed());
+                    }
+                    return;
+                }
+                default: break;
+                }
+                readPacket();
+            });
+        });
+    }
+
+private:
+    QString m_serial;
+    QByteArray m_command;
+    bool m_legacy{false};
+    QByteArray m_out;
+    QByteArray m_err;
+};
+
+class PushJob : public AdbConnectionJob {
+public:
+    PushJob(const QString& serial, const QString& localPath, const QString& remotePath)
+        : m_serial(serial)
+        , m_localPath(localPath)
+        , m_remotePath(remotePath)
+    {
+    }
+
+protected:
+    void onConnected() override
+    {
+        m_file = new QFile(m_localPath, this);
+        if (!m_file->open(QIODevice::ReadOnly)) {
+            fail(QString("Failed to open %1: %2").arg(m_localPath, m_file->errorString()));
+            return;
+        }
+        openTransport(m_serial, [this]() {
+            request("sync:", [this]() {
+                const QByteArray target = m_remotePath.toUtf8() + "," + QByteArray::number(SYNC_FILE_MODE);
+                write("SEND" + encodeLe32(target.size()) + target);
+                connect(socket(), &QTcpSocket::bytesWritten, this, [this]() { sendData(); });
+                sendData();
+            });
+        });
+    }
+
+private:
+    void sendData()
+    {
+        while (!finished() && !m_sent && socket()->bytesToWrite() < SYNC_SEND_BUFFER) {
+            if (m_file->atEnd()) {
+                m_sent = true;
+                const auto mtime = static_cast<quint32>(QFileInfo(m_localPath).lastModified().toSecsSinceEpoch());
+                write("DONE" + encodeLe32(mtime));
+                readResponse();
+                return;
+            }
+            const QByteArray chunk = m_file->read(SYNC_DATA_MAX);
+            if (chunk.isEmpty()) {
+                fail(QString("Failed to read %1: %2").arg(m_localPath, m_file->errorString()));
+                return;
+            }
+            write("DATA" + encodeLe32(chunk.size()) + chunk);
+        }
+    }
+
+    void readResponse()
+    {
+        readExact(8, [this](const QByteArray& response) {
+            const quint32 length = qFromLittleEndian<quint32>(response.constData() + 4);
+            if (response.startsWith("FAIL")) {
+                readExact(length, [this](const QByteArray& message) { fail(QString::fromUtf8(message)); });
+                return;
+            }
+            if (!response.startsWith("OKAY")) {
+                fail(QString("Unexpected sync response"));
+                return;
+            }
+            write("QUIT" + encodeLe32(0));
+            finish(QString("%1: 1 file pushed").arg(m_localPath));
+        });
+    }
+
+private:
+    QString m_serial;
+    QString m_localPath;
+    QString m_remotePath;
+    QFile* m_file{nullptr};
+    // 文件已全部发送，等待结果
+    bool m_sent{false};
+};
+
+// reverse 服务先以 OKAY 表示服务已接受，再以第二个状态表示执行结果
+class ReverseJob : public AdbConnectionJob {
+public:
+    ReverseJob(const QString& serial, const QByteArray& service)
+        : m_serial(serial)
+        , m_service(service)
+    {
+    }
+
+protected:
+    void onConnected() override
+    {
+        openTransport(m_serial, [this]() {
+            request(m_service, [this]() {
+                readStatus([this]() { finish(QString()); });
+            });
+        });
+    }
+
+private:
+    QString m_serial;
+    QByteArray m_service;
+};
+
+AdbClient* AdbClient::instance()
+{
+    static AdbClient instance;
+    return &instance;
+}
+
+auto AdbClient::hostCommand(const QString& service, int timeoutMs) -> QFuture<QString>
+{
+    return AdbCommandRunner::instance()->run(QString(), new HostCommandJob(service), timeoutMs);
+}
+
+auto AdbClient::shell(const QString& serial, const QString& command, int timeoutMs) -> QFuture<QString>
+{
+    return AdbCommandRunner::instance()->run(serial, new ShellJob(serial, command), timeoutMs);
+}
+
+auto AdbClient::push(const QString& serial, const QString& localPath, const QString& remotePath, int timeoutMs)
+    -> QFuture<QString>
+{
+    return AdbCommandRunner::instance()->run(serial, new PushJob(serial, localPath, remotePath), timeoutMs);
+}
+
+auto AdbClient::reverse(const QString& serial, const QString& remote, const QString& local, int timeoutMs)
+    -> QFuture<QString>
+{
+    return AdbCommandRunner::instance()->run(
+        serial, new ReverseJob(serial, "reverse:forward:" + remote.toUtf8() + ";" + local.toUtf8()), timeoutMs);
+}
+
+auto AdbClient::removeReverse(const QString& serial, const QString& remote, int timeoutMs) -> QFuture<QString>
+{
+    return AdbCommandRunner::instance()->run(serial, new ReverseJob(serial, "reverse:killforward:" + remote.toUtf8()),
+                                             timeoutMs);
+}
+
+quint16 AdbClient::serverPort()
+{
+    bool ok = false;
+    const int port = qEnvironmentVariableIntValue("ANDROID_ADB_SERVER_PORT", &ok);
+    return ok && port > 0 && port < 65536 ? static_cast<quint16>(port) : DEFAULT_SERVER_PORT;
+}
+
+} // namespace device
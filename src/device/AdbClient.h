@@ -0,0 +1,38 @@
+//
+// Created by neapu on 2025/12/13.
+//
+
+#pragma once
+#include "AdbHelper.h"
+#include <QFuture>
+#include <QString>
+
+namespace device {
+
+// adb server 的 smart socket 协议客户端，直接连接 localhost:5037，不再为每条命令启动 adb 进程。
+// 每个请求在独立的连接上执行，由 AdbCommandRunner 在其线程上以事件驱动，与 adb 进程共用同一设备的并发上限、
+// 超时和取消。
+class AdbClient {
+public:
+    static AdbClient* instance();
+
+    // host 服务，例如 "host:devices-l"、"host:version"
+    auto hostCommand(const QString& service, int timeoutMs = AdbHelper::DEFAULT_TIMEOUT_MS) -> QFuture<QString>;
+    // serial为空时使用唯一连接的设备
+    auto shell(const QString& serial, const QString& command, int timeoutMs = AdbHelper::DEFAULT_TIMEOUT_MS)
+        -> QFuture<QString>;
+    auto push(const QString& serial, const QString& localPath, const QString& remotePath,
+              int timeoutMs = AdbHelper::DEFAULT_TIMEOUT_MS) -> QFuture<QString>;
+    auto reverse(const QString& serial, const QString& remote, const QString& local,
+                 int timeoutMs = AdbHelper::DEFAULT_TIMEOUT_MS) -> QFuture<QString>;
+    auto removeReverse(const QString& serial, const QString& remote, int timeoutMs = AdbHelper::DEFAULT_TIMEOUT_MS)
+        -> QFuture<QString>;
+
+    static quint16 serverPort();
+
+private:
+    AdbClient() = default;
+    ~AdbClient() = default;
+};
+
+} // namespace device
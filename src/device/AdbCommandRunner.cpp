@@ -0,0 +1,220 @@
+//
+// Created by neapu on 2025/12/13.
+//
+
+#include "AdbCommandRunner.h"
+#include <logger.h>
+#include <QProcess>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <algorithm>
+
+namespace device {
+constexpr int MAX_RUNNING_PER_DEVICE = 2;
+constexpr int MAX_RUNNING_TOTAL = 32;
+constexpr qint64 QUEUE_DELAY_WARNING_MS = 1000;
+
+// 启动一个 adb 进程，以标准输出为结果
+class AdbProcessJob : public AdbJob {
+public:
+    explicit AdbProcessJob(const QStringList& arguments)
+        : m_arguments(arguments)
+    {
+    }
+
+    void start(Done done) override
+    {
+        m_process = new QProcess(this);
+        connect(m_process, &QProcess::finished, this, [this, done](int exitCode, QProcess::ExitStatus exitStatus) {
+            if (exitStatus == QProcess::CrashExit) {
+                done(AdbException(QString("Adb crashed")), {});
+                return;
+            }
+            if (exitCode != 0) {
+                QString error = QString::fromUtf8(m_process->readAllStandardError());
+                if (error.isEmpty()) error = QString::fromUtf8(m_process->readAllStandardOutput());
+                done(AdbException(error.trimmed()), {});
+                return;
+            }
+            done(std::nullopt, QString::fromUtf8(m_process->readAllStandardOutput()).trimmed());
+        });
+        connect(m_process, &QProcess::errorOccurred, this, [this, done](QProcess::ProcessError error) {
+            if (error == QProcess::FailedToStart) {
+                done(AdbException(QString("Failed to start adb: %1").arg(m_process->errorString())), {});
+            }
+        });
+        m_process->start(AdbHelper::adbPath(), m_arguments);
+    }
+
+    void abort() override
+    {
+        if (m_process) {
+            m_process->disconnect(this);
+            m_process->kill();
+        }
+    }
+
+private:
+    QStringList m_arguments;
+    QProcess* m_process{nullptr};
+};
+
+AdbCommandRunner::AdbCommandRunner()
+    : QObject(nullptr)
+{
+    m_thread.setObjectName("AdbCommandRunner");
+    moveToThread(&m_thread);
+    m_thread.start();
+}
+
+AdbCommandRunner::~AdbCommandRunner()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+AdbCommandRunner* AdbCommandRunner::instance()
+{
+    static AdbCommandRunner instance;
+    return &instance;
+}
+
+auto AdbCommandRunner::run(const QString& serial, const QStringList& arguments, int timeoutMs) -> QFuture<QString>
+{
+    QStringList args;
+    if (!serial.isEmpty()) {
+        args << "-s" << serial;
+    }
+    args << arguments;
+    return run(serial, new AdbProcessJob(args), timeoutMs);
+}
+
+auto AdbCommandRunner::run(const QString& serial, AdbJob* job, int timeoutMs) -> QFuture<QString>
+{
+    job->moveToThread(&m_thread);
+
+    Task task;
+    task.serial = serial;
+    task.job = job;
+    task.timeoutMs = timeoutMs;
+    task.promise = std::make_shared<QPromise<QString>>();
+    task.queuedTimer.start();
+    task.promise->start();
+    QFuture<QString> future = task.promise->future();
+
+    QMetaObject::invokeMethod(this, [this, task = std::move(task)]() mutable { enqueue(std::move(task)); }, Qt::QueuedConnection);
+    return future;
+}
+
+AdbCommandRunner::Stats AdbCommandRunner::stats() const
+{
+    QMutexLocker locker(&m_statsMutex);
+    return m_stats;
+}
+
+void AdbCommandRunner::enqueue(Task task)
+{
+    m_pending.push_back(std::move(task));
+    {
+        QMutexLocker locker(&m_statsMutex);
+        m_stats.maxPending = std::max<quint64>(m_stats.maxPending, m_pending.size());
+    }
+    schedule();
+}
+
+void AdbCommandRunner::schedule()
+{
+    for (auto it = m_pending.begin(); it != m_pending.end() && m_running < MAX_RUNNING_TOTAL;) {
+        if (it->promise->isCanceled()) {
+            it->promise->finish();
+            it->job->deleteLater();
+            QMutexLocker locker(&m_statsMutex);
+            m_stats.canceled++;
+            it = m_pending.erase(it);
+            continue;
+        }
+        if (m_runningPerDevice.value(it->serial) >= MAX_RUNNING_PER_DEVICE) {
+            ++it;
+            continue;
+        }
+        Task task = std::move(*it);
+        it = m_pending.erase(it);
+        startTask(std::move(task));
+    }
+}
+
+void AdbCommandRunner::startTask(Task task)
+{
+    const qint64 queueDelay = task.queuedTimer.elapsed();
+    {
+        QMutexLocker locker(&m_statsMutex);
+        m_stats.started++;
+        m_stats.totalQueueDelayMs += queueDelay;
+        m_stats.maxQueueDelayMs = std::max(m_stats.maxQueueDelayMs, queueDelay);
+    }
+    if (queueDelay >= QUEUE_DELAY_WARNING_MS) {
+        LOGW("adb command for device {} waited {} ms in queue", task.serial.toStdString(), queueDelay);
+    }
+
+    m_running++;
+    m_runningPerDevice[task.serial]++;
+
+    AdbJob* job = task.job;
+    auto* timer = new QTimer(job);
+    auto* watcher = new QFutureWatcher<QString>(job);
+    auto promise = task.promise;
+    const QString serial = task.serial;
+    // 完成、超时和取消可能先后触发，只处理第一次
+    auto settled = std::make_shared<bool>(false);
+    auto settle = [this, job, promise, serial, settled](const std::optional<AdbException>& error, const QString& output) {
+        if (*settled) return;
+        *settled = true;
+        if (error) {
+            promise->setException(*error);
+            QMutexLocker locker(&m_statsMutex);
+            m_stats.failed++;
+        } else if (!promise->isCanceled()) {
+            promise->addResult(output);
+        }
+        promise->finish();
+        // 可能在 job 自身的回调中完成，延迟销毁
+        job->deleteLater();
+        taskFinished(serial);
+    };
+
+    connect(timer, &QTimer::timeout, this, [this, job, settle]() {
+        job->abort();
+        {
+            QMutexLocker locker(&m_statsMutex);
+            m_stats.timedOut++;
+        }
+        settle(AdbException(QString("Timed out waiting for adb")), {});
+    });
+    connect(watcher, &QFutureWatcher<QString>::canceled, this, [this, job, settle]() {
+        job->abort();
+        {
+            QMutexLocker locker(&m_statsMutex);
+            m_stats.canceled++;
+        }
+        settle(std::nullopt, {});
+    });
+    watcher->setFuture(promise->future());
+
+    timer->setSingleShot(true);
+    if (task.timeoutMs > 0) {
+        timer->start(task.timeoutMs);
+    }
+    job->start(settle);
+}
+
+void AdbCommandRunner::taskFinished(const QString& serial)
+{
+    m_running--;
+    if (--m_runningPerDevice[serial] <= 0) {
+        m_runningPerDevice.remove(serial);
+    }
+    // 可能在 schedule 启动任务的过程中同步完成，延后再调度，不修改正在遍历的队列
+    QMetaObject::invokeMethod(this, &AdbCommandRunner::schedule, Qt::QueuedConnection);
+}
+
+} // namespace device
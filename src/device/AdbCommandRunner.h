@@ -0,0 +1,85 @@
+//
+// Created by neapu on 2025/12/13.
+//
+
+#pragma once
+#include "AdbHelper.h"
+#include <QObject>
+#include <QFuture>
+#include <QPromise>
+#include <QThread>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <functional>
+
+namespace device {
+
+// 一条异步执行的adb命令（adb进程或与adb server的一次会话），由 AdbCommandRunner 在执行线程上驱动。
+// 在调用线程构造后移动到执行线程，构造函数中不能创建子对象。
+class AdbJob : public QObject {
+public:
+    using Done = std::function<void(const std::optional<AdbException>& error, const QString& output)>;
+
+    // 在执行线程调用，完成时调用一次 done，可以在 start 返回前调用
+    virtual void start(Done done) = 0;
+    // 超时或取消时在执行线程调用，之后 done 的调用被忽略
+    virtual void abort() = 0;
+};
+
+// 事件驱动的adb命令执行器：adb进程和adb server连接的启动、输出、超时和取消都由专用线程上的信号驱动，
+// 不占用任何阻塞等待的线程。同一设备同时运行的命令数有上限，多余的命令排队。
+class AdbCommandRunner : public QObject {
+    Q_OBJECT
+public:
+    static AdbCommandRunner* instance();
+
+    // 启动 adb 进程执行命令。取消返回的QFuture会终止对应进程或将其移出队列
+    auto run(const QString& serial, const QStringList& arguments, int timeoutMs) -> QFuture<QString>;
+    // 执行器接管 job，job 不能有父对象。timeoutMs 不大于0时不限时
+    auto run(const QString& serial, AdbJob* job, int timeoutMs) -> QFuture<QString>;
+
+    struct Stats {
+        quint64 started{0};
+        quint64 failed{0};
+        quint64 timedOut{0};
+        quint64 canceled{0};
+        // 最多同时排队的命令数
+        quint64 maxPending{0};
+        qint64 maxQueueDelayMs{0};
+        qint64 totalQueueDelayMs{0};
+    };
+    Stats stats() const;
+
+private:
+    AdbCommandRunner();
+    ~AdbCommandRunner() override;
+
+    struct Task {
+        QString serial;
+        // 由执行器拥有，完成或移出队列时 deleteLater
+        AdbJob* job{nullptr};
+        int timeoutMs{0};
+        std::shared_ptr<QPromise<QString>> promise;
+        QElapsedTimer queuedTimer;
+    };
+
+    void enqueue(Task task);
+    void schedule();
+    void startTask(Task task);
+    void taskFinished(const QString& serial);
+
+private:
+    QThread m_thread;
+    std::deque<Task> m_pending;
+    QHash<QString, int> m_runningPerDevice;
+    int m_running{0};
+
+    mutable QMutex m_statsMutex;
+    Stats m_stats;
+};
+
+} // namespace device
@@ -3,14 +3,14 @@
 //
 
 #include "AdbHelper.h"
+#include "AdbClient.h"
+#include "AdbCommandRunner.h"
 #include <QCoreApplication>
-#include <QtConcurrent>
 #include <QDir>
-#include <QThreadPool>
 
 namespace device {
 
-static QString adbPath()
+QString AdbHelper::adbPath()
 {
 #ifdef DEBUG_MODE
 #ifdef _WIN32
@@ -32,60 +32,43 @@ AdbHelper::AdbHelper()
 {
 }
 
-auto AdbHelper::runCommandAsync(const QStringList& arguments) -> QFuture<QString>
+auto AdbHelper::runCommandAsync(const QStringList& arguments, int timeoutMs) -> QFuture<QString>
 {
-    return runCommandAsync("", arguments);
+    return runCommandAsync("", arguments, timeoutMs);
 }
 
-auto AdbHelper::runCommandAsync(const QString& serial, const QStringList& arguments) -> QFuture<QString>
+auto AdbHelper::runCommandAsync(const QString& serial, const QStringList& arguments, int timeoutMs) -> QFuture<QString>
 {
-    QPromise<QString> promise;
-    QFuture<QString> future = promise.future();
-
-    QThreadPool::globalInstance()->start([promise = std::move(promise), serial, arguments]() mutable {
-        QString program = adbPath();
-        QStringList args;
-        if (!serial.isEmpty()) {
-            args << "-s" << serial;
-        }
-        args << arguments;
-
-        QProcess process;
-        process.start(program, args);
-
-        promise.start();
-
-        if (!process.waitForStarted()) {
-            promise.setException(AdbException(QString("Failed to start adb: %1").arg(process.errorString())));
-            promise.finish();
-            return;
-        }
-
-        if (!process.waitForFinished()) {
-            promise.setException(AdbException(QString("Timed out waiting for adb")));
-            promise.finish();
-            return;
-        }
-
-        if (process.exitStatus() == QProcess::CrashExit) {
-            promise.setException(AdbException(QString("Adb crashed")));
-            promise.finish();
-            return;
-        }
+    if (auto future = runNativeCommand(serial, arguments, timeoutMs)) {
+        return *future;
+    }
+    return AdbCommandRunner::instance()->run(serial, arguments, timeoutMs);
+}
 
-        if (process.exitCode() != 0) {
-            QString error = QString::fromUtf8(process.readAllStandardError());
-            if (error.isEmpty()) error = QString::fromUtf8(process.readAllStandardOutput());
-            promise.setException(AdbException(error.trimmed()));
-            promise.finish();
-            return;
+auto AdbHelper::runNativeCommand(const QString& serial, const QStringList& arguments, int timeoutMs)
+    -> std::optional<QFuture<QString>>
+{
+    if (arguments.isEmpty()) {
+        return std::nullopt;
+    }
+    auto* client = AdbClient::instance();
+    const QString& command = arguments[0];
+    if (command == "devices" && arguments.size() == 2 && arguments[1] == "-l") {
+        return client->hostCommand("host:devices-l", timeoutMs);
+    }
+    if (command == "shell" && arguments.size() > 1) {
+        return client->shell(serial, arguments.mid(1).join(' '), timeoutMs);
+    }
+    if (command == "push" && arguments.size() == 3) {
+        return client->push(serial, arguments[1], arguments[2], timeoutMs);
+    }
+    if (command == "reverse" && arguments.size() == 3) {
+        if (arguments[1] == "--remove") {
+            return client->removeReverse(serial, arguments[2], timeoutMs);
         }
-
-        promise.addResult(QString::fromUtf8(process.readAllStandardOutput()).trimmed());
-        promise.finish();
-    });
-
-    return future;
+        return client->reverse(serial, arguments[1], arguments[2], timeoutMs);
+    }
+    return std::nullopt;
 }
 
 auto AdbHelper::runBackgroundCommand(const QString& serial, const QStringList& arguments) -> QProcess*
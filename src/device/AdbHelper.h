@@ -8,6 +8,7 @@
 #include <QProcess>
 #include <QString>
 #include <QException>
+#include <optional>
 
 namespace device {
 
@@ -27,10 +28,20 @@ public:
     AdbHelper();
     ~AdbHelper() override = default;
 
-    static auto runCommandAsync(const QStringList& arguments) -> QFuture<QString>;
-    static auto runCommandAsync(const QString& serial, const QStringList& arguments) -> QFuture<QString>;
+    static constexpr int DEFAULT_TIMEOUT_MS = 30000;
+
+    static auto runCommandAsync(const QStringList& arguments, int timeoutMs = DEFAULT_TIMEOUT_MS) -> QFuture<QString>;
+    static auto runCommandAsync(const QString& serial, const QStringList& arguments, int timeoutMs = DEFAULT_TIMEOUT_MS)
+        -> QFuture<QString>;
 
     static auto runBackgroundCommand(const QString& serial, const QStringList& arguments) -> QProcess*;
+
+    static QString adbPath();
+
+private:
+    // 能由 AdbClient 直接完成的命令走 smart socket 协议，其余命令仍启动 adb 进程，两者都由 AdbCommandRunner 调度
+    static auto runNativeCommand(const QString& serial, const QStringList& arguments, int timeoutMs)
+        -> std::optional<QFuture<QString>>;
 };
 
 } // namespace device
@@ -0,0 +1,246 @@
+//
+// Created by neapu on 2025/12/13.
+//
+
+#include "DeviceTracker.h"
+#include "AdbClient.h"
+#include "AdbHelper.h"
+#include <logger.h>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QRegularExpression>
+#include <algorithm>
+
+namespace device {
+constexpr int RECONNECT_INTERVAL_MS = 2000;
+constexpr auto TRACK_DEVICES_SERVICE = "host:track-devices-l";
+// 设备刚进入 device 状态时 shell 可能尚未就绪，属性查询失败后按递增的间隔重试
+constexpr int PROPERTY_FETCH_ATTEMPTS = 3;
+constexpr int PROPERTY_RETRY_BASE_MS = 1000;
+
+DeviceTracker::DeviceTracker(QObject* parent)
+    : QObject(parent)
+{
+    m_socket = new QTcpSocket(this);
+    connect(m_socket, &QTcpSocket::connected, this, &DeviceTracker::onConnected);
+    connect(m_socket, &QTcpSocket::readyRead, this, &DeviceTracker::onReadyRead);
+    connect(m_socket, &QTcpSocket::disconnected, this, &DeviceTracker::onDisconnected);
+    connect(m_socket, &QTcpSocket::errorOccurred, this, [this](QAbstractSocket::SocketError error) {
+        if (error == QAbstractSocket::ConnectionRefusedError) {
+            LOGW("adb server is not reachable, starting it");
+            if (!m_startingServer) {
+                m_startingServer = true;
+                AdbHelper::runCommandAsync({"start-server"}).then(this, [this](const QString&) {
+                    m_startingServer = false;
+                    start();
+                }).onFailed(this, [this](const AdbException& ex) {
+                    m_startingServer = false;
+                    LOGE("Failed to start adb server: {}", ex.message().toStdString());
+                    scheduleReconnect();
+                });
+            }
+            return;
+        }
+        if (error != QAbstractSocket::RemoteHostClosedError) {
+            LOGW("Device tracker socket error: {}", m_socket->errorString().toStdString());
+            scheduleReconnect();
+        }
+    });
+
+    m_reconnectTimer.setSingleShot(true);
+    m_reconnectTimer.setInterval(RECONNECT_INTERVAL_MS);
+    connect(&m_reconnectTimer, &QTimer::timeout, this, &DeviceTracker::start);
+}
+
+void DeviceTracker::start()
+{
+    FUNC_TRACE;
+    if (m_socket->state() != QAbstractSocket::UnconnectedState) {
+        return;
+    }
+    m_buffer.clear();
+    m_statusReceived = false;
+    m_socket->connectToHost(QHostAddress::LocalHost, AdbClient::serverPort());
+}
+
+QList<DeviceInfoPtr> DeviceTracker::parseDeviceList(const QString& output)
+{
+    QList<DeviceInfoPtr> deviceList;
+    const QStringList lines = output.split('\n', Qt::SkipEmptyParts);
+    for (const QString& line : lines) {
+        if (line.startsWith("List of devices attached")) continue;
+
+        QString trimmedLine = line.trimmed();
+        if (trimmedLine.isEmpty()) continue;
+
+        QStringList parts = trimmedLine.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+        if (parts.size() < 2) continue;
+
+        auto info = std::make_shared<DeviceInfo>();
+        info->serial = parts[0];
+        info->status = parts[1];
+
+        for (int j = 2; j < parts.size(); ++j) {
+            if (parts[j].startsWith("model:")) {
+                info->name = parts[j].mid(6);
+                info->name = info->name.replace('_', ' ');
+            }
+        }
+
+        if (info->name.isEmpty()) {
+            info->name = info->serial;
+        }
+
+        deviceList.append(info);
+    }
+    return deviceList;
+}
+
+void DeviceTracker::onConnected()
+{
+    const QByteArray service(TRACK_DEVICES_SERVICE);
+    m_socket->write(QByteArray::number(service.size(), 16).rightJustified(4, '0') + service);
+}
+
+void DeviceTracker::onReadyRead()
+{
+    m_buffer += m_socket->readAll();
+
+    if (!m_statusReceived) {
+        if (m_buffer.size() < 4) return;
+        const QByteArray status = m_buffer.left(4);
+        if (status != "OKAY") {
+            LOGE("adb server rejected {}: {}", TRACK_DEVICES_SERVICE, QString::fromUtf8(m_buffer.mid(8)).toStdString());
+            m_socket->abort();
+            scheduleReconnect();
+            return;
+        }
+        m_buffer.remove(0, 4);
+        m_statusReceived = true;
+        m_tracking = true;
+        LOGI("Tracking devices through adb server");
+    }
+
+    // 每次设备变化服务端推送一个4位十六进制长度前缀的完整列表
+    while (m_buffer.size() >= 4) {
+        bool ok = false;
+        const int length = m_buffer.left(4).toInt(&ok, 16);
+        if (!ok) {
+            LOGE("Invalid track-devices message length");
+            m_socket->abort();
+            scheduleReconnect();
+            return;
+        }
+        if (m_buffer.size() < 4 + length) return;
+        const QString payload = QString::fromUtf8(m_buffer.constData() + 4, length);
+        m_buffer.remove(0, 4 + length);
+        applyDeviceList(payload);
+    }
+}
+
+void DeviceTracker::onDisconnected()
+{
+    LOGW("Device tracker disconnected from adb server");
+    m_tracking = false;
+    // adb server 不可用时列表中的设备都无法打开，发布空列表，重连后服务端会推送完整列表
+    m_lastPayload.clear();
+    m_androidVersions.clear();
+    if (!m_devices.isEmpty()) {
+        m_devices.clear();
+        publish();
+    }
+    scheduleReconnect();
+}
+
+void DeviceTracker::scheduleReconnect()
+{
+    if (!m_reconnectTimer.isActive()) {
+        m_reconnectTimer.start();
+    }
+}
+
+void DeviceTracker::applyDeviceList(const QString& payload)
+{
+    if (payload == m_lastPayload) {
+        return;
+    }
+    m_lastPayload = payload;
+
+    const auto deviceList = parseDeviceList(payload);
+    QSet<QString> online;
+    for (const auto& device : deviceList) {
+        if (device->status == "device") {
+            online.insert(device->serial);
+        }
+    }
+
+    // 断开或离线的设备清除属性缓存，下次连接时重新查询
+    for (auto it = m_androidVersions.begin(); it != m_androidVersions.end();) {
+        if (!online.contains(it.key())) {
+            it = m_androidVersions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (const auto& serial : online) {
+        if (!m_androidVersions.contains(serial)) {
+            fetchProperties(serial);
+        }
+    }
+
+    m_devices = deviceList;
+    publish();
+}
+
+bool DeviceTracker::isOnline(const QString& serial) const
+{
+    return std::any_of(m_devices.begin(), m_devices.end(), [&serial](const DeviceInfoPtr& d) {
+        return d->serial == serial && d->status == "device";
+    });
+}
+
+void DeviceTracker::fetchProperties(const QString& serial, int attempt)
+{
+    if (m_pendingProperties.contains(serial)) {
+        return;
+    }
+    m_pendingProperties.insert(serial);
+    AdbHelper::runCommandAsync(serial, {"shell", "getprop", "ro.build.version.release"}).then(this, [this, serial](const QString& version) {
+        m_pendingProperties.remove(serial);
+        if (!isOnline(serial)) return;
+        m_androidVersions.insert(serial, version);
+        publish();
+    }).onFailed(this, [this, serial, attempt](const AdbException& ex) {
+        m_pendingProperties.remove(serial);
+        if (attempt + 1 >= PROPERTY_FETCH_ATTEMPTS) {
+            LOGE("Failed to get Android version for device {}: {}", serial.toStdString(), ex.message().toStdString());
+            return;
+        }
+        LOGW("Failed to get Android version for device {}, retrying: {}", serial.toStdString(), ex.message().toStdString());
+        QTimer::singleShot(PROPERTY_RETRY_BASE_MS * (attempt + 1), this, [this, serial, attempt]() {
+            // 等待期间设备可能已断开，或重新连接后已查询成功
+            if (isOnline(serial) && !m_androidVersions.contains(serial)) {
+                fetchProperties(serial, attempt + 1);
+            }
+        });
+    });
+}
+
+void DeviceTracker::publish()
+{
+    // 生成新的快照，模型层通过比较字段得到增量变化
+    QList<DeviceInfoPtr> snapshot;
+    snapshot.reserve(m_devices.size());
+    for (const auto& device : m_devices) {
+        auto info = std::make_shared<DeviceInfo>(*device);
+        const QString version = m_androidVersions.value(info->serial);
+        if (!version.isEmpty()) {
+            info->androidVersion = QString("Android ") + version;
+        }
+        snapshot.append(info);
+    }
+    m_devices = snapshot;
+    emit devicesChanged(m_devices);
+}
+
+} // namespace device
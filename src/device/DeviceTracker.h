@@ -0,0 +1,63 @@
+//
+// Created by neapu on 2025/12/13.
+//
+
+#pragma once
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include "DeviceInfo.h"
+
+class QTcpSocket;
+
+namespace device {
+
+// 通过 adb server 的 host:track-devices-l 长连接跟踪设备变化，只在列表变化时通知。
+// 设备属性（Android版本）在每次连接后查询并缓存，失败时有限次重试。与 adb server 断开时发布空列表。
+class DeviceTracker : public QObject {
+    Q_OBJECT
+public:
+    explicit DeviceTracker(QObject* parent = nullptr);
+    ~DeviceTracker() override = default;
+
+    void start();
+    bool isTracking() const { return m_tracking; }
+
+    // 当前设备列表快照，每次变化都会生成新的DeviceInfo对象
+    QList<DeviceInfoPtr> devices() const { return m_devices; }
+
+    static QList<DeviceInfoPtr> parseDeviceList(const QString& output);
+
+signals:
+    void devicesChanged(const QList<device::DeviceInfoPtr>& devices);
+
+private slots:
+    void onConnected();
+    void onReadyRead();
+    void onDisconnected();
+
+private:
+    void scheduleReconnect();
+    void applyDeviceList(const QString& payload);
+    // attempt 为已失败的次数
+    void fetchProperties(const QString& serial, int attempt = 0);
+    bool isOnline(const QString& serial) const;
+    void publish();
+
+private:
+    QTcpSocket* m_socket{nullptr};
+    QTimer m_reconnectTimer;
+    QByteArray m_buffer;
+    bool m_statusReceived{false};
+    bool m_tracking{false};
+    bool m_startingServer{false};
+
+    QString m_lastPayload;
+    QList<DeviceInfoPtr> m_devices;
+    // serial -> Android版本，设备断开或离线时清除
+    QHash<QString, QString> m_androidVersions;
+    QSet<QString> m_pendingProperties;
+};
+
+} // namespace device
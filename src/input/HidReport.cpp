@@ -0,0 +1,238 @@
+//
+// Created by neapu on 2025/12/16.
+//
+
+#include "HidReport.h"
+#include <qnamespace.h>
+#include <algorithm>
+
+namespace input {
+constexpr uint8_t USAGE_ERROR_ROLL_OVER = 0x01;
+constexpr uint8_t USAGE_MODIFIER_FIRST = 0xe0;
+constexpr uint8_t USAGE_MODIFIER_LAST = 0xe7;
+// 描述符声明的按键 usage 上限，与 scrcpy 一致
+constexpr uint8_t USAGE_KEY_MAX = 0x65;
+
+constexpr uint8_t KEYBOARD_REPORT_DESCRIPTOR[] = {
+    0x05, 0x01, // Usage Page (Generic Desktop)
+    0x09, 0x06, // Usage (Keyboard)
+    0xa1, 0x01, // Collection (Application)
+    // 修饰键
+    0x05, 0x07, //   Usage Page (Key Codes)
+    0x19, 0xe0, //   Usage Minimum (224)
+    0x29, 0xe7, //   Usage Maximum (231)
+    0x15, 0x00, //   Logical Minimum (0)
+    0x25, 0x01, //   Logical Maximum (1)
+    0x75, 0x01, //   Report Size (1)
+    0x95, 0x08, //   Report Count (8)
+    0x81, 0x02, //   Input (Data, Variable, Absolute)
+    // 保留字节
+    0x75, 0x08, //   Report Size (8)
+    0x95, 0x01, //   Report Count (1)
+    0x81, 0x01, //   Input (Constant)
+    // LED
+    0x05, 0x08, //   Usage Page (LEDs)
+    0x19, 0x01, //   Usage Minimum (1)
+    0x29, 0x05, //   Usage Maximum (5)
+    0x75, 0x01, //   Report Size (1)
+    0x95, 0x05, //   Report Count (5)
+    0x91, 0x02, //   Output (Data, Variable, Absolute)
+    0x75, 0x03, //   Report Size (3)
+    0x95, 0x01, //   Report Count (1)
+    0x91, 0x01, //   Output (Constant)
+    // 按键数组
+    0x05, 0x07, //   Usage Page (Key Codes)
+    0x19, 0x00, //   Usage Minimum (0)
+    0x29, USAGE_KEY_MAX, // Usage Maximum (101)
+    0x15, 0x00, //   Logical Minimum (0)
+    0x25, USAGE_KEY_MAX, // Logical Maximum (101)
+    0x75, 0x08, //   Report Size (8)
+    0x95, 0x06, //   Report Count (6)
+    0x81, 0x00, //   Input (Data, Array)
+    0xc0,       // End Collection
+};
+
+constexpr uint8_t MOUSE_REPORT_DESCRIPTOR[] = {
+    0x05, 0x01, // Usage Page (Generic Desktop)
+    0x09, 0x02, // Usage (Mouse)
+    0xa1, 0x01, // Collection (Application)
+    0x09, 0x01, //   Usage (Pointer)
+    0xa1, 0x00, //   Collection (Physical)
+    // 5 个按键
+    0x05, 0x09, //     Usage Page (Buttons)
+    0x19, 0x01, //     Usage Minimum (1)
+    0x29, 0x05, //     Usage Maximum (5)
+    0x15, 0x00, //     Logical Minimum (0)
+    0x25, 0x01, //     Logical Maximum (1)
+    0x95, 0x05, //     Report Count (5)
+    0x75, 0x01, //     Report Size (1)
+    0x81, 0x02, //     Input (Data, Variable, Absolute)
+    0x95, 0x01, //     Report Count (1)
+    0x75, 0x03, //     Report Size (3)
+    0x81, 0x01, //     Input (Constant)
+    // X、Y、滚轮
+    0x05, 0x01, //     Usage Page (Generic Desktop)
+    0x09, 0x30, //     Usage (X)
+    0x09, 0x31, //     Usage (Y)
+    0x09, 0x38, //     Usage (Wheel)
+    0x15, 0x81, //     Logical Minimum (-127)
+    0x25, 0x7f, //     Logical Maximum (127)
+    0x75, 0x08, //     Report Size (8)
+    0x95, 0x03, //     Report Count (3)
+    0x81, 0x06, //     Input (Data, Variable, Relative)
+    // 水平滚轮
+    0x05, 0x0c, //     Usage Page (Consumer)
+    0x0a, 0x38, 0x02, // Usage (AC Pan)
+    0x15, 0x81, //     Logical Minimum (-127)
+    0x25, 0x7f, //     Logical Maximum (127)
+    0x75, 0x08, //     Report Size (8)
+    0x95, 0x01, //     Report Count (1)
+    0x81, 0x06, //     Input (Data, Variable, Relative)
+    0xc0,       //   End Collection
+    0xc0,       // End Collection
+};
+
+QByteArray HidKeyboard::reportDescriptor()
+{
+    return QByteArray::fromRawData(reinterpret_cast<const char*>(KEYBOARD_REPORT_DESCRIPTOR), sizeof(KEYBOARD_REPORT_DESCRIPTOR));
+}
+uint8_t HidKeyboard::usageForKey(int key)
+{
+    if (key >= Qt::Key_A && key <= Qt::Key_Z) {
+        return static_cast<uint8_t>(0x04 + key - Qt::Key_A);
+    }
+    if (key >= Qt::Key_1 && key <= Qt::Key_9) {
+        return static_cast<uint8_t>(0x1e + key - Qt::Key_1);
+    }
+    if (key >= Qt::Key_F1 && key <= Qt::Key_F12) {
+        return static_cast<uint8_t>(0x3a + key - Qt::Key_F1);
+    }
+    // Qt 按输入的字符给出键值，按住 Shift 时符号键要映射回所在的物理键
+    switch (key) {
+    case Qt::Key_0: case Qt::Key_ParenRight: return 0x27;
+    case Qt::Key_Exclam: return 0x1e;
+    case Qt::Key_At: return 0x1f;
+    case Qt::Key_NumberSign: return 0x20;
+    case Qt::Key_Dollar: return 0x21;
+    case Qt::Key_Percent: return 0x22;
+    case Qt::Key_AsciiCircum: return 0x23;
+    case Qt::Key_Ampersand: return 0x24;
+    case Qt::Key_Asterisk: return 0x25;
+    case Qt::Key_ParenLeft: return 0x26;
+    case Qt::Key_Return: case Qt::Key_Enter: return 0x28;
+    case Qt::Key_Escape: return 0x29;
+    case Qt::Key_Backspace: return 0x2a;
+    case Qt::Key_Tab: case Qt::Key_Backtab: return 0x2b;
+    case Qt::Key_Space: return 0x2c;
+    case Qt::Key_Minus: case Qt::Key_Underscore: return 0x2d;
+    case Qt::Key_Equal: case Qt::Key_Plus: return 0x2e;
+    case Qt::Key_BracketLeft: case Qt::Key_BraceLeft: return 0x2f;
+    case Qt::Key_BracketRight: case Qt::Key_BraceRight: return 0x30;
+    case Qt::Key_Backslash: case Qt::Key_Bar: return 0x31;
+    case Qt::Key_Semicolon: case Qt::Key_Colon: return 0x33;
+    case Qt::Key_Apostrophe: case Qt::Key_QuoteDbl: return 0x34;
+    case Qt::Key_QuoteLeft: case Qt::Key_AsciiTilde: return 0x35;
+    case Qt::Key_Comma: case Qt::Key_Less: return 0x36;
+    case Qt::Key_Period: case Qt::Key_Greater: return 0x37;
+    case Qt::Key_Slash: case Qt::Key_Question: return 0x38;
+    case Qt::Key_CapsLock: return 0x39;
+    case Qt::Key_Print: return 0x46;
+    case Qt::Key_ScrollLock: return 0x47;
+    case Qt::Key_Pause: return 0x48;
+    case Qt::Key_Insert: return 0x49;
+    case Qt::Key_Home: return 0x4a;
+    case Qt::Key_PageUp: return 0x4b;
+    case Qt::Key_Delete: return 0x4c;
+    case Qt::Key_End: return 0x4d;
+    case Qt::Key_PageDown: return 0x4e;
+    case Qt::Key_Right: return 0x4f;
+    case Qt::Key_Left: return 0x50;
+    case Qt::Key_Down: return 0x51;
+    case Qt::Key_Up: return 0x52;
+    case Qt::Key_NumLock: return 0x53;
+    case Qt::Key_Menu: return 0x65;
+    case Qt::Key_Control: return 0xe0;
+    case Qt::Key_Shift: return 0xe1;
+    case Qt::Key_Alt: return 0xe2;
+    case Qt::Key_Meta: return 0xe3;
+    default: return 0;
+    }
+}
+bool HidKeyboard::press(uint8_t usage)
+{
+    if (usage >= USAGE_MODIFIER_FIRST && usage <= USAGE_MODIFIER_LAST) {
+        const auto bit = static_cast<uint8_t>(1 << (usage - USAGE_MODIFIER_FIRST));
+        if (m_modifiers & bit) {
+            return false;
+        }
+        m_modifiers |= bit;
+        return true;
+    }
+    const auto end = m_keys.begin() + m_keyCount;
+    if (usage == 0 || usage > USAGE_KEY_MAX || m_keyCount == m_keys.size() || std::find(m_keys.begin(), end, usage) != end) {
+        return false;
+    }
+    m_keys[m_keyCount++] = usage;
+    return true;
+}
+bool HidKeyboard::release(uint8_t usage)
+{
+    if (usage >= USAGE_MODIFIER_FIRST && usage <= USAGE_MODIFIER_LAST) {
+        const auto bit = static_cast<uint8_t>(1 << (usage - USAGE_MODIFIER_FIRST));
+        if (!(m_modifiers & bit)) {
+            return false;
+        }
+        m_modifiers &= static_cast<uint8_t>(~bit);
+        return true;
+    }
+    const auto end = m_keys.begin() + m_keyCount;
+    const auto it = std::find(m_keys.begin(), end, usage);
+    if (it == end) {
+        return false;
+    }
+    // 保持按下的先后顺序
+    std::copy(it + 1, end, it);
+    m_keys[--m_keyCount] = 0;
+    return true;
+}
+bool HidKeyboard::releaseAll()
+{
+    if (m_modifiers == 0 && m_keyCount == 0) {
+        return false;
+    }
+    m_modifiers = 0;
+    m_keys = {};
+    m_keyCount = 0;
+    return true;
+}
+HidKeyboard::Report HidKeyboard::report() const
+{
+    Report report{};
+    report[0] = m_modifiers;
+    if (m_keyCount > REPORT_KEYS) {
+        std::fill(report.begin() + 2, report.end(), USAGE_ERROR_ROLL_OVER);
+    } else {
+        std::copy_n(m_keys.begin(), m_keyCount, report.begin() + 2);
+    }
+    return report;
+}
+
+QByteArray HidMouse::reportDescriptor()
+{
+    return QByteArray::fromRawData(reinterpret_cast<const char*>(MOUSE_REPORT_DESCRIPTOR), sizeof(MOUSE_REPORT_DESCRIPTOR));
+}
+uint8_t HidMouse::buttonsFromQt(int buttons)
+{
+    uint8_t result = 0;
+    if (buttons & Qt::LeftButton) result |= BUTTON_LEFT;
+    if (buttons & Qt::RightButton) result |= BUTTON_RIGHT;
+    if (buttons & Qt::MiddleButton) result |= BUTTON_MIDDLE;
+    if (buttons & Qt::BackButton) result |= BUTTON_BACK;
+    if (buttons & Qt::ForwardButton) result |= BUTTON_FORWARD;
+    return result;
+}
+HidMouse::Report HidMouse::report(uint8_t buttons, int8_t dx, int8_t dy, int8_t wheel, int8_t hWheel)
+{
+    return {buttons, static_cast<uint8_t>(dx), static_cast<uint8_t>(dy), static_cast<uint8_t>(wheel), static_cast<uint8_t>(hWheel)};
+}
+} // namespace input
@@ -0,0 +1,59 @@
+//
+// Created by neapu on 2025/12/16.
+//
+
+#pragma once
+#include <QByteArray>
+#include <array>
+#include <cstdint>
+
+namespace input {
+// HID 键盘，报告描述符与 scrcpy 的 hid_keyboard 一致：
+// 1 字节修饰键位图 + 1 字节保留 + 6 字节按键数组，另有 5 位 LED 输出报告
+class HidKeyboard {
+public:
+    static constexpr uint16_t ID = 1;
+    static constexpr size_t REPORT_SIZE = 8;
+    using Report = std::array<uint8_t, REPORT_SIZE>;
+
+    static QByteArray reportDescriptor();
+    // Qt::Key 对应的 HID usage，不支持的键返回 0。Qt 不区分左右修饰键，统一映射为左侧
+    static uint8_t usageForKey(int key);
+
+    // 状态有变化时返回 true
+    bool press(uint8_t usage);
+    bool release(uint8_t usage);
+    // 没有按下任何键时返回 false
+    bool releaseAll();
+    Report report() const;
+
+private:
+    static constexpr size_t REPORT_KEYS = 6;
+    // 同时按下超过 6 个键时报告 ErrorRollOver，松开到 6 个以内再恢复，因此需要记录更多的键
+    static constexpr size_t MAX_TRACKED_KEYS = 16;
+
+    uint8_t m_modifiers{0};
+    std::array<uint8_t, MAX_TRACKED_KEYS> m_keys{};
+    size_t m_keyCount{0};
+};
+
+// HID 相对坐标鼠标，报告描述符与 scrcpy 的 hid_mouse 一致：
+// 5 个按键位 + X/Y/滚轮/水平滚轮各 1 字节
+class HidMouse {
+public:
+    static constexpr uint16_t ID = 2;
+    static constexpr size_t REPORT_SIZE = 5;
+    using Report = std::array<uint8_t, REPORT_SIZE>;
+
+    static constexpr uint8_t BUTTON_LEFT = 1 << 0;
+    static constexpr uint8_t BUTTON_RIGHT = 1 << 1;
+    static constexpr uint8_t BUTTON_MIDDLE = 1 << 2;
+    static constexpr uint8_t BUTTON_BACK = 1 << 3;
+    static constexpr uint8_t BUTTON_FORWARD = 1 << 4;
+
+    static QByteArray reportDescriptor();
+    // Qt::MouseButtons 转换为 HID 按键位
+    static uint8_t buttonsFromQt(int buttons);
+    static Report report(uint8_t buttons, int8_t dx, int8_t dy, int8_t wheel, int8_t hWheel);
+};
+} // namespace input
@@ -0,0 +1,59 @@
+//
+// Created by neapu on 2025/12/15.
+//
+
+#pragma once
+#include <cstdint>
+#include <optional>
+
+namespace input {
+// 从界面线程采集的原始输入，定长值类型，不携带任何需要分配的数据
+struct InputEvent {
+    enum class Type : uint8_t {
+        KeyPress,
+        KeyRelease,
+        MousePress,
+        MouseRelease,
+        MouseMove,
+        Wheel,
+        // 窗口失去焦点，所有按下的键和触点都应释放
+        FocusLost,
+    };
+
+    Type type{Type::MouseMove};
+    // 采集时刻（MediaClock::nowUs），沿输入线程、控制通道一路传递用于统计延迟
+    int64_t timestampUs{0};
+    // Qt::Key
+    int key{0};
+    bool autoRepeat{false};
+    // Qt::MouseButton
+    int button{0};
+    int buttons{0};
+    // 在视频画面内的归一化坐标 [0, 1]，画面外时超出该范围
+    float x{0.0f};
+    float y{0.0f};
+    // 相对上一次移动的位移（逻辑像素），用于视角拖动
+    float dx{0.0f};
+    float dy{0.0f};
+    // 滚轮格数
+    float wheelX{0.0f};
+    float wheelY{0.0f};
+};
+
+// 输入事件的接收端，post 必须线程安全且不阻塞
+class InputSink {
+public:
+    virtual ~InputSink() = default;
+    virtual void post(const InputEvent& event) = 0;
+    // 为 true 时界面应隐藏并锁定鼠标，只上报相对位移
+    virtual bool wantsPointerLock() const = 0;
+
+    struct PointerPosition {
+        float x{0.0f};
+        float y{0.0f};
+    };
+    // 锁定鼠标时设备上受鼠标控制的点，视频画面内的归一化坐标，线程安全。
+    // 界面据此绘制本地叠加层；接收端不知道该位置（例如相对移动的 UHID 鼠标）时返回空
+    virtual std::optional<PointerPosition> pointerPosition() const { return std::nullopt; }
+};
+} // namespace input
@@ -0,0 +1,191 @@
+//
+// Created by neapu on 2025/12/15.
+//
+
+#include "Keymap.h"
+#include <logger.h>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QKeySequence>
+
+namespace input {
+static int keyFromString(const QString& text)
+{
+    if (text.isEmpty()) {
+        return 0;
+    }
+    const QKeySequence sequence = QKeySequence::fromString(text, QKeySequence::PortableText);
+    return sequence.isEmpty() ? 0 : sequence[0].key();
+}
+static QString keyToString(int key)
+{
+    return key == 0 ? QString() : QKeySequence(key).toString(QKeySequence::PortableText);
+}
+static int buttonFromString(const QString& text)
+{
+    if (text.compare("Left", Qt::CaseInsensitive) == 0) return Qt::LeftButton;
+    if (text.compare("Right", Qt::CaseInsensitive) == 0) return Qt::RightButton;
+    if (text.compare("Middle", Qt::CaseInsensitive) == 0) return Qt::MiddleButton;
+    if (text.compare("Back", Qt::CaseInsensitive) == 0) return Qt::BackButton;
+    if (text.compare("Forward", Qt::CaseInsensitive) == 0) return Qt::ForwardButton;
+    return 0;
+}
+static QString buttonToString(int button)
+{
+    switch (button) {
+    case Qt::LeftButton: return "Left";
+    case Qt::RightButton: return "Right";
+    case Qt::MiddleButton: return "Middle";
+    case Qt::BackButton: return "Back";
+    case Qt::ForwardButton: return "Forward";
+    default: return {};
+    }
+}
+static KeymapProfile::Point pointFromJson(const QJsonObject& json, const KeymapProfile::Point& fallback = {})
+{
+    return {static_cast<float>(json.value("x").toDouble(fallback.x)), static_cast<float>(json.value("y").toDouble(fallback.y))};
+}
+static void pointToJson(QJsonObject& json, const KeymapProfile::Point& point)
+{
+    json["x"] = point.x;
+    json["y"] = point.y;
+}
+
+KeymapProfile KeymapProfile::defaultProfile()
+{
+    KeymapProfile profile;
+    profile.name = "default";
+    profile.toggleKey = Qt::Key_QuoteLeft;
+    profile.joystick.enabled = true;
+    profile.joystick.up = Qt::Key_W;
+    profile.joystick.left = Qt::Key_A;
+    profile.joystick.down = Qt::Key_S;
+    profile.joystick.right = Qt::Key_D;
+    profile.mouseLook.enabled = true;
+    profile.taps.push_back({0, Qt::LeftButton, {0.85f, 0.65f}});
+    profile.taps.push_back({Qt::Key_Space, 0, {0.92f, 0.8f}});
+    profile.skillWheels.push_back({Qt::Key_Q, {0.78f, 0.85f}, 0.06f});
+    return profile;
+}
+KeymapProfile KeymapProfile::fromJson(const QJsonObject& json)
+{
+    KeymapProfile profile;
+    profile.name = json.value("name").toString();
+    profile.toggleKey = keyFromString(json.value("toggleKey").toString());
+
+    if (const auto joystick = json.value("joystick").toObject(); !joystick.isEmpty()) {
+        profile.joystick.enabled = true;
+        profile.joystick.up = keyFromString(joystick.value("up").toString());
+        profile.joystick.left = keyFromString(joystick.value("left").toString());
+        profile.joystick.down = keyFromString(joystick.value("down").toString());
+        profile.joystick.right = keyFromString(joystick.value("right").toString());
+        profile.joystick.center = pointFromJson(joystick, profile.joystick.center);
+        profile.joystick.radius = static_cast<float>(joystick.value("radius").toDouble(profile.joystick.radius));
+    }
+    if (const auto mouseLook = json.value("mouseLook").toObject(); !mouseLook.isEmpty()) {
+        profile.mouseLook.enabled = true;
+        profile.mouseLook.anchor = pointFromJson(mouseLook, profile.mouseLook.anchor);
+        profile.mouseLook.sensitivity = static_cast<float>(mouseLook.value("sensitivity").toDouble(profile.mouseLook.sensitivity));
+        profile.mouseLook.bounds = static_cast<float>(mouseLook.value("bounds").toDouble(profile.mouseLook.bounds));
+    }
+    for (const auto& value : json.value("taps").toArray()) {
+        const auto tap = value.toObject();
+        profile.taps.push_back({keyFromString(tap.value("key").toString()), buttonFromString(tap.value("button").toString()), pointFromJson(tap)});
+    }
+    for (const auto& value : json.value("skillWheels").toArray()) {
+        const auto wheel = value.toObject();
+        profile.skillWheels.push_back({keyFromString(wheel.value("key").toString()), pointFromJson(wheel),
+                                       static_cast<float>(wheel.value("radius").toDouble(0.06))});
+    }
+    return profile;
+}
+QJsonObject KeymapProfile::toJson() const
+{
+    QJsonObject json;
+    json["name"] = name;
+    json["toggleKey"] = keyToString(toggleKey);
+    if (joystick.enabled) {
+        QJsonObject object;
+        object["up"] = keyToString(joystick.up);
+        object["left"] = keyToString(joystick.left);
+        object["down"] = keyToString(joystick.down);
+        object["right"] = keyToString(joystick.right);
+        pointToJson(object, joystick.center);
+        object["radius"] = joystick.radius;
+        json["joystick"] = object;
+    }
+    if (mouseLook.enabled) {
+        QJsonObject object;
+        pointToJson(object, mouseLook.anchor);
+        object["sensitivity"] = mouseLook.sensitivity;
+        object["bounds"] = mouseLook.bounds;
+        json["mouseLook"] = object;
+    }
+    QJsonArray tapArray;
+    for (const auto& tap : taps) {
+        QJsonObject object;
+        if (tap.key) object["key"] = keyToString(tap.key);
+        if (tap.button) object["button"] = buttonToString(tap.button);
+        pointToJson(object, tap.position);
+        tapArray.append(object);
+    }
+    json["taps"] = tapArray;
+    QJsonArray wheelArray;
+    for (const auto& wheel : skillWheels) {
+        QJsonObject object;
+        object["key"] = keyToString(wheel.key);
+        pointToJson(object, wheel.position);
+        object["radius"] = wheel.radius;
+        wheelArray.append(object);
+    }
+    json["skillWheels"] = wheelArray;
+    return json;
+}
+
+KeymapStore::KeymapStore(const QString& directory)
+    : m_directory(directory)
+{
+    QDir().mkpath(m_directory);
+    // 首次使用时写出默认配置，方便用户在此基础上修改
+    if (!QFile::exists(filePath("default"))) {
+        save("default", KeymapProfile::defaultProfile());
+    }
+}
+KeymapProfile KeymapStore::load(const QString& packageName) const
+{
+    for (const auto& name : {packageName, QStringLiteral("default")}) {
+        if (name.isEmpty()) {
+            continue;
+        }
+        QFile file(filePath(name));
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        QJsonParseError error{};
+        const auto document = QJsonDocument::fromJson(file.readAll(), &error);
+        if (error.error != QJsonParseError::NoError || !document.isObject()) {
+            LOGW("Invalid keymap profile {}: {}", file.fileName().toStdString(), error.errorString().toStdString());
+            continue;
+        }
+        LOGI("Loaded keymap profile {}", file.fileName().toStdString());
+        return KeymapProfile::fromJson(document.object());
+    }
+    return KeymapProfile::defaultProfile();
+}
+bool KeymapStore::save(const QString& packageName, const KeymapProfile& profile) const
+{
+    QFile file(filePath(packageName));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        LOGE("Failed to write keymap profile {}", file.fileName().toStdString());
+        return false;
+    }
+    file.write(QJsonDocument(profile.toJson()).toJson());
+    return true;
+}
+QString KeymapStore::filePath(const QString& name) const
+{
+    return m_directory + "/" + name + ".json";
+}
+} // namespace input
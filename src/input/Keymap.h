@@ -0,0 +1,76 @@
+//
+// Created by neapu on 2025/12/15.
+//
+
+#pragma once
+#include <QString>
+#include <QJsonObject>
+#include <vector>
+
+namespace input {
+// 键位配置，坐标均为相对设备画面的归一化值 [0, 1]
+struct KeymapProfile {
+    struct Point {
+        float x{0.5f};
+        float y{0.5f};
+    };
+    // WASD 摇杆：按键组合决定方向，触点从中心推到半径处
+    struct Joystick {
+        bool enabled{false};
+        int up{0};
+        int left{0};
+        int down{0};
+        int right{0};
+        Point center{0.2f, 0.75f};
+        float radius{0.08f};
+    };
+    // 鼠标视角：鼠标位移拖动锚点处的触点，超出范围后抬起并回到锚点重新按下
+    struct MouseLook {
+        bool enabled{false};
+        Point anchor{0.7f, 0.45f};
+        // 每逻辑像素鼠标位移对应的设备像素
+        float sensitivity{1.0f};
+        // 触点离锚点的最大距离（归一化）
+        float bounds{0.25f};
+    };
+    // 点击：按键或鼠标按键按下时在固定位置按下触点
+    struct Tap {
+        int key{0};
+        int button{0};
+        Point position;
+    };
+    // 技能轮盘：按下时在技能位置按下触点，按住期间鼠标位移在半径内拖动，松开时释放
+    struct SkillWheel {
+        int key{0};
+        Point position;
+        float radius{0.06f};
+    };
+
+    QString name;
+    // 切换键位映射与普通触控模式
+    int toggleKey{0};
+    Joystick joystick;
+    MouseLook mouseLook;
+    std::vector<Tap> taps;
+    std::vector<SkillWheel> skillWheels;
+
+    static KeymapProfile defaultProfile();
+    static KeymapProfile fromJson(const QJsonObject& json);
+    QJsonObject toJson() const;
+};
+
+// 按应用包名存取键位配置，没有专用配置时使用 default.json
+class KeymapStore {
+public:
+    explicit KeymapStore(const QString& directory);
+
+    KeymapProfile load(const QString& packageName) const;
+    bool save(const QString& packageName, const KeymapProfile& profile) const;
+
+private:
+    QString filePath(const QString& name) const;
+
+private:
+    QString m_directory;
+};
+} // namespace input
@@ -0,0 +1,410 @@
+//
+// Created by neapu on 2025/12/15.
+//
+
+#include "KeymapEngine.h"
+#include "../codec/MediaClock.h"
+#include <logger.h>
+#include <qnamespace.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace input {
+using network::ControlMessage;
+using Action = ControlMessage::Action;
+
+constexpr uint64_t POINTER_ID_JOYSTICK = 1;
+constexpr uint64_t POINTER_ID_LOOK = 2;
+constexpr uint64_t POINTER_ID_SKILL = 3;
+constexpr uint64_t POINTER_ID_TAP_BASE = 16;
+
+// android.view.MotionEvent.BUTTON_PRIMARY
+constexpr int32_t BUTTON_PRIMARY = 1;
+
+constexpr uint8_t JOYSTICK_UP = 1 << 0;
+constexpr uint8_t JOYSTICK_LEFT = 1 << 1;
+constexpr uint8_t JOYSTICK_DOWN = 1 << 2;
+constexpr uint8_t JOYSTICK_RIGHT = 1 << 3;
+
+KeymapEngine::KeymapEngine(ControlSender sender, ScreenSizeProvider screenSize, EnabledCallback enabledCallback)
+    : m_sender(std::move(sender))
+    , m_screenSize(std::move(screenSize))
+    , m_enabledCallback(std::move(enabledCallback))
+{
+    m_running = true;
+    m_worker = std::thread(&KeymapEngine::workerLoop, this);
+}
+KeymapEngine::~KeymapEngine()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_cv.notify_all();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+void KeymapEngine::post(const InputEvent& event)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_count == QUEUE_CAPACITY) {
+            // 输入线程跟不上时丢弃最旧的事件，保证新输入不被延迟
+            m_head = (m_head + 1) % QUEUE_CAPACITY;
+            --m_count;
+            ++m_stats.dropped;
+        }
+        m_queue[(m_head + m_count) % QUEUE_CAPACITY] = event;
+        ++m_count;
+    }
+    m_cv.notify_one();
+}
+void KeymapEngine::setProfile(const KeymapProfile& profile)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingProfile = profile;
+    }
+    m_cv.notify_one();
+}
+std::optional<InputSink::PointerPosition> KeymapEngine::pointerPosition() const
+{
+    const uint64_t packed = m_lookPoint.load(std::memory_order_relaxed);
+    if (packed == NO_LOOK_POINT) {
+        return std::nullopt;
+    }
+    return PointerPosition{std::bit_cast<float>(static_cast<uint32_t>(packed >> 32)),
+                           std::bit_cast<float>(static_cast<uint32_t>(packed))};
+}
+KeymapEngine::Stats KeymapEngine::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+void KeymapEngine::workerLoop()
+{
+    for (;;) {
+        size_t batchSize = 0;
+        std::optional<KeymapProfile> profile;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return m_count > 0 || m_pendingProfile || !m_running; });
+            if (!m_running) {
+                break;
+            }
+            profile.swap(m_pendingProfile);
+            for (; m_count > 0; --m_count, m_head = (m_head + 1) % QUEUE_CAPACITY) {
+                m_batch[batchSize++] = m_queue[m_head];
+            }
+            m_head = 0;
+        }
+
+        // 画面尺寸在旋转后会变化，每批事件取一次
+        m_size = m_screenSize ? m_screenSize() : QSize();
+        if (profile) {
+            applyProfile(std::move(*profile));
+        }
+
+        int64_t maxLatencyUs = 0;
+        int64_t totalLatencyUs = 0;
+        m_batchMessages = 0;
+        for (size_t i = 0; i < batchSize; ++i) {
+            process(m_batch[i]);
+            const int64_t latencyUs = codec::MediaClock::nowUs() - m_batch[i].timestampUs;
+            maxLatencyUs = std::max(maxLatencyUs, latencyUs);
+            totalLatencyUs += latencyUs;
+        }
+        publishLookPoint();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.events += batchSize;
+        m_stats.messages += m_batchMessages;
+        m_stats.totalLatencyUs += totalLatencyUs;
+        m_stats.maxLatencyUs = std::max(m_stats.maxLatencyUs, maxLatencyUs);
+    }
+}
+void KeymapEngine::applyProfile(KeymapProfile&& profile)
+{
+    releaseAll(codec::MediaClock::nowUs());
+    m_profile = std::move(profile);
+    m_tapPressed.assign(m_profile.taps.size(), 0);
+    m_pointerLock = m_enabled && m_profile.mouseLook.enabled;
+    LOGI("Keymap profile '{}' applied: {} taps, {} skill wheels", m_profile.name.toStdString(), m_profile.taps.size(),
+         m_profile.skillWheels.size());
+}
+void KeymapEngine::process(const InputEvent& event)
+{
+    switch (event.type) {
+    case InputEvent::Type::KeyPress: processKey(event, true); break;
+    case InputEvent::Type::KeyRelease: processKey(event, false); break;
+    case InputEvent::Type::MousePress: processMouseButton(event, true); break;
+    case InputEvent::Type::MouseRelease: processMouseButton(event, false); break;
+    case InputEvent::Type::MouseMove: processMouseMove(event); break;
+    case InputEvent::Type::Wheel: processWheel(event); break;
+    case InputEvent::Type::FocusLost: releaseAll(event.timestampUs); break;
+    }
+}
+void KeymapEngine::processKey(const InputEvent& event, bool pressed)
+{
+    if (event.autoRepeat) {
+        return;
+    }
+    if (pressed && m_profile.toggleKey != 0 && event.key == m_profile.toggleKey) {
+        setEnabled(!m_enabled, event.timestampUs);
+        return;
+    }
+    if (!m_enabled) {
+        return;
+    }
+
+    const auto& joystick = m_profile.joystick;
+    if (joystick.enabled) {
+        uint8_t bit = 0;
+        if (event.key == joystick.up) bit = JOYSTICK_UP;
+        else if (event.key == joystick.left) bit = JOYSTICK_LEFT;
+        else if (event.key == joystick.down) bit = JOYSTICK_DOWN;
+        else if (event.key == joystick.right) bit = JOYSTICK_RIGHT;
+        if (bit) {
+            m_joystickMask = pressed ? (m_joystickMask | bit) : (m_joystickMask & ~bit);
+            updateJoystick(event.timestampUs);
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < m_profile.taps.size(); ++i) {
+        const auto& tap = m_profile.taps[i];
+        if (tap.key == 0 || tap.key != event.key || m_tapPressed[i] == static_cast<uint8_t>(pressed)) {
+            continue;
+        }
+        m_tapPressed[i] = pressed;
+        sendTouch(pressed ? Action::Down : Action::Up, POINTER_ID_TAP_BASE + i, toScreen(tap.position), event.timestampUs);
+        return;
+    }
+
+    for (size_t i = 0; i < m_profile.skillWheels.size(); ++i) {
+        const auto& wheel = m_profile.skillWheels[i];
+        if (wheel.key != event.key) {
+            continue;
+        }
+        const Vec2 position = toScreen(wheel.position);
+        if (pressed && m_activeSkill < 0) {
+            m_activeSkill = static_cast<int>(i);
+            m_skillOffset = {};
+            sendTouch(Action::Down, POINTER_ID_SKILL, position, event.timestampUs);
+        } else if (!pressed && m_activeSkill == static_cast<int>(i)) {
+            m_activeSkill = -1;
+            sendTouch(Action::Up, POINTER_ID_SKILL, {position.x + m_skillOffset.x, position.y + m_skillOffset.y}, event.timestampUs);
+        }
+        return;
+    }
+}
+void KeymapEngine::processMouseButton(const InputEvent& event, bool pressed)
+{
+    if (!m_enabled) {
+        // 普通触控模式：左键按下拖动即单指触摸
+        if (event.button != Qt::LeftButton) {
+            return;
+        }
+        if (pressed && (event.x < 0.0f || event.x > 1.0f || event.y < 0.0f || event.y > 1.0f)) {
+            return;
+        }
+        if (pressed == m_mouseDown) {
+            return;
+        }
+        m_mouseDown = pressed;
+        m_mousePosition = toScreen({event.x, event.y});
+        sendTouch(pressed ? Action::Down : Action::Up, ControlMessage::POINTER_ID_MOUSE, m_mousePosition,
+                  event.timestampUs, BUTTON_PRIMARY, pressed ? BUTTON_PRIMARY : 0);
+        return;
+    }
+
+    for (size_t i = 0; i < m_profile.taps.size(); ++i) {
+        const auto& tap = m_profile.taps[i];
+        if (tap.button == 0 || tap.button != event.button || m_tapPressed[i] == static_cast<uint8_t>(pressed)) {
+            continue;
+        }
+        m_tapPressed[i] = pressed;
+        sendTouch(pressed ? Action::Down : Action::Up, POINTER_ID_TAP_BASE + i, toScreen(tap.position), event.timestampUs);
+        return;
+    }
+}
+void KeymapEngine::processMouseMove(const InputEvent& event)
+{
+    if (!m_enabled) {
+        if (m_mouseDown) {
+            m_mousePosition = toScreen({event.x, event.y});
+            sendTouch(Action::Move, ControlMessage::POINTER_ID_MOUSE, m_mousePosition, event.timestampUs, 0, BUTTON_PRIMARY);
+        }
+        return;
+    }
+
+    const float sensitivity = m_profile.mouseLook.sensitivity;
+    const float dx = event.dx * sensitivity;
+    const float dy = event.dy * sensitivity;
+    if (dx == 0.0f && dy == 0.0f) {
+        return;
+    }
+
+    // 按住技能轮盘时鼠标用于瞄准技能方向
+    if (m_activeSkill >= 0) {
+        const auto& wheel = m_profile.skillWheels[static_cast<size_t>(m_activeSkill)];
+        const float radius = wheel.radius * minDimension();
+        m_skillOffset.x += dx;
+        m_skillOffset.y += dy;
+        const float length = std::hypot(m_skillOffset.x, m_skillOffset.y);
+        if (length > radius && length > 0.0f) {
+            m_skillOffset.x *= radius / length;
+            m_skillOffset.y *= radius / length;
+        }
+        const Vec2 position = toScreen(wheel.position);
+        sendTouch(Action::Move, POINTER_ID_SKILL, {position.x + m_skillOffset.x, position.y + m_skillOffset.y}, event.timestampUs);
+        return;
+    }
+
+    if (!m_profile.mouseLook.enabled) {
+        return;
+    }
+    const Vec2 anchor = toScreen(m_profile.mouseLook.anchor);
+    if (!m_lookDown) {
+        m_lookDown = true;
+        m_lookPosition = anchor;
+        sendTouch(Action::Down, POINTER_ID_LOOK, m_lookPosition, event.timestampUs);
+    }
+    m_lookPosition.x += dx;
+    m_lookPosition.y += dy;
+    const float bounds = m_profile.mouseLook.bounds * minDimension();
+    if (std::hypot(m_lookPosition.x - anchor.x, m_lookPosition.y - anchor.y) > bounds) {
+        // 拖到边界后抬起，回到锚点重新按下，视角得以持续转动
+        sendTouch(Action::Up, POINTER_ID_LOOK, m_lookPosition, event.timestampUs);
+        m_lookPosition = anchor;
+        sendTouch(Action::Down, POINTER_ID_LOOK, m_lookPosition, event.timestampUs);
+        return;
+    }
+    sendTouch(Action::Move, POINTER_ID_LOOK, m_lookPosition, event.timestampUs);
+}
+void KeymapEngine::processWheel(const InputEvent& event)
+{
+    if (m_enabled || m_size.isEmpty()) {
+        return;
+    }
+    const Vec2 position = toScreen({event.x, event.y});
+    auto message = ControlMessage::scroll({static_cast<int32_t>(position.x), static_cast<int32_t>(position.y),
+                                           static_cast<uint16_t>(m_size.width()), static_cast<uint16_t>(m_size.height())},
+                                          event.wheelX, event.wheelY);
+    message.timestampUs = event.timestampUs;
+    if (m_sender(message)) {
+        ++m_batchMessages;
+    }
+}
+void KeymapEngine::updateJoystick(int64_t timestampUs)
+{
+    const auto& joystick = m_profile.joystick;
+    const Vec2 center = toScreen(joystick.center);
+    if (m_joystickMask == 0) {
+        if (m_joystickDown) {
+            m_joystickDown = false;
+            sendTouch(Action::Up, POINTER_ID_JOYSTICK, center, timestampUs);
+        }
+        return;
+    }
+
+    float dirX = 0.0f;
+    float dirY = 0.0f;
+    if (m_joystickMask & JOYSTICK_UP) dirY -= 1.0f;
+    if (m_joystickMask & JOYSTICK_DOWN) dirY += 1.0f;
+    if (m_joystickMask & JOYSTICK_LEFT) dirX -= 1.0f;
+    if (m_joystickMask & JOYSTICK_RIGHT) dirX += 1.0f;
+    const float length = std::hypot(dirX, dirY);
+    const float radius = joystick.radius * minDimension();
+    // 相反方向同时按下时停在中心
+    const Vec2 target = length > 0.0f
+        ? Vec2{center.x + dirX / length * radius, center.y + dirY / length * radius}
+        : center;
+
+    if (!m_joystickDown) {
+        m_joystickDown = true;
+        sendTouch(Action::Down, POINTER_ID_JOYSTICK, center, timestampUs);
+    }
+    sendTouch(Action::Move, POINTER_ID_JOYSTICK, target, timestampUs);
+}
+void KeymapEngine::setEnabled(bool enabled, int64_t timestampUs)
+{
+    releaseAll(timestampUs);
+    m_enabled = enabled;
+    m_pointerLock = m_enabled && m_profile.mouseLook.enabled;
+    LOGI("Keymap {}", enabled ? "enabled" : "disabled");
+    if (m_enabledCallback) {
+        m_enabledCallback(enabled);
+    }
+}
+void KeymapEngine::releaseAll(int64_t timestampUs)
+{
+    if (m_joystickDown) {
+        m_joystickDown = false;
+        sendTouch(Action::Up, POINTER_ID_JOYSTICK, toScreen(m_profile.joystick.center), timestampUs);
+    }
+    m_joystickMask = 0;
+    if (m_lookDown) {
+        m_lookDown = false;
+        sendTouch(Action::Up, POINTER_ID_LOOK, m_lookPosition, timestampUs);
+    }
+    if (m_activeSkill >= 0) {
+        const Vec2 position = toScreen(m_profile.skillWheels[static_cast<size_t>(m_activeSkill)].position);
+        sendTouch(Action::Up, POINTER_ID_SKILL, {position.x + m_skillOffset.x, position.y + m_skillOffset.y}, timestampUs);
+        m_activeSkill = -1;
+    }
+    for (size_t i = 0; i < m_tapPressed.size(); ++i) {
+        if (m_tapPressed[i]) {
+            m_tapPressed[i] = 0;
+            sendTouch(Action::Up, POINTER_ID_TAP_BASE + i, toScreen(m_profile.taps[i].position), timestampUs);
+        }
+    }
+    if (m_mouseDown) {
+        m_mouseDown = false;
+        sendTouch(Action::Up, ControlMessage::POINTER_ID_MOUSE, m_mousePosition, timestampUs, BUTTON_PRIMARY, 0);
+    }
+}
+void KeymapEngine::publishLookPoint()
+{
+    if (!m_enabled || !m_profile.mouseLook.enabled) {
+        m_lookPoint.store(NO_LOOK_POINT, std::memory_order_relaxed);
+        return;
+    }
+    KeymapProfile::Point point = m_profile.mouseLook.anchor;
+    if (m_lookDown && !m_size.isEmpty()) {
+        point.x = m_lookPosition.x / static_cast<float>(m_size.width());
+        point.y = m_lookPosition.y / static_cast<float>(m_size.height());
+    }
+    const uint64_t packed = static_cast<uint64_t>(std::bit_cast<uint32_t>(point.x)) << 32
+        | std::bit_cast<uint32_t>(point.y);
+    m_lookPoint.store(packed, std::memory_order_relaxed);
+}
+KeymapEngine::Vec2 KeymapEngine::toScreen(const KeymapProfile::Point& point) const
+{
+    return {point.x * static_cast<float>(m_size.width()), point.y * static_cast<float>(m_size.height())};
+}
+float KeymapEngine::minDimension() const
+{
+    return static_cast<float>(std::min(m_size.width(), m_size.height()));
+}
+void KeymapEngine::sendTouch(Action action, uint64_t pointerId, const Vec2& position, int64_t timestampUs,
+                             int32_t actionButton, int32_t buttons)
+{
+    if (m_size.isEmpty()) {
+        return;
+    }
+    const ControlMessage::Position screenPosition{
+        static_cast<int32_t>(std::lround(position.x)),
+        static_cast<int32_t>(std::lround(position.y)),
+        static_cast<uint16_t>(m_size.width()),
+        static_cast<uint16_t>(m_size.height()),
+    };
+    auto message = ControlMessage::touch(action, pointerId, screenPosition, 1.0f, actionButton, buttons);
+    message.timestampUs = timestampUs;
+    if (m_sender(message)) {
+        ++m_batchMessages;
+    }
+}
+} // namespace input
@@ -0,0 +1,110 @@
+//
+// Created by neapu on 2025/12/15.
+//
+
+#pragma once
+#include "InputEvent.h"
+#include "Keymap.h"
+#include "../network/ControlMessage.h"
+#include <QSize>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace input {
+// 键位映射引擎：在专用输入线程上把键盘鼠标事件转换为多点触控手势并发送到控制通道。
+// 事件写入预分配的环形队列，处理过程不做分配，配置只在切换时整体替换。
+class KeymapEngine final : public InputSink {
+public:
+    using ControlSender = std::function<bool(const network::ControlMessage&)>;
+    using ScreenSizeProvider = std::function<QSize()>;
+    // 在输入线程上调用
+    using EnabledCallback = std::function<void(bool enabled)>;
+
+    KeymapEngine(ControlSender sender, ScreenSizeProvider screenSize, EnabledCallback enabledCallback = {});
+    ~KeymapEngine() override;
+
+    void post(const InputEvent& event) override;
+    bool wantsPointerLock() const override { return m_pointerLock.load(); }
+    // 鼠标视角触点的当前位置，未按下时为锚点，与发给设备的触点一致（含灵敏度、边界和回到锚点）
+    std::optional<PointerPosition> pointerPosition() const override;
+
+    // 线程安全，切换前会释放所有按下的触点
+    void setProfile(const KeymapProfile& profile);
+
+    struct Stats {
+        uint64_t events{0};
+        uint64_t messages{0};
+        uint64_t dropped{0};
+        // 从采集到交给控制通道的耗时
+        int64_t maxLatencyUs{0};
+        int64_t totalLatencyUs{0};
+    };
+    Stats stats() const;
+
+private:
+    struct Vec2 {
+        float x{0.0f};
+        float y{0.0f};
+    };
+
+    void workerLoop();
+    void applyProfile(KeymapProfile&& profile);
+    void process(const InputEvent& event);
+    void processKey(const InputEvent& event, bool pressed);
+    void processMouseButton(const InputEvent& event, bool pressed);
+    void processMouseMove(const InputEvent& event);
+    void processWheel(const InputEvent& event);
+    void updateJoystick(int64_t timestampUs);
+    void setEnabled(bool enabled, int64_t timestampUs);
+    void releaseAll(int64_t timestampUs);
+    void publishLookPoint();
+
+    Vec2 toScreen(const KeymapProfile::Point& point) const;
+    float minDimension() const;
+    void sendTouch(network::ControlMessage::Action action, uint64_t pointerId, const Vec2& position, int64_t timestampUs,
+                   int32_t actionButton = 0, int32_t buttons = 0);
+
+private:
+    static constexpr size_t QUEUE_CAPACITY = 512;
+
+    ControlSender m_sender;
+    ScreenSizeProvider m_screenSize;
+    EnabledCallback m_enabledCallback;
+
+    std::thread m_worker;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::array<InputEvent, QUEUE_CAPACITY> m_queue{};
+    size_t m_head{0};
+    size_t m_count{0};
+    std::optional<KeymapProfile> m_pendingProfile;
+    bool m_running{false};
+    Stats m_stats;
+
+    std::atomic<bool> m_pointerLock{false};
+    // 高、低 32 位分别为归一化 x、y 的位模式，整体原子更新
+    static constexpr uint64_t NO_LOOK_POINT = ~0ull;
+    std::atomic<uint64_t> m_lookPoint{NO_LOOK_POINT};
+
+    // 以下只在输入线程访问
+    std::array<InputEvent, QUEUE_CAPACITY> m_batch{};
+    KeymapProfile m_profile;
+    QSize m_size;
+    bool m_enabled{false};
+    uint8_t m_joystickMask{0};
+    bool m_joystickDown{false};
+    bool m_lookDown{false};
+    Vec2 m_lookPosition;
+    int m_activeSkill{-1};
+    Vec2 m_skillOffset;
+    std::vector<uint8_t> m_tapPressed;
+    bool m_mouseDown{false};
+    Vec2 m_mousePosition;
+    uint64_t m_batchMessages{0};
+};
+} // namespace input
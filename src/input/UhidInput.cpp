@@ -0,0 +1,183 @@
+//
+// Created by neapu on 2025/12/16.
+//
+
+#include "UhidInput.h"
+#include "../codec/MediaClock.h"
+#include <logger.h>
+#include <qnamespace.h>
+#include <algorithm>
+#include <cmath>
+
+namespace input {
+using network::ControlMessage;
+
+// 与 scrcpy 一致，不声明具体厂商
+constexpr uint16_t VENDOR_ID = 0;
+constexpr uint16_t PRODUCT_ID = 0;
+constexpr int HID_AXIS_MAX = 127;
+constexpr int CAPTURE_KEY = Qt::Key_Alt;
+
+static int8_t takeAxis(float& pending)
+{
+    const float value = std::clamp(std::trunc(pending), static_cast<float>(-HID_AXIS_MAX), static_cast<float>(HID_AXIS_MAX));
+    pending -= value;
+    return static_cast<int8_t>(value);
+}
+
+UhidInput::UhidInput(ControlSender sender)
+    : m_sender(std::move(sender))
+{
+    m_sender(ControlMessage::uhidCreate(HidKeyboard::ID, VENDOR_ID, PRODUCT_ID, "GameScrcpy keyboard", HidKeyboard::reportDescriptor()));
+    m_sender(ControlMessage::uhidCreate(HidMouse::ID, VENDOR_ID, PRODUCT_ID, "GameScrcpy mouse", HidMouse::reportDescriptor()));
+}
+UhidInput::~UhidInput()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    releaseAll();
+    m_sender(ControlMessage::uhidDestroy(HidKeyboard::ID));
+    m_sender(ControlMessage::uhidDestroy(HidMouse::ID));
+}
+void UhidInput::post(const InputEvent& event)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    switch (event.type) {
+    case InputEvent::Type::KeyPress: processKey(event, true); break;
+    case InputEvent::Type::KeyRelease: processKey(event, false); break;
+    case InputEvent::Type::MousePress:
+    case InputEvent::Type::MouseRelease: processMouseButton(event); break;
+    case InputEvent::Type::MouseMove: processMouseMove(event); break;
+    case InputEvent::Type::Wheel: processWheel(event); break;
+    case InputEvent::Type::FocusLost:
+        releaseAll();
+        setCaptured(false);
+        break;
+    }
+    ++m_stats.events;
+    if (event.timestampUs > 0) {
+        const int64_t latencyUs = codec::MediaClock::nowUs() - event.timestampUs;
+        m_stats.totalLatencyUs += latencyUs;
+        m_stats.maxLatencyUs = std::max(m_stats.maxLatencyUs, latencyUs);
+    }
+}
+UhidInput::Stats UhidInput::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+void UhidInput::processKey(const InputEvent& event, bool pressed)
+{
+    // 设备端的 HID 栈自己处理按键重复
+    if (event.autoRepeat) {
+        return;
+    }
+    if (event.key == CAPTURE_KEY) {
+        // 捕获键不转发给设备，单独按下再松开时释放鼠标捕获
+        if (pressed) {
+            m_captureKeyDown = true;
+            m_captureKeyUsed = false;
+        } else if (m_captureKeyDown) {
+            m_captureKeyDown = false;
+            if (!m_captureKeyUsed && m_captured.load()) {
+                setCaptured(false);
+            }
+        }
+        return;
+    }
+    if (m_captureKeyDown) {
+        m_captureKeyUsed = true;
+    }
+    const uint8_t usage = HidKeyboard::usageForKey(event.key);
+    if (usage == 0) {
+        return;
+    }
+    if (pressed ? m_keyboard.press(usage) : m_keyboard.release(usage)) {
+        sendKeyboardReport();
+    }
+}
+void UhidInput::processMouseButton(const InputEvent& event)
+{
+    if (!m_captured.load()) {
+        // 未捕获时点击画面只用于开始捕获，本次点击不转发
+        if (event.type == InputEvent::Type::MousePress && event.x >= 0.0f && event.x <= 1.0f && event.y >= 0.0f && event.y <= 1.0f) {
+            setCaptured(true);
+        }
+        return;
+    }
+    const uint8_t buttons = HidMouse::buttonsFromQt(event.buttons);
+    if (buttons == m_mouseButtons) {
+        return;
+    }
+    m_mouseButtons = buttons;
+    sendMouseReport(0, 0, 0, 0);
+}
+void UhidInput::processMouseMove(const InputEvent& event)
+{
+    if (!m_captured.load()) {
+        return;
+    }
+    m_pendingDx += event.dx;
+    m_pendingDy += event.dy;
+    // 单个报告的位移范围是 ±127，快速移动时拆成多个报告
+    while (std::abs(m_pendingDx) >= 1.0f || std::abs(m_pendingDy) >= 1.0f) {
+        const int8_t dx = takeAxis(m_pendingDx);
+        const int8_t dy = takeAxis(m_pendingDy);
+        sendMouseReport(dx, dy, 0, 0);
+    }
+}
+void UhidInput::processWheel(const InputEvent& event)
+{
+    if (!m_captured.load()) {
+        return;
+    }
+    m_pendingWheel += event.wheelY;
+    m_pendingHWheel += event.wheelX;
+    const int8_t wheel = takeAxis(m_pendingWheel);
+    const int8_t hWheel = takeAxis(m_pendingHWheel);
+    if (wheel != 0 || hWheel != 0) {
+        sendMouseReport(0, 0, wheel, hWheel);
+    }
+}
+void UhidInput::setCaptured(bool captured)
+{
+    if (m_captured.exchange(captured) == captured) {
+        return;
+    }
+    LOGI("UHID mouse {}", captured ? "captured" : "released");
+    if (!captured && m_mouseButtons != 0) {
+        m_mouseButtons = 0;
+        sendMouseReport(0, 0, 0, 0);
+    }
+    m_pendingDx = m_pendingDy = 0.0f;
+    m_pendingWheel = m_pendingHWheel = 0.0f;
+}
+void UhidInput::releaseAll()
+{
+    if (m_keyboard.releaseAll()) {
+        sendKeyboardReport();
+    }
+    if (m_mouseButtons != 0) {
+        m_mouseButtons = 0;
+        sendMouseReport(0, 0, 0, 0);
+    }
+    m_captureKeyDown = false;
+}
+void UhidInput::sendKeyboardReport()
+{
+    const auto report = m_keyboard.report();
+    if (!m_sender(ControlMessage::uhidInput(HidKeyboard::ID, report.data(), report.size()))) {
+        ++m_stats.dropped;
+        return;
+    }
+    ++m_stats.reports;
+}
+void UhidInput::sendMouseReport(int8_t dx, int8_t dy, int8_t wheel, int8_t hWheel)
+{
+    const auto report = HidMouse::report(m_mouseButtons, dx, dy, wheel, hWheel);
+    if (!m_sender(ControlMessage::uhidInput(HidMouse::ID, report.data(), report.size()))) {
+        ++m_stats.dropped;
+        return;
+    }
+    ++m_stats.reports;
+}
+} // namespace input
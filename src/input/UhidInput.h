@@ -0,0 +1,68 @@
+//
+// Created by neapu on 2025/12/16.
+//
+
+#pragma once
+#include "InputEvent.h"
+#include "HidReport.h"
+#include "../network/ControlMessage.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+namespace input {
+// UHID 输入后端：把键盘鼠标事件直接转换为 HID 报告，经控制通道交给设备上的虚拟 HID 设备，
+// 由系统输入栈按物理键盘鼠标处理，不经过注入事件的路径。
+// 报告只有几个字节，转换在调用 post 的线程上完成，不再经过输入线程排队。
+// 鼠标为相对坐标：点击画面后捕获鼠标，单独按下并松开 Alt 或窗口失去焦点时释放。
+class UhidInput final : public InputSink {
+public:
+    using ControlSender = std::function<bool(const network::ControlMessage&)>;
+
+    // 构造时创建键盘和鼠标两个 UHID 设备
+    explicit UhidInput(ControlSender sender);
+    // 释放所有按键并销毁设备，必须在控制通道关闭前析构
+    ~UhidInput() override;
+
+    void post(const InputEvent& event) override;
+    bool wantsPointerLock() const override { return m_captured.load(); }
+
+    struct Stats {
+        uint64_t events{0};
+        uint64_t reports{0};
+        uint64_t dropped{0};
+        // 从采集到交给控制通道的耗时
+        int64_t maxLatencyUs{0};
+        int64_t totalLatencyUs{0};
+    };
+    Stats stats() const;
+
+private:
+    void processKey(const InputEvent& event, bool pressed);
+    void processMouseButton(const InputEvent& event);
+    void processMouseMove(const InputEvent& event);
+    void processWheel(const InputEvent& event);
+    void setCaptured(bool captured);
+    void releaseAll();
+
+    void sendKeyboardReport();
+    void sendMouseReport(int8_t dx, int8_t dy, int8_t wheel, int8_t hWheel);
+
+private:
+    ControlSender m_sender;
+    mutable std::mutex m_mutex;
+    Stats m_stats;
+    std::atomic<bool> m_captured{false};
+
+    HidKeyboard m_keyboard;
+    uint8_t m_mouseButtons{0};
+    // 不足 1 个单位的位移和滚动量累积到下一次
+    float m_pendingDx{0.0f};
+    float m_pendingDy{0.0f};
+    float m_pendingWheel{0.0f};
+    float m_pendingHWheel{0.0f};
+    // 捕获键按下期间是否按过其他键，按过则松开时不切换捕获
+    bool m_captureKeyDown{false};
+    bool m_captureKeyUsed{false};
+};
+} // namespace input
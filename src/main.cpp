@@ -2,9 +2,15 @@
 #include <QQmlApplicationEngine>
 #include <logger.h>
 #include <QQmlContext>
+#include <QStandardPaths>
+#include <QDir>
+#include <QCommandLineParser>
 #include "SessionManager.h"
+#include "AutomationServer.h"
 #include "model/DeviceModel.h"
 #include "view/QMLAdapter.h"
+#include "codec/DecoderProbe.h"
+#include "device/AdbCommandRunner.h"
 
 // clang-format off
 void qtMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString& msg)
@@ -39,6 +45,18 @@ int main(int argc, char *argv[])
 
     QApplication app(argc, argv);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    const QCommandLineOption automationOption("automation",
+        "Listen for automation requests on the local socket <name>.", "name");
+    parser.addOption(automationOption);
+    parser.process(app);
+
+    // 解码能力探测只在首次启动时运行，之后读取缓存
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    QDir().mkpath(dataDir);
+    codec::DecoderProbe::instance()->start((dataDir + "/decoder_probe.cache").toStdString());
+
     auto deviceModel = model::DeviceModel::instance();
     auto sessionManager = SessionManager::instance();
     QObject::connect(
@@ -48,6 +66,13 @@ int main(int argc, char *argv[])
         &model::DeviceModel::onDeviceListUpdated);
     sessionManager->updateDeviceList();
 
+    // 在会话之前析构，调度线程不会再访问会话
+    std::unique_ptr<AutomationServer> automationServer;
+    if (parser.isSet(automationOption)) {
+        automationServer = std::make_unique<AutomationServer>();
+        automationServer->start(parser.value(automationOption));
+    }
+
     QQmlApplicationEngine engine;
 
     engine.rootContext()->setContextProperty("deviceModel", deviceModel);
@@ -62,5 +87,13 @@ int main(int argc, char *argv[])
 
     engine.load(QUrl(QStringLiteral("qrc:/qml/Main.qml")));
 
-    return app.exec();
+    const int ret = app.exec();
+
+    const auto adbStats = device::AdbCommandRunner::instance()->stats();
+    LOGI("adb command stats: {} started, {} failed, {} timed out, {} canceled, max pending {}, "
+         "queue delay avg {} ms, max {} ms",
+         adbStats.started, adbStats.failed, adbStats.timedOut, adbStats.canceled, adbStats.maxPending,
+         adbStats.started ? adbStats.totalQueueDelayMs / static_cast<qint64>(adbStats.started) : 0,
+         adbStats.maxQueueDelayMs);
+    return ret;
 }
@@ -51,8 +51,50 @@ QHash<int, QByteArray> DeviceModel::roleNames() const
 
 void DeviceModel::onDeviceListUpdated(const QList<device::DeviceInfoPtr>& deviceList)
 {
-    beginResetModel();
-    m_deviceList = deviceList;
-    endResetModel();
+    // 按serial比较新旧列表，只发出增删改通知，避免整个QML列表重建
+    QHash<QString, device::DeviceInfoPtr> incoming;
+    incoming.reserve(deviceList.size());
+    for (const auto& device : deviceList) {
+        if (device) incoming.insert(device->serial, device);
+    }
+
+    for (int row = static_cast<int>(m_deviceList.size()) - 1; row >= 0; --row) {
+        if (!incoming.contains(m_deviceList[row]->serial)) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_deviceList.removeAt(row);
+            endRemoveRows();
+        }
+    }
+
+    QHash<QString, int> rows;
+    rows.reserve(m_deviceList.size());
+    for (int row = 0; row < m_deviceList.size(); ++row) {
+        rows.insert(m_deviceList[row]->serial, row);
+    }
+
+    for (const auto& device : deviceList) {
+        if (!device) continue;
+        const auto it = rows.constFind(device->serial);
+        if (it == rows.constEnd()) {
+            const int row = static_cast<int>(m_deviceList.size());
+            beginInsertRows(QModelIndex(), row, row);
+            m_deviceList.append(device);
+            endInsertRows();
+            rows.insert(device->serial, row);
+            continue;
+        }
+
+        const int row = it.value();
+        const auto& old = m_deviceList[row];
+        QList<int> changedRoles;
+        if (old->name != device->name) changedRoles << NameRole;
+        if (old->androidVersion != device->androidVersion) changedRoles << AndroidVersion;
+        if (old->status != device->status) changedRoles << Status;
+        m_deviceList[row] = device;
+        if (!changedRoles.isEmpty()) {
+            const QModelIndex modelIndex = index(row);
+            emit dataChanged(modelIndex, modelIndex, changedRoles);
+        }
+    }
 }
 } // namespace model
\ No newline at end of file
@@ -0,0 +1,239 @@
+//
+// Created by neapu on 2025/12/15.
+//
+
+#include "ControlChannel.h"
+#include "../codec/MediaClock.h"
+#include <logger.h>
+#include <QTcpSocket>
+#include <algorithm>
+
+namespace network {
+// socket 内部待发送数据超过该值时视为积压，暂停写出并开始合并移动事件
+constexpr qint64 BACKLOG_BYTES = 4096;
+constexpr size_t WRITE_BUFFER_RESERVE = 64 * 1024;
+
+ControlChannel::ControlChannel()
+    : QObject(nullptr)
+{
+    m_writeBuffer.reserve(WRITE_BUFFER_RESERVE);
+    m_thread.setObjectName("ControlChannel");
+    moveToThread(&m_thread);
+    m_thread.start();
+}
+ControlChannel::~ControlChannel()
+{
+    detachSocket();
+    m_thread.quit();
+    m_thread.wait();
+}
+void ControlChannel::attachSocket(QTcpSocket* socket)
+{
+    if (!socket) {
+        return;
+    }
+    // 关闭 Nagle，高频小包不在内核中等待合并
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    socket->setParent(nullptr);
+    socket->moveToThread(&m_thread);
+    QMetaObject::invokeMethod(this, [this, socket]() {
+        if (m_socket) {
+            m_socket->abort();
+            m_socket->deleteLater();
+        }
+        m_socket = socket;
+        connect(m_socket, &QTcpSocket::disconnected, this, &ControlChannel::onSocketDisconnected);
+        connect(m_socket, &QTcpSocket::bytesWritten, this, &ControlChannel::flush);
+        connect(m_socket, &QTcpSocket::readyRead, this, &ControlChannel::onReadyRead);
+        m_parser.reset();
+        m_pendingAcks = {};
+        m_connected = true;
+        flush();
+    }, Qt::QueuedConnection);
+}
+void ControlChannel::detachSocket()
+{
+    auto detach = [this]() {
+        if (m_socket) {
+            m_socket->disconnect(this);
+            m_socket->disconnectFromHost();
+            delete m_socket;
+            m_socket = nullptr;
+        }
+        m_connected = false;
+        m_backlogged = false;
+        QMutexLocker locker(&m_mutex);
+        for (size_t i = 0; i < m_count; ++i) {
+            m_slots[(m_head + i) % SLOT_COUNT] = {};
+        }
+        m_head = 0;
+        m_count = 0;
+    };
+    if (QThread::currentThread() == &m_thread || !m_thread.isRunning()) {
+        detach();
+    } else {
+        QMetaObject::invokeMethod(this, detach, Qt::BlockingQueuedConnection);
+    }
+}
+bool ControlChannel::push(const ControlMessage& message)
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_stats.pushed;
+
+    // 积压时，同一触点最后一条未发出的消息若也是移动事件，直接覆盖为最新位置
+    if (message.isTouchMove() && (m_backlogged.load() || m_count == SLOT_COUNT)) {
+        for (size_t i = m_count; i > 0; --i) {
+            auto& queued = m_slots[(m_head + i - 1) % SLOT_COUNT];
+            if (queued.type != ControlMessage::Type::InjectTouchEvent || queued.pointerId != message.pointerId) {
+                continue;
+            }
+            if (queued.action == ControlMessage::Action::Move) {
+                const int64_t timestampUs = queued.timestampUs;
+                queued = message;
+                // 保留最早的入队时刻，排队延迟按被合并的第一条事件计算
+                queued.timestampUs = timestampUs;
+                ++m_stats.merged;
+                return true;
+            }
+            break;
+        }
+    }
+
+    if (m_count == SLOT_COUNT) {
+        ++m_stats.dropped;
+        return false;
+    }
+    auto& slot = m_slots[(m_head + m_count) % SLOT_COUNT];
+    slot = message;
+    if (slot.timestampUs == 0) {
+        slot.timestampUs = codec::MediaClock::nowUs();
+    }
+    ++m_count;
+
+    // 同一个事件循环周期内只投递一次写出请求
+    if (!m_flushScheduled) {
+        m_flushScheduled = true;
+        locker.unlock();
+        QMetaObject::invokeMethod(this, &ControlChannel::flush, Qt::QueuedConnection);
+    }
+    return true;
+}
+ControlChannel::Stats ControlChannel::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+void ControlChannel::flush()
+{
+    if (!m_socket || m_socket->state() != QAbstractSocket::ConnectedState) {
+        QMutexLocker locker(&m_mutex);
+        m_flushScheduled = false;
+        return;
+    }
+    if (m_socket->bytesToWrite() > BACKLOG_BYTES) {
+        // 等 bytesWritten 再次触发 flush，期间新的移动事件在槽位中合并
+        m_backlogged = true;
+        QMutexLocker locker(&m_mutex);
+        m_flushScheduled = false;
+        return;
+    }
+    m_backlogged = false;
+
+    m_writeBuffer.clear();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_flushScheduled = false;
+        if (m_count == 0) {
+            return;
+        }
+        const int64_t nowUs = codec::MediaClock::nowUs();
+        for (; m_count > 0; --m_count, m_head = (m_head + 1) % SLOT_COUNT) {
+            auto& message = m_slots[m_head];
+            const size_t offset = m_writeBuffer.size();
+            // 只有剪贴板等大消息会超出预留容量
+            m_writeBuffer.resize(offset + message.serializedSize());
+            m_writeBuffer.resize(offset + message.serialize(m_writeBuffer.data() + offset));
+
+            const int64_t delayUs = nowUs - message.timestampUs;
+            m_stats.totalQueueDelayUs += delayUs;
+            m_stats.maxQueueDelayUs = std::max(m_stats.maxQueueDelayUs, delayUs);
+            ++m_stats.sent;
+            if (message.type == ControlMessage::Type::SetClipboard && message.sequence != 0) {
+                // 序号为0表示不需要确认
+                m_pendingAcks[m_pendingAckNext] = {message.sequence, nowUs};
+                m_pendingAckNext = (m_pendingAckNext + 1) % PENDING_ACK_COUNT;
+            }
+            // 释放文本等共享数据
+            message.text = {};
+            message.reportDescriptor = {};
+        }
+        m_head = 0;
+        ++m_stats.flushes;
+        m_stats.bytesWritten += m_writeBuffer.size();
+    }
+
+    const qint64 written = m_socket->write(reinterpret_cast<const char*>(m_writeBuffer.data()), static_cast<qint64>(m_writeBuffer.size()));
+    if (written < 0) {
+        LOGE("Failed to write control messages: {}", m_socket->errorString().toStdString());
+        return;
+    }
+    m_socket->flush();
+}
+void ControlChannel::onSocketDisconnected()
+{
+    LOGI("Control channel disconnected");
+    m_connected = false;
+    emit disconnected();
+}
+void ControlChannel::onReadyRead()
+{
+    if (!m_socket) {
+        return;
+    }
+    m_parser.append(m_socket->readAll());
+    while (auto message = m_parser.next()) {
+        dispatch(*message);
+    }
+    if (m_parser.hasError()) {
+        // 流已错位，无法再对齐到消息边界
+        LOGE("Invalid device message stream, closing control channel");
+        m_socket->abort();
+    }
+}
+void ControlChannel::dispatch(const DeviceMessage& message)
+{
+    switch (message.type) {
+    case DeviceMessage::Type::Clipboard:
+        emit clipboardReceived(message.text);
+        break;
+    case DeviceMessage::Type::AckClipboard: {
+        const int64_t sentUs = takeAckSendTime(message.sequence);
+        int64_t rttUs = -1;
+        if (sentUs > 0) {
+            rttUs = codec::MediaClock::nowUs() - sentUs;
+            QMutexLocker locker(&m_mutex);
+            ++m_stats.acks;
+            m_stats.lastAckRttUs = rttUs;
+            m_stats.totalAckRttUs += rttUs;
+            m_stats.maxAckRttUs = std::max(m_stats.maxAckRttUs, rttUs);
+        }
+        emit clipboardAcknowledged(message.sequence, rttUs);
+        break;
+    }
+    case DeviceMessage::Type::UhidOutput:
+        emit uhidOutputReceived(message.uhidId, message.data);
+        break;
+    }
+}
+int64_t ControlChannel::takeAckSendTime(uint64_t sequence)
+{
+    for (auto& pending : m_pendingAcks) {
+        if (pending.sequence == sequence) {
+            const int64_t sentUs = pending.sentUs;
+            pending = {};
+            return sentUs;
+        }
+    }
+    return 0;
+}
+} // namespace network
@@ -0,0 +1,95 @@
+//
+// Created by neapu on 2025/12/15.
+//
+
+#pragma once
+#include "ControlMessage.h"
+#include "DeviceMessage.h"
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <array>
+#include <atomic>
+#include <vector>
+
+class QTcpSocket;
+
+namespace network {
+// 控制通道：控制连接的 socket 运行在独立的 I/O 线程上。
+// 任意线程都可以 push 消息，消息写入预分配的槽位，每个事件循环周期合并写出一次；
+// socket 积压时同一触点尚未发出的移动事件会被新的位置覆盖，避免排队延迟不断累积。
+// 设备消息同样在 I/O 线程上解析，解析结果的信号从 I/O 线程发出，不经过 GUI 线程。
+class ControlChannel : public QObject {
+    Q_OBJECT
+public:
+    ControlChannel();
+    ~ControlChannel() override;
+
+    // 接管已连接的 socket，socket 不能有父对象，调用方线程必须是 socket 当前所在线程
+    void attachSocket(QTcpSocket* socket);
+    // 关闭并释放 socket，阻塞直到 I/O 线程处理完成
+    void detachSocket();
+    bool isConnected() const { return m_connected.load(); }
+
+    // 线程安全，队列满时返回 false
+    bool push(const ControlMessage& message);
+
+    struct Stats {
+        uint64_t pushed{0};
+        uint64_t merged{0};
+        uint64_t dropped{0};
+        uint64_t flushes{0};
+        uint64_t bytesWritten{0};
+        int64_t maxQueueDelayUs{0};
+        int64_t totalQueueDelayUs{0};
+        uint64_t sent{0};
+        // 设置剪贴板到收到设备确认的往返时间，反映控制通道的端到端延迟
+        uint64_t acks{0};
+        int64_t lastAckRttUs{0};
+        int64_t maxAckRttUs{0};
+        int64_t totalAckRttUs{0};
+    };
+    Stats stats() const;
+
+signals:
+    void disconnected();
+    // 以下信号在 I/O 线程发出，需要操作界面的接收方应使用排队连接
+    void clipboardReceived(const QString& text);
+    // sequence 为 setClipboard 时指定的序号，rttUs 为从写出到收到确认的时间，无法匹配时为 -1
+    void clipboardAcknowledged(quint64 sequence, qint64 rttUs);
+    void uhidOutputReceived(quint16 id, const QByteArray& data);
+
+private:
+    void flush();
+    void onSocketDisconnected();
+    void onReadyRead();
+    void dispatch(const DeviceMessage& message);
+    int64_t takeAckSendTime(uint64_t sequence);
+
+private:
+    static constexpr size_t SLOT_COUNT = 256;
+
+    QThread m_thread;
+    QTcpSocket* m_socket{nullptr};
+    std::atomic<bool> m_connected{false};
+    std::atomic<bool> m_backlogged{false};
+
+    mutable QMutex m_mutex;
+    std::array<ControlMessage, SLOT_COUNT> m_slots{};
+    size_t m_head{0};
+    size_t m_count{0};
+    bool m_flushScheduled{false};
+    Stats m_stats;
+
+    // 只在 I/O 线程访问
+    std::vector<uint8_t> m_writeBuffer;
+    DeviceMessageParser m_parser;
+    struct PendingAck {
+        uint64_t sequence{0};
+        int64_t sentUs{0};
+    };
+    static constexpr size_t PENDING_ACK_COUNT = 16;
+    std::array<PendingAck, PENDING_ACK_COUNT> m_pendingAcks{};
+    size_t m_pendingAckNext{0};
+};
+} // namespace network
@@ -0,0 +1,266 @@
+//
+// Created by neapu on 2025/12/15.
+//
+
+#include "ControlMessage.h"
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+namespace network {
+constexpr size_t INJECT_KEYCODE_SIZE = 14;
+constexpr size_t INJECT_TEXT_HEADER_SIZE = 5;
+constexpr size_t INJECT_TOUCH_EVENT_SIZE = 32;
+constexpr size_t INJECT_SCROLL_EVENT_SIZE = 21;
+constexpr size_t BACK_OR_SCREEN_ON_SIZE = 2;
+constexpr size_t RESET_VIDEO_SIZE = 1;
+// type + id + vendor_id + product_id + name_len，之后是名称和 2 字节的描述符长度
+constexpr size_t UHID_CREATE_HEADER_SIZE = 8;
+constexpr size_t UHID_INPUT_HEADER_SIZE = 5;
+constexpr size_t UHID_DESTROY_SIZE = 3;
+constexpr size_t START_APP_HEADER_SIZE = 2;
+// 文本注入的长度上限与 scrcpy 客户端一致
+constexpr size_t INJECT_TEXT_MAX_LENGTH = 300;
+
+static uint8_t* write8(uint8_t* out, uint8_t value)
+{
+    *out = value;
+    return out + 1;
+}
+static uint8_t* write16be(uint8_t* out, uint16_t value)
+{
+    qToBigEndian<quint16>(value, out);
+    return out + 2;
+}
+static uint8_t* write32be(uint8_t* out, uint32_t value)
+{
+    qToBigEndian<quint32>(value, out);
+    return out + 4;
+}
+static uint8_t* write64be(uint8_t* out, uint64_t value)
+{
+    qToBigEndian<quint64>(value, out);
+    return out + 8;
+}
+static uint8_t* writePosition(uint8_t* out, const ControlMessage::Position& position)
+{
+    out = write32be(out, static_cast<uint32_t>(position.x));
+    out = write32be(out, static_cast<uint32_t>(position.y));
+    out = write16be(out, position.screenWidth);
+    return write16be(out, position.screenHeight);
+}
+// [0, 1] 映射到 u16 定点数，1.0 对应 0xffff
+static uint16_t toU16FixedPoint(float value)
+{
+    value = std::clamp(value, 0.0f, 1.0f);
+    return value >= 1.0f ? 0xffff : static_cast<uint16_t>(value * 65536.0f);
+}
+// [-1, 1] 映射到 i16 定点数
+static int16_t toI16FixedPoint(float value)
+{
+    value = std::clamp(value, -1.0f, 1.0f);
+    const auto scaled = static_cast<int32_t>(value * 32768.0f);
+    return static_cast<int16_t>(std::clamp(scaled, -0x8000, 0x7fff));
+}
+// 文本按 UTF-8 截断，不截断在多字节字符中间
+static size_t utf8TruncatedLength(const QByteArray& text, size_t maxLength)
+{
+    size_t length = std::min(static_cast<size_t>(text.size()), maxLength);
+    if (length == static_cast<size_t>(text.size())) {
+        return length;
+    }
+    while (length > 0 && (static_cast<uint8_t>(text[static_cast<qsizetype>(length)]) & 0xc0) == 0x80) {
+        --length;
+    }
+    return length;
+}
+
+ControlMessage ControlMessage::keycode(Action action, int32_t keycode, int32_t repeat, int32_t metaState)
+{
+    ControlMessage msg;
+    msg.type = Type::InjectKeycode;
+    msg.action = action;
+    msg.keycode = keycode;
+    msg.repeat = repeat;
+    msg.metaState = metaState;
+    return msg;
+}
+ControlMessage ControlMessage::touch(Action action, uint64_t pointerId, const Position& position, float pressure,
+                                     int32_t actionButton, int32_t buttons)
+{
+    ControlMessage msg;
+    msg.type = Type::InjectTouchEvent;
+    msg.action = action;
+    msg.pointerId = pointerId;
+    msg.position = position;
+    msg.pressure = action == Action::Up ? 0.0f : pressure;
+    msg.actionButton = actionButton;
+    msg.buttons = buttons;
+    return msg;
+}
+ControlMessage ControlMessage::scroll(const Position& position, float hScroll, float vScroll, int32_t buttons)
+{
+    ControlMessage msg;
+    msg.type = Type::InjectScrollEvent;
+    msg.position = position;
+    msg.hScroll = hScroll;
+    msg.vScroll = vScroll;
+    msg.buttons = buttons;
+    return msg;
+}
+ControlMessage ControlMessage::backOrScreenOn(Action action)
+{
+    ControlMessage msg;
+    msg.type = Type::BackOrScreenOn;
+    msg.action = action;
+    return msg;
+}
+ControlMessage ControlMessage::setClipboard(uint64_t sequence, const QByteArray& text, bool paste)
+{
+    ControlMessage msg;
+    msg.type = Type::SetClipboard;
+    msg.sequence = sequence;
+    msg.text = text;
+    msg.paste = paste;
+    return msg;
+}
+ControlMessage ControlMessage::uhidCreate(uint16_t id, uint16_t vendorId, uint16_t productId, const QByteArray& name,
+                                          const QByteArray& reportDescriptor)
+{
+    ControlMessage msg;
+    msg.type = Type::UhidCreate;
+    msg.uhidId = id;
+    msg.vendorId = vendorId;
+    msg.productId = productId;
+    msg.text = name;
+    msg.reportDescriptor = reportDescriptor;
+    return msg;
+}
+ControlMessage ControlMessage::uhidInput(uint16_t id, const uint8_t* report, size_t size)
+{
+    ControlMessage msg;
+    msg.type = Type::UhidInput;
+    msg.uhidId = id;
+    msg.hidReportSize = static_cast<uint8_t>(std::min(size, HID_REPORT_MAX_SIZE));
+    std::memcpy(msg.hidReport.data(), report, msg.hidReportSize);
+    return msg;
+}
+ControlMessage ControlMessage::uhidDestroy(uint16_t id)
+{
+    ControlMessage msg;
+    msg.type = Type::UhidDestroy;
+    msg.uhidId = id;
+    return msg;
+}
+ControlMessage ControlMessage::startApp(const QByteArray& name)
+{
+    ControlMessage msg;
+    msg.type = Type::StartApp;
+    msg.text = name;
+    return msg;
+}
+ControlMessage ControlMessage::resetVideo()
+{
+    ControlMessage msg;
+    msg.type = Type::ResetVideo;
+    return msg;
+}
+size_t ControlMessage::serializedSize() const
+{
+    switch (type) {
+    case Type::InjectKeycode: return INJECT_KEYCODE_SIZE;
+    case Type::InjectText: return INJECT_TEXT_HEADER_SIZE + utf8TruncatedLength(text, INJECT_TEXT_MAX_LENGTH);
+    case Type::InjectTouchEvent: return INJECT_TOUCH_EVENT_SIZE;
+    case Type::InjectScrollEvent: return INJECT_SCROLL_EVENT_SIZE;
+    case Type::BackOrScreenOn: return BACK_OR_SCREEN_ON_SIZE;
+    case Type::SetClipboard: return SET_CLIPBOARD_HEADER_SIZE + utf8TruncatedLength(text, CLIPBOARD_TEXT_MAX_LENGTH);
+    case Type::UhidCreate:
+        return UHID_CREATE_HEADER_SIZE + utf8TruncatedLength(text, UHID_NAME_MAX_LENGTH) + 2
+            + std::min<size_t>(reportDescriptor.size(), UINT16_MAX);
+    case Type::UhidInput: return UHID_INPUT_HEADER_SIZE + hidReportSize;
+    case Type::UhidDestroy: return UHID_DESTROY_SIZE;
+    case Type::StartApp: return START_APP_HEADER_SIZE + utf8TruncatedLength(text, START_APP_NAME_MAX_LENGTH);
+    case Type::ResetVideo: return RESET_VIDEO_SIZE;
+    }
+    return 0;
+}
+size_t ControlMessage::serialize(uint8_t* out) const
+{
+    uint8_t* p = write8(out, static_cast<uint8_t>(type));
+    switch (type) {
+    case Type::InjectKeycode:
+        p = write8(p, static_cast<uint8_t>(action));
+        p = write32be(p, static_cast<uint32_t>(keycode));
+        p = write32be(p, static_cast<uint32_t>(repeat));
+        p = write32be(p, static_cast<uint32_t>(metaState));
+        break;
+    case Type::InjectText: {
+        const size_t length = utf8TruncatedLength(text, INJECT_TEXT_MAX_LENGTH);
+        p = write32be(p, static_cast<uint32_t>(length));
+        std::memcpy(p, text.constData(), length);
+        p += length;
+        break;
+    }
+    case Type::InjectTouchEvent:
+        p = write8(p, static_cast<uint8_t>(action));
+        p = write64be(p, pointerId);
+        p = writePosition(p, position);
+        p = write16be(p, toU16FixedPoint(pressure));
+        p = write32be(p, static_cast<uint32_t>(actionButton));
+        p = write32be(p, static_cast<uint32_t>(buttons));
+        break;
+    case Type::InjectScrollEvent:
+        p = writePosition(p, position);
+        // 与 scrcpy 客户端一致，先除以16归一化到 [-1, 1]
+        p = write16be(p, static_cast<uint16_t>(toI16FixedPoint(hScroll / 16.0f)));
+        p = write16be(p, static_cast<uint16_t>(toI16FixedPoint(vScroll / 16.0f)));
+        p = write32be(p, static_cast<uint32_t>(buttons));
+        break;
+    case Type::BackOrScreenOn:
+        p = write8(p, static_cast<uint8_t>(action));
+        break;
+    case Type::SetClipboard: {
+        const size_t length = utf8TruncatedLength(text, CLIPBOARD_TEXT_MAX_LENGTH);
+        p = write64be(p, sequence);
+        p = write8(p, paste ? 1 : 0);
+        p = write32be(p, static_cast<uint32_t>(length));
+        std::memcpy(p, text.constData(), length);
+        p += length;
+        break;
+    }
+    case Type::UhidCreate: {
+        p = write16be(p, uhidId);
+        p = write16be(p, vendorId);
+        p = write16be(p, productId);
+        const size_t nameLength = utf8TruncatedLength(text, UHID_NAME_MAX_LENGTH);
+        p = write8(p, static_cast<uint8_t>(nameLength));
+        std::memcpy(p, text.constData(), nameLength);
+        p += nameLength;
+        const size_t descriptorSize = std::min<size_t>(reportDescriptor.size(), UINT16_MAX);
+        p = write16be(p, static_cast<uint16_t>(descriptorSize));
+        std::memcpy(p, reportDescriptor.constData(), descriptorSize);
+        p += descriptorSize;
+        break;
+    }
+    case Type::UhidInput:
+        p = write16be(p, uhidId);
+        p = write16be(p, hidReportSize);
+        std::memcpy(p, hidReport.data(), hidReportSize);
+        p += hidReportSize;
+        break;
+    case Type::UhidDestroy:
+        p = write16be(p, uhidId);
+        break;
+    case Type::StartApp: {
+        const size_t length = utf8TruncatedLength(text, START_APP_NAME_MAX_LENGTH);
+        p = write8(p, static_cast<uint8_t>(length));
+        std::memcpy(p, text.constData(), length);
+        p += length;
+        break;
+    }
+    case Type::ResetVideo:
+        break;
+    }
+    return static_cast<size_t>(p - out);
+}
+} // namespace network
@@ -0,0 +1,114 @@
+//
+// Created by neapu on 2025/12/15.
+//
+
+#pragma once
+#include <QByteArray>
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+namespace network {
+// scrcpy 控制消息（客户端->设备），字段布局与 scrcpy 3.3.3 的 ControlMessageReader 一致。
+// 消息本身是定长的值类型，序列化到调用方提供的缓冲区，不做任何分配。
+struct ControlMessage {
+    enum class Type : uint8_t {
+        InjectKeycode = 0,
+        InjectText = 1,
+        InjectTouchEvent = 2,
+        InjectScrollEvent = 3,
+        BackOrScreenOn = 4,
+        SetClipboard = 9,
+        UhidCreate = 12,
+        UhidInput = 13,
+        UhidDestroy = 14,
+        StartApp = 16,
+        ResetVideo = 17,
+    };
+
+    // android.view.KeyEvent / MotionEvent 的 action 取值
+    enum class Action : uint8_t {
+        Down = 0,
+        Up = 1,
+        Move = 2,
+    };
+
+    static constexpr uint64_t POINTER_ID_MOUSE = UINT64_C(-1);
+    static constexpr uint64_t POINTER_ID_GENERIC_FINGER = UINT64_C(-2);
+    static constexpr uint64_t POINTER_ID_VIRTUAL_FINGER = UINT64_C(-3);
+
+    // 服务端可接受的最大消息长度
+    static constexpr size_t MAX_SIZE = 1 << 18;
+    static constexpr size_t SET_CLIPBOARD_HEADER_SIZE = 14;
+    static constexpr size_t CLIPBOARD_TEXT_MAX_LENGTH = MAX_SIZE - SET_CLIPBOARD_HEADER_SIZE;
+    // 与 scrcpy 的 SC_HID_MAX_SIZE 一致，键盘和鼠标的输入报告都不超过该长度
+    static constexpr size_t HID_REPORT_MAX_SIZE = 15;
+    static constexpr size_t UHID_NAME_MAX_LENGTH = 127;
+    static constexpr size_t START_APP_NAME_MAX_LENGTH = 255;
+
+    struct Position {
+        int32_t x{0};
+        int32_t y{0};
+        // 坐标所在的画面尺寸，与设备当前视频尺寸不一致时服务端会丢弃事件
+        uint16_t screenWidth{0};
+        uint16_t screenHeight{0};
+    };
+
+    Type type{Type::ResetVideo};
+    Action action{Action::Down};
+    // 入队时刻（MediaClock::nowUs），用于统计控制通道的排队延迟
+    int64_t timestampUs{0};
+
+    // InjectKeycode
+    int32_t keycode{0};
+    int32_t repeat{0};
+    int32_t metaState{0};
+
+    // InjectTouchEvent / InjectScrollEvent
+    uint64_t pointerId{POINTER_ID_GENERIC_FINGER};
+    Position position;
+    float pressure{1.0f};
+    int32_t actionButton{0};
+    int32_t buttons{0};
+    float hScroll{0.0f};
+    float vScroll{0.0f};
+
+    // SetClipboard / InjectText / StartApp，隐式共享，不复制数据
+    QByteArray text;
+    uint64_t sequence{0};
+    bool paste{false};
+
+    // UhidCreate / UhidInput / UhidDestroy
+    uint16_t uhidId{0};
+    // UhidCreate，设备名放在 text 中，报告描述符只在创建时发送一次
+    uint16_t vendorId{0};
+    uint16_t productId{0};
+    QByteArray reportDescriptor;
+    // UhidInput，报告定长存放，高频发送不分配
+    std::array<uint8_t, HID_REPORT_MAX_SIZE> hidReport{};
+    uint8_t hidReportSize{0};
+
+    static ControlMessage keycode(Action action, int32_t keycode, int32_t repeat = 0, int32_t metaState = 0);
+    static ControlMessage touch(Action action, uint64_t pointerId, const Position& position, float pressure = 1.0f,
+                                int32_t actionButton = 0, int32_t buttons = 0);
+    // 滚动量以滚轮格数为单位，范围 [-16, 16]
+    static ControlMessage scroll(const Position& position, float hScroll, float vScroll, int32_t buttons = 0);
+    static ControlMessage backOrScreenOn(Action action);
+    static ControlMessage setClipboard(uint64_t sequence, const QByteArray& text, bool paste);
+    static ControlMessage uhidCreate(uint16_t id, uint16_t vendorId, uint16_t productId, const QByteArray& name,
+                                     const QByteArray& reportDescriptor);
+    // size 超过 HID_REPORT_MAX_SIZE 时截断
+    static ControlMessage uhidInput(uint16_t id, const uint8_t* report, size_t size);
+    static ControlMessage uhidDestroy(uint16_t id);
+    // name 为包名，虚拟显示器上启动应用时使用
+    static ControlMessage startApp(const QByteArray& name);
+    static ControlMessage resetVideo();
+
+    // 序列化后的长度
+    size_t serializedSize() const;
+    // 写入 out，out 至少有 serializedSize() 字节，返回写入的字节数
+    size_t serialize(uint8_t* out) const;
+
+    bool isTouchMove() const { return type == Type::InjectTouchEvent && action == Action::Move; }
+};
+} // namespace network
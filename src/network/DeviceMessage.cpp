@@ -0,0 +1,94 @@
+//
+// Created by neapu on 2025/12/15.
+//
+
+#include "DeviceMessage.h"
+#include <logger.h>
+#include <QtEndian>
+
+namespace network {
+constexpr qsizetype CLIPBOARD_HEADER_SIZE = 5;
+constexpr qsizetype ACK_CLIPBOARD_SIZE = 9;
+constexpr qsizetype UHID_OUTPUT_HEADER_SIZE = 5;
+// 已消费的数据超过该值且超过缓冲区一半时才整理，摊薄搬移开销
+constexpr qsizetype COMPACT_THRESHOLD = 64 * 1024;
+
+void DeviceMessageParser::append(const QByteArray& data)
+{
+    compact();
+    m_buffer.append(data);
+}
+std::optional<DeviceMessage> DeviceMessageParser::next()
+{
+    if (m_error || available() < 1) {
+        return std::nullopt;
+    }
+    const uchar* p = cursor();
+    DeviceMessage message;
+    message.type = static_cast<DeviceMessage::Type>(p[0]);
+    switch (message.type) {
+    case DeviceMessage::Type::Clipboard: {
+        if (available() < CLIPBOARD_HEADER_SIZE) {
+            return std::nullopt;
+        }
+        const auto length = static_cast<qsizetype>(qFromBigEndian<quint32>(p + 1));
+        if (length > MAX_MESSAGE_SIZE - CLIPBOARD_HEADER_SIZE) {
+            LOGE("Device clipboard message too large: {}", length);
+            m_error = true;
+            return std::nullopt;
+        }
+        if (available() < CLIPBOARD_HEADER_SIZE + length) {
+            return std::nullopt;
+        }
+        message.text = QString::fromUtf8(reinterpret_cast<const char*>(p) + CLIPBOARD_HEADER_SIZE, length);
+        m_offset += CLIPBOARD_HEADER_SIZE + length;
+        return message;
+    }
+    case DeviceMessage::Type::AckClipboard:
+        if (available() < ACK_CLIPBOARD_SIZE) {
+            return std::nullopt;
+        }
+        message.sequence = qFromBigEndian<quint64>(p + 1);
+        m_offset += ACK_CLIPBOARD_SIZE;
+        return message;
+    case DeviceMessage::Type::UhidOutput: {
+        if (available() < UHID_OUTPUT_HEADER_SIZE) {
+            return std::nullopt;
+        }
+        message.uhidId = qFromBigEndian<quint16>(p + 1);
+        const auto size = static_cast<qsizetype>(qFromBigEndian<quint16>(p + 3));
+        if (available() < UHID_OUTPUT_HEADER_SIZE + size) {
+            return std::nullopt;
+        }
+        message.data = m_buffer.sliced(m_offset + UHID_OUTPUT_HEADER_SIZE, size);
+        m_offset += UHID_OUTPUT_HEADER_SIZE + size;
+        return message;
+    }
+    }
+    LOGE("Unknown device message type: {}", static_cast<int>(p[0]));
+    m_error = true;
+    return std::nullopt;
+}
+void DeviceMessageParser::reset()
+{
+    m_buffer.clear();
+    m_offset = 0;
+    m_error = false;
+}
+void DeviceMessageParser::compact()
+{
+    if (m_offset == 0) {
+        return;
+    }
+    if (m_offset == m_buffer.size()) {
+        // 全部消费完时只重置长度，保留已分配的容量
+        m_buffer.resize(0);
+        m_offset = 0;
+        return;
+    }
+    if (m_offset >= COMPACT_THRESHOLD && m_offset * 2 >= m_buffer.size()) {
+        m_buffer.remove(0, m_offset);
+        m_offset = 0;
+    }
+}
+} // namespace network
@@ -0,0 +1,52 @@
+//
+// Created by neapu on 2025/12/15.
+//
+
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <cstdint>
+#include <optional>
+
+namespace network {
+// scrcpy 设备消息（设备->客户端），布局与 scrcpy 3.3.3 的 DeviceMessageWriter 一致
+struct DeviceMessage {
+    enum class Type : uint8_t {
+        Clipboard = 0,
+        AckClipboard = 1,
+        UhidOutput = 2,
+    };
+
+    Type type{Type::Clipboard};
+    // Clipboard，解析时直接从接收缓冲区解码
+    QString text;
+    // AckClipboard
+    uint64_t sequence{0};
+    // UhidOutput
+    uint16_t uhidId{0};
+    QByteArray data;
+};
+
+// 流式解析：数据追加到内部缓冲区，按读偏移逐条取出，不为每条消息搬移剩余数据
+class DeviceMessageParser {
+public:
+    static constexpr qsizetype MAX_MESSAGE_SIZE = 1 << 18;
+
+    void append(const QByteArray& data);
+    // 缓冲区中没有完整的消息时返回空
+    std::optional<DeviceMessage> next();
+    // 遇到未知类型或超长消息时流已无法继续解析
+    bool hasError() const { return m_error; }
+    void reset();
+
+private:
+    qsizetype available() const { return m_buffer.size() - m_offset; }
+    const uchar* cursor() const { return reinterpret_cast<const uchar*>(m_buffer.constData()) + m_offset; }
+    void compact();
+
+private:
+    QByteArray m_buffer;
+    qsizetype m_offset{0};
+    bool m_error{false};
+};
+} // namespace network
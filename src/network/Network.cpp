@@ -27,6 +27,10 @@ Network::Network(QObject* parent)
 {
     m_server = new QTcpServer(this);
     connect(m_server, &QTcpServer::newConnection, this, &Network::onNewConnection);
+    m_controlChannel = std::make_unique<ControlChannel>();
+    connect(m_controlChannel.get(), &ControlChannel::disconnected, this, []() {
+        LOGI("Control socket disconnected");
+    }, Qt::QueuedConnection);
 }
 bool Network::start() const
 {
@@ -63,15 +67,11 @@ void Network::stop()
         m_audioSocket = nullptr;
     }
 
-    if (m_controlSocket) {
-        m_controlSocket->disconnectFromHost();
-        m_controlSocket->deleteLater();
-        m_controlSocket = nullptr;
-    }
+    m_controlChannel->detachSocket();
+    m_controlConnected = false;
 
     m_videoBuffer.clear();
     m_audioBuffer.clear();
-    m_controlBuffer.clear();
 
     m_deviceNameReceived = false;
     m_videoMetaDataReceived = false;
@@ -84,19 +84,15 @@ int Network::port() const
     }
     return -1;
 }
-void Network::sendControlData(const QByteArray& data) const
+bool Network::sendControlMessage(const ControlMessage& message) const
 {
-    if (!m_controlSocket || m_controlSocket->state() != QTcpSocket::ConnectedState) {
-        LOGW("Control socket is not connected");
-        return;
-    }
-    m_controlSocket->write(data);
+    return m_controlChannel->push(message);
 }
 void Network::onNewConnection()
 {
     FUNC_TRACE;
 
-    // 连接顺序一定是：视频->音频->控制
+    // 连接顺序一定是：视频->音频->控制，未开启的流不建立连接
     if (!m_videoSocket) {
         m_videoSocket = m_server->nextPendingConnection();
         connect(m_videoSocket, &QTcpSocket::disconnected, this, &Network::onSocketDisconnected);
@@ -105,7 +101,7 @@ void Network::onNewConnection()
         return;
     }
 
-    if (!m_audioSocket) {
+    if (m_audioEnabled && !m_audioSocket) {
         m_audioSocket = m_server->nextPendingConnection();
         connect(m_audioSocket, &QTcpSocket::disconnected, this, &Network::onSocketDisconnected);
         connect(m_audioSocket, &QTcpSocket::readyRead, this, &Network::onReadData);
@@ -113,11 +109,11 @@ void Network::onNewConnection()
         return;
     }
 
-    if (!m_controlSocket) {
-        m_controlSocket = m_server->nextPendingConnection();
-        connect(m_controlSocket, &QTcpSocket::disconnected, this, &Network::onSocketDisconnected);
-        connect(m_controlSocket, &QTcpSocket::readyRead, this, &Network::onReadData);
-        LOGI("Control socket connected from {}", m_controlSocket->peerAddress().toString().toStdString());
+    if (m_controlEnabled && !m_controlConnected) {
+        QTcpSocket* controlSocket = m_server->nextPendingConnection();
+        LOGI("Control socket connected from {}", controlSocket->peerAddress().toString().toStdString());
+        m_controlConnected = true;
+        m_controlChannel->attachSocket(controlSocket);
         return;
     }
 
@@ -140,8 +136,6 @@ void Network::onSocketDisconnected()
         LOGI("Video socket disconnected");
     } else if (senderSocket == m_audioSocket) {
         LOGI("Audio socket disconnected");
-    } else if (senderSocket == m_controlSocket) {
-        LOGI("Control socket disconnected");
     } else {
         LOGW("Unknown socket disconnected");
         senderSocket->deleteLater();
@@ -158,8 +152,6 @@ void Network::onReadData()
         onVideoDataReceived();
     } else if (senderSocket == m_audioSocket) {
         onAudioDataReceived();
-    } else if (senderSocket == m_controlSocket) {
-        onControlDataReceived();
     } else {
         LOGW("Unknown socket data received");
         senderSocket->readAll(); // 清空数据
@@ -267,9 +259,4 @@ void Network::onAudioDataReceived()
         emit receivedAudioData(configFlag, keyFrameFlag, pts, frameData);
     }
 }
-void Network::onControlDataReceived()
-{
-    // TODO: 实现控制数据的处理逻辑
-    m_controlSocket->readAll();
-}
 } // namespace network
@@ -4,6 +4,8 @@
 
 #pragma once
 #include <QTcpServer>
+#include "ControlChannel.h"
+#include <memory>
 
 namespace network {
 
@@ -18,7 +20,13 @@ public:
 
     int port() const;
 
-    void sendControlData(const QByteArray& data) const;
+    // 服务端关闭音频时不会建立音频连接，需在启动服务端前设置
+    void setAudioEnabled(bool enabled) { m_audioEnabled = enabled; }
+    void setControlEnabled(bool enabled) { m_controlEnabled = enabled; }
+
+    // 线程安全，控制连接建立前的消息会保留到连接后发出
+    bool sendControlMessage(const ControlMessage& message) const;
+    ControlChannel* controlChannel() const { return m_controlChannel.get(); }
 
 signals:
     void receivedDeviceName(const QByteArray& name);
@@ -26,7 +34,6 @@ signals:
     void receivedVideoData(bool configFlag, bool keyFrameFlag, int64_t pts, const QByteArray& data);
     void receivedAudioMetaData(int codecId);
     void receivedAudioData(bool configFlag, bool keyFrameFlag, int64_t pts, const QByteArray& data);
-    // TODO: void receivedControlData(const QByteArray& data);
 
 private slots:
     void onNewConnection();
@@ -34,17 +41,20 @@ private slots:
     void onReadData();
     void onVideoDataReceived();
     void onAudioDataReceived();
-    void onControlDataReceived();
 
 private:
     QTcpServer* m_server{nullptr};
     QTcpSocket* m_videoSocket{nullptr};
     QTcpSocket* m_audioSocket{nullptr};
-    QTcpSocket* m_controlSocket{nullptr};
+    // 控制连接交给 ControlChannel 在其 I/O 线程上读写
+    std::unique_ptr<ControlChannel> m_controlChannel;
+    bool m_controlConnected{false};
 
     QByteArray m_videoBuffer;
     QByteArray m_audioBuffer;
-    QByteArray m_controlBuffer;
+
+    bool m_audioEnabled{false};
+    bool m_controlEnabled{false};
 
     bool m_deviceNameReceived{false};
     bool m_videoMetaDataReceived{false};
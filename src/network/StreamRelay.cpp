@@ -0,0 +1,253 @@
+//
+// Created by neapu on 2025/12/30.
+//
+
+#include "StreamRelay.h"
+#include <logger.h>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QtEndian>
+#include <algorithm>
+
+namespace network {
+constexpr qsizetype DEVICE_NAME_SIZE = 64;
+constexpr qsizetype PACKET_HEADER_SIZE = 12;
+constexpr uint64_t PACKET_FLAG_CONFIG = UINT64_C(1) << 63;
+constexpr uint64_t PACKET_FLAG_KEYFRAME = UINT64_C(1) << 62;
+// 观看端的发送积压上限，8Mbps 的码流约为 2 秒
+constexpr qint64 MAX_VIEWER_BACKLOG_BYTES = 2 * 1024 * 1024;
+// GOP 缓存上限，超过后停止缓存，之后加入的观看端等下一个关键帧
+constexpr qint64 MAX_GOP_BYTES = 16 * 1024 * 1024;
+constexpr size_t MAX_VIEWERS = 16;
+
+StreamRelay::StreamRelay()
+    : QObject(nullptr)
+{
+    m_thread.setObjectName("StreamRelay");
+    moveToThread(&m_thread);
+    m_thread.start();
+}
+StreamRelay::~StreamRelay()
+{
+    stop();
+    m_thread.quit();
+    m_thread.wait();
+}
+bool StreamRelay::start(quint16 port)
+{
+    bool ok = false;
+    QMetaObject::invokeMethod(this, [this, port, &ok]() {
+        if (m_server) {
+            return;
+        }
+        m_server = new QTcpServer(this);
+        if (!m_server->listen(QHostAddress::LocalHost, port)) {
+            LOGE("Failed to start stream relay on port {}: {}", port, m_server->errorString().toStdString());
+            delete m_server;
+            m_server = nullptr;
+            return;
+        }
+        connect(m_server, &QTcpServer::newConnection, this, &StreamRelay::onNewConnection);
+        m_port = m_server->serverPort();
+        LOGI("Stream relay listening on 127.0.0.1:{}", m_port.load());
+        ok = true;
+    }, Qt::BlockingQueuedConnection);
+    return ok;
+}
+void StreamRelay::stop()
+{
+    auto close = [this]() {
+        for (auto& viewer : m_viewers) {
+            viewer.socket->disconnect(this);
+            viewer.socket->abort();
+            delete viewer.socket;
+        }
+        m_viewers.clear();
+        delete m_server;
+        m_server = nullptr;
+        m_port = 0;
+        m_deviceName.clear();
+        m_header.clear();
+        m_config.clear();
+        m_gop.clear();
+        m_gopBytes = 0;
+        m_gopValid = false;
+    };
+    if (QThread::currentThread() == &m_thread || !m_thread.isRunning()) {
+        close();
+    } else {
+        QMetaObject::invokeMethod(this, close, Qt::BlockingQueuedConnection);
+    }
+}
+quint16 StreamRelay::port() const
+{
+    return m_port.load();
+}
+void StreamRelay::setDeviceName(const QByteArray& name)
+{
+    QMetaObject::invokeMethod(this, [this, name]() {
+        m_deviceName = name.left(DEVICE_NAME_SIZE - 1);
+    }, Qt::QueuedConnection);
+}
+void StreamRelay::setVideoMetaData(int codec, int width, int height)
+{
+    QMetaObject::invokeMethod(this, [this, codec, width, height]() {
+        m_header = m_deviceName;
+        m_header.resize(DEVICE_NAME_SIZE, '\0');
+        uchar meta[12];
+        qToBigEndian<quint32>(static_cast<quint32>(codec), meta);
+        qToBigEndian<quint32>(static_cast<quint32>(width), meta + 4);
+        qToBigEndian<quint32>(static_cast<quint32>(height), meta + 8);
+        m_header.append(reinterpret_cast<const char*>(meta), sizeof(meta));
+        // 提前连上的观看端现在才能收到头部
+        for (auto& viewer : m_viewers) {
+            if (!viewer.headerSent) {
+                sendHeader(viewer);
+            }
+        }
+        std::erase_if(m_viewers, [](const Viewer& viewer) { return !viewer.socket; });
+    }, Qt::QueuedConnection);
+}
+void StreamRelay::pushVideo(bool configFlag, bool keyFrameFlag, int64_t pts, const QByteArray& data)
+{
+    // 帧头和数据拼成一块只构造一次，GOP 缓存和所有观看端共用
+    QByteArray packet(PACKET_HEADER_SIZE + data.size(), Qt::Uninitialized);
+    uint64_t ptsAndFlags = static_cast<uint64_t>(pts) & ~(PACKET_FLAG_CONFIG | PACKET_FLAG_KEYFRAME);
+    if (configFlag) ptsAndFlags |= PACKET_FLAG_CONFIG;
+    if (keyFrameFlag) ptsAndFlags |= PACKET_FLAG_KEYFRAME;
+    auto* out = reinterpret_cast<uchar*>(packet.data());
+    qToBigEndian<quint64>(ptsAndFlags, out);
+    qToBigEndian<quint32>(static_cast<quint32>(data.size()), out + 8);
+    std::copy(data.constBegin(), data.constEnd(), packet.data() + PACKET_HEADER_SIZE);
+    QMetaObject::invokeMethod(this, [this, packet, configFlag, keyFrameFlag]() {
+        dispatch(packet, configFlag, keyFrameFlag);
+    }, Qt::QueuedConnection);
+}
+StreamRelay::Stats StreamRelay::stats() const
+{
+    QMutexLocker locker(&m_statsMutex);
+    return m_stats;
+}
+void StreamRelay::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        if (m_viewers.size() >= MAX_VIEWERS) {
+            LOGW("Stream relay has {} viewers, rejecting connection", m_viewers.size());
+            socket->abort();
+            socket->deleteLater();
+            continue;
+        }
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        // 观看端发来的数据没有意义，直接丢弃
+        connect(socket, &QTcpSocket::readyRead, socket, [socket]() { socket->readAll(); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() { onViewerDisconnected(socket); });
+        LOGI("Stream relay viewer connected from port {}", socket->peerPort());
+        m_viewers.push_back({socket});
+        {
+            QMutexLocker locker(&m_statsMutex);
+            ++m_stats.viewers;
+        }
+        if (!m_header.isEmpty()) {
+            sendHeader(m_viewers.back());
+        }
+    }
+    std::erase_if(m_viewers, [](const Viewer& viewer) { return !viewer.socket; });
+}
+void StreamRelay::onViewerDisconnected(QTcpSocket* socket)
+{
+    const auto it = std::find_if(m_viewers.begin(), m_viewers.end(),
+                                 [socket](const Viewer& viewer) { return viewer.socket == socket; });
+    if (it != m_viewers.end()) {
+        LOGI("Stream relay viewer disconnected");
+        m_viewers.erase(it);
+    }
+    socket->deleteLater();
+}
+void StreamRelay::sendHeader(Viewer& viewer)
+{
+    viewer.headerSent = true;
+    viewer.burstBytes = m_header.size() + m_config.size() + (m_gopValid ? m_gopBytes : 0);
+    if (!write(viewer, m_header)) {
+        return;
+    }
+    if (!m_config.isEmpty() && !write(viewer, m_config)) {
+        return;
+    }
+    if (!m_gopValid) {
+        viewer.waitingKeyFrame = true;
+        return;
+    }
+    for (const auto& packet : m_gop) {
+        if (!write(viewer, packet)) {
+            return;
+        }
+    }
+}
+void StreamRelay::dispatch(const QByteArray& packet, bool configFlag, bool keyFrameFlag)
+{
+    if (configFlag) {
+        // 配置包在关键帧之前单独发送，旋转后会更新
+        m_config = packet;
+    } else if (keyFrameFlag) {
+        m_gop.clear();
+        m_gopBytes = 0;
+        m_gopValid = true;
+    }
+    if (!configFlag && m_gopValid) {
+        m_gop.push_back(packet);
+        m_gopBytes += packet.size();
+        if (m_gopBytes > MAX_GOP_BYTES) {
+            LOGW("Stream relay GOP exceeds {} bytes, late viewers will wait for the next key frame", MAX_GOP_BYTES);
+            m_gop.clear();
+            m_gopBytes = 0;
+            m_gopValid = false;
+        }
+    }
+
+    uint64_t bytesSent = 0;
+    for (auto& viewer : m_viewers) {
+        if (!viewer.socket || !viewer.headerSent) {
+            continue;
+        }
+        if (viewer.waitingKeyFrame) {
+            // 配置包照常发送，它总在下一个关键帧之前
+            if (!configFlag && !keyFrameFlag) {
+                continue;
+            }
+            viewer.waitingKeyFrame = configFlag;
+        }
+        if (viewer.burstBytes > 0 && viewer.socket->bytesToWrite() < MAX_VIEWER_BACKLOG_BYTES) {
+            viewer.burstBytes = 0;
+        }
+        if (write(viewer, packet)) {
+            bytesSent += static_cast<uint64_t>(packet.size());
+        }
+    }
+    std::erase_if(m_viewers, [](const Viewer& viewer) { return !viewer.socket; });
+
+    QMutexLocker locker(&m_statsMutex);
+    ++m_stats.packets;
+    m_stats.bytesSent += bytesSent;
+    m_stats.gopPackets = m_gop.size();
+    m_stats.gopBytes = static_cast<uint64_t>(m_gopBytes);
+}
+bool StreamRelay::write(Viewer& viewer, const QByteArray& data)
+{
+    if (!viewer.socket) {
+        return false;
+    }
+    if (viewer.socket->bytesToWrite() + data.size() > MAX_VIEWER_BACKLOG_BYTES + viewer.burstBytes) {
+        LOGW("Stream relay viewer on port {} is lagging, dropping it", viewer.socket->peerPort());
+        // 先断开信号，abort 同步发出的 disconnected 不会修改正在遍历的列表
+        viewer.socket->disconnect(this);
+        viewer.socket->abort();
+        viewer.socket->deleteLater();
+        viewer.socket = nullptr;
+        QMutexLocker locker(&m_statsMutex);
+        ++m_stats.dropped;
+        return false;
+    }
+    viewer.socket->write(data);
+    return true;
+}
+} // namespace network
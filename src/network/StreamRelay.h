@@ -0,0 +1,86 @@
+//
+// Created by neapu on 2025/12/30.
+//
+
+#pragma once
+#include <QObject>
+#include <QThread>
+#include <QByteArray>
+#include <QMutex>
+#include <vector>
+#include <atomic>
+
+class QTcpServer;
+class QTcpSocket;
+
+namespace network {
+// 本机转发：把一个会话的视频流按 scrcpy 视频连接的格式（64 字节设备名、12 字节编码信息、
+// 12 字节帧头加数据）提供给任意多个本机观看端，设备只编码一次。
+// 缓存最近的配置包和从最近一个关键帧开始的 GOP，中途加入的观看端立即可以解码；
+// 每个观看端的发送积压超过上限时断开，不拖慢其他观看端。socket 运行在独立的 I/O 线程上。
+class StreamRelay : public QObject {
+    Q_OBJECT
+public:
+    StreamRelay();
+    ~StreamRelay() override;
+
+    // 只监听回环地址，port 为 0 时自动选择
+    bool start(quint16 port);
+    void stop();
+    // 未监听时返回 0
+    quint16 port() const;
+
+    // 以下三个方法线程安全，按收到设备数据的顺序调用
+    void setDeviceName(const QByteArray& name);
+    void setVideoMetaData(int codec, int width, int height);
+    void pushVideo(bool configFlag, bool keyFrameFlag, int64_t pts, const QByteArray& data);
+
+    struct Stats {
+        uint64_t viewers{0};
+        // 因积压被断开的观看端
+        uint64_t dropped{0};
+        uint64_t packets{0};
+        uint64_t bytesSent{0};
+        // 当前缓存的 GOP
+        uint64_t gopPackets{0};
+        uint64_t gopBytes{0};
+    };
+    Stats stats() const;
+
+private:
+    struct Viewer {
+        QTcpSocket* socket{nullptr};
+        bool headerSent{false};
+        // 加入时没有完整的 GOP 可用，等下一个关键帧
+        bool waitingKeyFrame{false};
+        // 加入时一次性发送的缓存数据不计入积压，直到积压回落到上限以下
+        qint64 burstBytes{0};
+    };
+
+    void onNewConnection();
+    void onViewerDisconnected(QTcpSocket* socket);
+    // 以下在 I/O 线程调用。发送头部和缓存的配置包、GOP
+    void sendHeader(Viewer& viewer);
+    void dispatch(const QByteArray& packet, bool configFlag, bool keyFrameFlag);
+    // 积压超过上限时断开，返回 false
+    bool write(Viewer& viewer, const QByteArray& data);
+
+private:
+    QThread m_thread;
+    QTcpServer* m_server{nullptr};
+    std::atomic<quint16> m_port{0};
+
+    // 只在 I/O 线程访问
+    std::vector<Viewer> m_viewers;
+    QByteArray m_deviceName;
+    // 设备名加编码信息，收到编码信息前为空
+    QByteArray m_header;
+    QByteArray m_config;
+    std::vector<QByteArray> m_gop;
+    qint64 m_gopBytes{0};
+    bool m_gopValid{false};
+
+    mutable QMutex m_statsMutex;
+    Stats m_stats;
+};
+} // namespace network
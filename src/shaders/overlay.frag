@@ -0,0 +1,37 @@
+#version 450
+
+layout(location = 0) in vec2 vLocal;
+layout(location = 0) out vec4 fragColor;
+
+layout(std140, binding = 0) uniform OverlayBuf {
+    mat4 u_mvp;
+    vec4 u_rect;
+    vec4 u_color;
+    vec4 u_shape;
+};
+
+const float RING_RADIUS = 0.7;
+
+// 图形在片段着色器中按距离生成，整个叠加层只需要一个四边形
+void main()
+{
+    float halfWidth = u_shape.y * 0.5;
+    float aa = u_shape.w;
+    float coverage;
+    if (u_shape.x < 0.5) {
+        // 光标：圆环加中心点
+        float r = length(vLocal);
+        float ring = 1.0 - smoothstep(halfWidth, halfWidth + aa, abs(r - RING_RADIUS));
+        float dot = 1.0 - smoothstep(u_shape.y, u_shape.y + aa, r);
+        coverage = max(ring, dot);
+    } else {
+        // 准星：十字线，中心留空
+        vec2 a = abs(vLocal);
+        float horizontal = (1.0 - smoothstep(halfWidth, halfWidth + aa, a.y)) * smoothstep(u_shape.z, u_shape.z + aa, a.x);
+        float vertical = (1.0 - smoothstep(halfWidth, halfWidth + aa, a.x)) * smoothstep(u_shape.z, u_shape.z + aa, a.y);
+        coverage = max(horizontal, vertical);
+    }
+    float alpha = u_color.a * coverage;
+    // 输出预乘 alpha，与管线的混合方式一致
+    fragColor = vec4(u_color.rgb * alpha, alpha);
+}
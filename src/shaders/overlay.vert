@@ -0,0 +1,19 @@
+#version 450
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 texCoord;
+
+layout(location = 0) out vec2 vLocal;
+
+layout(std140, binding = 0) uniform OverlayBuf {
+    mat4 u_mvp;   // 与视频画面相同的 letterbox 变换
+    vec4 u_rect;  // xy: 中心，zw: 半宽高（视频画面的 NDC）
+    vec4 u_color; // 预乘前的颜色和不透明度
+    vec4 u_shape; // x: 样式（0 光标，1 准星），y: 线宽，z: 准星中心留空，w: 抗锯齿宽度（均相对半宽）
+};
+
+void main() {
+    vec2 p = u_rect.xy + position * u_rect.zw;
+    gl_Position = u_mvp * vec4(p, 0.0, 1.0);
+    vLocal = position;
+}
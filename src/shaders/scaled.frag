@@ -0,0 +1,138 @@
+#version 450
+// 高质量缩放的着色器变体，由 CMake 按输入格式和缩放算法分别编译：
+//   格式：FORMAT_YUV420P / FORMAT_NV12
+//   算法：SCALER_BICUBIC / SCALER_LANCZOS / SCALER_SHARP
+// 只对亮度使用高阶滤波，色度本身是半分辨率，保持双线性
+layout(location = 0) in vec2 vTexCoord;
+layout(location = 0) out vec4 fragColor;
+layout(binding = 0) uniform sampler2D yTexture;
+#if defined(FORMAT_NV12)
+layout(binding = 1) uniform sampler2D uvTexture;
+#else
+layout(binding = 1) uniform sampler2D uTexture;
+layout(binding = 2) uniform sampler2D vTexture;
+#endif
+layout(std140, binding = 4) uniform ColorParams {
+    mat4 COLOR_CONVERSION; // mat3 in upper-left, Y_OFFSET in [3][0]
+};
+layout(std140, binding = 5) uniform ScaleParams {
+    vec4 TEXEL_SIZE;   // xy: 1/亮度纹理尺寸，zw: 亮度纹理尺寸
+    vec4 SCALE_PARAMS; // x: 锐化强度
+};
+
+const float UV_OFFSET = 0.5;
+const float PI = 3.14159265;
+
+vec3 saturate(vec3 v) { return clamp(v, 0.0, 1.0); }
+
+// Catmull-Rom，利用双线性采样把 4x4 合并为 9 次采样
+float sampleBicubic(vec2 uv)
+{
+    vec2 samplePos = uv * TEXEL_SIZE.zw;
+    vec2 texPos1 = floor(samplePos - 0.5) + 0.5;
+    vec2 f = samplePos - texPos1;
+
+    vec2 w0 = f * (-0.5 + f * (1.0 - 0.5 * f));
+    vec2 w1 = 1.0 + f * f * (-2.5 + 1.5 * f);
+    vec2 w2 = f * (0.5 + f * (2.0 - 1.5 * f));
+    vec2 w3 = f * f * (-0.5 + 0.5 * f);
+
+    vec2 w12 = w1 + w2;
+    vec2 offset12 = w2 / w12;
+
+    vec2 texPos0 = (texPos1 - 1.0) * TEXEL_SIZE.xy;
+    vec2 texPos3 = (texPos1 + 2.0) * TEXEL_SIZE.xy;
+    vec2 texPos12 = (texPos1 + offset12) * TEXEL_SIZE.xy;
+
+    float r = 0.0;
+    r += texture(yTexture, vec2(texPos0.x, texPos0.y)).r * w0.x * w0.y;
+    r += texture(yTexture, vec2(texPos12.x, texPos0.y)).r * w12.x * w0.y;
+    r += texture(yTexture, vec2(texPos3.x, texPos0.y)).r * w3.x * w0.y;
+    r += texture(yTexture, vec2(texPos0.x, texPos12.y)).r * w0.x * w12.y;
+    r += texture(yTexture, vec2(texPos12.x, texPos12.y)).r * w12.x * w12.y;
+    r += texture(yTexture, vec2(texPos3.x, texPos12.y)).r * w3.x * w12.y;
+    r += texture(yTexture, vec2(texPos0.x, texPos3.y)).r * w0.x * w3.y;
+    r += texture(yTexture, vec2(texPos12.x, texPos3.y)).r * w12.x * w3.y;
+    r += texture(yTexture, vec2(texPos3.x, texPos3.y)).r * w3.x * w3.y;
+    return r;
+}
+
+#if defined(SCALER_LANCZOS)
+vec4 lanczos2Weights(float f)
+{
+    // 4 个抽头到采样点的距离为 1+f, f, 1-f, 2-f
+    vec4 x = vec4(1.0 + f, f, 1.0 - f, 2.0 - f);
+    vec4 px = PI * max(x, vec4(1e-5));
+    vec4 w = 2.0 * sin(px) * sin(px * 0.5) / (px * px);
+    return w / dot(w, vec4(1.0));
+}
+
+// Lanczos-2，4x4 共 16 次采样，在纹素中心采样得到原值
+float sampleLanczos(vec2 uv)
+{
+    vec2 samplePos = uv * TEXEL_SIZE.zw;
+    vec2 texPos1 = floor(samplePos - 0.5) + 0.5;
+    vec2 f = samplePos - texPos1;
+    vec4 wx = lanczos2Weights(f.x);
+    vec4 wy = lanczos2Weights(f.y);
+
+    float r = 0.0;
+    for (int j = 0; j < 4; ++j) {
+        float y = (texPos1.y + float(j - 1)) * TEXEL_SIZE.y;
+        float row = 0.0;
+        for (int i = 0; i < 4; ++i) {
+            float x = (texPos1.x + float(i - 1)) * TEXEL_SIZE.x;
+            row += texture(yTexture, vec2(x, y)).r * wx[i];
+        }
+        r += row * wy[j];
+    }
+    return r;
+}
+#endif
+
+#if defined(SCALER_SHARP)
+// 边缘自适应：以 Catmull-Rom 为基础，限制在周围 2x2 源像素的范围内避免振铃，
+// 再按局部对比度做自适应锐化，对比度高的边缘少锐化，平坦区域的细节多锐化
+float sampleSharp(vec2 uv)
+{
+    float c = sampleBicubic(uv);
+    vec2 base = (floor(uv * TEXEL_SIZE.zw - 0.5) + 0.5) * TEXEL_SIZE.xy;
+    float a = texture(yTexture, base).r;
+    float b = texture(yTexture, base + vec2(TEXEL_SIZE.x, 0.0)).r;
+    float d = texture(yTexture, base + vec2(0.0, TEXEL_SIZE.y)).r;
+    float e = texture(yTexture, base + TEXEL_SIZE.xy).r;
+    float mn = min(min(a, b), min(d, e));
+    float mx = max(max(a, b), max(d, e));
+
+    float blurred = texture(yTexture, uv).r;
+    float contrast = mx - mn;
+    float amount = SCALE_PARAMS.x * (1.0 - smoothstep(0.0, 0.5, contrast));
+    return clamp(c + amount * (c - blurred), mn, mx);
+}
+#endif
+
+float sampleLuma(vec2 uv)
+{
+#if defined(SCALER_LANCZOS)
+    return sampleLanczos(uv);
+#elif defined(SCALER_SHARP)
+    return sampleSharp(uv);
+#else
+    return sampleBicubic(uv);
+#endif
+}
+
+void main()
+{
+    float y = sampleLuma(vTexCoord);
+#if defined(FORMAT_NV12)
+    vec2 uv = texture(uvTexture, vTexCoord).rg;
+#else
+    vec2 uv = vec2(texture(uTexture, vTexCoord).r, texture(vTexture, vTexCoord).r);
+#endif
+    float Y = y - COLOR_CONVERSION[3][0]; // Y_OFFSET stored in 4th row
+    float U = uv.x - UV_OFFSET;
+    float V = uv.y - UV_OFFSET;
+    vec3 rgb = saturate(mat3(COLOR_CONVERSION) * vec3(Y, U, V));
+    fragColor = vec4(rgb, 1.0);
+}
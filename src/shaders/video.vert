@@ -7,9 +7,10 @@ layout(location = 0) out vec2 vTexCoord;
 
 layout(std140, binding = 3) uniform UBuf {
     mat4 u_mvp;
+    vec4 u_uvRect; // xy: 显示区域左上角，zw: 宽高（纹理的归一化坐标）
 };
 
 void main() {
     gl_Position = u_mvp * vec4(position, 0.0, 1.0);
-    vTexCoord = texCoord;
+    vTexCoord = u_uvRect.xy + texCoord * u_uvRect.zw;
 }
\ No newline at end of file
@@ -14,6 +14,7 @@ CentralWidget::CentralWidget(QWidget* parent)
     m_layout->setContentsMargins(0, 0, 0, 0);
 
     m_videoRenderer = new VideoRenderer(this);
+    connect(m_videoRenderer, &VideoRenderer::framePresented, this, &CentralWidget::framePresented);
     m_layout->addWidget(m_videoRenderer);
 
     setLayout(m_layout);
@@ -22,4 +23,31 @@ void CentralWidget::renderFrame(codec::FramePtr&& frame) const
 {
     m_videoRenderer->renderFrame(std::move(frame));
 }
+void CentralWidget::setPresentationConfig(const PresentationScheduler::Config& config) const
+{
+    m_videoRenderer->setPresentationConfig(config);
+}
+PresentationScheduler::Stats CentralWidget::presentationStats() const
+{
+    return m_videoRenderer->presentationStats();
+}
+void CentralWidget::setCursorOverlay(CursorOverlay::Style style) const
+{
+    m_videoRenderer->setCursorOverlay(style);
+}
+void CentralWidget::setScaler(Scaler scaler) const
+{
+    m_videoRenderer->setScaler(scaler);
+}
+void CentralWidget::setRegionOfInterest(const QRectF& region) const
+{
+    m_videoRenderer->setRegionOfInterest(region);
+}
+void CentralWidget::setInputSink(input::InputSink* sink) const
+{
+    m_videoRenderer->setInputSink(sink);
+    if (sink) {
+        m_videoRenderer->setFocus();
+    }
+}
 } // namespace view
\ No newline at end of file
@@ -5,6 +5,10 @@
 #pragma once
 #include <QWidget>
 #include "../codec/Frame.h"
+#include "PresentationScheduler.h"
+#include "CursorOverlay.h"
+#include "Scaler.h"
+#include "../input/InputEvent.h"
 
 #include <QBoxLayout>
 
@@ -17,6 +21,15 @@ public:
     ~CentralWidget() override = default;
 
     void renderFrame(codec::FramePtr&& frame) const;
+    void setPresentationConfig(const PresentationScheduler::Config& config) const;
+    PresentationScheduler::Stats presentationStats() const;
+    void setInputSink(input::InputSink* sink) const;
+    void setCursorOverlay(CursorOverlay::Style style) const;
+    void setScaler(Scaler scaler) const;
+    void setRegionOfInterest(const QRectF& region) const;
+
+signals:
+    void framePresented(qint64 pts);
 
 private:
     QBoxLayout* m_layout{nullptr};
@@ -20,10 +20,15 @@ ControlDock::ControlDock(QWidget* parent)
     m_backButton = new QPushButton("Back", m_content);
     m_backButton->setMinimumSize({80, 40});
     m_layout->addWidget(m_backButton);
+    // 不抢占画面的焦点，否则按下后键位映射会收到失焦
+    m_backButton->setFocusPolicy(Qt::NoFocus);
+    connect(m_backButton, &QPushButton::clicked, this, &ControlDock::backClicked);
 
     m_homeButton = new QPushButton("Home", m_content);
     m_homeButton->setMinimumSize({80, 40});
     m_layout->addWidget(m_homeButton);
+    m_homeButton->setFocusPolicy(Qt::NoFocus);
+    connect(m_homeButton, &QPushButton::clicked, this, &ControlDock::homeClicked);
 
     m_toggleButton = new QPushButton("Toggle Position", m_content);
     m_toggleButton->setMinimumSize({80, 40});
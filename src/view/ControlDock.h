@@ -17,6 +17,10 @@ public:
     explicit ControlDock(QWidget* parent = nullptr);
     ~ControlDock() override = default;
 
+signals:
+    void backClicked();
+    void homeClicked();
+
 private:
     QWidget* m_content{nullptr};
     QBoxLayout* m_layout{nullptr};
@@ -0,0 +1,105 @@
+//
+// Created by neapu on 2025/12/16.
+//
+
+#include "CursorOverlay.h"
+#include "Uniforms.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstring>
+
+namespace view {
+// mat4 + 3 个 vec4
+constexpr quint32 OVERLAY_UBUF_SIZE = 112;
+// 线宽、准星中心留空和抗锯齿宽度，相对叠加层的半边长
+constexpr float LINE_WIDTH = 0.12f;
+constexpr float CROSSHAIR_GAP = 0.3f;
+// 白色半透明，在深浅画面上都可辨认
+constexpr float OVERLAY_COLOR[4] = {1.0f, 1.0f, 1.0f, 0.85f};
+
+CursorOverlay::CursorOverlay(QRhi* rhi, QRhiRenderPassDescriptor* renderPassDesc, const QShader& vs, const QShader& fs)
+{
+    FUNC_TRACE;
+    m_uBuffer.reset(rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, OVERLAY_UBUF_SIZE));
+    if (!m_uBuffer->create()) {
+        LOGE("Failed to create overlay uniform buffer");
+        throw std::runtime_error("Failed to create overlay uniform buffer");
+    }
+
+    m_srb.reset(rhi->newShaderResourceBindings());
+    m_srb->setBindings({
+        QRhiShaderResourceBinding::uniformBuffer(0, QRhiShaderResourceBinding::VertexStage | QRhiShaderResourceBinding::FragmentStage, m_uBuffer.get()),
+    });
+    if (!m_srb->create()) {
+        LOGE("Failed to create overlay shader resource bindings");
+        throw std::runtime_error("Failed to create overlay shader resource bindings");
+    }
+
+    QRhiVertexInputLayout inputLayout{};
+    inputLayout.setBindings({ sizeof(float) * 4 });
+    inputLayout.setAttributes({
+        { 0, 0, QRhiVertexInputAttribute::Float2, 0 },
+        { 0, 1, QRhiVertexInputAttribute::Float2, sizeof(float) * 2 },
+    });
+
+    // 着色器输出预乘 alpha
+    QRhiGraphicsPipeline::TargetBlend blend;
+    blend.enable = true;
+    blend.srcColor = QRhiGraphicsPipeline::One;
+    blend.dstColor = QRhiGraphicsPipeline::OneMinusSrcAlpha;
+    blend.srcAlpha = QRhiGraphicsPipeline::One;
+    blend.dstAlpha = QRhiGraphicsPipeline::OneMinusSrcAlpha;
+
+    m_pipeline.reset(rhi->newGraphicsPipeline());
+    m_pipeline->setShaderStages({
+        { QRhiShaderStage::Vertex, vs },
+        { QRhiShaderStage::Fragment, fs },
+    });
+    m_pipeline->setVertexInputLayout(inputLayout);
+    m_pipeline->setTopology(QRhiGraphicsPipeline::TriangleStrip);
+    m_pipeline->setTargetBlends({ blend });
+    m_pipeline->setShaderResourceBindings(m_srb.get());
+    m_pipeline->setRenderPassDescriptor(renderPassDesc);
+    if (!m_pipeline->create()) {
+        LOGE("Failed to create overlay pipeline");
+        throw std::runtime_error("Failed to create overlay pipeline");
+    }
+}
+void CursorOverlay::update(QRhiResourceUpdateBatch* rub, const QSize& renderSize, const QSize& frameSize,
+                           const QPointF& position, float sizePx) const
+{
+    const QMatrix4x4 mvp = Uniforms::letterboxMatrix(renderSize, frameSize);
+    // 画面在窗口中实际占据的像素尺寸，用于把像素大小换算为画面的 NDC
+    const float videoWidthPx = static_cast<float>(renderSize.width()) * mvp(0, 0);
+    const float videoHeightPx = static_cast<float>(renderSize.height()) * mvp(1, 1);
+    if (videoWidthPx <= 0.0f || videoHeightPx <= 0.0f) {
+        return;
+    }
+
+    float data[OVERLAY_UBUF_SIZE / sizeof(float)];
+    std::memcpy(data, mvp.constData(), 64);
+    // 归一化坐标的 y 向下，NDC 的 y 向上
+    data[16] = static_cast<float>(position.x()) * 2.0f - 1.0f;
+    data[17] = 1.0f - static_cast<float>(position.y()) * 2.0f;
+    data[18] = sizePx / videoWidthPx;
+    data[19] = sizePx / videoHeightPx;
+    std::memcpy(data + 20, OVERLAY_COLOR, sizeof(OVERLAY_COLOR));
+    data[24] = m_style == Style::Cursor ? 0.0f : 1.0f;
+    data[25] = LINE_WIDTH;
+    data[26] = CROSSHAIR_GAP;
+    // 约一个像素的抗锯齿过渡
+    data[27] = 2.0f / std::max(sizePx, 1.0f);
+    rub->updateDynamicBuffer(m_uBuffer.get(), 0, OVERLAY_UBUF_SIZE, data);
+}
+void CursorOverlay::draw(QRhiCommandBuffer* cb, QRhiBuffer* quadBuffer) const
+{
+    if (m_style == Style::None) {
+        return;
+    }
+    cb->setGraphicsPipeline(m_pipeline.get());
+    cb->setShaderResources(m_srb.get());
+    const QRhiCommandBuffer::VertexInput vertexInput[] = { { quadBuffer, 0 } };
+    cb->setVertexInput(0, 1, vertexInput);
+    cb->draw(4);
+}
+} // namespace view
@@ -0,0 +1,38 @@
+//
+// Created by neapu on 2025/12/16.
+//
+
+#pragma once
+#include <rhi/qrhi.h>
+#include <QPointF>
+
+namespace view {
+// 本地光标/准星叠加层：跟随本机输入立即更新，不等待设备画面的往返。
+// 与视频在同一个渲染 pass 中绘制，使用同一个 letterbox 变换，只多一个四边形。
+class CursorOverlay {
+public:
+    enum class Style {
+        None,
+        Cursor,
+        Crosshair,
+    };
+
+    // 复用视频的四边形顶点缓冲区（位置 + 纹理坐标，位置范围 [-1, 1]）
+    CursorOverlay(QRhi* rhi, QRhiRenderPassDescriptor* renderPassDesc, const QShader& vs, const QShader& fs);
+    ~CursorOverlay() = default;
+
+    void setStyle(Style style) { m_style = style; }
+    Style style() const { return m_style; }
+
+    // position 为视频画面内的归一化坐标，sizePx 为叠加层的边长（像素）
+    void update(QRhiResourceUpdateBatch* rub, const QSize& renderSize, const QSize& frameSize, const QPointF& position,
+                float sizePx) const;
+    void draw(QRhiCommandBuffer* cb, QRhiBuffer* quadBuffer) const;
+
+private:
+    Style m_style{Style::Crosshair};
+    std::unique_ptr<QRhiBuffer> m_uBuffer{};
+    std::unique_ptr<QRhiShaderResourceBindings> m_srb{};
+    std::unique_ptr<QRhiGraphicsPipeline> m_pipeline{};
+};
+} // namespace view
@@ -5,14 +5,18 @@
 #include "DeviceWindow.h"
 #include "CentralWidget.h"
 #include "ControlDock.h"
+#include <QEvent>
 
 namespace view {
 DeviceWindow::DeviceWindow()
     : QMainWindow(nullptr)
 {
     m_centralWidget = new CentralWidget(this);
+    connect(m_centralWidget, &CentralWidget::framePresented, this, &DeviceWindow::framePresented);
     setCentralWidget(m_centralWidget);
     auto* controlDock = new ControlDock(this);
+    connect(controlDock, &ControlDock::backClicked, this, &DeviceWindow::backRequested);
+    connect(controlDock, &ControlDock::homeClicked, this, &DeviceWindow::homeRequested);
     addDockWidget(Qt::RightDockWidgetArea, controlDock);
     resize({800, 600});
 }
@@ -20,9 +24,40 @@ void DeviceWindow::renderFrame(codec::FramePtr&& frame) const
 {
     m_centralWidget->renderFrame(std::move(frame));
 }
+void DeviceWindow::setPresentationConfig(const PresentationScheduler::Config& config) const
+{
+    m_centralWidget->setPresentationConfig(config);
+}
+PresentationScheduler::Stats DeviceWindow::presentationStats() const
+{
+    return m_centralWidget->presentationStats();
+}
+void DeviceWindow::setCursorOverlay(CursorOverlay::Style style) const
+{
+    m_centralWidget->setCursorOverlay(style);
+}
+void DeviceWindow::setScaler(Scaler scaler) const
+{
+    m_centralWidget->setScaler(scaler);
+}
+void DeviceWindow::setRegionOfInterest(const QRectF& region) const
+{
+    m_centralWidget->setRegionOfInterest(region);
+}
+void DeviceWindow::setInputSink(input::InputSink* sink) const
+{
+    m_centralWidget->setInputSink(sink);
+}
 void DeviceWindow::closeEvent(QCloseEvent* event)
 {
     QMainWindow::closeEvent(event);
     emit windowClosed();
 }
+void DeviceWindow::changeEvent(QEvent* event)
+{
+    QMainWindow::changeEvent(event);
+    if (event->type() == QEvent::ActivationChange && isActiveWindow()) {
+        emit activated();
+    }
+}
 } // namespace view
\ No newline at end of file
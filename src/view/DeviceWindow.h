@@ -5,6 +5,9 @@
 #pragma once
 #include <QMainWindow>
 #include "../codec/Frame.h"
+#include "PresentationScheduler.h"
+#include "CursorOverlay.h"
+#include "Scaler.h"
 
 namespace view {
 class CentralWidget;
@@ -15,12 +18,24 @@ public:
     ~DeviceWindow() override = default;
 
     void renderFrame(codec::FramePtr&& frame) const;
+    void setPresentationConfig(const PresentationScheduler::Config& config) const;
+    PresentationScheduler::Stats presentationStats() const;
+    void setInputSink(input::InputSink* sink) const;
+    void setCursorOverlay(CursorOverlay::Style style) const;
+    void setScaler(Scaler scaler) const;
+    void setRegionOfInterest(const QRectF& region) const;
 
 signals:
     void windowClosed();
+    // 窗口成为活动窗口
+    void activated();
+    void framePresented(qint64 pts);
+    void backRequested();
+    void homeRequested();
 
 protected:
     void closeEvent(QCloseEvent* event) override;
+    void changeEvent(QEvent* event) override;
 
 private:
     CentralWidget* m_centralWidget{nullptr};
@@ -0,0 +1,170 @@
+//
+// Created by neapu on 2025/12/15.
+//
+
+#include "PresentationScheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace view {
+constexpr double FRAME_INTERVAL_SMOOTHING = 1.0 / 16;
+// 超过1.5个帧间隔仍未显示新帧才算重复，容忍刷新与帧率不整除的情况
+constexpr double REPEAT_THRESHOLD_INTERVALS = 1.5;
+// 最后一帧到达后继续调度的帧间隔数，用于统计卡顿期间的重复
+constexpr double ACTIVE_INTERVALS = 3.0;
+
+PresentationScheduler::PresentationScheduler(const Config& config)
+    : m_config(config)
+{
+}
+void PresentationScheduler::setConfig(const Config& config)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+}
+void PresentationScheduler::push(codec::FramePtr&& frame, int64_t arrivalUs)
+{
+    if (!frame) {
+        return;
+    }
+    const int64_t pts = frame->pts();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    pushLocked({pts, arrivalUs, std::move(frame)});
+}
+void PresentationScheduler::pushLocked(Entry&& entry)
+{
+    if (entry.pts >= 0) {
+        if (m_lastPts >= 0 && entry.pts > m_lastPts) {
+            const auto interval = static_cast<double>(entry.pts - m_lastPts);
+            m_frameIntervalUs = m_frameIntervalUs > 0.0
+                ? m_frameIntervalUs + (interval - m_frameIntervalUs) * FRAME_INTERVAL_SMOOTHING
+                : interval;
+        }
+        m_lastPts = entry.pts;
+    }
+    m_lastArrivalUs = entry.arrivalUs;
+
+    while (m_queue.size() >= m_config.maxQueuedFrames) {
+        m_queue.pop_front();
+        ++m_stats.skipped;
+    }
+    m_queue.push_back(std::move(entry));
+}
+codec::FramePtr PresentationScheduler::pick(int64_t refreshUs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry picked{};
+    if (!pickLocked(refreshUs, picked)) {
+        return nullptr;
+    }
+    return std::move(picked.frame);
+}
+bool PresentationScheduler::pickLocked(int64_t refreshUs, Entry& picked)
+{
+    const codec::MediaClock* clock = m_config.clock && m_config.clock->valid() ? m_config.clock : nullptr;
+    // 队列按到达顺序排列，取最后一个已到呈现时刻的帧
+    size_t dueCount = 0;
+    for (const auto& entry : m_queue) {
+        if (dueTimeLocked(entry) > refreshUs) {
+            break;
+        }
+        ++dueCount;
+    }
+
+    if (dueCount == 0) {
+        if (m_lastShownPts >= 0 && m_frameIntervalUs > 0.0 && clock) {
+            // 以上一帧的映射反推此刻应显示的内容PTS
+            const int64_t offsetUs = clock->presentationTimeUs(m_lastShownPts) - m_lastShownPts;
+            const int64_t expectedPts = refreshUs - offsetUs;
+            if (static_cast<double>(expectedPts - m_lastShownPts) >= m_frameIntervalUs * REPEAT_THRESHOLD_INTERVALS) {
+                ++m_stats.repeated;
+            }
+        }
+        return false;
+    }
+
+    m_stats.skipped += dueCount - 1;
+    m_queue.erase(m_queue.begin(), m_queue.begin() + static_cast<std::ptrdiff_t>(dueCount - 1));
+    picked = std::move(m_queue.front());
+    m_queue.pop_front();
+    ++m_stats.shown;
+
+    if (picked.pts >= 0) {
+        m_lastShownPts = picked.pts;
+    }
+    if (picked.pts >= 0 && clock) {
+        // Welford算法累计呈现延迟的均值和方差
+        const auto latency = static_cast<double>(refreshUs - clock->toLocalUs(picked.pts));
+        ++m_latencySamples;
+        const double delta = latency - m_stats.latencyMeanUs;
+        m_stats.latencyMeanUs += delta / static_cast<double>(m_latencySamples);
+        m_latencyM2 += delta * (latency - m_stats.latencyMeanUs);
+    }
+    return true;
+}
+bool PresentationScheduler::wantsRefresh(int64_t nowUs) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_queue.empty()) {
+        return true;
+    }
+    return m_frameIntervalUs > 0.0 && static_cast<double>(nowUs - m_lastArrivalUs) < m_frameIntervalUs * ACTIVE_INTERVALS;
+}
+int64_t PresentationScheduler::dueTimeLocked(const Entry& entry) const
+{
+    if (entry.pts < 0 || !m_config.clock || !m_config.clock->valid()) {
+        return entry.arrivalUs;
+    }
+    // 解码晚于呈现时刻的帧在下一次刷新显示，由此产生的音视频偏差由音频按 reportSkew 修正
+    return m_config.clock->presentationTimeUs(entry.pts);
+}
+PresentationScheduler::Stats PresentationScheduler::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    if (m_config.clock) {
+        stats.delayUs = m_config.clock->presentationDelayUs();
+        stats.jitterUs = m_config.clock->jitterUs();
+    }
+    stats.latencyStdDevUs = m_latencySamples > 1 ? std::sqrt(m_latencyM2 / static_cast<double>(m_latencySamples - 1)) : 0.0;
+    return stats;
+}
+void PresentationScheduler::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.clear();
+    m_lastPts = -1;
+    m_lastArrivalUs = 0;
+    m_frameIntervalUs = 0.0;
+    m_lastShownPts = -1;
+    m_stats = {};
+    m_latencySamples = 0;
+    m_latencyM2 = 0.0;
+}
+PresentationScheduler::Stats PresentationScheduler::benchmark(const std::vector<TracePoint>& trace, double refreshHz,
+                                                             codec::MediaClock::SyncMode mode)
+{
+    if (trace.empty() || refreshHz <= 0.0) {
+        return {};
+    }
+    codec::MediaClock clock(mode);
+    Config config;
+    config.clock = &clock;
+    PresentationScheduler scheduler(config);
+    const auto refreshIntervalUs = static_cast<int64_t>(1e6 / refreshHz);
+    const int64_t endUs = trace.back().arrivalUs + codec::MediaClock::MAX_PRESENTATION_DELAY_US + refreshIntervalUs;
+    size_t next = 0;
+    Entry picked{};
+    // 回放不涉及其他线程，直接调用内部实现
+    for (int64_t refreshUs = trace.front().arrivalUs; refreshUs <= endUs; refreshUs += refreshIntervalUs) {
+        while (next < trace.size() && trace[next].arrivalUs <= refreshUs) {
+            clock.update(trace[next].pts, trace[next].arrivalUs);
+            scheduler.pushLocked({trace[next].pts, trace[next].arrivalUs, nullptr});
+            ++next;
+        }
+        scheduler.pickLocked(refreshUs, picked);
+    }
+    return scheduler.stats();
+}
+} // namespace view
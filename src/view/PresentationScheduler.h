@@ -0,0 +1,82 @@
+//
+// Created by neapu on 2025/12/15.
+//
+
+#pragma once
+#include "../codec/Frame.h"
+#include "../codec/MediaClock.h"
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace view {
+// 呈现调度：在每次显示刷新时决定显示哪一帧。帧的呈现时刻取自会话主时钟，与音频对准同一时刻；
+// 呈现延迟由时钟的同步模式决定（LatencyFirst 为0，Smooth 随抖动自适应）。
+// 已到呈现时刻的帧中只显示最新的一帧，其余计为跳过；应有新帧却没有时计为重复。
+class PresentationScheduler {
+public:
+    struct Config {
+        // 会话主时钟，由会话按收到的数据包更新，生命周期长于调度器。为空时帧到达即呈现
+        const codec::MediaClock* clock{nullptr};
+        // 队列上限，超出时丢弃最旧的帧
+        size_t maxQueuedFrames{8};
+    };
+    struct Stats {
+        uint64_t shown{0};
+        uint64_t skipped{0};
+        uint64_t repeated{0};
+        int64_t delayUs{0};
+        int64_t jitterUs{0};
+        // 从到达时钟映射到实际呈现的延迟，标准差即抖动造成的judder
+        double latencyMeanUs{0.0};
+        double latencyStdDevUs{0.0};
+    };
+    struct TracePoint {
+        int64_t pts;
+        int64_t arrivalUs;
+    };
+
+    PresentationScheduler() = default;
+    explicit PresentationScheduler(const Config& config);
+    ~PresentationScheduler() = default;
+
+    void setConfig(const Config& config);
+
+    void push(codec::FramePtr&& frame, int64_t arrivalUs = codec::MediaClock::nowUs());
+    // 每次刷新调用，返回本次应显示的新帧，没有时返回空，继续显示上一帧
+    codec::FramePtr pick(int64_t refreshUs = codec::MediaClock::nowUs());
+    // 有待显示的帧，或者流仍在活动、需要继续按刷新节奏调度
+    bool wantsRefresh(int64_t nowUs = codec::MediaClock::nowUs()) const;
+
+    Stats stats() const;
+    void reset();
+
+    // 以给定刷新率回放到达序列，返回调度统计。回放时用序列本身更新一个给定模式的时钟，
+    // 相当于数据包到达后立即解码完成
+    static Stats benchmark(const std::vector<TracePoint>& trace, double refreshHz, codec::MediaClock::SyncMode mode);
+
+private:
+    struct Entry {
+        int64_t pts;
+        int64_t arrivalUs;
+        codec::FramePtr frame;
+    };
+    void pushLocked(Entry&& entry);
+    bool pickLocked(int64_t refreshUs, Entry& picked);
+    int64_t dueTimeLocked(const Entry& entry) const;
+
+private:
+    mutable std::mutex m_mutex;
+    Config m_config;
+    std::deque<Entry> m_queue;
+
+    int64_t m_lastPts{-1};
+    int64_t m_lastArrivalUs{0};
+    double m_frameIntervalUs{0.0};
+    int64_t m_lastShownPts{-1};
+
+    Stats m_stats;
+    uint64_t m_latencySamples{0};
+    double m_latencyM2{0.0};
+};
+} // namespace view
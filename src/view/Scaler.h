@@ -0,0 +1,40 @@
+//
+// Created by neapu on 2025/12/16.
+//
+
+#pragma once
+#include <QString>
+
+namespace view {
+// 视频放大显示时亮度使用的滤波算法，缩小显示时统一使用双线性
+enum class Scaler {
+    Bilinear,
+    // Catmull-Rom，9 次采样
+    Bicubic,
+    // Lanczos-2，16 次采样
+    Lanczos,
+    // Catmull-Rom + 防振铃限制 + 对比度自适应锐化，14 次采样
+    Sharp,
+};
+
+inline const char* scalerName(Scaler scaler)
+{
+    switch (scaler) {
+    case Scaler::Bicubic: return "bicubic";
+    case Scaler::Lanczos: return "lanczos";
+    case Scaler::Sharp: return "sharp";
+    default: return "bilinear";
+    }
+}
+
+// 格式对应的片段着色器，双线性使用原始的着色器，其余为 CMake 生成的变体
+inline QString fragmentShaderName(const QString& format, Scaler scaler)
+{
+    switch (scaler) {
+    case Scaler::Bicubic: return QString(":/shaders/%1_bicubic.frag.qsb").arg(format);
+    case Scaler::Lanczos: return QString(":/shaders/%1_lanczos.frag.qsb").arg(format);
+    case Scaler::Sharp: return QString(":/shaders/%1_sharp.frag.qsb").arg(format);
+    default: return QString(":/shaders/%1.frag.qsb").arg(format);
+    }
+}
+} // namespace view
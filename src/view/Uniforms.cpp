@@ -4,11 +4,17 @@
 
 #include "Uniforms.h"
 #include "logger.h"
+#include "../codec/ColorMatrix.h"
+#include <algorithm>
+#include <cstring>
 
 namespace view {
+// mat4 u_mvp + vec4 u_uvRect
+constexpr quint32 VS_UBUF_SIZE = 80;
+
 Uniforms::Uniforms(QRhi* rhi)
 {
-    m_vsUBuffer.reset(rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, 64));
+    m_vsUBuffer.reset(rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, VS_UBUF_SIZE));
     if (!m_vsUBuffer->create()) {
         LOGE("Failed to create vertex shader uniform buffer");
         throw std::runtime_error("Failed to create vertex shader uniform buffer");
@@ -19,8 +25,14 @@ Uniforms::Uniforms(QRhi* rhi)
         LOGE("Failed to create color params uniform buffer");
         throw std::runtime_error("Failed to create color params uniform buffer");
     }
+
+    m_scaleParamsUBuffer.reset(rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, 32));
+    if (!m_scaleParamsUBuffer->create()) {
+        LOGE("Failed to create scale params uniform buffer");
+        throw std::runtime_error("Failed to create scale params uniform buffer");
+    }
 }
-void Uniforms::updateVsUniforms(QRhiResourceUpdateBatch* rub, const QSize& renderSize, const QSize& frameSize) const
+QMatrix4x4 Uniforms::letterboxMatrix(const QSize& renderSize, const QSize& frameSize)
 {
     QMatrix4x4 vertexMatrix;
     vertexMatrix.setToIdentity();
@@ -49,68 +61,49 @@ void Uniforms::updateVsUniforms(QRhiResourceUpdateBatch* rub, const QSize& rende
 
     // NEAPU_LOGD("Update mvp matrix. scaleX={}, scaleY={}", scaleX, scaleY);
     vertexMatrix.scale(scaleX, scaleY);
-
-    rub->updateDynamicBuffer(m_vsUBuffer.get(), 0, 64, vertexMatrix.constData());
+    return vertexMatrix;
+}
+QSize Uniforms::regionSize(const QSize& frameSize, const QRectF& uvRect)
+{
+    return {std::max(1, qRound(frameSize.width() * uvRect.width())), std::max(1, qRound(frameSize.height() * uvRect.height()))};
+}
+void Uniforms::updateVsUniforms(QRhiResourceUpdateBatch* rub, const QSize& renderSize, const QSize& frameSize,
+                                const QRectF& uvRect) const
+{
+    // 按显示区域的宽高比做 letterbox，区域放大后铺满窗口
+    const QMatrix4x4 vertexMatrix = letterboxMatrix(renderSize, regionSize(frameSize, uvRect));
+    float data[VS_UBUF_SIZE / sizeof(float)];
+    std::memcpy(data, vertexMatrix.constData(), 64);
+    data[16] = static_cast<float>(uvRect.x());
+    data[17] = static_cast<float>(uvRect.y());
+    data[18] = static_cast<float>(uvRect.width());
+    data[19] = static_cast<float>(uvRect.height());
+    rub->updateDynamicBuffer(m_vsUBuffer.get(), 0, VS_UBUF_SIZE, data);
 }
 void Uniforms::updateColorParamsUniforms(QRhiResourceUpdateBatch* rub, codec::Frame::ColorSpace colorSpace,
                                          codec::Frame::ColorRange colorRange) const
 {
-    float yOffset = 0.0f;
-    if (colorRange == codec::Frame::ColorRange::Limited) {
-        yOffset = 16.0f / 255.0f;
+    // 系数与 CPU 转换共用
+    const auto matrix = codec::ColorMatrix::forFrame(colorSpace, colorRange);
+    const QMatrix4x4 colorMatrix(
+        matrix.m[0], matrix.m[1], matrix.m[2], 0.0f,
+        matrix.m[3], matrix.m[4], matrix.m[5], 0.0f,
+        matrix.m[6], matrix.m[7], matrix.m[8], 0.0f,
+        matrix.yOffset, 0.0f,     0.0f,        1.0f
+    );
+    rub->updateDynamicBuffer(m_colorParamsUBuffer.get(), 0, 64, colorMatrix.constData());
+}
+void Uniforms::updateScaleParamsUniforms(QRhiResourceUpdateBatch* rub, const QSize& textureSize, float sharpness) const
+{
+    if (textureSize.isEmpty()) {
+        return;
     }
-
-    constexpr float bt601Limited[9] = {
-        1.164f,  0.0f,    1.596f,
-        1.164f, -0.391f, -0.813f,
-        1.164f,  2.018f,  0.0f
-    };
-    constexpr float bt601Full[9] = {
-        1.0f,  0.0f,    1.402f,
-        1.0f, -0.344f, -0.714f,
-        1.0f,  1.772f,  0.0f
-    };
-    constexpr float bt709Limited[9] = {
-        1.164f,  0.0f,    1.793f,
-        1.164f, -0.213f, -0.533f,
-        1.164f,  2.112f,  0.0f
+    const float w = static_cast<float>(textureSize.width());
+    const float h = static_cast<float>(textureSize.height());
+    const float params[8] = {
+        1.0f / w, 1.0f / h, w, h,
+        sharpness, 0.0f, 0.0f, 0.0f,
     };
-    constexpr float bt709Full[9] = {
-        1.0f,  0.0f,    1.574f,
-        1.0f, -0.187f, -0.468f,
-        1.0f,  1.855f,  0.0f
-    };
-
-    QMatrix4x4 colorMatrix;
-    if (colorSpace == codec::Frame::ColorSpace::BT709 && colorRange == codec::Frame::ColorRange::Limited) {
-        colorMatrix = QMatrix4x4(
-            bt709Limited[0], bt709Limited[1], bt709Limited[2], 0.0f,
-            bt709Limited[3], bt709Limited[4], bt709Limited[5], 0.0f,
-            bt709Limited[6], bt709Limited[7], bt709Limited[8], 0.0f,
-            yOffset,           0.0f,           0.0f,           1.0f
-        );
-    } else if (colorSpace == codec::Frame::ColorSpace::BT709 && colorRange == codec::Frame::ColorRange::Full) {
-        colorMatrix = QMatrix4x4(
-            bt709Full[0], bt709Full[1], bt709Full[2], 0.0f,
-            bt709Full[3], bt709Full[4], bt709Full[5], 0.0f,
-            bt709Full[6], bt709Full[7], bt709Full[8], 0.0f,
-            yOffset,        0.0f,        0.0f,        1.0f
-        );
-    } else if (colorSpace == codec::Frame::ColorSpace::BT601 && colorRange == codec::Frame::ColorRange::Limited) {
-        colorMatrix = QMatrix4x4(
-            bt601Limited[0], bt601Limited[1], bt601Limited[2], 0.0f,
-            bt601Limited[3], bt601Limited[4], bt601Limited[5], 0.0f,
-            bt601Limited[6], bt601Limited[7], bt601Limited[8], 0.0f,
-            yOffset,           0.0f,           0.0f,           1.0f
-        );
-    } else { // BT601 Full
-        colorMatrix = QMatrix4x4(
-            bt601Full[0], bt601Full[1], bt601Full[2], 0.0f,
-            bt601Full[3], bt601Full[4], bt601Full[5], 0.0f,
-            bt601Full[6], bt601Full[7], bt601Full[8], 0.0f,
-            yOffset,        0.0f,        0.0f,        1.0f
-        );
-    }
-    rub->updateDynamicBuffer(m_colorParamsUBuffer.get(), 0, 64, colorMatrix.constData());
+    rub->updateDynamicBuffer(m_scaleParamsUBuffer.get(), 0, sizeof(params), params);
 }
 } // namespace view
\ No newline at end of file
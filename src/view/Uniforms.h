@@ -4,6 +4,8 @@
 
 #pragma once
 #include <rhi/qrhi.h>
+#include <QMatrix4x4>
+#include <QRectF>
 #include "../codec/Frame.h"
 
 namespace view {
@@ -15,13 +17,23 @@ public:
 
     QRhiBuffer* vsUBuffer() const { return m_vsUBuffer.get(); }
     QRhiBuffer* colorParamsUBuffer() const { return m_colorParamsUBuffer.get(); }
+    QRhiBuffer* scaleParamsUBuffer() const { return m_scaleParamsUBuffer.get(); }
 
-    void updateVsUniforms(QRhiResourceUpdateBatch* rub, const QSize& renderSize, const QSize& frameSize) const;
+    // 保持宽高比居中显示的顶点变换，叠加层使用同一变换与画面对齐
+    static QMatrix4x4 letterboxMatrix(const QSize& renderSize, const QSize& frameSize);
+    // uvRect 为显示的画面区域（归一化坐标），只改变采样坐标，不复制纹理
+    void updateVsUniforms(QRhiResourceUpdateBatch* rub, const QSize& renderSize, const QSize& frameSize,
+                          const QRectF& uvRect = QRectF(0.0, 0.0, 1.0, 1.0)) const;
+    // 区域在帧中的像素尺寸，至少为 1x1
+    static QSize regionSize(const QSize& frameSize, const QRectF& uvRect);
     void updateColorParamsUniforms(QRhiResourceUpdateBatch* rub, codec::Frame::ColorSpace colorSpace, codec::Frame::ColorRange colorRange) const;
+    // 缩放着色器需要的纹素尺寸和锐化强度
+    void updateScaleParamsUniforms(QRhiResourceUpdateBatch* rub, const QSize& textureSize, float sharpness) const;
 
 private:
     std::unique_ptr<QRhiBuffer> m_vsUBuffer{};
     std::unique_ptr<QRhiBuffer> m_colorParamsUBuffer{};
+    std::unique_ptr<QRhiBuffer> m_scaleParamsUBuffer{};
 };
 
 } // namespace view
@@ -19,8 +19,9 @@ static PFNEGLDESTROYIMAGEKHRPROC s_eglDestroyImageKHR = (PFNEGLDESTROYIMAGEKHRPR
 static PFNGLEGLIMAGETARGETTEXTURE2DOESPROC s_glEGLImageTargetTexture2DOES = (PFNGLEGLIMAGETARGETTEXTURE2DOESPROC)eglGetProcAddress("glEGLImageTargetTexture2DOES");
 
 namespace view {
-VaapiTexturesSrb::VaapiTexturesSrb(QRhi* rhi, Uniforms* uniforms, const codec::FramePtr& frame)
+VaapiTexturesSrb::VaapiTexturesSrb(QRhi* rhi, Uniforms* uniforms, const codec::FramePtr& frame, Scaler scaler)
     : m_rhi(rhi)
+    , m_scaler(scaler)
     , m_vaDisplay(frame->vaDisplay())
     , m_width(frame->width())
     , m_height(frame->height())
@@ -77,6 +78,7 @@ VaapiTexturesSrb::VaapiTexturesSrb(QRhi* rhi, Uniforms* uniforms, const codec::F
         QRhiShaderResourceBinding::sampledTexture(1, QRhiShaderResourceBinding::FragmentStage, m_uvTexture.get(), m_sampler.get()),
         QRhiShaderResourceBinding::uniformBuffer(3, QRhiShaderResourceBinding::VertexStage, m_uniforms->vsUBuffer()),
         QRhiShaderResourceBinding::uniformBuffer(4, QRhiShaderResourceBinding::FragmentStage, m_uniforms->colorParamsUBuffer()),
+        QRhiShaderResourceBinding::uniformBuffer(5, QRhiShaderResourceBinding::FragmentStage, m_uniforms->scaleParamsUBuffer()),
     });
     if (!m_srb->create()) {
         LOGE("Failed to create shader resource bindings");
@@ -90,9 +92,9 @@ VaapiTexturesSrb::~VaapiTexturesSrb()
     FUNC_TRACE;
 }
 
-QString VaapiTexturesSrb::getFragmentShaderName()
+QString VaapiTexturesSrb::getFragmentShaderName() const
 {
-    return ":/shaders/nv12.frag.qsb";
+    return fragmentShaderName("nv12", m_scaler);
 }
 void VaapiTexturesSrb::updateTexture(QRhiResourceUpdateBatch* rub, const codec::FramePtr& frame)
 {
@@ -7,6 +7,7 @@
 #include <rhi/qrhi.h>
 #include "../codec/Frame.h"
 #include "Uniforms.h"
+#include "Scaler.h"
 
 class QOpenGLFunctions;
 
@@ -14,11 +15,11 @@ namespace view {
 
 class VaapiTexturesSrb {
 public:
-    VaapiTexturesSrb(QRhi* rhi, Uniforms* uniforms, const codec::FramePtr& frame);
+    VaapiTexturesSrb(QRhi* rhi, Uniforms* uniforms, const codec::FramePtr& frame, Scaler scaler = Scaler::Bilinear);
     ~VaapiTexturesSrb();
 
     QRhiShaderResourceBindings* getSrb() const { return m_srb.get(); }
-    static QString getFragmentShaderName() ;
+    QString getFragmentShaderName() const;
     void updateTexture(QRhiResourceUpdateBatch* rub, const codec::FramePtr& frame);
 
 private:
@@ -27,6 +28,7 @@ private:
 
 private:
     QRhi* m_rhi{nullptr};
+    Scaler m_scaler{Scaler::Bilinear};
     QOpenGLFunctions* m_glFuncs{ nullptr };
 
     void* m_vaDisplay{ nullptr };
@@ -7,8 +7,14 @@
 #include "EmptySrb.h"
 #include "YuvTexturesSrb.h"
 #include "VaapiTexturesSrb.h"
+#include "../codec/MediaClock.h"
 
 #include <QFile>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QCursor>
+#include <algorithm>
 
 namespace view {
 static const float vertexData[] = {
@@ -18,6 +24,14 @@ static const float vertexData[] = {
     -1.0f, -1.0f,  0.0f, 1.0f,
      1.0f, -1.0f,  1.0f, 1.0f
 };
+// 叠加层的边长（逻辑像素）
+constexpr float OVERLAY_SIZE = 24.0f;
+// Sharp 缩放的锐化强度
+constexpr float SHARPNESS = 0.5f;
+// 每累计这么多帧输出一次 GPU 耗时
+constexpr uint64_t GPU_TIME_LOG_INTERVAL = 600;
+// 支持时间戳但连续这么多帧都没有结果时，认为窗口的 QRhi 没有启用时间戳
+constexpr uint64_t GPU_TIME_ZERO_WARN_FRAMES = 120;
 QShader loadShader(const QString& name)
 {
     QFile file(name);
@@ -29,7 +43,11 @@ QShader loadShader(const QString& name)
 }
 VideoRenderer::VideoRenderer(QWidget* parent)
     : QRhiWidget(parent)
-{}
+{
+    setFocusPolicy(Qt::StrongFocus);
+    // 视角拖动需要在不按键时也收到鼠标移动
+    setMouseTracking(true);
+}
 void VideoRenderer::initialize(QRhiCommandBuffer* cb)
 {
     if (m_rhi != rhi()) {
@@ -58,6 +76,7 @@ void VideoRenderer::initialize(QRhiCommandBuffer* cb)
         LOGE("Failed to create graphics pipeline");
         return;
     }
+    createOverlay();
 
     auto* rub = m_rhi->nextResourceUpdateBatch();
     rub->uploadStaticBuffer(m_vertexBuffer.get(), vertexData);
@@ -68,10 +87,19 @@ void VideoRenderer::render(QRhiCommandBuffer* cb)
     if (!m_pipeline) {
         return;
     }
+    recordGpuTime(cb->lastCompletedGpuTime());
+
+    if (auto frame = m_scheduler.pick()) {
+        m_currentFrame = std::move(frame);
+        m_textureDirty = true;
+        emit framePresented(m_currentFrame->pts());
+    }
+    // 流仍在活动时按刷新节奏继续调度
+    if (m_scheduler.wantsRefresh()) {
+        update();
+    }
 
-    QMutexLocker locker(&m_frameMutex);
     if (!m_currentFrame) {
-        locker.unlock();
         cb->beginPass(renderTarget(), QColor(0, 0, 0, 255), {1.0f, 0}, nullptr);
         cb->endPass();
         return;
@@ -85,21 +113,30 @@ void VideoRenderer::render(QRhiCommandBuffer* cb)
     //     return;
     // }
 
+    // 只有放大显示时才需要高阶滤波，窗口缩放跨过原始尺寸时切换着色器
+    const QSize frameSize(m_currentFrame->width(), m_currentFrame->height());
+    const QSize regionSize = Uniforms::regionSize(frameSize, m_region);
+    const bool upscaling = renderSize.width() > regionSize.width() || renderSize.height() > regionSize.height();
+    const Scaler scaler = upscaling ? m_scaler : Scaler::Bilinear;
+
     if (m_currentFrame &&
         (m_currentFrame->pixelFormat() != m_oldPixelFormat ||
         m_currentFrame->width() != m_oldWidth ||
-        m_currentFrame->height() != m_oldHeight)) {
+        m_currentFrame->height() != m_oldHeight ||
+        scaler != m_activeScaler)) {
         m_oldPixelFormat = m_currentFrame->pixelFormat();
         m_oldWidth = m_currentFrame->width();
         m_oldHeight = m_currentFrame->height();
+        m_activeScaler = scaler;
         m_uniforms->updateColorParamsUniforms(rub, m_currentFrame->colorSpace(), m_currentFrame->colorRange());
+        m_uniforms->updateScaleParamsUniforms(rub, QSize(m_oldWidth, m_oldHeight), SHARPNESS);
 
         using enum codec::Frame::PixelFormat;
         if (m_currentFrame->pixelFormat() == YUV420P) {
-            m_textureSrbProxy = pro::make_proxy<TextureSrb, YuvTexturesSrb>(m_rhi, m_uniforms.get(), m_currentFrame);
+            m_textureSrbProxy = pro::make_proxy<TextureSrb, YuvTexturesSrb>(m_rhi, m_uniforms.get(), m_currentFrame, scaler);
 #ifdef __linux__
         } else if (m_currentFrame->pixelFormat() == Vaapi) {
-            m_textureSrbProxy = pro::make_proxy<TextureSrb, VaapiTexturesSrb>(m_rhi, m_uniforms.get(), m_currentFrame);
+            m_textureSrbProxy = pro::make_proxy<TextureSrb, VaapiTexturesSrb>(m_rhi, m_uniforms.get(), m_currentFrame, scaler);
 #endif
         } else {
             LOGE("Unsupported frame pixel format: {}", m_currentFrame->rawPixelFormat());
@@ -110,11 +147,20 @@ void VideoRenderer::render(QRhiCommandBuffer* cb)
             rub->release();
             return;
         }
+        m_textureDirty = true;
     }
 
-    m_uniforms->updateVsUniforms(rub, renderSize, QSize(m_currentFrame->width(), m_currentFrame->height()));
-    m_textureSrbProxy->updateTexture(rub, m_currentFrame);
-    locker.unlock();
+    m_uniforms->updateVsUniforms(rub, renderSize, frameSize, m_region);
+    // 重复显示同一帧时纹理内容不变，无需重新上传
+    if (m_textureDirty) {
+        m_textureSrbProxy->updateTexture(rub, m_currentFrame);
+        m_textureDirty = false;
+    }
+    const bool drawOverlay = m_overlay && m_pointerLocked && m_overlay->style() != CursorOverlay::Style::None;
+    if (drawOverlay) {
+        m_overlay->update(rub, renderSize, regionSize, overlayPosition(),
+                          OVERLAY_SIZE * static_cast<float>(devicePixelRatio()));
+    }
 
     cb->beginPass(renderTarget(), QColor(0, 0, 0, 255), {1.0f, 0}, rub);
 
@@ -125,6 +171,9 @@ void VideoRenderer::render(QRhiCommandBuffer* cb)
     const QRhiCommandBuffer::VertexInput vertexInput[] = { { m_vertexBuffer.get(), 0 } };
     cb->setVertexInput(0, 1, vertexInput);
     cb->draw(4);
+    if (drawOverlay) {
+        m_overlay->draw(cb, m_vertexBuffer.get());
+    }
 
     cb->endPass();
 }
@@ -133,12 +182,248 @@ void VideoRenderer::renderFrame(codec::FramePtr&& frame)
     if (!frame) {
         return;
     }
-    {
-        QMutexLocker locker(&m_frameMutex);
-        m_currentFrame = std::move(frame);
+    m_scheduler.push(std::move(frame));
+    update();
+}
+void VideoRenderer::setInputSink(input::InputSink* sink)
+{
+    m_inputSink = sink;
+    if (!m_inputSink) {
+        updatePointerLock(false);
     }
+}
+void VideoRenderer::setScaler(Scaler scaler)
+{
+    m_scaler = scaler;
     update();
 }
+void VideoRenderer::setRegionOfInterest(const QRectF& region)
+{
+    const QRectF clamped = region.intersected(QRectF(0.0, 0.0, 1.0, 1.0));
+    m_region = clamped.isEmpty() ? QRectF(0.0, 0.0, 1.0, 1.0) : clamped;
+    update();
+}
+void VideoRenderer::setCursorOverlay(CursorOverlay::Style style)
+{
+    m_overlayStyle = style;
+    if (m_overlay) {
+        m_overlay->setStyle(style);
+    }
+    update();
+}
+void VideoRenderer::keyPressEvent(QKeyEvent* event)
+{
+    if (!m_inputSink) {
+        QRhiWidget::keyPressEvent(event);
+        return;
+    }
+    input::InputEvent inputEvent;
+    inputEvent.type = input::InputEvent::Type::KeyPress;
+    inputEvent.timestampUs = codec::MediaClock::nowUs();
+    inputEvent.key = event->key();
+    inputEvent.autoRepeat = event->isAutoRepeat();
+    m_inputSink->post(inputEvent);
+}
+void VideoRenderer::keyReleaseEvent(QKeyEvent* event)
+{
+    if (!m_inputSink) {
+        QRhiWidget::keyReleaseEvent(event);
+        return;
+    }
+    input::InputEvent inputEvent;
+    inputEvent.type = input::InputEvent::Type::KeyRelease;
+    inputEvent.timestampUs = codec::MediaClock::nowUs();
+    inputEvent.key = event->key();
+    inputEvent.autoRepeat = event->isAutoRepeat();
+    m_inputSink->post(inputEvent);
+}
+void VideoRenderer::mousePressEvent(QMouseEvent* event)
+{
+    if (!m_inputSink) {
+        QRhiWidget::mousePressEvent(event);
+        return;
+    }
+    m_inputSink->post(makeMouseEvent(input::InputEvent::Type::MousePress, event));
+}
+void VideoRenderer::mouseReleaseEvent(QMouseEvent* event)
+{
+    if (!m_inputSink) {
+        QRhiWidget::mouseReleaseEvent(event);
+        return;
+    }
+    m_inputSink->post(makeMouseEvent(input::InputEvent::Type::MouseRelease, event));
+}
+void VideoRenderer::mouseMoveEvent(QMouseEvent* event)
+{
+    if (!m_inputSink) {
+        QRhiWidget::mouseMoveEvent(event);
+        return;
+    }
+    updatePointerLock(m_inputSink->wantsPointerLock());
+    auto inputEvent = makeMouseEvent(input::InputEvent::Type::MouseMove, event);
+    if (m_pointerLocked) {
+        // 锁定时鼠标始终拉回中心，位移相对中心计算；拉回产生的移动事件位移为0
+        const QPointF center(width() / 2.0, height() / 2.0);
+        inputEvent.dx = static_cast<float>(event->position().x() - center.x());
+        inputEvent.dy = static_cast<float>(event->position().y() - center.y());
+        if (inputEvent.dx == 0.0f && inputEvent.dy == 0.0f) {
+            return;
+        }
+        QCursor::setPos(mapToGlobal(center.toPoint()));
+        // 叠加层在下一次刷新时按接收端的触点位置绘制，不等设备画面。
+        // 接收端不提供位置时按本机位移估计
+        const QPointF delta = toViewPosition(event->position()) - toViewPosition(center);
+        m_overlayPosition.setX(std::clamp(m_overlayPosition.x() + delta.x(), 0.0, 1.0));
+        m_overlayPosition.setY(std::clamp(m_overlayPosition.y() + delta.y(), 0.0, 1.0));
+        update();
+    } else {
+        inputEvent.dx = static_cast<float>(event->position().x() - m_lastMousePosition.x());
+        inputEvent.dy = static_cast<float>(event->position().y() - m_lastMousePosition.y());
+    }
+    m_lastMousePosition = event->position();
+    m_inputSink->post(inputEvent);
+}
+void VideoRenderer::wheelEvent(QWheelEvent* event)
+{
+    if (!m_inputSink) {
+        QRhiWidget::wheelEvent(event);
+        return;
+    }
+    const QPointF position = toVideoPosition(event->position());
+    input::InputEvent inputEvent;
+    inputEvent.type = input::InputEvent::Type::Wheel;
+    inputEvent.timestampUs = codec::MediaClock::nowUs();
+    inputEvent.x = static_cast<float>(position.x());
+    inputEvent.y = static_cast<float>(position.y());
+    // angleDelta 以 1/8 度为单位，一格为 15 度
+    inputEvent.wheelX = static_cast<float>(event->angleDelta().x()) / 120.0f;
+    inputEvent.wheelY = static_cast<float>(event->angleDelta().y()) / 120.0f;
+    m_inputSink->post(inputEvent);
+}
+void VideoRenderer::focusOutEvent(QFocusEvent* event)
+{
+    QRhiWidget::focusOutEvent(event);
+    if (!m_inputSink) {
+        return;
+    }
+    updatePointerLock(false);
+    input::InputEvent inputEvent;
+    inputEvent.type = input::InputEvent::Type::FocusLost;
+    inputEvent.timestampUs = codec::MediaClock::nowUs();
+    m_inputSink->post(inputEvent);
+}
+void VideoRenderer::recordGpuTime(double seconds)
+{
+    if (!m_gpuTimeChecked) {
+        m_gpuTimeChecked = true;
+        if (!m_rhi->isFeatureSupported(QRhi::Timestamps)) {
+            LOGI("GPU timestamps are not supported by the {} backend, render time is not measured", m_rhi->backendName());
+        }
+    }
+    // 返回的是之前某一帧的结果，没有启用时间戳（QRhi::EnableTimestamps）时为 0
+    const Scaler scaler = m_gpuTimeScaler;
+    m_gpuTimeScaler = m_activeScaler;
+    if (seconds <= 0.0) {
+        if (!m_gpuTimeZeroLogged && m_rhi->isFeatureSupported(QRhi::Timestamps) &&
+            ++m_gpuTimeZeroFrames == GPU_TIME_ZERO_WARN_FRAMES) {
+            m_gpuTimeZeroLogged = true;
+            LOGI("GPU timestamps are supported but not enabled on the window's QRhi, "
+                 "run ScalerGpuBench to measure scaler render time");
+        }
+        return;
+    }
+    m_gpuTimeZeroFrames = 0;
+    auto& time = m_gpuTime[static_cast<size_t>(scaler)];
+    const double ms = seconds * 1000.0;
+    ++time.samples;
+    time.totalMs += ms;
+    time.maxMs = std::max(time.maxMs, ms);
+    if (time.samples % GPU_TIME_LOG_INTERVAL == 0) {
+        LOGI("GPU time with scaler {}: mean {:.3f} ms, max {:.3f} ms over {} frames",
+             scalerName(scaler), time.totalMs / static_cast<double>(time.samples), time.maxMs,
+             time.samples);
+    }
+}
+QPointF VideoRenderer::overlayPosition() const
+{
+    const auto pointer = m_inputSink ? m_inputSink->pointerPosition() : std::nullopt;
+    if (!pointer) {
+        return m_overlayPosition;
+    }
+    // 触点坐标相对整个画面，叠加层坐标相对显示区域
+    return {(pointer->x - m_region.x()) / m_region.width(), (pointer->y - m_region.y()) / m_region.height()};
+}
+QPointF VideoRenderer::toViewPosition(const QPointF& position) const
+{
+    // 与 Uniforms::updateVsUniforms 一致，显示区域保持宽高比居中显示
+    if (width() <= 0 || height() <= 0 || m_oldWidth <= 0 || m_oldHeight <= 0) {
+        return {position.x() / std::max(1, width()), position.y() / std::max(1, height())};
+    }
+    const QSize regionSize = Uniforms::regionSize(QSize(m_oldWidth, m_oldHeight), m_region);
+    const double winRatio = static_cast<double>(width()) / height();
+    const double videoRatio = static_cast<double>(regionSize.width()) / regionSize.height();
+    double videoWidth = width();
+    double videoHeight = height();
+    if (winRatio > videoRatio) {
+        videoWidth = height() * videoRatio;
+    } else {
+        videoHeight = width() / videoRatio;
+    }
+    const double left = (width() - videoWidth) / 2.0;
+    const double top = (height() - videoHeight) / 2.0;
+    return {(position.x() - left) / videoWidth, (position.y() - top) / videoHeight};
+}
+QPointF VideoRenderer::toVideoPosition(const QPointF& position) const
+{
+    const QPointF view = toViewPosition(position);
+    return {m_region.x() + view.x() * m_region.width(), m_region.y() + view.y() * m_region.height()};
+}
+input::InputEvent VideoRenderer::makeMouseEvent(input::InputEvent::Type type, const QMouseEvent* event) const
+{
+    const QPointF position = toVideoPosition(event->position());
+    input::InputEvent inputEvent;
+    inputEvent.type = type;
+    inputEvent.timestampUs = codec::MediaClock::nowUs();
+    inputEvent.button = static_cast<int>(event->button());
+    inputEvent.buttons = static_cast<int>(event->buttons());
+    inputEvent.x = static_cast<float>(position.x());
+    inputEvent.y = static_cast<float>(position.y());
+    return inputEvent;
+}
+void VideoRenderer::updatePointerLock(bool locked)
+{
+    if (locked == m_pointerLocked) {
+        return;
+    }
+    m_pointerLocked = locked;
+    m_overlayPosition = QPointF(0.5, 0.5);
+    update();
+    if (locked) {
+        setCursor(Qt::BlankCursor);
+        grabMouse();
+        QCursor::setPos(mapToGlobal(QPoint(width() / 2, height() / 2)));
+    } else {
+        releaseMouse();
+        unsetCursor();
+    }
+}
+void VideoRenderer::createOverlay()
+{
+    auto vs = loadShader(":/shaders/overlay.vert.qsb");
+    auto fs = loadShader(":/shaders/overlay.frag.qsb");
+    if (!vs.isValid() || !fs.isValid()) {
+        LOGE("Failed to load overlay shaders");
+        return;
+    }
+    // 叠加层不可用时只影响本地反馈，视频照常显示
+    try {
+        m_overlay = std::make_unique<CursorOverlay>(m_rhi, renderTarget()->renderPassDescriptor(), vs, fs);
+        m_overlay->setStyle(m_overlayStyle);
+    } catch (const std::exception& e) {
+        LOGE("Failed to create cursor overlay: {}", e.what());
+        m_overlay.reset();
+    }
+}
 bool VideoRenderer::createPipeline()
 {
     FUNC_TRACE;
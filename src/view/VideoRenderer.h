@@ -4,11 +4,15 @@
 
 #pragma once
 #include <QRhiWidget>
-#include <QMutex>
+#include <array>
 #include <rhi/qrhi.h>
 #include <proxy/proxy.h>
 #include "../codec/Frame.h"
 #include "Uniforms.h"
+#include "PresentationScheduler.h"
+#include "CursorOverlay.h"
+#include "Scaler.h"
+#include "../input/InputEvent.h"
 
 namespace view {
 PRO_DEF_MEM_DISPATCH(MemGetSrb, getSrb);
@@ -31,8 +35,43 @@ public:
 
     void renderFrame(codec::FramePtr&& frame);
 
+    void setPresentationConfig(const PresentationScheduler::Config& config) { m_scheduler.setConfig(config); }
+    PresentationScheduler::Stats presentationStats() const { return m_scheduler.stats(); }
+
+    // 键盘鼠标事件转发到 sink，传入 nullptr 停止转发
+    void setInputSink(input::InputSink* sink);
+    // 放大显示时使用的滤波算法
+    void setScaler(Scaler scaler);
+    // 只显示画面的一部分（归一化坐标），空矩形恢复完整画面。输入坐标随之换算回完整画面
+    void setRegionOfInterest(const QRectF& region);
+    // 鼠标锁定时绘制的本地叠加层
+    void setCursorOverlay(CursorOverlay::Style style);
+
+signals:
+    // 新帧实际呈现时发出，pts 为设备端PTS（微秒）
+    void framePresented(qint64 pts);
+
+protected:
+    void keyPressEvent(QKeyEvent* event) override;
+    void keyReleaseEvent(QKeyEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void focusOutEvent(QFocusEvent* event) override;
+
 private:
     bool createPipeline();
+    void createOverlay();
+    // 窗口坐标转换为显示区域内的归一化坐标
+    QPointF toViewPosition(const QPointF& position) const;
+    // 窗口坐标转换为完整视频画面内的归一化坐标
+    QPointF toVideoPosition(const QPointF& position) const;
+    input::InputEvent makeMouseEvent(input::InputEvent::Type type, const QMouseEvent* event) const;
+    void updatePointerLock(bool locked);
+    void recordGpuTime(double seconds);
+    // 显示区域内的归一化坐标，优先使用接收端报告的触点位置
+    QPointF overlayPosition() const;
 
 private:
     QRhi* m_rhi{nullptr};
@@ -40,13 +79,40 @@ private:
     std::unique_ptr<QRhiGraphicsPipeline> m_pipeline{};
     pro::proxy<TextureSrb> m_textureSrbProxy{};
     std::unique_ptr<Uniforms> m_uniforms{nullptr};
+    std::unique_ptr<CursorOverlay> m_overlay{nullptr};
+    CursorOverlay::Style m_overlayStyle{CursorOverlay::Style::Crosshair};
+    // 接收端不报告触点位置时的叠加层位置，显示区域内的归一化坐标，锁定时随相对位移移动
+    QPointF m_overlayPosition{0.5, 0.5};
 
+    // 帧由调度器在刷新时取出，当前帧只在渲染线程中访问
+    PresentationScheduler m_scheduler;
     codec::FramePtr m_currentFrame{nullptr};
-    QMutex m_frameMutex;
+    bool m_textureDirty{false};
+
+    input::InputSink* m_inputSink{nullptr};
+    bool m_pointerLocked{false};
+    QPointF m_lastMousePosition;
+
+    // 显示区域（归一化坐标），默认为完整画面
+    QRectF m_region{0.0, 0.0, 1.0, 1.0};
 
     int m_oldWidth{0};
     int m_oldHeight{0};
     codec::Frame::PixelFormat m_oldPixelFormat{codec::Frame::PixelFormat::None};
+    Scaler m_scaler{Scaler::Bicubic};
+    Scaler m_activeScaler{Scaler::Bilinear};
+
+    // 每帧命令缓冲区的 GPU 耗时，按提交时使用的滤波算法分开统计
+    struct GpuTime {
+        uint64_t samples{0};
+        double totalMs{0.0};
+        double maxMs{0.0};
+    };
+    std::array<GpuTime, static_cast<size_t>(Scaler::Sharp) + 1> m_gpuTime{};
+    Scaler m_gpuTimeScaler{Scaler::Bilinear};
+    bool m_gpuTimeChecked{false};
+    uint64_t m_gpuTimeZeroFrames{0};
+    bool m_gpuTimeZeroLogged{false};
 };
 
 } // namespace view
@@ -7,8 +7,9 @@
 #include "logger.h"
 
 namespace view {
-YuvTexturesSrb::YuvTexturesSrb(QRhi* rhi, Uniforms* uniforms, const codec::FramePtr& frame)
+YuvTexturesSrb::YuvTexturesSrb(QRhi* rhi, Uniforms* uniforms, const codec::FramePtr& frame, Scaler scaler)
     : m_rhi(rhi)
+    , m_scaler(scaler)
     , m_width(frame->width())
     , m_height(frame->height())
 {
@@ -36,6 +37,7 @@ YuvTexturesSrb::YuvTexturesSrb(QRhi* rhi, Uniforms* uniforms, const codec::Frame
         QRhiShaderResourceBinding::sampledTexture(2, QRhiShaderResourceBinding::FragmentStage, m_vTexture.get(), m_sampler.get()),
         QRhiShaderResourceBinding::uniformBuffer(3, QRhiShaderResourceBinding::VertexStage, uniforms->vsUBuffer()),
         QRhiShaderResourceBinding::uniformBuffer(4, QRhiShaderResourceBinding::FragmentStage, uniforms->colorParamsUBuffer()),
+        QRhiShaderResourceBinding::uniformBuffer(5, QRhiShaderResourceBinding::FragmentStage, uniforms->scaleParamsUBuffer()),
     });
     if (!m_srb->create()) {
         LOGE("Failed to create shader resource bindings for YUV textures");
@@ -46,9 +48,9 @@ YuvTexturesSrb::~YuvTexturesSrb()
 {
     FUNC_TRACE;
 }
-QString YuvTexturesSrb::getFragmentShaderName()
+QString YuvTexturesSrb::getFragmentShaderName() const
 {
-    return ":/shaders/yuv420p.frag.qsb";
+    return fragmentShaderName("yuv420p", m_scaler);
 }
 void YuvTexturesSrb::updateTexture(QRhiResourceUpdateBatch* rub, const codec::FramePtr& frame) const
 {
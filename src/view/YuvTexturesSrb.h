@@ -7,19 +7,21 @@
 #include <rhi/qrhi.h>
 #include "../codec/Frame.h"
 #include "Uniforms.h"
+#include "Scaler.h"
 
 namespace view {
 class YuvTexturesSrb {
 public:
-    YuvTexturesSrb(QRhi* rhi, Uniforms* uniforms, const codec::FramePtr& frame);
+    YuvTexturesSrb(QRhi* rhi, Uniforms* uniforms, const codec::FramePtr& frame, Scaler scaler = Scaler::Bilinear);
     ~YuvTexturesSrb();
 
     QRhiShaderResourceBindings* getSrb() const { return m_srb.get(); }
-    static QString getFragmentShaderName() ;
+    QString getFragmentShaderName() const;
     void updateTexture(QRhiResourceUpdateBatch* rub, const codec::FramePtr& frame) const;
 
 private:
     QRhi* m_rhi{nullptr};
+    Scaler m_scaler{Scaler::Bilinear};
     int m_width{0};
     int m_height{0};
     std::unique_ptr<QRhiTexture> m_yTexture{};
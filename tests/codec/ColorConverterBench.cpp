@@ -0,0 +1,132 @@
+//
+// Created by neapu on 2026/1/2.
+//
+
+// YUV 转 RGBA 的吞吐测量：对当前 CPU 支持的每种内核，按格式和缩小倍数转换同一帧若干次，输出每帧耗时和相对标量版本的加速比。
+// 用法：
+//   ColorConverterBench [--width W] [--height H] [--frames N]
+// 默认 1920x1080、200 帧。
+#include "codec/ColorConverter.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+using codec::ColorConverter;
+
+namespace {
+struct AVFrameDeleter {
+    void operator()(AVFrame* frame) const { av_frame_free(&frame); }
+};
+using AVFramePtr = std::unique_ptr<AVFrame, AVFrameDeleter>;
+
+AVFramePtr randomFrame(AVPixelFormat format, int width, int height)
+{
+    AVFramePtr frame(av_frame_alloc());
+    if (!frame) {
+        return nullptr;
+    }
+    frame->format = format;
+    frame->width = width;
+    frame->height = height;
+    if (av_frame_get_buffer(frame.get(), 0) < 0) {
+        return nullptr;
+    }
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> byte(0, 255);
+    for (int plane = 0; plane < 4 && frame->data[plane]; ++plane) {
+        const int rows = plane == 0 ? height : (height + 1) / 2;
+        for (int row = 0; row < rows; ++row) {
+            uint8_t* line = frame->data[plane] + static_cast<ptrdiff_t>(row) * frame->linesize[plane];
+            for (int x = 0; x < frame->linesize[plane]; ++x) {
+                line[x] = static_cast<uint8_t>(byte(rng));
+            }
+        }
+    }
+    return frame;
+}
+
+// 每帧的平均耗时（毫秒），失败返回负值
+double measure(ColorConverter::Isa isa, const AVFrame* frame, int scale, int frames)
+{
+    ColorConverter converter(isa);
+    const int stride = ColorConverter::outputWidth(frame->width, scale) * 4;
+    std::vector<uint8_t> out(static_cast<size_t>(stride) * ColorConverter::outputHeight(frame->height, scale));
+    // 预热一次，分配行缓冲
+    if (!converter.convert(frame, out.data(), stride, ColorConverter::Output::RGBA, scale)) {
+        return -1.0;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        converter.convert(frame, out.data(), stride, ColorConverter::Output::RGBA, scale);
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / frames;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int width = 1920;
+    int height = 1080;
+    int frames = 200;
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--width") == 0 && hasValue) {
+            width = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--height") == 0 && hasValue) {
+            height = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--frames") == 0 && hasValue) {
+            frames = std::atoi(argv[++i]);
+        } else {
+            std::fprintf(stderr, "Usage: %s [--width W] [--height H] [--frames N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (width <= 0 || height <= 0 || frames <= 0) {
+        std::fprintf(stderr, "Invalid size or frame count\n");
+        return 2;
+    }
+
+    struct Format {
+        AVPixelFormat format;
+        const char* name;
+    };
+    std::printf("%dx%d, %d frames, best kernel %s\n", width, height, frames,
+                ColorConverter::isaName(ColorConverter::bestIsa()));
+    std::printf("%-8s %-6s %-8s %10s %8s\n", "format", "scale", "kernel", "ms/frame", "speedup");
+    for (const Format& format : {Format{AV_PIX_FMT_NV12, "nv12"}, Format{AV_PIX_FMT_YUV420P, "yuv420p"},
+                                 Format{AV_PIX_FMT_P010LE, "p010"}}) {
+        const auto frame = randomFrame(format.format, width, height);
+        if (!frame) {
+            std::fprintf(stderr, "Failed to allocate %s frame\n", format.name);
+            return 1;
+        }
+        for (const int scale : {1, 2, 4}) {
+            if (ColorConverter::outputWidth(width, scale) <= 0 || ColorConverter::outputHeight(height, scale) <= 0) {
+                continue;
+            }
+            const double scalarMs = measure(ColorConverter::Isa::Scalar, frame.get(), scale, frames);
+            for (const auto isa : {ColorConverter::Isa::Scalar, ColorConverter::Isa::SSE41, ColorConverter::Isa::AVX2,
+                                   ColorConverter::Isa::NEON}) {
+                if (!ColorConverter::isaSupported(isa)) {
+                    continue;
+                }
+                const double ms = isa == ColorConverter::Isa::Scalar ? scalarMs : measure(isa, frame.get(), scale, frames);
+                if (ms < 0.0) {
+                    std::fprintf(stderr, "Conversion failed for %s\n", format.name);
+                    return 1;
+                }
+                std::printf("%-8s %-6d %-8s %10.3f %7.2fx\n", format.name, scale, ColorConverter::isaName(isa), ms,
+                            scalarMs / ms);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+//
+// Created by neapu on 2026/1/2.
+//
+
+#include "codec/ColorConverter.h"
+#include <QTest>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+using codec::ColorConverter;
+
+namespace {
+struct AVFrameDeleter {
+    void operator()(AVFrame* frame) const { av_frame_free(&frame); }
+};
+using AVFramePtr = std::unique_ptr<AVFrame, AVFrameDeleter>;
+
+// 随机内容的软件帧，亮度和色度都覆盖到 0 和 255，检验各内核的截断
+AVFramePtr randomFrame(AVPixelFormat format, int width, int height, std::mt19937& rng)
+{
+    AVFramePtr frame(av_frame_alloc());
+    if (!frame) {
+        return nullptr;
+    }
+    frame->format = format;
+    frame->width = width;
+    frame->height = height;
+    if (av_frame_get_buffer(frame.get(), 0) < 0) {
+        return nullptr;
+    }
+    std::uniform_int_distribution<int> byte(0, 255);
+    for (int plane = 0; plane < 4 && frame->data[plane]; ++plane) {
+        const int rows = plane == 0 ? height : (height + 1) / 2;
+        for (int row = 0; row < rows; ++row) {
+            uint8_t* line = frame->data[plane] + static_cast<ptrdiff_t>(row) * frame->linesize[plane];
+            for (int x = 0; x < frame->linesize[plane]; ++x) {
+                line[x] = static_cast<uint8_t>(byte(rng));
+            }
+        }
+    }
+    return frame;
+}
+
+std::vector<ColorConverter::Isa> simdIsas()
+{
+    std::vector<ColorConverter::Isa> isas;
+    for (const auto isa : {ColorConverter::Isa::SSE41, ColorConverter::Isa::AVX2, ColorConverter::Isa::NEON}) {
+        if (ColorConverter::isaSupported(isa)) {
+            isas.push_back(isa);
+        }
+    }
+    return isas;
+}
+} // namespace
+
+class ColorConverterTest : public QObject {
+    Q_OBJECT
+private slots:
+    void knownValues();
+    void simdMatchesScalar_data();
+    void simdMatchesScalar();
+    void rejectsInvalidScale();
+};
+
+void ColorConverterTest::knownValues()
+{
+    std::mt19937 rng(1);
+    // 有限范围的 16 和 235 对应黑和白，全范围的 0 和 255 对应黑和白
+    struct Case {
+        AVColorRange range;
+        uint8_t y;
+        uint8_t expected;
+    };
+    for (const Case& c : {Case{AVCOL_RANGE_MPEG, 16, 0}, Case{AVCOL_RANGE_MPEG, 235, 255},
+                          Case{AVCOL_RANGE_JPEG, 0, 0}, Case{AVCOL_RANGE_JPEG, 255, 255}}) {
+        auto frame = randomFrame(AV_PIX_FMT_YUV420P, 16, 2, rng);
+        QVERIFY(frame);
+        frame->color_range = c.range;
+        std::fill_n(frame->data[0], frame->linesize[0] * 2, c.y);
+        std::fill_n(frame->data[1], frame->linesize[1], 128);
+        std::fill_n(frame->data[2], frame->linesize[2], 128);
+        for (const auto isa : {ColorConverter::Isa::Scalar, ColorConverter::Isa::SSE41, ColorConverter::Isa::AVX2,
+                               ColorConverter::Isa::NEON}) {
+            if (!ColorConverter::isaSupported(isa)) {
+                continue;
+            }
+            ColorConverter converter(isa);
+            std::vector<uint8_t> out(16 * 4 * 2);
+            QVERIFY(converter.convert(frame.get(), out.data(), 16 * 4));
+            for (size_t i = 0; i < out.size(); i += 4) {
+                QCOMPARE(out[i], c.expected);
+                QCOMPARE(out[i + 1], c.expected);
+                QCOMPARE(out[i + 2], c.expected);
+                QCOMPARE(out[i + 3], uint8_t(0xff));
+            }
+        }
+    }
+}
+
+void ColorConverterTest::simdMatchesScalar_data()
+{
+    QTest::addColumn<int>("format");
+    QTest::addColumn<int>("scale");
+    QTest::addColumn<int>("range");
+    QTest::addColumn<int>("colorSpace");
+    QTest::addColumn<bool>("bgra");
+
+    for (const auto format : {AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUVJ420P, AV_PIX_FMT_NV12, AV_PIX_FMT_P010LE}) {
+        for (const int scale : {1, 2, 4, 8}) {
+            for (const auto range : {AVCOL_RANGE_MPEG, AVCOL_RANGE_JPEG}) {
+                for (const auto space : {AVCOL_SPC_BT470BG, AVCOL_SPC_BT709}) {
+                    for (const bool bgra : {false, true}) {
+                        const QByteArray name = QByteArray::number(format) + "/x" + QByteArray::number(scale)
+                            + (range == AVCOL_RANGE_JPEG ? "/full" : "/limited")
+                            + (space == AVCOL_SPC_BT709 ? "/709" : "/601") + (bgra ? "/bgra" : "/rgba");
+                        QTest::newRow(name.constData()) << static_cast<int>(format) << scale << static_cast<int>(range)
+                                                        << static_cast<int>(space) << bgra;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void ColorConverterTest::simdMatchesScalar()
+{
+    QFETCH(int, format);
+    QFETCH(int, scale);
+    QFETCH(int, range);
+    QFETCH(int, colorSpace);
+    QFETCH(bool, bgra);
+
+    const auto isas = simdIsas();
+    if (isas.empty()) {
+        QSKIP("No SIMD color conversion kernels on this CPU");
+    }
+    const auto output = bgra ? ColorConverter::Output::BGRA : ColorConverter::Output::RGBA;
+    std::mt19937 rng(static_cast<unsigned>(format * 131 + scale * 17 + range * 7 + colorSpace));
+    // 奇数宽度覆盖各内核的向量尾部：AVX2 一次 16 像素、SSE4.1 和 NEON 一次 8 像素
+    for (const int width : {1, 7, 9, 15, 17, 31, 33, 63, 65, 127, 1081}) {
+        const int height = 2 * scale + 1;
+        const int outWidth = ColorConverter::outputWidth(width, scale);
+        if (outWidth <= 0) {
+            continue;
+        }
+        auto frame = randomFrame(static_cast<AVPixelFormat>(format), width, height, rng);
+        QVERIFY(frame);
+        frame->color_range = static_cast<AVColorRange>(range);
+        frame->colorspace = static_cast<AVColorSpace>(colorSpace);
+
+        const int stride = outWidth * 4;
+        const size_t size = static_cast<size_t>(stride) * ColorConverter::outputHeight(height, scale);
+        std::vector<uint8_t> expected(size);
+        ColorConverter scalar(ColorConverter::Isa::Scalar);
+        QVERIFY(scalar.convert(frame.get(), expected.data(), stride, output, scale));
+        for (const auto isa : isas) {
+            std::vector<uint8_t> actual(size);
+            ColorConverter converter(isa);
+            QCOMPARE(converter.isa(), isa);
+            QVERIFY(converter.convert(frame.get(), actual.data(), stride, output, scale));
+            if (actual != expected) {
+                const auto mismatch = std::mismatch(actual.begin(), actual.end(), expected.begin());
+                QFAIL(qPrintable(QString("%1 differs from scalar at width %2, byte %3: %4 vs %5")
+                                     .arg(ColorConverter::isaName(isa)).arg(width)
+                                     .arg(mismatch.first - actual.begin()).arg(*mismatch.first).arg(*mismatch.second)));
+            }
+        }
+    }
+}
+
+void ColorConverterTest::rejectsInvalidScale()
+{
+    std::mt19937 rng(1);
+    auto frame = randomFrame(AV_PIX_FMT_NV12, 16, 16, rng);
+    QVERIFY(frame);
+    ColorConverter converter;
+    std::vector<uint8_t> out(16 * 16 * 4);
+    QVERIFY(!converter.convert(frame.get(), out.data(), 16 * 4, ColorConverter::Output::RGBA, 3));
+    QVERIFY(!converter.convert(frame.get(), out.data(), 16 * 4, ColorConverter::Output::RGBA, 0));
+    QVERIFY(!converter.convert(nullptr, out.data(), 16 * 4));
+}
+
+QTEST_GUILESS_MAIN(ColorConverterTest)
+#include "ColorConverterTest.moc"
@@ -0,0 +1,155 @@
+//
+// Created by neapu on 2026/1/2.
+//
+
+#include "codec/LatencyProbe.h"
+#include <QTest>
+#include <chrono>
+#include <cstring>
+#include <thread>
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+using codec::Frame;
+using codec::FramePtr;
+using codec::LatencyProbe;
+
+// 代替设备的合成画面：收到控制事件后感兴趣区域由黑变白，之后的帧都带着这个变化
+class FakeScreen {
+public:
+    static constexpr int WIDTH = 320;
+    static constexpr int HEIGHT = 240;
+
+    bool tap()
+    {
+        ++taps;
+        changed = !changed;
+        return acceptTaps;
+    }
+
+    FramePtr render()
+    {
+        auto frame = std::make_unique<Frame>();
+        AVFrame* av = frame->avFrame();
+        av->format = AV_PIX_FMT_YUV420P;
+        av->width = WIDTH;
+        av->height = HEIGHT;
+        av->pts = m_nextPts;
+        m_nextPts += 16667;
+        if (av_frame_get_buffer(av, 0) < 0) {
+            return nullptr;
+        }
+        for (int y = 0; y < HEIGHT; ++y) {
+            std::memset(av->data[0] + static_cast<ptrdiff_t>(y) * av->linesize[0], changed ? 235 : 16, WIDTH);
+        }
+        for (int plane = 1; plane < 3; ++plane) {
+            std::memset(av->data[plane], 128, static_cast<size_t>(av->linesize[plane]) * HEIGHT / 2);
+        }
+        return frame;
+    }
+
+    int taps{0};
+    bool changed{false};
+    bool acceptTaps{true};
+
+private:
+    int64_t m_nextPts{0};
+};
+
+class LatencyProbeTest : public QObject {
+    Q_OBJECT
+private slots:
+    void ignoresStartBeforeFirstFrame();
+    void measuresOnStaticScreen();
+    void timesOutWithoutChange();
+    void failedTriggerReturnsToIdle();
+    void sumOfAbsDiff();
+};
+
+void LatencyProbeTest::ignoresStartBeforeFirstFrame()
+{
+    FakeScreen screen;
+    LatencyProbe probe({}, [&screen]() { return screen.tap(); });
+    probe.start();
+    QCOMPARE(screen.taps, 0);
+    QVERIFY(!probe.busy());
+}
+
+void LatencyProbeTest::measuresOnStaticScreen()
+{
+    FakeScreen screen;
+    LatencyProbe probe({}, [&screen]() { return screen.tap(); });
+    // 只解码出一帧，之后画面静止，服务端不再发送新帧
+    probe.onFrame(*screen.render());
+
+    for (int i = 1; i <= 2; ++i) {
+        probe.start();
+        QCOMPARE(screen.taps, i);
+        QVERIFY(probe.busy());
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        const FramePtr frame = screen.render();
+        probe.onFrame(*frame);
+        QVERIFY(probe.busy());
+        probe.onPresented(frame->pts());
+        QVERIFY(!probe.busy());
+
+        const auto stats = probe.stats();
+        QCOMPARE(stats.samples, static_cast<uint64_t>(i));
+        QVERIFY(stats.lastDecodeUs >= 5000);
+        QVERIFY(stats.lastPresentUs >= stats.lastDecodeUs);
+    }
+}
+
+void LatencyProbeTest::timesOutWithoutChange()
+{
+    FakeScreen screen;
+    LatencyProbe::Config config;
+    config.timeoutUs = 20000;
+    LatencyProbe probe(config, [&screen]() {
+        ++screen.taps;
+        return true;
+    });
+    probe.onFrame(*screen.render());
+    probe.start();
+    QVERIFY(probe.busy());
+
+    probe.onFrame(*screen.render());
+    probe.poll();
+    QVERIFY(probe.busy());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    probe.poll();
+    QVERIFY(!probe.busy());
+    QCOMPARE(probe.stats().timeouts, static_cast<uint64_t>(1));
+    QCOMPARE(probe.stats().samples, static_cast<uint64_t>(0));
+}
+
+void LatencyProbeTest::failedTriggerReturnsToIdle()
+{
+    FakeScreen screen;
+    screen.acceptTaps = false;
+    LatencyProbe probe({}, [&screen]() { return screen.tap(); });
+    probe.onFrame(*screen.render());
+    probe.start();
+    QCOMPARE(screen.taps, 1);
+    QVERIFY(!probe.busy());
+}
+
+void LatencyProbeTest::sumOfAbsDiff()
+{
+    // 覆盖向量部分和尾部
+    std::vector<uint8_t> a(67);
+    std::vector<uint8_t> b(67);
+    uint64_t expected = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<uint8_t>(i * 37);
+        b[i] = static_cast<uint8_t>(255 - i * 11);
+        expected += static_cast<uint64_t>(std::abs(a[i] - b[i]));
+    }
+    QCOMPARE(LatencyProbe::sumOfAbsDiff(a.data(), b.data(), a.size()), expected);
+}
+
+QTEST_GUILESS_MAIN(LatencyProbeTest)
+#include "LatencyProbeTest.moc"
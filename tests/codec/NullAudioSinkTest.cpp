@@ -0,0 +1,119 @@
+//
+// Created by neapu on 2026/1/2.
+//
+
+#include "codec/NullAudioSink.h"
+#include <QTest>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using codec::AudioBuffer;
+using codec::NullAudioSink;
+using namespace std::chrono;
+
+constexpr int SAMPLE_RATE = 48000;
+constexpr int CHANNELS = 2;
+// 设备端 Opus 每包 20ms
+constexpr int PACKET_MS = 20;
+
+class NullAudioSinkTest : public QObject {
+    Q_OBJECT
+private slots:
+    void startStop();
+    void consumesAtRealTimeRate();
+    void steadyStateDepth();
+};
+
+void NullAudioSinkTest::startStop()
+{
+    AudioBuffer buffer(SAMPLE_RATE, CHANNELS, 100);
+    NullAudioSink sink;
+    QVERIFY(!sink.start(nullptr));
+    QVERIFY(sink.start(&buffer));
+    QVERIFY(!sink.start(&buffer));
+    sink.stop();
+    sink.stop();
+    QVERIFY(sink.start(&buffer));
+}
+
+void NullAudioSinkTest::consumesAtRealTimeRate()
+{
+    constexpr int PREFILL_MS = 500;
+    constexpr int RUN_MS = 300;
+    AudioBuffer buffer(SAMPLE_RATE, CHANNELS, 1000);
+    const std::vector<int16_t> samples(static_cast<size_t>(SAMPLE_RATE) * PREFILL_MS / 1000 * CHANNELS, 1);
+    buffer.write(samples.data(), SAMPLE_RATE * PREFILL_MS / 1000);
+
+    NullAudioSink sink;
+    const auto begin = steady_clock::now();
+    QVERIFY(sink.start(&buffer));
+    std::this_thread::sleep_for(milliseconds(RUN_MS));
+    sink.stop();
+    const auto elapsedMs = duration_cast<milliseconds>(steady_clock::now() - begin).count();
+
+    const int consumedMs = PREFILL_MS - buffer.bufferedFrames() * 1000 / SAMPLE_RATE;
+    qInfo("consumed %d ms of audio in %lld ms", consumedMs, static_cast<long long>(elapsedMs));
+    // 拉取间隔为 10ms，允许一个间隔加调度误差
+    QVERIFY(consumedMs <= elapsedMs + 5);
+    QVERIFY(consumedMs >= RUN_MS - 30);
+    QCOMPARE(buffer.underflowFrames(), 0);
+}
+
+void NullAudioSinkTest::steadyStateDepth()
+{
+    // 与 AudioDecoder 的用法一致：预先缓冲 20ms，之后每 20ms 写入一包，输出端按实时速率拉取
+    constexpr int JITTER_MS = 20;
+    constexpr int RUN_MS = 2000;
+    constexpr int PACKET_FRAMES = SAMPLE_RATE * PACKET_MS / 1000;
+    AudioBuffer buffer(SAMPLE_RATE, CHANNELS, 200);
+    const std::vector<int16_t> packet(static_cast<size_t>(PACKET_FRAMES) * CHANNELS, 1);
+    buffer.write(packet.data(), SAMPLE_RATE * JITTER_MS / 1000);
+
+    NullAudioSink sink;
+    QVERIFY(sink.start(&buffer));
+    std::atomic<bool> producing{true};
+    std::thread producer([&]() {
+        auto next = steady_clock::now();
+        while (producing.load()) {
+            next += milliseconds(PACKET_MS);
+            std::this_thread::sleep_until(next);
+            buffer.write(packet.data(), PACKET_FRAMES);
+        }
+    });
+
+    // 跳过前 500ms 的启动过程，之后每 2ms 采样一次缓冲深度
+    std::this_thread::sleep_for(milliseconds(500));
+    int64_t totalDepthFrames = 0;
+    int maxDepthFrames = 0;
+    int samplesTaken = 0;
+    const int64_t underflowBefore = buffer.underflowFrames();
+    const auto end = steady_clock::now() + milliseconds(RUN_MS);
+    while (steady_clock::now() < end) {
+        const int depth = buffer.bufferedFrames();
+        totalDepthFrames += depth;
+        maxDepthFrames = std::max(maxDepthFrames, depth);
+        ++samplesTaken;
+        std::this_thread::sleep_for(milliseconds(2));
+    }
+    const int64_t underflowMs = (buffer.underflowFrames() - underflowBefore) * 1000 / SAMPLE_RATE;
+    producing.store(false);
+    producer.join();
+    sink.stop();
+
+    const double meanDepthMs = static_cast<double>(totalDepthFrames) / samplesTaken * 1000 / SAMPLE_RATE;
+    const double maxDepthMs = static_cast<double>(maxDepthFrames) * 1000 / SAMPLE_RATE;
+    qInfo("buffer depth mean %.1f ms, max %.1f ms, underflow %lld ms in %d ms, overflow %lld frames",
+          meanDepthMs, maxDepthMs, static_cast<long long>(underflowMs), RUN_MS,
+          static_cast<long long>(buffer.overflowFrames()));
+    // 深度在一包和一包加预缓冲之间波动，不应持续增长或耗尽
+    QVERIFY(meanDepthMs > 0);
+    QVERIFY(maxDepthMs <= JITTER_MS + 2 * PACKET_MS);
+    QCOMPARE(buffer.overflowFrames(), 0);
+    QVERIFY(underflowMs <= RUN_MS / 20);
+}
+
+QTEST_GUILESS_MAIN(NullAudioSinkTest)
+#include "NullAudioSinkTest.moc"
@@ -0,0 +1,297 @@
+//
+// Created by neapu on 2026/1/2.
+//
+
+#include "device/AdbClient.h"
+#include "device/AdbCommandRunner.h"
+#include <QTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <QtEndian>
+#include <functional>
+
+using device::AdbClient;
+using device::AdbCommandRunner;
+using device::AdbException;
+
+// 代替 adb server 的本地服务：按 smart socket 协议逐个读取请求，交给测试设置的处理函数应答
+class StandInAdbServer : public QObject {
+    Q_OBJECT
+public:
+    // 返回 false 表示该连接上不再有后续请求
+    using Handler = std::function<bool(QTcpSocket* socket, const QByteArray& service)>;
+
+    bool listen()
+    {
+        connect(&m_server, &QTcpServer::newConnection, this, [this]() {
+            while (QTcpSocket* socket = m_server.nextPendingConnection()) {
+                ++m_connections;
+                m_sockets.append(socket);
+                connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+                connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+        return m_server.listen(QHostAddress::LocalHost, 0);
+    }
+    quint16 port() const { return m_server.serverPort(); }
+    void setHandler(Handler handler) { m_handler = std::move(handler); }
+    int connections() const { return m_connections; }
+    const QList<QByteArray>& services() const { return m_services; }
+    // 模拟 adb server 重启，关闭所有已建立的连接
+    void dropConnections()
+    {
+        for (const auto& socket : std::as_const(m_sockets)) {
+            if (socket) {
+                socket->abort();
+            }
+        }
+        m_sockets.clear();
+        m_buffers.clear();
+    }
+    void reset()
+    {
+        m_services.clear();
+        m_connections = 0;
+    }
+
+    static void okay(QTcpSocket* socket) { socket->write("OKAY"); }
+    static void fail(QTcpSocket* socket, const QByteArray& message)
+    {
+        socket->write("FAIL" + QByteArray::number(message.size(), 16).rightJustified(4, '0') + message);
+    }
+    static void lengthPrefixed(QTcpSocket* socket, const QByteArray& data)
+    {
+        socket->write(QByteArray::number(data.size(), 16).rightJustified(4, '0') + data);
+    }
+    static void shellPacket(QTcpSocket* socket, char id, const QByteArray& payload)
+    {
+        QByteArray header(5, Qt::Uninitialized);
+        header[0] = id;
+        qToLittleEndian<quint32>(static_cast<quint32>(payload.size()), header.data() + 1);
+        socket->write(header + payload);
+    }
+
+private:
+    void onReadyRead(QTcpSocket* socket)
+    {
+        QByteArray& buffer = m_buffers[socket];
+        buffer += socket->readAll();
+        while (buffer.size() >= 4) {
+            bool ok = false;
+            const int length = buffer.left(4).toInt(&ok, 16);
+            if (!ok || buffer.size() < 4 + length) {
+                return;
+            }
+            const QByteArray service = buffer.mid(4, length);
+            buffer.remove(0, 4 + length);
+            m_services.append(service);
+            if (!m_handler || !m_handler(socket, service)) {
+                m_buffers.remove(socket);
+                socket->disconnectFromHost();
+                return;
+            }
+        }
+    }
+
+private:
+    QTcpServer m_server;
+    Handler m_handler;
+    QList<QPointer<QTcpSocket>> m_sockets;
+    QHash<QTcpSocket*, QByteArray> m_buffers;
+    QList<QByteArray> m_services;
+    int m_connections{0};
+};
+
+class AdbClientTest : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void init();
+    void hostCommand();
+    void shellV2();
+    void shellFallsBackToV1();
+    void transportFailure();
+    void staleSpareSocketIsReplaced();
+    void timeout();
+
+private:
+    // 等待完成并取出结果，失败时返回异常信息
+    static QString waitResult(QFuture<QString> future, QString* error);
+
+private:
+    StandInAdbServer m_server;
+};
+
+void AdbClientTest::initTestCase()
+{
+    QVERIFY(m_server.listen());
+    qputenv("ANDROID_ADB_SERVER_PORT", QByteArray::number(m_server.port()));
+    QCOMPARE(AdbClient::serverPort(), m_server.port());
+}
+
+void AdbClientTest::init()
+{
+    m_server.reset();
+    m_server.setHandler({});
+}
+
+QString AdbClientTest::waitResult(QFuture<QString> future, QString* error)
+{
+    if (!QTest::qWaitFor([&]() { return future.isFinished(); }, 5000)) {
+        *error = "not finished";
+        return {};
+    }
+    try {
+        return future.result();
+    } catch (const AdbException& ex) {
+        *error = ex.message();
+        return {};
+    }
+}
+
+void AdbClientTest::hostCommand()
+{
+    m_server.setHandler([](QTcpSocket* socket, const QByteArray& service) {
+        if (service != "host:devices-l") {
+            StandInAdbServer::fail(socket, "unknown service");
+            return false;
+        }
+        StandInAdbServer::okay(socket);
+        StandInAdbServer::lengthPrefixed(socket, "emulator-5554 device product:sdk model:Pixel_7\n");
+        return false;
+    });
+    QString error;
+    const QString output = waitResult(AdbClient::instance()->hostCommand("host:devices-l"), &error);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+    QCOMPARE(output, QString("emulator-5554 device product:sdk model:Pixel_7"));
+}
+
+void AdbClientTest::shellV2()
+{
+    m_server.setHandler([](QTcpSocket* socket, const QByteArray& service) {
+        if (service == "host:transport:emulator-5554") {
+            StandInAdbServer::okay(socket);
+            return true;
+        }
+        if (service == "shell,v2,raw:getprop ro.build.version.release") {
+            StandInAdbServer::okay(socket);
+            StandInAdbServer::shellPacket(socket, 1, "14\n");
+            StandInAdbServer::shellPacket(socket, 3, QByteArray(1, '\0'));
+            return false;
+        }
+        StandInAdbServer::fail(socket, "unexpected " + service);
+        return false;
+    });
+    QString error;
+    const QString output = waitResult(AdbClient::instance()->shell("emulator-5554", "getprop ro.build.version.release"), &error);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+    QCOMPARE(output, QString("14"));
+
+    // 非0退出码以标准错误的内容作为异常
+    m_server.setHandler([](QTcpSocket* socket, const QByteArray& service) {
+        StandInAdbServer::okay(socket);
+        if (service.startsWith("shell,v2,raw:")) {
+            StandInAdbServer::shellPacket(socket, 2, "stat: missing: No such file\n");
+            StandInAdbServer::shellPacket(socket, 3, QByteArray(1, '\1'));
+            return false;
+        }
+        return true;
+    });
+    waitResult(AdbClient::instance()->shell("emulator-5554", "stat missing"), &error);
+    QCOMPARE(error, QString("stat: missing: No such file"));
+}
+
+void AdbClientTest::shellFallsBackToV1()
+{
+    m_server.setHandler([](QTcpSocket* socket, const QByteArray& service) {
+        if (service.startsWith("host:transport:")) {
+            StandInAdbServer::okay(socket);
+            return true;
+        }
+        if (service.startsWith("shell,v2,raw:")) {
+            StandInAdbServer::fail(socket, "closed");
+            return false;
+        }
+        StandInAdbServer::okay(socket);
+        socket->write("Physical size: 1080x2400\n");
+        return false;
+    });
+    QString error;
+    const QString output = waitResult(AdbClient::instance()->shell("old-device", "wm size"), &error);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+    QCOMPARE(output, QString("Physical size: 1080x2400"));
+    QVERIFY(m_server.services().contains("shell:wm size"));
+}
+
+void AdbClientTest::transportFailure()
+{
+    m_server.setHandler([](QTcpSocket* socket, const QByteArray& service) {
+        StandInAdbServer::fail(socket, "device '" + service.mid(15) + "' not found");
+        return false;
+    });
+    QString error;
+    waitResult(AdbClient::instance()->shell("missing", "echo"), &error);
+    QCOMPARE(error, QString("device 'missing' not found"));
+    QCOMPARE(m_server.services(), QList<QByteArray>{"host:transport:missing"});
+
+    waitResult(AdbClient::instance()->reverse("missing", "localabstract:scrcpy", "tcp:27183"), &error);
+    QCOMPARE(error, QString("device 'missing' not found"));
+}
+
+void AdbClientTest::staleSpareSocketIsReplaced()
+{
+    const auto devices = [](QTcpSocket* socket, const QByteArray&) {
+        StandInAdbServer::okay(socket);
+        StandInAdbServer::lengthPrefixed(socket, "serial\tdevice\n");
+        return false;
+    };
+    m_server.setHandler(devices);
+    QString error;
+    waitResult(AdbClient::instance()->hostCommand("host:devices-l"), &error);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+
+    // 每次请求同时建立下一个请求的空闲连接。空闲连接在使用时才失效（adb server 刚重启）：
+    // 请求没有应答就被关闭，客户端应换新连接重试
+    bool dropped = false;
+    m_server.setHandler([&dropped, devices](QTcpSocket* socket, const QByteArray& service) {
+        if (!dropped) {
+            dropped = true;
+            socket->abort();
+            return false;
+        }
+        return devices(socket, service);
+    });
+    const QString output = waitResult(AdbClient::instance()->hostCommand("host:devices-l"), &error);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+    QCOMPARE(output, QString("serial\tdevice"));
+    QVERIFY(dropped);
+
+    // 空闲期间被关闭的连接立即丢弃，下一个请求直接建立新连接
+    m_server.setHandler(devices);
+    m_server.dropConnections();
+    m_server.reset();
+    QTest::qWait(100);
+    waitResult(AdbClient::instance()->hostCommand("host:devices-l"), &error);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+    QCOMPARE(m_server.services().size(), 1);
+}
+
+void AdbClientTest::timeout()
+{
+    // 接受连接但从不应答
+    m_server.setHandler([](QTcpSocket*, const QByteArray&) { return true; });
+    const quint64 timedOutBefore = AdbCommandRunner::instance()->stats().timedOut;
+    QElapsedTimer timer;
+    timer.start();
+    QString error;
+    waitResult(AdbClient::instance()->hostCommand("host:version", 200), &error);
+    QCOMPARE(error, QString("Timed out waiting for adb"));
+    QVERIFY(timer.elapsed() >= 200);
+    QVERIFY(timer.elapsed() < 2000);
+    QCOMPARE(AdbCommandRunner::instance()->stats().timedOut, timedOutBefore + 1);
+}
+
+QTEST_GUILESS_MAIN(AdbClientTest)
+#include "AdbClientTest.moc"
@@ -0,0 +1,88 @@
+//
+// Created by neapu on 2026/1/2.
+//
+
+// 呈现调度的 judder 测量：以给定刷新率回放到达序列，比较 LatencyFirst 和 Smooth 两种同步模式。
+// 用法：
+//   PresentationSchedulerBench [--refresh HZ] [--fps FPS] [--jitter-ms MS] [--frames N] [--seed N]
+//   PresentationSchedulerBench [--refresh HZ] --trace FILE
+// 不给 --trace 时使用合成序列（默认 60fps、4ms 指数抖动、3600 帧）。
+// 序列文件每行一帧 "pts_us,arrival_us"，以 # 开头的行为注释。
+#include "SyntheticTrace.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using view::PresentationScheduler;
+using SyncMode = codec::MediaClock::SyncMode;
+
+static bool loadTrace(const char* path, std::vector<PresentationScheduler::TracePoint>& trace)
+{
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream stream(line);
+        PresentationScheduler::TracePoint point{};
+        char comma = 0;
+        if (!(stream >> point.pts >> comma >> point.arrivalUs) || comma != ',') {
+            std::fprintf(stderr, "Invalid trace line: %s\n", line.c_str());
+            return false;
+        }
+        trace.push_back(point);
+    }
+    return !trace.empty();
+}
+
+static void report(const char* name, const PresentationScheduler::Stats& stats)
+{
+    std::printf("%-13s judder %7.2f ms  latency %7.2f ms  delay %6.2f ms  shown %6llu  skipped %5llu  repeated %5llu\n",
+                name, stats.latencyStdDevUs / 1000.0, stats.latencyMeanUs / 1000.0, static_cast<double>(stats.delayUs) / 1000.0,
+                static_cast<unsigned long long>(stats.shown), static_cast<unsigned long long>(stats.skipped),
+                static_cast<unsigned long long>(stats.repeated));
+}
+
+int main(int argc, char* argv[])
+{
+    double refreshHz = 60.0;
+    double fps = 60.0;
+    double jitterMs = 4.0;
+    int frames = 3600;
+    unsigned seed = 1;
+    const char* tracePath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--refresh") && hasValue) refreshHz = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--fps") && hasValue) fps = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--jitter-ms") && hasValue) jitterMs = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--frames") && hasValue) frames = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--seed") && hasValue) seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--trace") && hasValue) tracePath = argv[++i];
+        else {
+            std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    std::vector<PresentationScheduler::TracePoint> trace;
+    if (tracePath) {
+        if (!loadTrace(tracePath, trace)) {
+            std::fprintf(stderr, "Failed to load trace %s\n", tracePath);
+            return 1;
+        }
+        std::printf("trace %s: %zu frames, refresh %.1f Hz\n", tracePath, trace.size(), refreshHz);
+    } else {
+        trace = test::syntheticTrace(fps, frames, jitterMs * 1000.0, seed);
+        std::printf("synthetic trace: %d frames at %.1f fps, %.1f ms exponential jitter, seed %u, refresh %.1f Hz\n",
+                    frames, fps, jitterMs, seed, refreshHz);
+    }
+    report("latencyFirst", PresentationScheduler::benchmark(trace, refreshHz, SyncMode::LatencyFirst));
+    report("smooth", PresentationScheduler::benchmark(trace, refreshHz, SyncMode::Smooth));
+    return 0;
+}
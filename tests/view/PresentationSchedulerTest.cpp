@@ -0,0 +1,54 @@
+//
+// Created by neapu on 2026/1/2.
+//
+
+#include "SyntheticTrace.h"
+#include <QTest>
+
+using view::PresentationScheduler;
+using SyncMode = codec::MediaClock::SyncMode;
+
+class PresentationSchedulerTest : public QObject {
+    Q_OBJECT
+private slots:
+    void steadyStreamShowsEveryFrame();
+    void smoothReducesJudder();
+    void delayIsCapped();
+};
+
+void PresentationSchedulerTest::steadyStreamShowsEveryFrame()
+{
+    constexpr int FRAMES = 600;
+    const auto trace = test::syntheticTrace(60.0, FRAMES, 0.0);
+    for (const auto mode : {SyncMode::LatencyFirst, SyncMode::Smooth}) {
+        const auto stats = PresentationScheduler::benchmark(trace, 60.0, mode);
+        QCOMPARE(stats.shown, static_cast<uint64_t>(FRAMES));
+        QCOMPARE(stats.skipped, 0u);
+        QVERIFY(stats.jitterUs == 0);
+    }
+}
+
+void PresentationSchedulerTest::smoothReducesJudder()
+{
+    // 与 PresentationSchedulerBench 的默认参数相同
+    const auto trace = test::syntheticTrace(60.0, 3600, 4000.0);
+    const auto latencyFirst = PresentationScheduler::benchmark(trace, 60.0, SyncMode::LatencyFirst);
+    const auto smooth = PresentationScheduler::benchmark(trace, 60.0, SyncMode::Smooth);
+    qInfo("judder latencyFirst %.2f ms, smooth %.2f ms; skipped %llu vs %llu",
+          latencyFirst.latencyStdDevUs / 1000.0, smooth.latencyStdDevUs / 1000.0,
+          static_cast<unsigned long long>(latencyFirst.skipped), static_cast<unsigned long long>(smooth.skipped));
+    QVERIFY(smooth.latencyStdDevUs < latencyFirst.latencyStdDevUs / 2);
+    QVERIFY(smooth.skipped < latencyFirst.skipped);
+    // 平滑以增加呈现延迟为代价
+    QVERIFY(smooth.latencyMeanUs > latencyFirst.latencyMeanUs);
+}
+
+void PresentationSchedulerTest::delayIsCapped()
+{
+    const auto trace = test::syntheticTrace(60.0, 600, 200000.0);
+    const auto stats = PresentationScheduler::benchmark(trace, 60.0, SyncMode::Smooth);
+    QCOMPARE(stats.delayUs, codec::MediaClock::MAX_PRESENTATION_DELAY_US);
+}
+
+QTEST_GUILESS_MAIN(PresentationSchedulerTest)
+#include "PresentationSchedulerTest.moc"
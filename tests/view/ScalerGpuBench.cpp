@@ -0,0 +1,304 @@
+//
+// Created by neapu on 2026/1/3.
+//
+
+// 缩放着色器的 GPU 耗时：自建启用时间戳的 QRhi，把随机内容的 720p 帧按每种格式和缩放算法放大渲染到 1440p 的纹理，
+// 输出每帧 GPU 耗时的均值和最大值。VideoRenderer 使用窗口的 QRhi，没有启用时间戳，渲染耗时在这里测量。
+// 用法：
+//   ScalerGpuBench [--backend gl|vulkan|d3d11|metal] [--frames N]
+// 默认使用平台的原生后端（Windows 为 d3d11，macOS 为 metal，其余为 gl），每种组合 300 帧。
+#include "view/Scaler.h"
+#include "view/Uniforms.h"
+#include <QGuiApplication>
+#include <QFile>
+#include <QOffscreenSurface>
+#include <rhi/qrhi.h>
+#if QT_CONFIG(vulkan)
+#include <QVulkanInstance>
+#endif
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+using view::Scaler;
+
+namespace {
+constexpr QSize SOURCE_SIZE(1280, 720);
+constexpr QSize TARGET_SIZE(2560, 1440);
+// 与 VideoRenderer 相同
+constexpr float SHARPNESS = 0.5f;
+// 前几帧包含首次上传和驱动的延迟编译，不计入结果
+constexpr int WARMUP_FRAMES = 10;
+// 放大显示时的目标
+constexpr double TARGET_MS = 1.0;
+
+const float VERTEX_DATA[] = {
+    -1.0f,  1.0f,  0.0f, 0.0f,
+     1.0f,  1.0f,  1.0f, 0.0f,
+    -1.0f, -1.0f,  0.0f, 1.0f,
+     1.0f, -1.0f,  1.0f, 1.0f
+};
+
+struct Result {
+    int samples{0};
+    double totalMs{0.0};
+    double maxMs{0.0};
+};
+
+QShader loadShader(const QString& name)
+{
+    QFile file(name);
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::fprintf(stderr, "Failed to open shader %s\n", qPrintable(name));
+        return {};
+    }
+    return QShader::fromSerialized(file.readAll());
+}
+
+QByteArray randomPlane(const QSize& size, int bytesPerPixel, std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> byte(16, 235);
+    QByteArray data(size.width() * size.height() * bytesPerPixel, Qt::Uninitialized);
+    for (auto& value : data) {
+        value = static_cast<char>(byte(rng));
+    }
+    return data;
+}
+
+// 格式对应的平面：yuv420p 为 Y/U/V 三个 R8 纹理，nv12 为 R8 亮度和 RG8 交织色度
+struct Plane {
+    QRhiTexture::Format format;
+    QSize size;
+    int bytesPerPixel;
+};
+std::vector<Plane> planesFor(const char* format)
+{
+    const QSize chromaSize(SOURCE_SIZE.width() / 2, SOURCE_SIZE.height() / 2);
+    if (!std::strcmp(format, "nv12")) {
+        return {{QRhiTexture::R8, SOURCE_SIZE, 1}, {QRhiTexture::RG8, chromaSize, 2}};
+    }
+    return {{QRhiTexture::R8, SOURCE_SIZE, 1}, {QRhiTexture::R8, chromaSize, 1}, {QRhiTexture::R8, chromaSize, 1}};
+}
+
+bool run(QRhi* rhi, const char* format, Scaler scaler, int frames, Result& result)
+{
+    std::unique_ptr<QRhiBuffer> vertexBuffer(rhi->newBuffer(QRhiBuffer::Immutable, QRhiBuffer::VertexBuffer, sizeof(VERTEX_DATA)));
+    if (!vertexBuffer->create()) {
+        std::fprintf(stderr, "Failed to create vertex buffer\n");
+        return false;
+    }
+    view::Uniforms uniforms(rhi);
+
+    std::mt19937 rng(1);
+    const auto planes = planesFor(format);
+    std::vector<std::unique_ptr<QRhiTexture>> textures;
+    std::vector<QByteArray> planeData;
+    for (const auto& plane : planes) {
+        textures.emplace_back(rhi->newTexture(plane.format, plane.size));
+        if (!textures.back()->create()) {
+            std::fprintf(stderr, "Failed to create %s plane texture\n", format);
+            return false;
+        }
+        planeData.push_back(randomPlane(plane.size, plane.bytesPerPixel, rng));
+    }
+    std::unique_ptr<QRhiSampler> sampler(rhi->newSampler(QRhiSampler::Linear, QRhiSampler::Linear, QRhiSampler::None,
+                                                         QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge));
+    sampler->create();
+
+    // 绑定与 YuvTexturesSrb/VaapiTexturesSrb 相同
+    std::vector<QRhiShaderResourceBinding> bindings;
+    for (size_t i = 0; i < textures.size(); ++i) {
+        bindings.push_back(QRhiShaderResourceBinding::sampledTexture(static_cast<int>(i), QRhiShaderResourceBinding::FragmentStage,
+                                                                     textures[i].get(), sampler.get()));
+    }
+    bindings.push_back(QRhiShaderResourceBinding::uniformBuffer(3, QRhiShaderResourceBinding::VertexStage, uniforms.vsUBuffer()));
+    bindings.push_back(QRhiShaderResourceBinding::uniformBuffer(4, QRhiShaderResourceBinding::FragmentStage, uniforms.colorParamsUBuffer()));
+    bindings.push_back(QRhiShaderResourceBinding::uniformBuffer(5, QRhiShaderResourceBinding::FragmentStage, uniforms.scaleParamsUBuffer()));
+    std::unique_ptr<QRhiShaderResourceBindings> srb(rhi->newShaderResourceBindings());
+    srb->setBindings(bindings.begin(), bindings.end());
+    if (!srb->create()) {
+        std::fprintf(stderr, "Failed to create shader resource bindings\n");
+        return false;
+    }
+
+    std::unique_ptr<QRhiTexture> target(rhi->newTexture(QRhiTexture::RGBA8, TARGET_SIZE, 1, QRhiTexture::RenderTarget));
+    if (!target->create()) {
+        std::fprintf(stderr, "Failed to create render target texture\n");
+        return false;
+    }
+    std::unique_ptr<QRhiTextureRenderTarget> renderTarget(rhi->newTextureRenderTarget({target.get()}));
+    std::unique_ptr<QRhiRenderPassDescriptor> renderPass(renderTarget->newCompatibleRenderPassDescriptor());
+    renderTarget->setRenderPassDescriptor(renderPass.get());
+    if (!renderTarget->create()) {
+        std::fprintf(stderr, "Failed to create render target\n");
+        return false;
+    }
+
+    const QShader vs = loadShader(":/shaders/video.vert.qsb");
+    const QShader fs = loadShader(view::fragmentShaderName(format, scaler));
+    if (!vs.isValid() || !fs.isValid()) {
+        return false;
+    }
+    QRhiVertexInputLayout inputLayout;
+    inputLayout.setBindings({sizeof(float) * 4});
+    inputLayout.setAttributes({
+        {0, 0, QRhiVertexInputAttribute::Float2, 0},
+        {0, 1, QRhiVertexInputAttribute::Float2, sizeof(float) * 2},
+    });
+    std::unique_ptr<QRhiGraphicsPipeline> pipeline(rhi->newGraphicsPipeline());
+    pipeline->setShaderStages({{QRhiShaderStage::Vertex, vs}, {QRhiShaderStage::Fragment, fs}});
+    pipeline->setVertexInputLayout(inputLayout);
+    pipeline->setTopology(QRhiGraphicsPipeline::TriangleStrip);
+    pipeline->setShaderResourceBindings(srb.get());
+    pipeline->setRenderPassDescriptor(renderPass.get());
+    if (!pipeline->create()) {
+        std::fprintf(stderr, "Failed to create graphics pipeline\n");
+        return false;
+    }
+
+    for (int i = 0; i < WARMUP_FRAMES + frames; ++i) {
+        QRhiCommandBuffer* cb = nullptr;
+        if (rhi->beginOffscreenFrame(&cb) != QRhi::FrameOpSuccess) {
+            std::fprintf(stderr, "Failed to begin offscreen frame\n");
+            return false;
+        }
+        // 与 VideoRenderer 一样每帧重新上传纹理，时间戳只覆盖这一帧的命令
+        QRhiResourceUpdateBatch* rub = rhi->nextResourceUpdateBatch();
+        if (i == 0) {
+            rub->uploadStaticBuffer(vertexBuffer.get(), VERTEX_DATA);
+            uniforms.updateVsUniforms(rub, TARGET_SIZE, SOURCE_SIZE);
+            uniforms.updateColorParamsUniforms(rub, codec::Frame::ColorSpace::BT709, codec::Frame::ColorRange::Limited);
+            uniforms.updateScaleParamsUniforms(rub, SOURCE_SIZE, SHARPNESS);
+        }
+        for (size_t plane = 0; plane < textures.size(); ++plane) {
+            const QRhiTextureSubresourceUploadDescription sub(planeData[plane].constData(),
+                                                             static_cast<quint32>(planeData[plane].size()));
+            rub->uploadTexture(textures[plane].get(), QRhiTextureUploadDescription({0, 0, sub}));
+        }
+        cb->beginPass(renderTarget.get(), Qt::black, {1.0f, 0}, rub);
+        cb->setGraphicsPipeline(pipeline.get());
+        cb->setShaderResources(srb.get());
+        cb->setViewport(QRhiViewport(0.0f, 0.0f, static_cast<float>(TARGET_SIZE.width()), static_cast<float>(TARGET_SIZE.height())));
+        const QRhiCommandBuffer::VertexInput vertexInput[] = {{vertexBuffer.get(), 0}};
+        cb->setVertexInput(0, 1, vertexInput);
+        cb->draw(4);
+        cb->endPass();
+        rhi->endOffscreenFrame();
+
+        // 离屏帧结束时已等待 GPU 完成，返回的就是这一帧的耗时
+        const double seconds = cb->lastCompletedGpuTime();
+        if (i < WARMUP_FRAMES || seconds <= 0.0) {
+            continue;
+        }
+        const double ms = seconds * 1000.0;
+        ++result.samples;
+        result.totalMs += ms;
+        result.maxMs = std::max(result.maxMs, ms);
+    }
+    return true;
+}
+
+struct RhiHolder {
+    std::unique_ptr<QOffscreenSurface> fallbackSurface;
+#if QT_CONFIG(vulkan)
+    QVulkanInstance vulkanInstance;
+#endif
+    std::unique_ptr<QRhi> rhi;
+};
+
+bool createRhi(const QByteArray& backend, RhiHolder& holder)
+{
+    const QRhi::Flags flags = QRhi::EnableTimestamps;
+    if (backend == "gl") {
+        QRhiGles2InitParams params;
+        holder.fallbackSurface.reset(QRhiGles2InitParams::newFallbackSurface());
+        params.fallbackSurface = holder.fallbackSurface.get();
+        holder.rhi.reset(QRhi::create(QRhi::OpenGLES2, &params, flags));
+#if QT_CONFIG(vulkan)
+    } else if (backend == "vulkan") {
+        holder.vulkanInstance.setExtensions(QRhiVulkanInitParams::preferredInstanceExtensions());
+        if (!holder.vulkanInstance.create()) {
+            return false;
+        }
+        QRhiVulkanInitParams params;
+        params.inst = &holder.vulkanInstance;
+        holder.rhi.reset(QRhi::create(QRhi::Vulkan, &params, flags));
+#endif
+#ifdef Q_OS_WIN
+    } else if (backend == "d3d11") {
+        QRhiD3D11InitParams params;
+        holder.rhi.reset(QRhi::create(QRhi::D3D11, &params, flags));
+#endif
+#if defined(Q_OS_MACOS) || defined(Q_OS_IOS)
+    } else if (backend == "metal") {
+        QRhiMetalInitParams params;
+        holder.rhi.reset(QRhi::create(QRhi::Metal, &params, flags));
+#endif
+    } else {
+        std::fprintf(stderr, "Backend %s is not available in this build\n", backend.constData());
+        return false;
+    }
+    return holder.rhi != nullptr;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QGuiApplication app(argc, argv);
+
+#if defined(Q_OS_WIN)
+    QByteArray backend = "d3d11";
+#elif defined(Q_OS_MACOS)
+    QByteArray backend = "metal";
+#else
+    QByteArray backend = "gl";
+#endif
+    int frames = 300;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--backend") && hasValue) backend = argv[++i];
+        else if (!std::strcmp(argv[i], "--frames") && hasValue) frames = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    RhiHolder holder;
+    if (!createRhi(backend, holder)) {
+        std::fprintf(stderr, "Failed to create %s QRhi\n", backend.constData());
+        return 1;
+    }
+    QRhi* rhi = holder.rhi.get();
+    if (!rhi->isFeatureSupported(QRhi::Timestamps)) {
+        std::fprintf(stderr, "The %s backend does not support GPU timestamps\n", rhi->backendName());
+        return 1;
+    }
+    std::printf("%s on %s: %dx%d -> %dx%d, %d frames per shader\n", rhi->backendName(),
+                rhi->driverInfo().deviceName.constData(), SOURCE_SIZE.width(), SOURCE_SIZE.height(),
+                TARGET_SIZE.width(), TARGET_SIZE.height(), frames);
+
+    bool ok = true;
+    for (const char* format : {"yuv420p", "nv12"}) {
+        for (const Scaler scaler : {Scaler::Bilinear, Scaler::Bicubic, Scaler::Lanczos, Scaler::Sharp}) {
+            Result result;
+            if (!run(rhi, format, scaler, frames, result)) {
+                ok = false;
+                continue;
+            }
+            if (result.samples == 0) {
+                std::printf("%-8s %-9s no timestamp samples\n", format, view::scalerName(scaler));
+                ok = false;
+                continue;
+            }
+            const double meanMs = result.totalMs / result.samples;
+            std::printf("%-8s %-9s mean %7.3f ms  max %7.3f ms  %s\n", format, view::scalerName(scaler), meanMs,
+                        result.maxMs, meanMs < TARGET_MS ? "ok" : "over 1 ms");
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,34 @@
+//
+// Created by neapu on 2026/1/2.
+//
+
+#pragma once
+#include "view/PresentationScheduler.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace test {
+// 固定帧率的到达序列：每帧在 PTS 之后加上一段指数分布的网络/解码抖动到达，
+// TCP 保证按顺序到达，因此到达时间不早于上一帧。种子固定，结果可复现
+inline std::vector<view::PresentationScheduler::TracePoint> syntheticTrace(double fps, int frames, double jitterMeanUs,
+                                                                          unsigned seed = 1)
+{
+    std::mt19937 rng(seed);
+    std::exponential_distribution<double> jitter(jitterMeanUs > 0 ? 1.0 / jitterMeanUs : 1.0);
+    // 任意的两端时钟偏移，调度器只关心差值
+    constexpr int64_t CLOCK_OFFSET_US = 1000000000;
+    const double intervalUs = 1e6 / fps;
+    std::vector<view::PresentationScheduler::TracePoint> trace;
+    trace.reserve(static_cast<size_t>(frames));
+    int64_t lastArrivalUs = 0;
+    for (int i = 0; i < frames; i++) {
+        const auto pts = static_cast<int64_t>(i * intervalUs);
+        const auto delayUs = jitterMeanUs > 0 ? static_cast<int64_t>(jitter(rng)) : 0;
+        const int64_t arrivalUs = std::max(lastArrivalUs, CLOCK_OFFSET_US + pts + delayUs);
+        trace.push_back({pts, arrivalUs});
+        lastArrivalUs = arrivalUs;
+    }
+    return trace;
+}
+} // namespace test